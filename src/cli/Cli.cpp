@@ -0,0 +1,584 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "Cli.h"
+#include "BatchScanner.h"
+#include "FlvConcat.h"
+#include "FlvCutter.h"
+#include "FlvSplitter.h"
+#include "Log.h"
+#include "ModelWidget.h"
+#include "Mp4Remuxer.h"
+#include "StreamExtractor.h"
+#include "Trace.h"
+#include "TsMuxer.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <cstdio>
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
+namespace {
+
+struct CliCommand {
+    const char* m_name;
+    const char* m_description;
+    int (*m_run)(const QStringList& args);
+};
+
+// 解析命令参数，失败或--help时输出用法并返回false，exit_code为进程退出码
+bool parseArgs(QCommandLineParser& parser, const QStringList& args, int positional, int& exit_code) {
+    parser.addHelpOption();
+    if (!parser.parse(args)) {
+        cliErr() << parser.errorText() << "\n\n" << parser.helpText();
+        exit_code = 2;
+        return false;
+    }
+    if (parser.isSet("help")) {
+        cliOut() << parser.helpText();
+        exit_code = 0;
+        return false;
+    }
+    if (parser.positionalArguments().size() < positional) {
+        cliErr() << parser.helpText();
+        exit_code = 2;
+        return false;
+    }
+    return true;
+}
+
+// 解析FLV文件，失败时输出原因
+bool loadTags(const QString& path, bool recover, ModelTagList& model) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        cliErr() << QString("打开文件失败：%1：%2\n").arg(path, file.errorString());
+        return false;
+    }
+    model.readFromFile(file, recover);
+    if (!model.getFlvHeader()) {
+        cliErr() << QString("不是有效的FLV文件：%1\n").arg(path);
+        return false;
+    }
+    return true;
+}
+
+int runHash(const QStringList& args) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("计算每个tag负载的XXH64哈希并标记重复的tag，按TSV输出");
+    parser.addPositionalArgument("file", "FLV文件");
+    parser.addOption({"duplicates", "只输出重复的tag"});
+    parser.addOption({"recover", "遇到损坏的tag时重同步继续解析"});
+    int exit_code = 0;
+    if (!parseArgs(parser, args, 1, exit_code))
+        return exit_code;
+
+    QString path = parser.positionalArguments().at(0);
+    ModelTagList model;
+    if (!loadTags(path, parser.isSet("recover"), model))
+        return 1;
+
+    try {
+        model.computePayloadHashes(path);
+    } catch (const QString& error) {
+        cliErr() << error << "\n";
+        return 1;
+    }
+
+    const TagIndex& index = model.getTagIndex();
+    bool only_duplicates = parser.isSet("duplicates");
+    QTextStream& out = cliOut();
+    out << "index\toffset\ttype\ttimestamp\tsize\thash\tduplicate\n";
+    for (size_t i = 0; i < index.size(); ++i) {
+        bool duplicate = index.m_flags[i] & TAG_FLAG_DUPLICATE;
+        if (only_duplicates && !duplicate)
+            continue;
+        const char* type = (index.m_flags[i] & TAG_FLAG_GARBAGE) ? "garbage" : getTagType(index.m_type[i]);
+        out << i << '\t' << QString("0x%1").arg(index.m_offset[i], 8, 16, QChar('0')) << '\t' << type << '\t'
+            << index.m_timestamp[i] << '\t' << index.m_data_size[i] << '\t'
+            << QString("%1").arg(index.m_payload_hash[i], 16, 16, QChar('0')) << '\t' << (duplicate ? 1 : 0) << '\n';
+    }
+    return 0;
+}
+
+int runExtract(const QStringList& args) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("导出裸码流：H.264/HEVC为Annex-B，AAC为ADTS，MP3原样输出。\n"
+                                     "不指定--video/--audio时导出所有支持的流，文件名为<输入文件名>.<格式>");
+    parser.addPositionalArgument("file", "FLV文件");
+    parser.addOption({"video", "视频流输出路径", "path"});
+    parser.addOption({"audio", "音频流输出路径", "path"});
+    parser.addOption({"track", "多轨文件中导出的轨道号，默认为0", "id", "0"});
+    parser.addOption({"recover", "遇到损坏的tag时重同步继续解析"});
+    int exit_code = 0;
+    if (!parseArgs(parser, args, 1, exit_code))
+        return exit_code;
+
+    bool track_ok = false;
+    uint32_t track_id = parser.value("track").toUInt(&track_ok);
+    if (!track_ok || track_id > 0xFF) {
+        cliErr() << QString("无效的轨道号：%1\n").arg(parser.value("track"));
+        return 2;
+    }
+
+    QString path = parser.positionalArguments().at(0);
+    ModelTagList model;
+    if (!loadTags(path, parser.isSet("recover"), model))
+        return 1;
+
+    const TagIndex& index = model.getTagIndex();
+    QFileInfo info(path);
+    bool explicit_target = parser.isSet("video") || parser.isSet("audio");
+    int exported = 0;
+    for (auto track : {StreamExtractor::TRACK_VIDEO, StreamExtractor::TRACK_AUDIO}) {
+        QString option = track == StreamExtractor::TRACK_VIDEO ? "video" : "audio";
+        QString format = StreamExtractor::outputFormat(index, track, static_cast<uint8_t>(track_id));
+        QString target = parser.value(option);
+        if (explicit_target && target.isEmpty())
+            continue;
+        if (format.isEmpty()) {
+            if (explicit_target) {
+                cliErr() << QString("%1：没有可导出的流\n").arg(option);
+                return 1;
+            }
+            continue;
+        }
+        if (target.isEmpty())
+            target = info.absolutePath() + "/" + info.completeBaseName() + "." + format;
+
+        ExtractReport report;
+        if (!StreamExtractor::extract(path, target, index, track, report, static_cast<uint8_t>(track_id))) {
+            cliErr() << QString("%1：导出失败：%2\n").arg(option, report.m_error);
+            return 1;
+        }
+        cliOut() << option << '\t' << target << '\t' << report.m_format << '\t' << report.m_frames << " frames\t"
+                 << report.m_output_size << " bytes\t" << report.m_skipped << " skipped\n";
+        ++exported;
+    }
+    if (exported == 0) {
+        cliErr() << "没有可导出的流，目前支持H.264、HEVC、AAC和MP3\n";
+        return 1;
+    }
+    return 0;
+}
+
+// 时间参数(ms)：1500ms、90s、90（秒）、1:30、01:02:03.5
+bool parseTime(const QString& text, uint32_t& ms) {
+    bool ok = false;
+    double value = 0;
+    if (text.endsWith("ms")) {
+        value = text.chopped(2).toDouble(&ok);
+    } else if (text.endsWith("s")) {
+        value = text.chopped(1).toDouble(&ok) * 1000;
+    } else {
+        ok = true;
+        for (const QString& part : text.split(':')) {
+            bool part_ok = false;
+            value = value * 60 + part.toDouble(&part_ok);
+            ok &= part_ok;
+        }
+        value *= 1000;
+    }
+    if (!ok || value < 0 || value > 0xFFFFFFFFu)
+        return false;
+    ms = static_cast<uint32_t>(value);
+    return true;
+}
+
+int runCut(const QStringList& args) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("无损截取时间范围：起点向前对齐到关键帧，带上之前的sequence header，"
+                                     "时间戳从0开始。\n时间格式：1500ms、90s、90、1:30、01:02:03.5");
+    parser.addPositionalArgument("file", "FLV文件");
+    parser.addOption({"start", "开始时间，默认为0", "time", "0"});
+    parser.addOption({"end", "结束时间（不含），默认到文件结尾", "time"});
+    parser.addOption({{"o", "output"}, "输出路径，默认为<输入文件名>_<开始>-<结束>.flv", "path"});
+    parser.addOption({"recover", "遇到损坏的tag时重同步继续解析"});
+    int exit_code = 0;
+    if (!parseArgs(parser, args, 1, exit_code))
+        return exit_code;
+
+    uint32_t start = 0;
+    uint32_t end = 0xFFFFFFFFu;
+    if (!parseTime(parser.value("start"), start) || (parser.isSet("end") && !parseTime(parser.value("end"), end))) {
+        cliErr() << "无法识别的时间\n";
+        return 2;
+    }
+
+    QString path = parser.positionalArguments().at(0);
+    ModelTagList model;
+    if (!loadTags(path, parser.isSet("recover"), model))
+        return 1;
+
+    QString target = parser.value("output");
+    if (target.isEmpty()) {
+        QFileInfo info(path);
+        QString end_text = parser.isSet("end") ? QString::number(end / 1000) : QString("end");
+        target = info.absolutePath() + "/" + info.completeBaseName() +
+                 QString("_%1-%2.flv").arg(start / 1000).arg(end_text);
+    }
+
+    CutReport report;
+    if (!FlvCutter::cut(path, target, model.getTagList(), model.getTagIndex(), start, end, report)) {
+        cliErr() << "截取失败：" << report.m_error << "\n";
+        return 1;
+    }
+    cliOut() << target << '\t' << report.m_start << '\t' << report.m_end << '\t' << report.m_tags_written
+             << " tags\t" << report.m_output_size << " bytes\n";
+    return 0;
+}
+
+int runConcat(const QStringList& args) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("按顺序无损合并多个FLV片段：检查编码参数是否一致，时间戳首尾相接，"
+                                     "去掉重复的sequence header并重建onMetaData");
+    parser.addPositionalArgument("files", "FLV片段，按合并顺序排列", "<file> <file>...");
+    parser.addOption({{"o", "output"}, "输出路径", "path"});
+    parser.addOption({"allow-config-change", "允许片段之间sequence header不同（如分辨率变化）"});
+    parser.addOption({"recover", "遇到损坏的tag时重同步继续解析"});
+    int exit_code = 0;
+    if (!parseArgs(parser, args, 2, exit_code))
+        return exit_code;
+    if (!parser.isSet("output")) {
+        cliErr() << "需要用-o指定输出路径\n";
+        return 2;
+    }
+
+    ConcatOptions options;
+    options.m_recover = parser.isSet("recover");
+    options.m_allow_config_change = parser.isSet("allow-config-change");
+    ConcatReport report;
+    QString target = parser.value("output");
+    if (!FlvConcat::concat(parser.positionalArguments(), target, options, report)) {
+        cliErr() << "合并失败：" << report.m_error << "\n";
+        return 1;
+    }
+    cliOut() << target << '\t' << report.m_segments << " segments\t" << report.m_tags_written << " tags\t"
+             << report.m_duration << " ms\t" << report.m_output_size << " bytes\n";
+    return 0;
+}
+
+int runRemux(const QStringList& args) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("不重新编码转封装为fragmented MP4（每个GOP一个分片），"
+                                     "支持H.264/HEVC/AV1视频和AAC音频");
+    parser.addPositionalArgument("file", "FLV文件");
+    parser.addOption({{"o", "output"}, "输出路径，默认为<输入文件名>.mp4", "path"});
+    parser.addOption({"recover", "遇到损坏的tag时重同步继续解析"});
+    int exit_code = 0;
+    if (!parseArgs(parser, args, 1, exit_code))
+        return exit_code;
+
+    QString path = parser.positionalArguments().at(0);
+    ModelTagList model;
+    if (!loadTags(path, parser.isSet("recover"), model))
+        return 1;
+
+    QString target = parser.value("output");
+    if (target.isEmpty()) {
+        QFileInfo info(path);
+        target = info.absolutePath() + "/" + info.completeBaseName() + ".mp4";
+    }
+
+    RemuxReport report;
+    if (!Mp4Remuxer::remux(path, target, model.getTagList(), model.getTagIndex(), report)) {
+        cliErr() << "转封装失败：" << report.m_error << "\n";
+        return 1;
+    }
+    cliOut() << target << '\t' << report.m_fragments << " fragments\t" << report.m_video_samples << " video\t"
+             << report.m_audio_samples << " audio\t" << report.m_output_size << " bytes\n";
+    return 0;
+}
+
+int runTs(const QStringList& args) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("不重新编码转封装为MPEG-TS，支持H.264/HEVC视频和AAC/MP3音频。\n"
+                                     "输出为.m3u8或指定--hls时按关键帧切分HLS分片并生成播放列表");
+    parser.addPositionalArgument("file", "FLV文件");
+    parser.addOption({{"o", "output"}, "输出路径（.ts或.m3u8），默认为<输入文件名>.ts/.m3u8", "path"});
+    parser.addOption({"hls", "输出HLS分片和播放列表"});
+    parser.addOption({"segment", "HLS分片目标时长（秒），默认为6", "seconds", "6"});
+    parser.addOption({"recover", "遇到损坏的tag时重同步继续解析"});
+    int exit_code = 0;
+    if (!parseArgs(parser, args, 1, exit_code))
+        return exit_code;
+
+    TsOptions options;
+    QString target = parser.value("output");
+    options.m_hls = parser.isSet("hls") || target.endsWith(".m3u8", Qt::CaseInsensitive);
+    bool ok = false;
+    double segment = parser.value("segment").toDouble(&ok);
+    if (!ok || segment <= 0) {
+        cliErr() << "无法识别的分片时长\n";
+        return 2;
+    }
+    options.m_segment_duration = static_cast<uint32_t>(segment * 1000);
+
+    QString path = parser.positionalArguments().at(0);
+    ModelTagList model;
+    if (!loadTags(path, parser.isSet("recover"), model))
+        return 1;
+
+    if (target.isEmpty()) {
+        QFileInfo info(path);
+        target = info.absolutePath() + "/" + info.completeBaseName() + (options.m_hls ? ".m3u8" : ".ts");
+    }
+
+    TsReport report;
+    if (!TsMuxer::remux(path, target, model.getTagIndex(), options, report)) {
+        cliErr() << "转封装失败：" << report.m_error << "\n";
+        return 1;
+    }
+    cliOut() << target << '\t' << report.m_segments << " segments\t" << report.m_video_frames << " video\t"
+             << report.m_audio_frames << " audio\t" << report.m_output_size << " bytes\n";
+    return 0;
+}
+
+int runSplit(const QStringList& args) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("按时长、大小或关键帧数无损分割，每段在达到阈值后的第一个关键帧处结束，"
+                                     "带上sequence header并重建onMetaData，各段并行写出。\n"
+                                     "输出为<输出目录>/<输入文件名>_001.flv、_002.flv...");
+    parser.addPositionalArgument("file", "FLV文件");
+    parser.addOption({"duration", "每段时长，格式同cut（如1:00:00）", "time"});
+    parser.addOption({"size", "每段大小(MB)", "mb"});
+    parser.addOption({"keyframes", "每段关键帧数", "count"});
+    parser.addOption({{"o", "output"}, "输出目录，默认为输入文件所在目录", "dir"});
+    parser.addOption({"recover", "遇到损坏的tag时重同步继续解析"});
+    int exit_code = 0;
+    if (!parseArgs(parser, args, 1, exit_code))
+        return exit_code;
+
+    SplitOptions options;
+    bool ok = false;
+    if (parser.isSet("duration")) {
+        uint32_t ms = 0;
+        ok = parseTime(parser.value("duration"), ms);
+        options.m_mode = SplitOptions::MODE_DURATION;
+        options.m_value = ms;
+    } else if (parser.isSet("size")) {
+        options.m_mode = SplitOptions::MODE_SIZE;
+        options.m_value = static_cast<uint64_t>(parser.value("size").toDouble(&ok) * 1024 * 1024);
+    } else if (parser.isSet("keyframes")) {
+        options.m_mode = SplitOptions::MODE_KEYFRAMES;
+        options.m_value = parser.value("keyframes").toULongLong(&ok);
+    }
+    if (!ok || options.m_value == 0) {
+        cliErr() << "需要指定--duration、--size或--keyframes中的一个正数\n";
+        return 2;
+    }
+
+    QString path = parser.positionalArguments().at(0);
+    ModelTagList model;
+    if (!loadTags(path, parser.isSet("recover"), model))
+        return 1;
+
+    QString output_dir = parser.isSet("output") ? parser.value("output") : QFileInfo(path).absolutePath();
+    SplitReport report;
+    if (!FlvSplitter::split(path, output_dir, model.getTagList(), model.getTagIndex(), options, report)) {
+        cliErr() << "分割失败：" << report.m_error << "\n";
+        return 1;
+    }
+    for (const QString& file : report.m_files) {
+        cliOut() << file << "\n";
+    }
+    cliOut() << report.m_files.size() << " parts\t" << report.m_tags_written << " tags\t" << report.m_output_size
+             << " bytes\n";
+    return 0;
+}
+
+int runScan(const QStringList& args) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("遍历目录树，并行解析每个FLV文件的文件头、tag和onMetaData并校验，"
+                                     "输出时长、codec、码率、校验错误数和损坏位置。\n"
+                                     "每个文件完成后立即输出一条，顺序为完成顺序；汇总输出到标准错误");
+    parser.addPositionalArgument("dirs", "要扫描的目录", "<dir> [<dir>...]");
+    parser.addOption({"format", "输出格式：csv或json，默认为csv", "format", "csv"});
+    parser.addOption({{"o", "output"}, "输出文件，默认为标准输出", "path"});
+    parser.addOption({"io", "同一个设备上同时解析的文件数，默认为2，机械硬盘建议为1", "count", "2"});
+    parser.addOption({"recover", "遇到损坏的tag时重同步继续解析"});
+    int exit_code = 0;
+    if (!parseArgs(parser, args, 1, exit_code))
+        return exit_code;
+
+    QString format = parser.value("format").toLower();
+    if (format != "csv" && format != "json") {
+        cliErr() << "--format只能为csv或json\n";
+        return 2;
+    }
+    ScanOptions options;
+    bool ok = false;
+    options.m_io_per_device = parser.value("io").toInt(&ok);
+    options.m_recover = parser.isSet("recover");
+    if (!ok || options.m_io_per_device <= 0) {
+        cliErr() << "--io需要为正整数\n";
+        return 2;
+    }
+
+    QStringList files;
+    for (const QString& dir : parser.positionalArguments()) {
+        if (!QFileInfo(dir).isDir()) {
+            cliErr() << "目录不存在：" << dir << "\n";
+            return 1;
+        }
+        files += BatchScanner::listFiles(dir, options.m_name_filters);
+    }
+    if (files.isEmpty()) {
+        cliErr() << "没有找到FLV文件\n";
+        return 1;
+    }
+
+    // 写入文件时在标准错误显示进度
+    QFile output_file;
+    QTextStream file_stream;
+    QTextStream* out = &cliOut();
+    bool to_file = parser.isSet("output");
+    if (to_file) {
+        output_file.setFileName(parser.value("output"));
+        if (!output_file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+            cliErr() << QString("打开输出文件失败：%1\n").arg(output_file.errorString());
+            return 1;
+        }
+        file_stream.setDevice(&output_file);
+        out = &file_stream;
+    }
+
+    bool json = format == "json";
+    *out << (json ? QString("[") : BatchScanner::csvHeader()) << '\n';
+    size_t finished = 0;
+    ScanReport report;
+    BatchScanner::scan(
+        files,
+        options,
+        [&](const ScanResult& result) {
+            if (json) {
+                *out << (finished ? ",\n" : "") << BatchScanner::toJson(result);
+            } else {
+                *out << BatchScanner::toCsv(result) << '\n';
+            }
+            out->flush();
+            ++finished;
+            if (to_file) {
+                cliErr() << QString("[%1/%2] %3\n").arg(finished).arg(files.size()).arg(result.m_path);
+                cliErr().flush();
+            }
+        },
+        report);
+    if (json) {
+        *out << "\n]\n";
+    }
+    out->flush();
+
+    cliErr() << report.toString() << '\n';
+    return 0;
+}
+
+const CliCommand COMMANDS[] = {
+    {"hash", "计算tag负载哈希并查找重复tag", runHash},
+    {"extract", "导出H.264/HEVC/AAC/MP3裸码流", runExtract},
+    {"cut", "按时间范围无损截取", runCut},
+    {"concat", "无损合并多个FLV片段", runConcat},
+    {"split", "按时长、大小或关键帧数无损分割", runSplit},
+    {"remux", "转封装为fragmented MP4", runRemux},
+    {"ts", "转封装为MPEG-TS或HLS", runTs},
+    {"scan", "批量扫描目录，输出各文件的分析和校验结果（CSV/JSON）", runScan},
+};
+
+const CliCommand* findCommand(const char* name) {
+    for (const CliCommand& command : COMMANDS) {
+        if (strcmp(command.m_name, name) == 0)
+            return &command;
+    }
+    return nullptr;
+}
+
+void printUsage(QTextStream& out) {
+    out << "用法：flv-parser <命令> [参数]，不带命令时启动图形界面\n\n命令：\n";
+    for (const CliCommand& command : COMMANDS) {
+        out << "  " << QString(command.m_name).leftJustified(12) << command.m_description << '\n';
+    }
+    out << "\nflv-parser <命令> --help 查看命令的参数\n";
+    out << "flv-parser <命令> ... --trace <文件> 记录各阶段耗时，导出为Chrome trace JSON\n";
+}
+
+// 程序以窗口子系统链接，从控制台启动时需要接回父进程的控制台
+void attachConsole() {
+#ifdef Q_OS_WIN
+    if (AttachConsole(ATTACH_PARENT_PROCESS)) {
+        freopen("CONOUT$", "w", stdout);
+        freopen("CONOUT$", "w", stderr);
+    }
+#endif
+}
+
+} // namespace
+
+QTextStream& cliOut() {
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+QTextStream& cliErr() {
+    static QTextStream stream(stderr);
+    return stream;
+}
+
+bool isCliCommand(int argc, char* argv[]) {
+    if (argc < 2)
+        return false;
+    return findCommand(argv[1]) || strcmp(argv[1], "help") == 0 || strcmp(argv[1], "--help") == 0;
+}
+
+int runCli(int argc, char* argv[]) {
+    attachConsole();
+    QCoreApplication app(argc, argv);
+
+    // 日志仍写入日志文件，标准输出只保留命令结果
+    initLog();
+    qSetMessagePattern("[%{type}] %{message}");
+    qInstallMessageHandler(customMessageHandler);
+
+    QStringList args = app.arguments();
+    const CliCommand* command = findCommand(argv[1]);
+
+    // 所有命令通用的--trace <文件>，在交给命令解析前取出
+    QString trace_path;
+    int trace_arg = args.indexOf("--trace");
+    if (command && trace_arg >= 2 && trace_arg + 1 < args.size()) {
+        trace_path = args[trace_arg + 1];
+        args.removeAt(trace_arg);
+        args.removeAt(trace_arg);
+        Trace::start();
+    }
+
+    int exit_code = 0;
+    if (command) {
+        // 去掉命令名，保留程序名供QCommandLineParser解析
+        args.removeAt(1);
+        qCInfo(runLog) << QString("[flv-cli] event[started] command[%1] args[%2]")
+                              .arg(command->m_name, args.mid(1).join(' '));
+        TRACE_SCOPE("cli_command");
+        exit_code = command->m_run(args);
+    } else {
+        printUsage(cliOut());
+    }
+
+    if (!trace_path.isEmpty()) {
+        Trace::stop();
+        QString error;
+        if (!Trace::exportChromeJson(trace_path, error)) {
+            cliErr() << "写出跟踪文件失败：" << error << '\n';
+            exit_code = exit_code ? exit_code : 1;
+        }
+    }
+
+    cliOut().flush();
+    cliErr().flush();
+    shutdownLog();
+    return exit_code;
+}
@@ -0,0 +1,24 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+
+/**
+ * @brief 命令行模式：flv-parser <命令> [参数]，不创建窗口，结果输出到标准输出
+ *
+ * 命令在Cli.cpp的命令表中注册，每个命令自行解析参数，返回进程退出码
+ */
+
+// argv[1]为已注册的命令或help时进入命令行模式
+bool isCliCommand(int argc, char* argv[]);
+
+int runCli(int argc, char* argv[]);
+
+// 命令的输出流，进程退出前统一刷新
+QTextStream& cliOut();
+QTextStream& cliErr();
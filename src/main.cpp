@@ -2,6 +2,7 @@
 //
 // SPDX-License-Identifier: MIT
 
+#include "Cli.h"
 #include "Log.h"
 #include "mainwindow.h"
 #include <QApplication>
@@ -9,6 +10,11 @@
 #include <QStyleFactory>
 
 int main(int argc, char* argv[]) {
+    // 带命令参数时走命令行模式，不创建窗口
+    if (isCliCommand(argc, argv)) {
+        return runCli(argc, argv);
+    }
+
     QApplication a(argc, argv);
     a.setWindowIcon(QIcon(":/app.ico"));
     a.setStyle(QStyleFactory::create("Fusion"));
@@ -20,5 +26,7 @@ int main(int argc, char* argv[]) {
 
     MainWindow w;
     w.show();
-    return a.exec();
+    int exit_code = a.exec();
+    shutdownLog();
+    return exit_code;
 }
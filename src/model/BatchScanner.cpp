@@ -0,0 +1,292 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "BatchScanner.h"
+#include "Log.h"
+#include "ModelWidget.h"
+#include "StreamValidator.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStorageInfo>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+// 一个设备上待解析的文件，由该设备的几个任务依次领取
+struct DeviceQueue {
+    QStringList m_files;
+    atomic<size_t> m_next{0};
+};
+
+// 逗号、引号或换行需要加引号，引号写两次
+QString csvField(const QString& text) {
+    if (!text.contains(',') && !text.contains('"') && !text.contains('\n') && !text.contains('\r'))
+        return text;
+    QString quoted = text;
+    quoted.replace("\"", "\"\"");
+    return "\"" + quoted + "\"";
+}
+
+QString jsonString(const QString& text) {
+    QString escaped = "\"";
+    for (QChar c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else if (c == '\r') {
+            escaped += "\\r";
+        } else if (c == '\t') {
+            escaped += "\\t";
+        } else if (c.unicode() < 0x20) {
+            escaped += QString("\\u%1").arg(c.unicode(), 4, 16, QChar('0'));
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped + "\"";
+}
+
+QString hexOffset(uint64_t offset) {
+    return "0x" + QString::number(static_cast<qulonglong>(offset), 16);
+}
+
+// onMetaData中的字段，从第一个onMetaData取
+void readMetadata(const vector<unique_ptr<FLVTag>>& tags, ScanResult& result) {
+    for (const auto& tag : tags) {
+        if (!tag->metadata_info || tag->metadata_info->m_metadata_values.key != "onMetaData")
+            continue;
+        for (const auto& item : tag->metadata_info->m_metadata_values.obj_value) {
+            if (!holds_alternative<double>(item.value))
+                continue;
+            double value = get<double>(item.value);
+            if (item.key == "duration") {
+                result.m_metadata_duration = value;
+            } else if (item.key == "width") {
+                result.m_width = static_cast<uint32_t>(value);
+            } else if (item.key == "height") {
+                result.m_height = static_cast<uint32_t>(value);
+            }
+        }
+        return;
+    }
+}
+
+} // namespace
+
+void ScanReport::add(const ScanResult& result) {
+    ++m_files;
+    if (!result.m_error.isEmpty()) {
+        ++m_failed;
+        return;
+    }
+    if (result.m_errors > 0)
+        ++m_with_errors;
+    m_total_size += result.m_file_size;
+    m_total_duration += result.m_duration;
+}
+
+QString ScanReport::toString() const {
+    return QString("扫描%1个文件，%2个无法解析，%3个校验出错误\n"
+                   "总大小%4字节，总时长%5秒，耗时%6ms")
+        .arg(m_files)
+        .arg(m_failed)
+        .arg(m_with_errors)
+        .arg(m_total_size)
+        .arg(m_total_duration / 1000.0, 0, 'f', 1)
+        .arg(m_elapsed);
+}
+
+QStringList BatchScanner::listFiles(const QString& dir, const QStringList& name_filters) {
+    QStringList files;
+    QDirIterator it(dir, name_filters, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        files.append(it.next());
+    }
+    files.sort();
+    return files;
+}
+
+void BatchScanner::scan(const QStringList& files,
+                        const ScanOptions& options,
+                        const function<void(const ScanResult&)>& on_result,
+                        ScanReport& report) {
+    QElapsedTimer timer;
+    timer.start();
+
+    // 按设备分组，设备之间的读取互不排队
+    vector<unique_ptr<DeviceQueue>> devices;
+    map<QByteArray, DeviceQueue*> device_queues;
+    for (const QString& path : files) {
+        QStorageInfo storage(path);
+        QByteArray device = storage.device().isEmpty() ? storage.rootPath().toUtf8() : storage.device();
+        DeviceQueue*& queue = device_queues[device];
+        if (!queue) {
+            devices.emplace_back(new DeviceQueue);
+            queue = devices.back().get();
+        }
+        queue->m_files.append(path);
+    }
+    qCInfo(runLog) << QString("[flv-scan] event[started] files[%1] devices[%2] io-per-device[%3]")
+                          .arg(files.size())
+                          .arg(devices.size())
+                          .arg(options.m_io_per_device);
+
+    mutex result_mutex;
+    TaskGroup group;
+    for (const auto& device : devices) {
+        DeviceQueue* queue = device.get();
+        int lanes = min<int>(max(1, options.m_io_per_device), queue->m_files.size());
+        for (int lane = 0; lane < lanes; ++lane) {
+            group.run([&, queue]() {
+                for (size_t i = queue->m_next++; i < static_cast<size_t>(queue->m_files.size()); i = queue->m_next++) {
+                    ScanResult result = analyzeFile(queue->m_files[i], options.m_recover);
+                    lock_guard<mutex> locker(result_mutex);
+                    report.add(result);
+                    on_result(result);
+                }
+            });
+        }
+    }
+    group.wait();
+
+    report.m_elapsed = timer.elapsed();
+    qCInfo(runLog) << QString("[flv-scan] event[finished] files[%1] failed[%2] with-errors[%3] elapsed[%4ms]")
+                          .arg(report.m_files)
+                          .arg(report.m_failed)
+                          .arg(report.m_with_errors)
+                          .arg(report.m_elapsed);
+}
+
+ScanResult BatchScanner::analyzeFile(const QString& path, bool recover) {
+    TRACE_SCOPE("scan_file");
+    QElapsedTimer timer;
+    timer.start();
+
+    ScanResult result;
+    result.m_path = path;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        result.m_error = "打开文件失败：" + file.errorString();
+        return result;
+    }
+    result.m_file_size = file.size();
+
+    // 文件头、tag和onMetaData的解析与打开文件相同，报告不需要负载，只解析头部
+    ModelTagList model;
+    model.readFromFile(file, recover, false);
+    file.close();
+    if (!model.getFlvHeader()) {
+        result.m_error = "不是有效的FLV文件";
+        return result;
+    }
+
+    const TagIndex& index = model.getTagIndex();
+    result.m_tags = index.size();
+    uint32_t first = UINT32_MAX;
+    uint32_t last = 0;
+    for (size_t i = 0; i < index.size(); ++i) {
+        uint8_t type = index.m_type[i];
+        if ((index.m_flags[i] & TAG_FLAG_GARBAGE) || (type != TAG_TYPE_VIDEO && type != TAG_TYPE_AUDIO))
+            continue;
+        first = min(first, index.m_timestamp[i]);
+        last = max(last, index.m_timestamp[i]);
+        QString& codec = type == TAG_TYPE_VIDEO ? result.m_video_codec : result.m_audio_codec;
+        if (codec.isEmpty())
+            codec = fourCCToString(index.m_codec[i]);
+    }
+    result.m_duration = first <= last ? last - first : 0;
+    if (result.m_duration > 0)
+        result.m_bitrate = result.m_file_size * 8 / result.m_duration;
+    readMetadata(model.getTagList(), result);
+
+    // 错误级别问题的位置即损坏位置，解析提前停止时加上停止位置
+    vector<ValidationIssue> issues = StreamValidator::validate(model.getFlvHeader(), index);
+    for (const ValidationIssue& issue : issues) {
+        if (issue.m_severity != SEVERITY_ERROR) {
+            ++result.m_warnings;
+            continue;
+        }
+        ++result.m_errors;
+        result.m_corruption_offsets.push_back(issue.m_offset);
+    }
+    if (index.m_parsed_end < index.m_file_size)
+        result.m_corruption_offsets.push_back(index.m_parsed_end);
+    auto& offsets = result.m_corruption_offsets;
+    sort(offsets.begin(), offsets.end());
+    offsets.erase(unique(offsets.begin(), offsets.end()), offsets.end());
+    if (offsets.size() > MAX_CORRUPTION_OFFSETS)
+        offsets.resize(MAX_CORRUPTION_OFFSETS);
+
+    result.m_elapsed = timer.elapsed();
+    qCDebug(runLog) << QString("[flv-scan] event[file finished] file[%1] tags[%2] errors[%3] elapsed[%4ms]")
+                           .arg(path)
+                           .arg(result.m_tags)
+                           .arg(result.m_errors)
+                           .arg(result.m_elapsed);
+    return result;
+}
+
+QString BatchScanner::csvHeader() {
+    return "path,size,duration_ms,metadata_duration_s,width,height,video_codec,audio_codec,bitrate_kbps,"
+           "tags,errors,warnings,corruption_offsets,elapsed_ms,error";
+}
+
+QString BatchScanner::toCsv(const ScanResult& result) {
+    QStringList offsets;
+    for (uint64_t offset : result.m_corruption_offsets) {
+        offsets.append(hexOffset(offset));
+    }
+
+    QStringList fields = {csvField(result.m_path),
+                          QString::number(result.m_file_size),
+                          QString::number(result.m_duration),
+                          QString::number(result.m_metadata_duration, 'f', 3),
+                          QString::number(result.m_width),
+                          QString::number(result.m_height),
+                          csvField(result.m_video_codec),
+                          csvField(result.m_audio_codec),
+                          QString::number(result.m_bitrate),
+                          QString::number(result.m_tags),
+                          QString::number(result.m_errors),
+                          QString::number(result.m_warnings),
+                          offsets.join(';'),
+                          QString::number(result.m_elapsed),
+                          csvField(result.m_error)};
+    return fields.join(',');
+}
+
+QString BatchScanner::toJson(const ScanResult& result) {
+    QStringList offsets;
+    for (uint64_t offset : result.m_corruption_offsets) {
+        offsets.append(QString::number(static_cast<qulonglong>(offset)));
+    }
+
+    QString json = "{\"path\":" + jsonString(result.m_path) + ",\"size\":" + QString::number(result.m_file_size);
+    if (!result.m_error.isEmpty())
+        return json + ",\"error\":" + jsonString(result.m_error) + "}";
+    json += QString(",\"duration_ms\":%1,\"metadata_duration_s\":%2,\"width\":%3,\"height\":%4")
+                .arg(result.m_duration)
+                .arg(result.m_metadata_duration, 0, 'f', 3)
+                .arg(result.m_width)
+                .arg(result.m_height);
+    json += ",\"video_codec\":" + jsonString(result.m_video_codec) +
+            ",\"audio_codec\":" + jsonString(result.m_audio_codec);
+    json += QString(",\"bitrate_kbps\":%1,\"tags\":%2,\"errors\":%3,\"warnings\":%4")
+                .arg(result.m_bitrate)
+                .arg(result.m_tags)
+                .arg(result.m_errors)
+                .arg(result.m_warnings);
+    json += ",\"corruption_offsets\":[" + offsets.join(',') + "]";
+    json += QString(",\"elapsed_ms\":%1}").arg(result.m_elapsed);
+    return json;
+}
@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @class ScanOptions
+ * @brief 批量扫描选项
+ */
+struct ScanOptions {
+    bool m_recover = false;  // 遇到损坏的tag时重同步继续解析，垃圾数据段记为损坏位置
+    int m_io_per_device = 2; // 同一个设备上同时解析的文件数，机械硬盘宜为1
+    QStringList m_name_filters = {"*.flv"};
+};
+
+/**
+ * @class ScanResult
+ * @brief 单个文件的分析结果
+ */
+struct ScanResult {
+    QString m_path;
+    uint64_t m_file_size = 0;
+    QString m_error; // 无法打开或不是FLV文件时非空，其余字段无效
+
+    uint64_t m_tags = 0;
+    uint32_t m_duration = 0;        // 第一个到最后一个音视频tag的时间戳跨度(ms)
+    double m_metadata_duration = 0; // onMetaData中的duration(s)
+    uint32_t m_width = 0;           // onMetaData中的宽高
+    uint32_t m_height = 0;
+    QString m_video_codec; // 第一个音视频帧的FourCC，没有该类型的流时为空
+    QString m_audio_codec;
+    uint64_t m_bitrate = 0; // 平均码率(kbps)，按文件大小和时长计算
+    uint64_t m_errors = 0;
+    uint64_t m_warnings = 0;
+    vector<uint64_t> m_corruption_offsets; // 错误级别问题的文件偏移（含垃圾数据段、截断位置），升序去重
+    int64_t m_elapsed = 0;                 // 解析和校验耗时(ms)
+};
+
+/**
+ * @class ScanReport
+ * @brief 批量扫描的汇总
+ */
+struct ScanReport {
+    uint64_t m_files = 0;
+    uint64_t m_failed = 0;      // 无法解析的文件
+    uint64_t m_with_errors = 0; // 校验出错误的文件
+    uint64_t m_total_size = 0;
+    uint64_t m_total_duration = 0; // ms
+    int64_t m_elapsed = 0;
+
+    void add(const ScanResult& result);
+    QString toString() const;
+};
+
+/**
+ * @class BatchScanner
+ * @brief 遍历目录树，在共用线程池中并行解析每个文件的文件头、tag和onMetaData并校验
+ *
+ * 文件按所在设备分组，每个设备最多m_io_per_device个任务依次从该设备的队列取文件解析，
+ * 不同设备的文件互不影响；每个文件完成后立即回调，调用方可以边扫描边输出
+ */
+class BatchScanner {
+  public:
+    // 目录树下匹配的文件，按路径排序
+    static QStringList listFiles(const QString& dir, const QStringList& name_filters);
+
+    // on_result在完成文件的线程中调用，各次调用之间互斥
+    static void scan(const QStringList& files,
+                     const ScanOptions& options,
+                     const function<void(const ScanResult&)>& on_result,
+                     ScanReport& report);
+
+    static ScanResult analyzeFile(const QString& path, bool recover);
+
+    static QString csvHeader();
+    static QString toCsv(const ScanResult& result);
+    static QString toJson(const ScanResult& result);
+
+    static constexpr size_t MAX_CORRUPTION_OFFSETS = 64; // 每个文件最多记录的损坏位置
+};
@@ -0,0 +1,253 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "BitrateTimeline.h"
+#include <QStringList>
+#include <algorithm>
+#include <cstdlib>
+
+static int streamOfType(uint8_t type) {
+    switch (type) {
+    case TAG_TYPE_AUDIO:
+        return BitrateTimeline::STREAM_AUDIO;
+    case TAG_TYPE_VIDEO:
+        return BitrateTimeline::STREAM_VIDEO;
+    case TAG_TYPE_SCRIPT:
+        return BitrateTimeline::STREAM_SCRIPT;
+    default:
+        return -1;
+    }
+}
+
+static int floorLog2(uint64_t value) {
+    int k = 0;
+    while (value >>= 1) {
+        ++k;
+    }
+    return k;
+}
+
+void SeriesPyramid::build(const vector<uint64_t>& values) {
+    m_levels.clear();
+    m_prefix.assign(values.size() + 1, 0);
+    for (size_t i = 0; i < values.size(); ++i) {
+        m_prefix[i + 1] = m_prefix[i] + values[i];
+    }
+    if (values.empty()) {
+        return;
+    }
+
+    vector<Node> level(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        level[i] = {values[i], values[i], static_cast<uint32_t>(i)};
+    }
+    m_levels.push_back(std::move(level));
+
+    // 逐层两两合并，直到只剩一个节点
+    while (m_levels.back().size() > 1) {
+        const vector<Node>& below = m_levels.back();
+        vector<Node> upper((below.size() + 1) / 2);
+        for (size_t i = 0; i < upper.size(); ++i) {
+            const Node& a = below[2 * i];
+            if (2 * i + 1 < below.size()) {
+                const Node& b = below[2 * i + 1];
+                upper[i] = {min(a.m_min, b.m_min), max(a.m_max, b.m_max), a.m_max >= b.m_max ? a.m_max_pos : b.m_max_pos};
+            } else {
+                upper[i] = a;
+            }
+        }
+        m_levels.push_back(std::move(upper));
+    }
+}
+
+SeriesPyramid::Result SeriesPyramid::query(size_t begin, size_t end) const {
+    Result result;
+    end = min(end, size());
+    if (begin >= end) {
+        return result;
+    }
+
+    result.m_sum = m_prefix[end] - m_prefix[begin];
+
+    // 选择节点宽度不超过区间长度的最高层，区间最多跨3个节点
+    int k = min(floorLog2(end - begin), static_cast<int>(m_levels.size()) - 1);
+    const vector<Node>& level = m_levels[k];
+    size_t first = begin >> k;
+    size_t last = min((end - 1) >> k, level.size() - 1);
+
+    result.m_min = level[first].m_min;
+    result.m_max = level[first].m_max;
+    result.m_max_pos = level[first].m_max_pos;
+    for (size_t i = first + 1; i <= last; ++i) {
+        result.m_min = min(result.m_min, level[i].m_min);
+        if (level[i].m_max > result.m_max) {
+            result.m_max = level[i].m_max;
+            result.m_max_pos = level[i].m_max_pos;
+        }
+    }
+    return result;
+}
+
+void BitrateTimeline::clear() {
+    m_streams = {};
+    m_gops.clear();
+    m_base_ms = 0;
+    m_bucket_ms = BUCKET_MS;
+    m_bucket_count = 0;
+    m_outlier_count = 0;
+}
+
+void BitrateTimeline::build(const TagIndex& index) {
+    clear();
+
+    // 参与统计的音视频/脚本tag
+    vector<size_t> tags;
+    tags.reserve(index.size());
+    for (size_t i = 0; i < index.size(); ++i) {
+        if (streamOfType(index.m_type[i]) >= 0 && !(index.m_flags[i] & TAG_FLAG_GARBAGE))
+            tags.push_back(i);
+    }
+
+    // 单个损坏的时间戳（如0附近夹着的0xFFFFFFFF）会使时间桶数暴涨，跳过前后都对不上的孤立跳变；
+    // 后续tag延续新时间线的跳变（时间戳重置、拼接）保留
+    vector<uint8_t> outlier(index.size(), 0);
+    int64_t prev_ms = -1;
+    for (size_t k = 0; k < tags.size(); ++k) {
+        int64_t ts = index.m_timestamp[tags[k]];
+        if (prev_ms >= 0 && llabs(ts - prev_ms) > MAX_TIMESTAMP_JUMP_MS && k + 1 < tags.size() &&
+            llabs(static_cast<int64_t>(index.m_timestamp[tags[k + 1]]) - prev_ms) <= MAX_TIMESTAMP_JUMP_MS) {
+            outlier[tags[k]] = 1;
+            ++m_outlier_count;
+            continue;
+        }
+        prev_ms = ts;
+    }
+
+    // 以最小时间戳为起点，避免直播录制的大起始时间戳产生大量空桶
+    bool found = false;
+    int64_t last_ms = 0;
+    for (size_t i : tags) {
+        if (outlier[i])
+            continue;
+        int64_t ts = index.m_timestamp[i];
+        m_base_ms = found ? min(m_base_ms, ts) : ts;
+        last_ms = found ? max(last_ms, ts) : ts;
+        found = true;
+    }
+    if (!found) {
+        return;
+    }
+
+    while (static_cast<uint64_t>(last_ms - m_base_ms) / m_bucket_ms + 1 > MAX_BUCKETS) {
+        m_bucket_ms *= 2;
+    }
+    m_bucket_count = static_cast<size_t>((last_ms - m_base_ms) / m_bucket_ms + 1);
+    for (auto& stream : m_streams) {
+        stream.m_bytes.assign(m_bucket_count, 0);
+        stream.m_counts.assign(m_bucket_count, 0);
+        stream.m_peak_tag.assign(m_bucket_count, -1);
+    }
+
+    GopBitrate gop;
+    auto finishGop = [&](int64_t end_ms) {
+        if (gop.m_start_tag >= 0) {
+            gop.m_duration_ms = end_ms - gop.m_start_ms;
+            m_gops.push_back(gop);
+        }
+    };
+
+    for (size_t i : tags) {
+        if (outlier[i])
+            continue;
+
+        int s = streamOfType(index.m_type[i]);
+        StreamTimeline& stream = m_streams[s];
+        int64_t ts = index.m_timestamp[i];
+        size_t bucket = static_cast<size_t>((ts - m_base_ms) / m_bucket_ms);
+        uint64_t span = index.tagSpan(i);
+
+        stream.m_bytes[bucket] += span;
+        stream.m_counts[bucket] += 1;
+        int64_t& peak = stream.m_peak_tag[bucket];
+        if (peak < 0 || index.m_data_size[i] > index.m_data_size[peak])
+            peak = static_cast<int64_t>(i);
+
+        stream.m_total_bytes += span;
+        stream.m_total_count += 1;
+        uint32_t data_size = max<uint32_t>(index.m_data_size[i], 1);
+        stream.m_size_histogram[min(floorLog2(data_size), 31)] += 1;
+
+        // 视频关键帧开始新的GOP，音频计入当前GOP
+        bool keyframe = s == STREAM_VIDEO && (index.m_flags[i] & TAG_FLAG_KEYFRAME) &&
+                        !(index.m_flags[i] & TAG_FLAG_SEQUENCE_HEADER);
+        if (keyframe) {
+            finishGop(ts);
+            gop = GopBitrate();
+            gop.m_start_tag = static_cast<int64_t>(i);
+            gop.m_start_ms = ts;
+        }
+        if (gop.m_start_tag >= 0 && s != STREAM_SCRIPT) {
+            gop.m_bytes += span;
+            if (s == STREAM_VIDEO)
+                gop.m_frames += 1;
+        }
+    }
+    finishGop(last_ms);
+
+    for (auto& stream : m_streams) {
+        stream.m_pyramid.build(stream.m_bytes);
+    }
+}
+
+int64_t BitrateTimeline::peakTag(size_t begin, size_t end) const {
+    int64_t best = -1;
+    uint64_t best_bytes = 0;
+    for (const auto& stream : m_streams) {
+        SeriesPyramid::Result r = stream.m_pyramid.query(begin, end);
+        if (r.m_max > best_bytes && stream.m_peak_tag[r.m_max_pos] >= 0) {
+            best_bytes = r.m_max;
+            best = stream.m_peak_tag[r.m_max_pos];
+        }
+    }
+    return best;
+}
+
+QString BitrateTimeline::summary() const {
+    static const char* names[STREAM_COUNT] = {"音频", "视频", "脚本"};
+
+    double seconds = m_bucket_count * m_bucket_ms / 1000.0;
+    QString text = QString("时长约 %1 s，%2 个GOP").arg(seconds, 0, 'f', 0).arg(m_gops.size());
+    if (m_bucket_ms != BUCKET_MS)
+        text += QString("，时间桶 %1 s").arg(m_bucket_ms / 1000.0, 0, 'f', 0);
+    if (m_outlier_count > 0)
+        text += QString("，跳过 %1 个异常时间戳").arg(m_outlier_count);
+    for (int s = 0; s < STREAM_COUNT; ++s) {
+        const StreamTimeline& stream = m_streams[s];
+        if (stream.m_total_count == 0)
+            continue;
+
+        SeriesPyramid::Result r = stream.m_pyramid.query(0, m_bucket_count);
+        text += QString("\n%1：%2 个tag，平均 %3 kbps，峰值 %4 kbps")
+                    .arg(names[s])
+                    .arg(stream.m_total_count)
+                    .arg(seconds > 0 ? stream.m_total_bytes * 8.0 / 1000.0 / seconds : 0, 0, 'f', 1)
+                    .arg(r.m_max * 8.0 / m_bucket_ms, 0, 'f', 1);
+
+        // 只列出非空的长度区间
+        QStringList histogram;
+        for (int k = 0; k < 32; ++k) {
+            if (stream.m_size_histogram[k] > 0)
+                histogram << QString("%1B:%2").arg(1ull << k).arg(stream.m_size_histogram[k]);
+        }
+        text += QString("\n  长度分布 %1").arg(histogram.join(" "));
+    }
+
+    if (!m_gops.empty()) {
+        auto [lo, hi] = minmax_element(m_gops.begin(), m_gops.end(), [](const GopBitrate& a, const GopBitrate& b) {
+            return a.kbps() < b.kbps();
+        });
+        text += QString("\nGOP码率 %1~%2 kbps").arg(lo->kbps(), 0, 'f', 1).arg(hi->kbps(), 0, 'f', 1);
+    }
+    return text;
+}
@@ -0,0 +1,109 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "TagIndex.h"
+#include <QString>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @class SeriesPyramid
+ * @brief 一维序列的min/max mip金字塔加前缀和，任意区间查询只需合并不超过3个节点
+ */
+struct SeriesPyramid {
+    struct Node {
+        uint64_t m_min = 0;
+        uint64_t m_max = 0;
+        uint32_t m_max_pos = 0; // 最大值所在的第0层下标
+    };
+
+    struct Result {
+        uint64_t m_min = 0;
+        uint64_t m_max = 0;
+        uint64_t m_sum = 0;
+        uint32_t m_max_pos = 0;
+    };
+
+    vector<vector<Node>> m_levels; // 第k层每个节点覆盖2^k个原始值
+    vector<uint64_t> m_prefix;     // 前缀和，区间和精确
+
+    void build(const vector<uint64_t>& values);
+
+    size_t size() const {
+        return m_levels.empty() ? 0 : m_levels[0].size();
+    }
+
+    // 查询[begin, end)，min/max按对齐的节点取，区间边缘会向外扩到节点边界
+    Result query(size_t begin, size_t end) const;
+};
+
+/**
+ * @class StreamTimeline
+ * @brief 单路流按秒聚合的码率和tag数
+ */
+struct StreamTimeline {
+    vector<uint64_t> m_bytes;   // 每个时间桶内的字节数（tag完整长度）
+    vector<uint32_t> m_counts;  // 每个时间桶内的tag数
+    vector<int64_t> m_peak_tag; // 每个时间桶内最大的tag，-1表示无
+    SeriesPyramid m_pyramid;    // 基于m_bytes
+
+    uint64_t m_total_bytes = 0;
+    uint64_t m_total_count = 0;
+    array<uint64_t, 32> m_size_histogram{}; // tag数据长度按2的幂分桶，第k桶为[2^k, 2^(k+1))
+};
+
+/**
+ * @class GopBitrate
+ * @brief 单个GOP的码率，包含GOP时间范围内的音视频数据
+ */
+struct GopBitrate {
+    int64_t m_start_tag = -1;
+    int64_t m_start_ms = 0;
+    int64_t m_duration_ms = 0;
+    uint64_t m_bytes = 0;
+    uint32_t m_frames = 0;
+
+    double kbps() const {
+        return m_duration_ms > 0 ? m_bytes * 8.0 / m_duration_ms : 0;
+    }
+};
+
+/**
+ * @class BitrateTimeline
+ * @brief 基于tag索引的码率时间线，音频/视频/脚本分开统计
+ */
+struct BitrateTimeline {
+    enum STREAM : int {
+        STREAM_AUDIO = 0,
+        STREAM_VIDEO,
+        STREAM_SCRIPT,
+        STREAM_COUNT
+    };
+
+    // 默认时间桶长度(ms)，时间跨度过大时按2倍加宽，使时间桶数不超过MAX_BUCKETS
+    static constexpr int64_t BUCKET_MS = 1000;
+    static constexpr size_t MAX_BUCKETS = 1 << 20;
+    // 与前一个tag相差超过此值、且下一个tag又回到原时间线的时间戳视为损坏，不参与统计
+    static constexpr int64_t MAX_TIMESTAMP_JUMP_MS = 60 * 1000;
+
+    array<StreamTimeline, STREAM_COUNT> m_streams;
+    vector<GopBitrate> m_gops;
+    int64_t m_base_ms = 0; // 第0个时间桶对应的时间戳
+    int64_t m_bucket_ms = BUCKET_MS;
+    size_t m_bucket_count = 0;
+    size_t m_outlier_count = 0; // 跳过的异常时间戳tag数
+
+    void build(const TagIndex& index);
+    void clear();
+
+    // 时间桶区间内所有流中最大的tag，无数据返回-1
+    int64_t peakTag(size_t begin, size_t end) const;
+
+    QString summary() const;
+};
@@ -0,0 +1,154 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "CodecConfig.h"
+#include "BitReader.h"
+
+bool parseAvcConfig(const uchar* p, uint32_t size, ParameterSets& out) {
+    if (size < 7)
+        return false;
+    out.m_annexb.clear();
+    out.m_length_size = (p[4] & 0x03) + 1;
+
+    uint32_t pos = 5;
+    for (int group = 0; group < 2; ++group) {
+        if (pos >= size)
+            return false;
+        // SPS个数为低5位，PPS个数为整个字节
+        int count = group == 0 ? (p[pos] & 0x1F) : p[pos];
+        ++pos;
+        for (int n = 0; n < count; ++n) {
+            if (pos + 2 > size)
+                return false;
+            uint32_t len = (p[pos] << 8) | p[pos + 1];
+            pos += 2;
+            if (pos + len > size)
+                return false;
+            out.m_annexb.append((const char*) START_CODE, 4);
+            out.m_annexb.append((const char*) p + pos, len);
+            pos += len;
+        }
+    }
+    return true;
+}
+
+bool parseHevcConfig(const uchar* p, uint32_t size, ParameterSets& out) {
+    if (size < 23)
+        return false;
+    out.m_annexb.clear();
+    out.m_length_size = (p[21] & 0x03) + 1;
+
+    int arrays = p[22];
+    uint32_t pos = 23;
+    for (int a = 0; a < arrays; ++a) {
+        if (pos + 3 > size)
+            return false;
+        uint32_t count = (p[pos + 1] << 8) | p[pos + 2];
+        pos += 3;
+        for (uint32_t n = 0; n < count; ++n) {
+            if (pos + 2 > size)
+                return false;
+            uint32_t len = (p[pos] << 8) | p[pos + 1];
+            pos += 2;
+            if (pos + len > size)
+                return false;
+            out.m_annexb.append((const char*) START_CODE, 4);
+            out.m_annexb.append((const char*) p + pos, len);
+            pos += len;
+        }
+    }
+    return true;
+}
+
+bool isParameterSetNalu(uint32_t codec, uchar header) {
+    if (codec == FOURCC_AVC1) {
+        uint8_t type = header & 0x1F;
+        return type == 7 || type == 8; // SPS PPS
+    }
+    uint8_t type = (header >> 1) & 0x3F;
+    return type >= 32 && type <= 34; // VPS SPS PPS
+}
+
+bool splitNalus(const uchar* p,
+                uint32_t size,
+                int length_size,
+                uint32_t codec,
+                vector<pair<uint32_t, uint32_t>>& nalus,
+                bool& has_parameter_sets) {
+    nalus.clear();
+    has_parameter_sets = false;
+    uint32_t pos = 0;
+    while (pos + length_size <= size) {
+        uint32_t len = 0;
+        for (int b = 0; b < length_size; ++b) {
+            len = (len << 8) | p[pos + b];
+        }
+        pos += length_size;
+        if (len == 0)
+            continue;
+        if (len > size - pos)
+            return false;
+        has_parameter_sets |= isParameterSetNalu(codec, p[pos]);
+        nalus.emplace_back(pos, len);
+        pos += len;
+    }
+    return true;
+}
+
+bool parseAudioSpecificConfig(const uchar* p, uint32_t size, AdtsConfig& out, QString& error) {
+    BitReader bits(p, size);
+    auto readObjectType = [&]() {
+        uint32_t type = bits.read(5);
+        return type == 31 ? 32 + bits.read(6) : type;
+    };
+
+    uint32_t object_type = readObjectType();
+    uint32_t frequency_index = bits.read(4);
+    if (frequency_index == 15)
+        bits.read(24);
+    uint32_t channels = bits.read(4);
+    if (object_type == 5 || object_type == 29) {
+        if (bits.read(4) == 15)
+            bits.read(24);
+        object_type = readObjectType();
+    }
+
+    if (bits.overflow()) {
+        error = "AudioSpecificConfig不完整";
+        return false;
+    }
+    if (object_type < 1 || object_type > 4) {
+        error = QString("ADTS不支持audioObjectType %1").arg(object_type);
+        return false;
+    }
+    if (frequency_index > 12) {
+        error = "ADTS不支持显式采样率";
+        return false;
+    }
+    out.m_profile = static_cast<uint8_t>(object_type - 1);
+    out.m_frequency_index = static_cast<uint8_t>(frequency_index);
+    out.m_channels = static_cast<uint8_t>(channels);
+    return true;
+}
+
+void makeAdtsHeader(uchar header[7], const AdtsConfig& config, uint32_t payload_size) {
+    uint32_t frame_size = 7 + payload_size;
+    header[0] = 0xFF;
+    header[1] = 0xF1; // MPEG-4，无CRC
+    header[2] =
+        static_cast<uchar>((config.m_profile << 6) | (config.m_frequency_index << 2) | (config.m_channels >> 2));
+    header[3] = static_cast<uchar>(((config.m_channels & 0x03) << 6) | (frame_size >> 11));
+    header[4] = static_cast<uchar>(frame_size >> 3);
+    header[5] = static_cast<uchar>(((frame_size & 0x07) << 5) | 0x1F); // buffer fullness 0x7FF
+    header[6] = 0xFC;
+}
+
+uint32_t streamCodec(const TagIndex& index, uint8_t tag_type) {
+    for (size_t i = 0; i < index.size(); ++i) {
+        if (index.m_type[i] == tag_type && !(index.m_flags[i] & (TAG_FLAG_GARBAGE | TAG_FLAG_MULTITRACK)) &&
+            index.m_codec[i] != 0)
+            return index.m_codec[i];
+    }
+    return 0;
+}
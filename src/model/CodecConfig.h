@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "TagIndex.h"
+#include <QByteArray>
+#include <QString>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// 解码配置记录解析和Annex-B/ADTS转换，裸码流导出和MPEG-TS转封装共用
+
+inline const uchar START_CODE[4] = {0, 0, 0, 1};
+
+// ADTS帧长度字段为13位
+constexpr uint32_t MAX_ADTS_FRAME = 0x1FFF;
+
+/**
+ * @brief 从sequence header中取出的参数集（已加好起始码）和NALU长度字段的字节数
+ */
+struct ParameterSets {
+    QByteArray m_annexb;
+    int m_length_size = 4;
+};
+
+// AVCDecoderConfigurationRecord
+bool parseAvcConfig(const uchar* p, uint32_t size, ParameterSets& out);
+
+// HEVCDecoderConfigurationRecord，VPS/SPS/PPS/SEI按数组顺序输出
+bool parseHevcConfig(const uchar* p, uint32_t size, ParameterSets& out);
+
+bool isParameterSetNalu(uint32_t codec, uchar header);
+
+// 按长度前缀切分NALU，结果为(相对p的偏移, 长度)，同时检查是否自带参数集，NALU越界时返回false
+bool splitNalus(const uchar* p,
+                uint32_t size,
+                int length_size,
+                uint32_t codec,
+                vector<pair<uint32_t, uint32_t>>& nalus,
+                bool& has_parameter_sets);
+
+/**
+ * @brief ADTS头需要的AudioSpecificConfig字段
+ */
+struct AdtsConfig {
+    uint8_t m_profile = 1; // audioObjectType - 1
+    uint8_t m_frequency_index = 4;
+    uint8_t m_channels = 2;
+};
+
+// AudioSpecificConfig，HE-AAC（SBR/PS显式信令）取核心层的类型和采样率
+bool parseAudioSpecificConfig(const uchar* p, uint32_t size, AdtsConfig& out, QString& error);
+
+void makeAdtsHeader(uchar header[7], const AdtsConfig& config, uint32_t payload_size);
+
+// 流的codec取第一个有codec的单轨tag
+uint32_t streamCodec(const TagIndex& index, uint8_t tag_type);
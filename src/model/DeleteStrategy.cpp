@@ -4,6 +4,7 @@
 
 #include "DeleteStrategy.h"
 #include "Log.h"
+#include "Trace.h"
 #include "Utils.h"
 #include <QFile>
 #include <QMessageBox>
@@ -56,6 +57,7 @@ bool StreamDeleteStrategy::copyTagsToTemp(const QString& sourcePath,
                                           const QString& tempPath,
                                           int rowIndex,
                                           const vector<unique_ptr<FLVTag>>& tagList) {
+    TRACE_SCOPE("delete_copy");
     QFile sourceFile(sourcePath);
     QFile tempFile(tempPath);
 
@@ -77,6 +79,7 @@ bool StreamDeleteStrategy::copyTagsToTemp(const QString& sourcePath,
             sourceFile.seek(tag->m_offset);
             QByteArray tagData(tag->m_size, 0);
             size_t readSize = sourceFile.read(tagData.data(), tag->m_size);
+            TRACE_COUNT(TRACE_BYTES_READ, readSize);
 
             tempFile.write(tagData, readSize);
         }
@@ -103,6 +106,7 @@ bool MMapDeleteStrategy::deleteTag(const QString& filePath, int rowIndex, const
 bool MMapDeleteStrategy::deleteTagInMemory(const QString& filePath,
                                            int rowIndex,
                                            const vector<unique_ptr<FLVTag>>& tagList) {
+    TRACE_SCOPE("delete_copy");
     HANDLE hFile = CreateFileW((LPCWSTR) filePath.utf16(),
                                GENERIC_READ | GENERIC_WRITE,
                                0,
@@ -137,6 +141,7 @@ bool MMapDeleteStrategy::deleteTagInMemory(const QString& filePath,
     // 移动数据
     if (moveSize > 0) {
         memmove((char*) pView + startPos, (char*) pView + endPos, moveSize);
+        TRACE_COUNT(TRACE_BYTES_READ, moveSize);
     }
 
     // 设置新的文件大小
@@ -0,0 +1,94 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <QString>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+using namespace std;
+
+// 字段的字节序或编码
+enum FIELD_ENCODING : uint8_t {
+    FIELD_BIG_ENDIAN,
+    FIELD_LITTLE_ENDIAN,
+    FIELD_EXTENDED_TIMESTAMP, // FLV时间戳：前3字节大端为低24位，第4字节为高8位
+    FIELD_ASCII               // 定长字符串
+};
+
+// 字段值的显示格式，为空时按默认格式显示
+using FieldFormatter = QString (*)(double value);
+
+/**
+ * @struct FieldDesc
+ * @brief 定长字段的描述：名称、字节位置、位段、字节序和显示格式
+ *
+ * 字段表为constexpr数组，解析、字段树和字节高亮都取自同一张表；
+ * 位置不固定的字段（如previous_tag_size、Enhanced RTMP中ModEx之后的字段）在表中记最简布局下的位置，
+ * 解析时按实际位置修正
+ */
+struct FieldDesc {
+    const char* m_name;
+    uint16_t m_offset;        // 相对所属结构（文件头或tag）起始的字节偏移
+    uint8_t m_size;           // 字节数，数值字段最多4字节
+    uint8_t m_bit_shift = 0;  // 位段的最低位
+    uint8_t m_bit_count = 0;  // 位段的位数，为0时取全部字节
+    FIELD_ENCODING m_encoding = FIELD_BIG_ENDIAN;
+    bool m_signed = false;    // 按位段（或全部字节）的最高位做符号扩展
+    FieldFormatter m_formatter = nullptr;
+};
+
+// 字段末尾相对所属结构起始的偏移
+constexpr uint32_t fieldEnd(const FieldDesc& field) {
+    return static_cast<uint32_t>(field.m_offset) + field.m_size;
+}
+
+namespace field_detail {
+
+template <FIELD_ENCODING ENCODING, size_t N, size_t... B>
+constexpr uint32_t loadBytes(const uint8_t* p, index_sequence<B...>) {
+    if constexpr (ENCODING == FIELD_EXTENDED_TIMESTAMP) {
+        return (static_cast<uint32_t>(p[3]) << 24) | (static_cast<uint32_t>(p[0]) << 16) |
+               (static_cast<uint32_t>(p[1]) << 8) | static_cast<uint32_t>(p[2]);
+    } else {
+        return ((static_cast<uint32_t>(p[B]) << (ENCODING == FIELD_BIG_ENDIAN ? (N - 1 - B) * 8 : B * 8)) | ...);
+    }
+}
+
+} // namespace field_detail
+
+/**
+ * 按字段表SCHEMA中第I个字段从data（所属结构起始）解码数值
+ *
+ * 字段描述在编译期已知，每个字段展开为固定的字节读取、移位和掩码，没有循环、分支和查表
+ */
+template <const auto& SCHEMA, size_t I>
+constexpr double decodeField(const uint8_t* data) {
+    constexpr FieldDesc field = SCHEMA[I];
+    static_assert(field.m_encoding != FIELD_ASCII, "string field, use decodeString");
+    static_assert(field.m_size >= 1 && field.m_size <= 4, "numeric field must be 1~4 bytes");
+    static_assert(field.m_encoding != FIELD_EXTENDED_TIMESTAMP || field.m_size == 4, "timestamp is 4 bytes");
+    static_assert(field.m_bit_shift + field.m_bit_count <= field.m_size * 8, "bit range exceeds field");
+
+    constexpr uint32_t bits = field.m_bit_count ? field.m_bit_count : field.m_size * 8;
+    uint32_t value = field_detail::loadBytes<field.m_encoding, field.m_size>(data + field.m_offset,
+                                                                             make_index_sequence<field.m_size>());
+    if constexpr (field.m_bit_count > 0) {
+        value = (value >> field.m_bit_shift) & ((1u << field.m_bit_count) - 1);
+    }
+    if constexpr (field.m_signed) {
+        return static_cast<double>(static_cast<int32_t>(value << (32 - bits)) >> (32 - bits));
+    }
+    return static_cast<double>(value);
+}
+
+template <const auto& SCHEMA, size_t I>
+string decodeString(const uint8_t* data) {
+    constexpr FieldDesc field = SCHEMA[I];
+    static_assert(field.m_encoding == FIELD_ASCII, "numeric field, use decodeField");
+    return string(reinterpret_cast<const char*>(data + field.m_offset), field.m_size);
+}
@@ -0,0 +1,244 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "FileSearch.h"
+#include "Parallel.h"
+#include "Utils.h"
+#include <QStringList>
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define FLV_SEARCH_SSE2
+#endif
+
+// 每个线程至少处理1MiB，避免小文件上的线程开销
+static constexpr size_t MIN_SEARCH_CHUNK = 1 << 20;
+
+static void appendBigEndian(vector<SearchPattern>& patterns, uint64_t value, int bytes, const QString& label) {
+    QByteArray data(bytes, 0);
+    for (int i = 0; i < bytes; ++i) {
+        data[bytes - 1 - i] = static_cast<char>((value >> (i * 8)) & 0xFF);
+    }
+    patterns.push_back({data, label});
+}
+
+static vector<SearchPattern> compileNumber(const QString& text) {
+    QString value = text;
+    QString width;
+    int colon = value.indexOf(':');
+    if (colon > 0) {
+        width = value.left(colon).trimmed().toLower();
+        value = value.mid(colon + 1).trimmed();
+    }
+
+    bool is_int = false;
+    bool is_double = false;
+    qlonglong n = value.toLongLong(&is_int, 0);
+    double d = value.toDouble(&is_double);
+    if (!is_int && !is_double) {
+        throw QString("无效的数值：%1").arg(value);
+    }
+
+    // 整数按宽度检查范围，负数按补码存储（如SI24的CTS）
+    auto fits = [&](int bytes) {
+        if (!is_int)
+            return false;
+        qlonglong max = (qlonglong(1) << (bytes * 8)) - 1;
+        qlonglong min = -(qlonglong(1) << (bytes * 8 - 1));
+        return n >= min && n <= max;
+    };
+    auto amf_number = [&](vector<SearchPattern>& patterns) {
+        double number = is_int ? static_cast<double>(n) : d;
+        uint64_t bits = 0;
+        memcpy(&bits, &number, sizeof(bits));
+        appendBigEndian(patterns, bits, 8, "f64");
+    };
+
+    vector<SearchPattern> patterns;
+    if (width.isEmpty()) {
+        // 未指定宽度时查找FLV常用的24/32位大端整数和AMF的double
+        if (fits(3))
+            appendBigEndian(patterns, static_cast<uint64_t>(n), 3, "u24");
+        if (fits(4))
+            appendBigEndian(patterns, static_cast<uint64_t>(n), 4, "u32");
+        amf_number(patterns);
+        return patterns;
+    }
+
+    if (width == "f64") {
+        amf_number(patterns);
+        return patterns;
+    }
+
+    int bytes = width == "u8" ? 1 : width == "u16" ? 2 : width == "u24" ? 3 : width == "u32" ? 4 : 0;
+    if (bytes == 0) {
+        throw QString("未知的数值宽度：%1（可用 u8 u16 u24 u32 f64）").arg(width);
+    }
+    if (!fits(bytes)) {
+        throw QString("数值 %1 超出 %2 的范围").arg(value).arg(width);
+    }
+    appendBigEndian(patterns, static_cast<uint64_t>(n), bytes, width);
+    return patterns;
+}
+
+vector<SearchPattern> FileSearch::compile(const QString& text, MODE mode) {
+    QString input = mode == MODE_TEXT ? text : text.trimmed();
+    if (input.isEmpty()) {
+        throw QString("搜索内容为空");
+    }
+
+    switch (mode) {
+    case MODE_HEX: {
+        QByteArray hex;
+        for (QChar c : input) {
+            if (c.isSpace())
+                continue;
+            char ch = c.toLatin1();
+            bool valid = (ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'f') || (ch >= 'A' && ch <= 'F');
+            if (!valid) {
+                throw QString("无效的十六进制字符：%1").arg(c);
+            }
+            hex.append(ch);
+        }
+        if (hex.size() % 2 != 0) {
+            throw QString("十六进制长度必须为偶数");
+        }
+        return {{QByteArray::fromHex(hex), "hex"}};
+    }
+    case MODE_TEXT:
+        return {{input.toUtf8(), "text"}};
+    case MODE_NUMBER:
+        return compileNumber(input);
+    default:
+        throw QString("未知的搜索模式");
+    }
+}
+
+// 查找起点在[begin, end)内的pattern
+static void scanPattern(const uchar* data,
+                        int64_t size,
+                        int64_t begin,
+                        int64_t end,
+                        const SearchPattern& pattern,
+                        uint8_t pattern_index,
+                        vector<SearchHit>& hits,
+                        size_t max_hits) {
+    const uchar* bytes = reinterpret_cast<const uchar*>(pattern.m_bytes.constData());
+    int64_t length = pattern.m_bytes.size();
+    int64_t last = min(end, size - length + 1); // 起点上界（不含）
+
+    auto addHit = [&](int64_t pos) {
+        SearchHit hit;
+        hit.m_offset = pos;
+        hit.m_length = static_cast<uint32_t>(length);
+        hit.m_pattern = pattern_index;
+        hit.m_context_size = static_cast<uint8_t>(min<int64_t>(hit.m_context.size(), size - pos));
+        memcpy(hit.m_context.data(), data + pos, hit.m_context_size);
+        hits.push_back(hit);
+    };
+
+    int64_t pos = begin;
+#ifdef FLV_SEARCH_SSE2
+    // 每次比较16个起点的首字节和尾字节，两者都相同的位置再完整比较
+    const __m128i first = _mm_set1_epi8(static_cast<char>(bytes[0]));
+    const __m128i tail = _mm_set1_epi8(static_cast<char>(bytes[length - 1]));
+    for (; pos + 16 <= last && hits.size() < max_hits; pos += 16) {
+        __m128i head_block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        __m128i tail_block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + length - 1));
+        __m128i hit = _mm_and_si128(_mm_cmpeq_epi8(head_block, first), _mm_cmpeq_epi8(tail_block, tail));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+        for (int bit = 0; mask != 0; ++bit, mask >>= 1) {
+            if ((mask & 1) && memcmp(data + pos + bit + 1, bytes + 1, length - 1) == 0) {
+                addHit(pos + bit);
+            }
+        }
+    }
+#endif
+
+    for (; pos < last && hits.size() < max_hits; ++pos) {
+        if (data[pos] == bytes[0] && memcmp(data + pos + 1, bytes + 1, length - 1) == 0) {
+            addHit(pos);
+        }
+    }
+}
+
+vector<SearchHit> FileSearch::find(const uchar* data,
+                                   int64_t size,
+                                   int64_t begin,
+                                   int64_t end,
+                                   const vector<SearchPattern>& patterns,
+                                   size_t max_hits) {
+    end = min(end, size);
+    if (patterns.empty() || begin >= end || max_hits == 0) {
+        return {};
+    }
+
+    size_t count = static_cast<size_t>(end - begin);
+    size_t chunk_size = parallelChunkSize(count, MIN_SEARCH_CHUNK);
+    vector<vector<SearchHit>> chunk_hits((count + chunk_size - 1) / chunk_size);
+
+    parallelFor(
+        count,
+        [&](size_t first, size_t last) {
+            auto& hits = chunk_hits[first / chunk_size];
+            for (size_t i = 0; i < patterns.size(); ++i) {
+                scanPattern(data, size, begin + first, begin + last, patterns[i], static_cast<uint8_t>(i), hits, max_hits);
+            }
+            if (patterns.size() > 1) {
+                stable_sort(hits.begin(), hits.end(), [](const SearchHit& a, const SearchHit& b) {
+                    return a.m_offset < b.m_offset;
+                });
+            }
+        },
+        MIN_SEARCH_CHUNK);
+
+    vector<SearchHit> result;
+    for (auto& hits : chunk_hits) {
+        size_t take = min(hits.size(), max_hits - result.size());
+        result.insert(result.end(), hits.begin(), hits.begin() + take);
+        if (result.size() >= max_hits)
+            break;
+    }
+    return result;
+}
+
+void FileSearch::resolveTags(const TagIndex& index, vector<SearchHit>& hits) {
+    for (auto& hit : hits) {
+        uint64_t offset = static_cast<uint64_t>(hit.m_offset);
+        auto next = upper_bound(index.m_offset.begin(), index.m_offset.end(), offset);
+        if (next == index.m_offset.begin()) {
+            hit.m_tag_index = hit.m_offset < FLV_HEADER_SIZE ? HIT_IN_HEADER : HIT_OUTSIDE_TAG;
+            continue;
+        }
+        size_t tag = next - index.m_offset.begin() - 1;
+        bool inside = offset < index.m_offset[tag] + index.tagSpan(tag);
+        hit.m_tag_index = inside ? static_cast<int64_t>(tag) : HIT_OUTSIDE_TAG;
+    }
+}
+
+QString FileSearch::fieldPath(TreeItem* root, int64_t base_offset, int64_t offset) {
+    // 字段偏移：小于等于0为相对tag起点的偏移取负，大于0为文件偏移（同TagView中的字段高亮）
+    auto contains = [&](TreeItem* item) {
+        int64_t begin = item->data->offset <= 0 ? base_offset - item->data->offset : item->data->offset;
+        return item->data->size > 0 && offset >= begin && offset < begin + item->data->size;
+    };
+
+    QStringList path;
+    TreeItem* item = root;
+    while (item) {
+        TreeItem* next = nullptr;
+        for (TreeItem* child : item->childItems) {
+            if (contains(child)) {
+                next = child;
+                break;
+            }
+        }
+        if (next)
+            path.append(next->data->name);
+        item = next;
+    }
+    return path.join("/");
+}
@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "TagIndex.h"
+#include <QByteArray>
+#include <QString>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// 命中位置不在任何tag内
+constexpr int64_t HIT_IN_HEADER = -1;  // FLV Header
+constexpr int64_t HIT_OUTSIDE_TAG = -2; // 未解析的区域
+
+/**
+ * @class SearchPattern
+ * @brief 一个待查找的字节序列，数值搜索会按不同宽度生成多个
+ */
+struct SearchPattern {
+    QByteArray m_bytes;
+    QString m_label; // 如 "hex"、"text"、"u24"、"f64"
+};
+
+/**
+ * @class SearchHit
+ * @brief 一次命中
+ */
+struct SearchHit {
+    int64_t m_offset = 0;                  // 文件偏移
+    int64_t m_tag_index = HIT_OUTSIDE_TAG; // 所在tag（不含FLV Header行）
+    uint32_t m_length = 0;
+    uint8_t m_pattern = 0;           // 命中的SearchPattern下标
+    uint8_t m_context_size = 0;
+    array<uchar, 16> m_context = {}; // 从命中位置开始的原始字节
+};
+
+/**
+ * @class FileSearch
+ * @brief 在映射的整个文件上查找字节序列：多线程分块，SSE2比较首尾字节过滤后再逐字节确认
+ */
+class FileSearch {
+  public:
+    enum MODE : int {
+        MODE_HEX = 0, // 如 "00 00 00 01 67"
+        MODE_TEXT,    // UTF-8字符串
+        MODE_NUMBER   // 如 "1920"、"u16:1920"、"f64:29.97"
+    };
+
+    // 命中数上限，超过后停止搜索
+    static constexpr size_t MAX_HITS = 100000;
+
+    // 输入转换为字节序列，格式错误时抛出QString
+    static vector<SearchPattern> compile(const QString& text, MODE mode);
+
+    // 查找起点在[begin, end)内的所有命中，匹配内容可以越过end；结果按偏移升序，最多max_hits个
+    static vector<SearchHit> find(const uchar* data,
+                                  int64_t size,
+                                  int64_t begin,
+                                  int64_t end,
+                                  const vector<SearchPattern>& patterns,
+                                  size_t max_hits);
+
+    // 根据tag索引填写m_tag_index
+    static void resolveTags(const TagIndex& index, vector<SearchHit>& hits);
+
+    // 命中位置所在的字段路径，如 "video_info/avc_config/sps"；base_offset为tag在文件中的偏移
+    static QString fieldPath(TreeItem* root, int64_t base_offset, int64_t offset);
+};
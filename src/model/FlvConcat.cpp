@@ -0,0 +1,230 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "FlvConcat.h"
+#include "FlvCutter.h"
+#include "Hash.h"
+#include "Log.h"
+#include "ModelWidget.h"
+#include "Utils.h"
+#include <QFile>
+#include <QFileInfo>
+#include <algorithm>
+#include <memory>
+
+namespace {
+
+// 片段之间的默认间隔(ms)，片段只有一帧时使用
+constexpr int64_t DEFAULT_FRAME_GAP = 40;
+
+/**
+ * @brief 每个片段解析后保留的信息，解析树用完即释放
+ */
+struct Segment {
+    QString m_path;
+    uint64_t m_file_size = 0;
+    TagIndex m_index;
+    vector<uint64_t> m_header_hash; // 每个tag，仅sequence header有值
+    uint32_t m_codec[2] = {0, 0};   // 音频/视频
+    int64_t m_first_header[2] = {-1, -1};
+    int64_t m_base = 0;      // 音视频数据帧的最小时间戳
+    int64_t m_last = 0;      // 音视频数据帧的最大时间戳
+    int64_t m_frame_gap = DEFAULT_FRAME_GAP;
+    int64_t m_offset = 0;    // 输出时间戳 = 原时间戳 + m_offset
+    vector<size_t> m_kept;
+};
+
+int streamOf(const TagIndex& index, size_t i) {
+    return index.m_type[i] == TAG_TYPE_VIDEO ? 1 : 0;
+}
+
+// 解析片段并统计时间戳范围、sequence header，metadata为空时取该片段的onMetaData
+void loadSegment(const QString& path,
+                 const ConcatOptions& options,
+                 Segment& segment,
+                 unique_ptr<MetadataItem>& metadata) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw QString("打开文件失败：%1：%2").arg(path, file.errorString());
+    }
+    ModelTagList model;
+    model.readFromFile(file, options.m_recover);
+    if (!model.getFlvHeader()) {
+        throw QString("不是有效的FLV文件：%1").arg(path);
+    }
+
+    segment.m_path = path;
+    segment.m_index = model.getTagIndex();
+    const TagIndex& index = segment.m_index;
+    segment.m_file_size = file.size();
+
+    // 时间戳范围和最后两帧视频的间隔
+    bool found = false;
+    int64_t last_video[2] = {-1, -1};
+    for (size_t i = 0; i < index.size(); ++i) {
+        if (!FlvCutter::isMediaTag(index, i) || (index.m_flags[i] & TAG_FLAG_SEQUENCE_HEADER))
+            continue;
+        int64_t ts = index.m_timestamp[i];
+        segment.m_base = found ? min(segment.m_base, ts) : ts;
+        segment.m_last = found ? max(segment.m_last, ts) : ts;
+        found = true;
+        if (index.m_type[i] == TAG_TYPE_VIDEO) {
+            last_video[0] = last_video[1];
+            last_video[1] = ts;
+        }
+        if (segment.m_codec[streamOf(index, i)] == 0)
+            segment.m_codec[streamOf(index, i)] = index.m_codec[i];
+    }
+    if (last_video[0] >= 0 && last_video[1] > last_video[0])
+        segment.m_frame_gap = last_video[1] - last_video[0];
+
+    // sequence header的负载哈希，用于兼容性检查和去重
+    segment.m_header_hash.assign(index.size(), 0);
+    uchar* mapped = segment.m_file_size > 0 ? file.map(0, segment.m_file_size) : nullptr;
+    if (!mapped) {
+        throw QString("映射文件失败：%1").arg(path);
+    }
+    for (size_t i = 0; i < index.size(); ++i) {
+        if (!FlvCutter::isMediaTag(index, i) || !(index.m_flags[i] & TAG_FLAG_SEQUENCE_HEADER) ||
+            index.m_offset[i] + index.tagSpan(i) > segment.m_file_size)
+            continue;
+        segment.m_header_hash[i] = xxhash64(mapped + index.m_offset[i] + 11, index.m_data_size[i]);
+        int stream = streamOf(index, i);
+        if (segment.m_first_header[stream] < 0)
+            segment.m_first_header[stream] = i;
+        if (segment.m_codec[stream] == 0)
+            segment.m_codec[stream] = index.m_codec[i];
+    }
+    file.unmap(mapped);
+
+    if (!metadata) {
+        for (auto& tag : model.getTagList()) {
+            if (tag->metadata_info && tag->metadata_info->m_metadata_values.key == "onMetaData") {
+                metadata = make_unique<MetadataItem>(tag->metadata_info->m_metadata_values);
+                break;
+            }
+        }
+    }
+}
+
+// 与第一个片段比较codec和sequence header
+void checkCompatible(const Segment& first, const Segment& segment, const ConcatOptions& options) {
+    static const char* names[2] = {"音频", "视频"};
+    for (int stream = 0; stream < 2; ++stream) {
+        if (first.m_codec[stream] == 0 || segment.m_codec[stream] == 0)
+            continue;
+        if (first.m_codec[stream] != segment.m_codec[stream]) {
+            throw QString("%1的%2编码为%3，与第一个片段的%4不同")
+                .arg(QFileInfo(segment.m_path).fileName())
+                .arg(names[stream])
+                .arg(fourCCToString(segment.m_codec[stream]))
+                .arg(fourCCToString(first.m_codec[stream]));
+        }
+        int64_t a = first.m_first_header[stream];
+        int64_t b = segment.m_first_header[stream];
+        if (options.m_allow_config_change || a < 0 || b < 0)
+            continue;
+        if (first.m_index.m_data_size[a] != segment.m_index.m_data_size[b] ||
+            first.m_header_hash[a] != segment.m_header_hash[b]) {
+            throw QString("%1的%2sequence header与第一个片段不同（编码参数改变），如需保留请允许参数变化")
+                .arg(QFileInfo(segment.m_path).fileName())
+                .arg(names[stream]);
+        }
+    }
+}
+
+} // namespace
+
+QString ConcatReport::toString() const {
+    return QString("合并%1个片段，写出%2个tag，时长%3ms，输出%4字节\n"
+                   "移除重复sequence header %5个，修正PreviousTagSize %6处")
+        .arg(m_segments)
+        .arg(m_tags_written)
+        .arg(m_duration)
+        .arg(m_output_size)
+        .arg(m_sequence_headers_removed)
+        .arg(m_previous_tag_size_fixed);
+}
+
+bool FlvConcat::concat(const QStringList& sources,
+                       const QString& target_path,
+                       const ConcatOptions& options,
+                       ConcatReport& report) {
+    report = ConcatReport();
+
+    try {
+        if (sources.size() < 2) {
+            throw QString("至少需要两个片段");
+        }
+        for (const QString& source : sources) {
+            if (QFileInfo(source) == QFileInfo(target_path))
+                throw QString("输出文件不能是输入片段之一");
+        }
+
+        // 第一遍：逐个解析片段并检查兼容性
+        vector<Segment> segments(sources.size());
+        unique_ptr<MetadataItem> metadata;
+        for (int s = 0; s < sources.size(); ++s) {
+            loadSegment(sources[s], options, segments[s], metadata);
+            if (s > 0)
+                checkCompatible(segments[0], segments[s], options);
+        }
+
+        // 第二遍：时间戳偏移和保留的tag
+        int64_t next_start = 0;
+        uint64_t last_header_hash[2] = {0, 0};
+        bool has_header[2] = {false, false};
+        for (Segment& segment : segments) {
+            const TagIndex& index = segment.m_index;
+            segment.m_offset = next_start - segment.m_base;
+            next_start = segment.m_last + segment.m_offset + segment.m_frame_gap;
+
+            for (size_t i = 0; i < index.size(); ++i) {
+                // 垃圾数据、截断的tag和各片段的script tag（onMetaData重建）不写出
+                if (!FlvCutter::isMediaTag(index, i) || index.m_offset[i] + index.tagSpan(i) > segment.m_file_size)
+                    continue;
+                int stream = streamOf(index, i);
+                if (index.m_flags[i] & TAG_FLAG_SEQUENCE_HEADER) {
+                    uint64_t hash = segment.m_header_hash[i];
+                    if (has_header[stream] && last_header_hash[stream] == hash) {
+                        ++report.m_sequence_headers_removed;
+                        continue;
+                    }
+                    has_header[stream] = true;
+                    last_header_hash[stream] = hash;
+                }
+                segment.m_kept.push_back(i);
+            }
+        }
+        report.m_segments = segments.size();
+
+        // 第三遍：依次映射各片段顺序写出
+        vector<TagRun> runs(segments.size());
+        for (size_t s = 0; s < segments.size(); ++s) {
+            runs[s].m_path = segments[s].m_path;
+            runs[s].m_index = &segments[s].m_index;
+            runs[s].m_kept = &segments[s].m_kept;
+            runs[s].m_offset = segments[s].m_offset;
+        }
+        TagWriteStats stats = FlvCutter::writeRuns(target_path, runs, metadata.get());
+        report.m_tags_written = stats.m_tags_written;
+        report.m_previous_tag_size_fixed = stats.m_previous_tag_size_fixed;
+        report.m_output_size = stats.m_output_size;
+        report.m_duration = stats.m_duration;
+
+        qCInfo(runLog) << QString("[flv-concat] event[finished] target[%1] segments[%2] tags[%3] duration[%4ms] "
+                                  "size[%5] seq_removed[%6]")
+                              .arg(target_path)
+                              .arg(report.m_segments)
+                              .arg(report.m_tags_written)
+                              .arg(report.m_duration)
+                              .arg(report.m_output_size)
+                              .arg(report.m_sequence_headers_removed);
+        return true;
+    } catch (const QString& error) {
+        qCInfo(runLog) << QString("[flv-concat] event[failed] error[%1]").arg(error);
+        report.m_error = error;
+        return false;
+    }
+}
@@ -0,0 +1,53 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <cstdint>
+
+using namespace std;
+
+/**
+ * @class ConcatOptions
+ * @brief 合并选项
+ */
+struct ConcatOptions {
+    bool m_recover = false;             // 片段用恢复模式解析
+    bool m_allow_config_change = false; // 允许片段之间sequence header不同（如分辨率变化），不同的会保留
+};
+
+/**
+ * @class ConcatReport
+ * @brief 合并结果统计
+ */
+struct ConcatReport {
+    uint64_t m_segments = 0;
+    uint64_t m_tags_written = 0;
+    uint64_t m_sequence_headers_removed = 0;
+    uint64_t m_previous_tag_size_fixed = 0;
+    uint32_t m_duration = 0; // 输出的时长(ms)
+    uint64_t m_output_size = 0;
+    QString m_error;
+
+    QString toString() const;
+};
+
+/**
+ * @class FlvConcat
+ * @brief 无损合并多个FLV片段
+ *
+ * 1. 逐个解析片段，比较各片段的codec和sequence header，不兼容时报错
+ * 2. 后一个片段的时间戳接在前一个片段最后一帧之后（间隔取前一片段最后两帧视频的间隔），整体从0开始
+ * 3. 与上一个写出的sequence header相同的直接丢弃，onMetaData按合并结果重建
+ * 4. 各片段依次映射，tag头改写时间戳后与负载一起经大块缓冲顺序写出
+ */
+class FlvConcat {
+  public:
+    static bool concat(const QStringList& sources,
+                       const QString& target_path,
+                       const ConcatOptions& options,
+                       ConcatReport& report);
+};
@@ -0,0 +1,291 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "FlvCutter.h"
+#include "BufferedWriter.h"
+#include "Log.h"
+#include "RepairWriter.h"
+#include "Utils.h"
+#include <QFile>
+#include <algorithm>
+#include <cstring>
+
+QString CutReport::toString() const {
+    return QString("截取范围%1ms - %2ms（起点已对齐到关键帧）\n"
+                   "写出%3个tag，输出%4字节\n"
+                   "带入sequence header %5个，修正PreviousTagSize %6处")
+        .arg(m_start)
+        .arg(m_end)
+        .arg(m_tags_written)
+        .arg(m_output_size)
+        .arg(m_sequence_headers)
+        .arg(m_previous_tag_size_fixed) +
+           (m_regression_tag >= 0 ? QString("\ntag #%1 时间戳回退，截取在此结束").arg(m_regression_tag) : QString());
+}
+
+bool FlvCutter::isMediaTag(const TagIndex& index, size_t i) {
+    return (index.m_type[i] == TAG_TYPE_AUDIO || index.m_type[i] == TAG_TYPE_VIDEO) &&
+           !(index.m_flags[i] & TAG_FLAG_GARBAGE);
+}
+
+bool FlvCutter::isVideoKeyframe(const TagIndex& index, size_t i) {
+    return index.m_type[i] == TAG_TYPE_VIDEO && (index.m_flags[i] & TAG_FLAG_KEYFRAME) &&
+           !(index.m_flags[i] & (TAG_FLAG_SEQUENCE_HEADER | TAG_FLAG_GARBAGE));
+}
+
+const MetadataItem* FlvCutter::findOnMetaData(const vector<unique_ptr<FLVTag>>& tags) {
+    for (auto& tag : tags) {
+        if (tag->metadata_info && tag->metadata_info->m_metadata_values.key == "onMetaData")
+            return &tag->metadata_info->m_metadata_values;
+    }
+    return nullptr;
+}
+
+int64_t FlvCutter::findStartTag(const TagIndex& index, uint32_t start) {
+    int64_t before = -1;
+    for (size_t i = 0; i < index.size(); ++i) {
+        if (!isVideoKeyframe(index, i))
+            continue;
+        if (index.m_timestamp[i] > start)
+            return before >= 0 ? before : static_cast<int64_t>(i);
+        before = i;
+    }
+    if (before >= 0)
+        return before;
+
+    // 没有视频关键帧时按音频对齐，音频每帧都可以独立解码
+    for (size_t i = 0; i < index.size(); ++i) {
+        if (isMediaTag(index, i) && !(index.m_flags[i] & TAG_FLAG_SEQUENCE_HEADER) && index.m_timestamp[i] >= start)
+            return i;
+    }
+    return -1;
+}
+
+bool FlvCutter::cut(const QString& source_path,
+                    const QString& target_path,
+                    const vector<unique_ptr<FLVTag>>& tags,
+                    const TagIndex& index,
+                    uint32_t start,
+                    uint32_t end,
+                    CutReport& report) {
+    report = CutReport();
+    QFile source(source_path);
+    uchar* mapped = nullptr;
+
+    try {
+        if (end <= start) {
+            throw QString("结束时间必须大于开始时间");
+        }
+        int64_t first = findStartTag(index, start);
+        if (first < 0) {
+            throw QString("%1ms之后没有可作为起点的关键帧").arg(start);
+        }
+        uint32_t base = index.m_timestamp[first];
+        report.m_start = base;
+
+        if (!source.open(QIODevice::ReadOnly)) {
+            throw QString("打开源文件失败：%1").arg(source.errorString());
+        }
+        int64_t source_size = source.size();
+        auto complete = [&](size_t i) {
+            return index.m_offset[i] + index.tagSpan(i) <= static_cast<uint64_t>(source_size);
+        };
+
+        // 起点之前最近的音频/视频sequence header
+        vector<size_t> kept = carriedSequenceHeaders(index, first, source_size);
+        report.m_sequence_headers = kept.size();
+
+        // 范围内的tag：按时间戳取[base, end)，范围内的sequence header不受起点限制，onMetaData重新生成；
+        // 时间戳回退超过MAX_INTERLEAVE_MS时后面是另一段时间线，在此结束
+        uint32_t latest = base;
+        for (size_t i = first; i < index.size(); ++i) {
+            if ((index.m_flags[i] & TAG_FLAG_GARBAGE) || !complete(i))
+                continue;
+            uint8_t type = index.m_type[i];
+            const FLVTag& tag = *tags[i];
+            if (tag.metadata_info && tag.metadata_info->m_metadata_values.key == "onMetaData")
+                continue;
+
+            uint32_t timestamp = index.m_timestamp[i];
+            bool sequence_header = index.m_flags[i] & TAG_FLAG_SEQUENCE_HEADER;
+            if (isMediaTag(index, i) && !sequence_header) {
+                if (timestamp + MAX_INTERLEAVE_MS < latest) {
+                    report.m_regression_tag = static_cast<int64_t>(i);
+                    break;
+                }
+                latest = max(latest, timestamp);
+            }
+            if (timestamp >= end || (timestamp < base && !sequence_header))
+                continue;
+            if (type != TAG_TYPE_SCRIPT && !sequence_header)
+                report.m_end = max(report.m_end, timestamp);
+            kept.push_back(i);
+        }
+
+        // 顺序写出，只访问保留的tag所在的映射页
+        mapped = source.map(0, source_size);
+        if (!mapped) {
+            throw QString("映射源文件失败：%1").arg(source.errorString());
+        }
+        writeTags(mapped, target_path, index, kept, base, findOnMetaData(tags), report);
+        source.unmap(mapped);
+        mapped = nullptr;
+
+        qCInfo(runLog) << QString("[flv-cut] event[finished] target[%1] start[%2] end[%3] tags[%4] size[%5]")
+                              .arg(target_path)
+                              .arg(report.m_start)
+                              .arg(report.m_end)
+                              .arg(report.m_tags_written)
+                              .arg(report.m_output_size);
+        return true;
+    } catch (const QString& error) {
+        qCInfo(runLog) << QString("[flv-cut] event[failed] error[%1]").arg(error);
+        report.m_error = error;
+        if (mapped)
+            source.unmap(mapped);
+        return false;
+    }
+}
+
+vector<size_t> FlvCutter::carriedSequenceHeaders(const TagIndex& index, size_t first, uint64_t source_size) {
+    int64_t last_header[2] = {-1, -1};
+    for (size_t i = 0; i < first; ++i) {
+        if (isMediaTag(index, i) && (index.m_flags[i] & TAG_FLAG_SEQUENCE_HEADER) &&
+            index.m_offset[i] + index.tagSpan(i) <= source_size)
+            last_header[index.m_type[i] == TAG_TYPE_VIDEO ? 1 : 0] = i;
+    }
+    vector<size_t> headers;
+    for (int64_t header : last_header) {
+        if (header >= 0)
+            headers.push_back(header);
+    }
+    sort(headers.begin(), headers.end());
+    return headers;
+}
+
+TagWriteStats FlvCutter::writeRuns(const QString& target_path,
+                                  const vector<TagRun>& runs,
+                                  const MetadataItem* original_metadata) {
+    TagWriteStats stats;
+    QString temp_path = target_path + "_temp";
+    QFile target(temp_path);
+
+    try {
+        auto outputTimestamp = [](const TagRun& run, size_t i) -> uint32_t {
+            return static_cast<uint32_t>(max<int64_t>(0, run.m_index->m_timestamp[i] + run.m_offset));
+        };
+
+        bool has_audio = false;
+        bool has_video = false;
+        vector<double> keyframe_times;
+        for (const TagRun& run : runs) {
+            const TagIndex& index = *run.m_index;
+            for (size_t i : *run.m_kept) {
+                has_audio |= index.m_type[i] == TAG_TYPE_AUDIO;
+                has_video |= index.m_type[i] == TAG_TYPE_VIDEO;
+                if (isMediaTag(index, i) && !(index.m_flags[i] & TAG_FLAG_SEQUENCE_HEADER))
+                    stats.m_duration = max(stats.m_duration, outputTimestamp(run, i));
+                if (isVideoKeyframe(index, i))
+                    keyframe_times.push_back(outputTimestamp(run, i) / 1000.0);
+            }
+        }
+
+        // 计算输出布局，onMetaData长度只和关键帧个数有关
+        vector<double> keyframe_positions(keyframe_times.size());
+        double duration = stats.m_duration / 1000.0;
+        QByteArray metadata_tag =
+            RepairWriter::buildMetadataTag(original_metadata, duration, 0, keyframe_times, keyframe_positions);
+        uint64_t out_pos = FLV_HEADER_SIZE + metadata_tag.size();
+        size_t keyframe = 0;
+        for (const TagRun& run : runs) {
+            for (size_t i : *run.m_kept) {
+                if (isVideoKeyframe(*run.m_index, i))
+                    keyframe_positions[keyframe++] = static_cast<double>(out_pos);
+                out_pos += run.m_index->tagSpan(i);
+            }
+        }
+        metadata_tag = RepairWriter::buildMetadataTag(
+            original_metadata, duration, static_cast<double>(out_pos), keyframe_times, keyframe_positions);
+
+        if (!target.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            throw QString("创建输出文件失败：%1").arg(target.errorString());
+        }
+        BufferedWriter writer(target, RepairWriter::WRITE_BUFFER_SIZE);
+
+        uchar header[FLV_HEADER_SIZE] = {'F', 'L', 'V', 1, 0, 0, 0, 0, 9, 0, 0, 0, 0};
+        header[4] = (has_audio ? 0x04 : 0) | (has_video ? 0x01 : 0);
+        writer.write(header, FLV_HEADER_SIZE);
+        writer.write(metadata_tag.constData(), metadata_tag.size());
+
+        // 逐组顺序写出，未映射的源文件写到时才映射，只访问保留的tag所在的页
+        for (const TagRun& run : runs) {
+            QFile source(run.m_path);
+            const uchar* mapped = run.m_mapped;
+            if (!mapped) {
+                if (!source.open(QIODevice::ReadOnly)) {
+                    throw QString("打开文件失败：%1：%2").arg(run.m_path, source.errorString());
+                }
+                mapped = source.map(0, source.size());
+                if (!mapped) {
+                    throw QString("映射文件失败：%1").arg(run.m_path);
+                }
+            }
+
+            const TagIndex& index = *run.m_index;
+            for (size_t i : *run.m_kept) {
+                const uchar* src = mapped + index.m_offset[i];
+                uint32_t data_size = index.m_data_size[i];
+
+                uchar tag_header[11];
+                memcpy(tag_header, src, 11);
+                uint32_t timestamp = outputTimestamp(run, i);
+                bigend_utoc24(tag_header + 4, timestamp & 0xFFFFFF);
+                tag_header[7] = static_cast<uchar>(timestamp >> 24);
+                writer.write(tag_header, 11);
+                writer.write(src + 11, data_size);
+
+                uchar prev[4];
+                bigend_utoc32(prev, 11 + data_size);
+                if (memcmp(prev, src + 11 + data_size, 4) != 0)
+                    ++stats.m_previous_tag_size_fixed;
+                writer.write(prev, 4);
+                ++stats.m_tags_written;
+            }
+        }
+
+        writer.flush();
+        stats.m_output_size = writer.written();
+        target.close();
+
+        if (QFile::exists(target_path) && !QFile::remove(target_path)) {
+            throw QString("删除原目标文件失败");
+        }
+        if (!QFile::rename(temp_path, target_path)) {
+            throw QString("重命名临时文件失败");
+        }
+    } catch (const QString&) {
+        target.close();
+        QFile::remove(temp_path);
+        throw;
+    }
+    return stats;
+}
+
+void FlvCutter::writeTags(const uchar* mapped,
+                          const QString& target_path,
+                          const TagIndex& index,
+                          const vector<size_t>& kept,
+                          uint32_t base,
+                          const MetadataItem* original_metadata,
+                          CutReport& report) {
+    TagRun run;
+    run.m_mapped = mapped;
+    run.m_index = &index;
+    run.m_kept = &kept;
+    run.m_offset = -static_cast<int64_t>(base);
+    TagWriteStats stats = writeRuns(target_path, {run}, original_metadata);
+    report.m_tags_written += stats.m_tags_written;
+    report.m_previous_tag_size_fixed += stats.m_previous_tag_size_fixed;
+    report.m_output_size += stats.m_output_size;
+}
@@ -0,0 +1,116 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "TagIndex.h"
+#include "TagInfo.h"
+#include <QString>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @class CutReport
+ * @brief 截取结果统计
+ */
+struct CutReport {
+    uint32_t m_start = 0;    // 实际起点（对齐到关键帧后的原始时间戳）
+    uint32_t m_end = 0;      // 最后一个写出的音视频tag的原始时间戳
+    uint64_t m_tags_written = 0;
+    uint64_t m_sequence_headers = 0; // 从范围之前带入的sequence header
+    uint64_t m_previous_tag_size_fixed = 0;
+    uint64_t m_output_size = 0;
+    int64_t m_regression_tag = -1; // 范围内遇到时间戳回退（重置、回绕）而提前结束的tag，-1为没有
+    QString m_error;
+
+    QString toString() const;
+};
+
+/**
+ * @class TagRun
+ * @brief 要写出的一组tag，来自同一个源文件，输出时间戳 = 原时间戳 + m_offset（小于0时取0）
+ */
+struct TagRun {
+    QString m_path;                  // m_mapped为空时，写出前按路径映射
+    const uchar* m_mapped = nullptr; // 映射的整个源文件
+    const TagIndex* m_index = nullptr;
+    const vector<size_t>* m_kept = nullptr; // 按输出顺序的tag下标
+    int64_t m_offset = 0;
+};
+
+/**
+ * @class TagWriteStats
+ * @brief writeRuns的输出统计
+ */
+struct TagWriteStats {
+    uint64_t m_tags_written = 0;
+    uint64_t m_previous_tag_size_fixed = 0;
+    uint64_t m_output_size = 0;
+    uint32_t m_duration = 0; // 输出中音视频数据帧的最大时间戳(ms)
+};
+
+/**
+ * @class FlvCutter
+ * @brief 无损截取[start, end)时间范围：起点向前对齐到关键帧，带上范围之前最近的sequence header，
+ *        时间戳从0开始，重建onMetaData，修正PreviousTagSize
+ *
+ * 只根据tag索引决定写出哪些tag，源文件映射后一次顺序拼接，范围之外的数据不会被读取
+ */
+class FlvCutter {
+  public:
+    // 音视频交错允许的时间戳回退(ms)，超过时视为时间戳重置
+    static constexpr uint32_t MAX_INTERLEAVE_MS = 1000;
+
+    /**
+     * 起点对齐到的tag下标，失败返回-1
+     *
+     * 按文件顺序取start之前最近的视频关键帧，遇到第一个超过start的关键帧即停止，
+     * 时间戳重置后的片段不会被选中；没有视频时为第一个时间戳不小于start的音频tag
+     */
+    static int64_t findStartTag(const TagIndex& index, uint32_t start);
+
+    static bool cut(const QString& source_path,
+                    const QString& target_path,
+                    const vector<unique_ptr<FLVTag>>& tags,
+                    const TagIndex& index,
+                    uint32_t start,
+                    uint32_t end,
+                    CutReport& report);
+
+    // 第一个onMetaData，没有时返回nullptr
+    static const MetadataItem* findOnMetaData(const vector<unique_ptr<FLVTag>>& tags);
+
+    // first之前最近的音频、视频sequence header（按tag顺序），截取和分割的输出都要带上才能独立解码
+    static vector<size_t> carriedSequenceHeaders(const TagIndex& index, size_t first, uint64_t source_size);
+
+    // 音频或视频tag（不含垃圾数据段）
+    static bool isMediaTag(const TagIndex& index, size_t i);
+    // 视频关键帧，不含sequence header
+    static bool isVideoKeyframe(const TagIndex& index, size_t i);
+
+    /**
+     * @brief 把各组tag依次写成一个独立的FLV文件（先写临时文件再改名），失败时抛出QString
+     *
+     * 改写tag头中的时间戳，按原onMetaData重建duration/filesize/keyframes，修正PreviousTagSize；
+     * 截取、分割和合并共用
+     */
+    static TagWriteStats writeRuns(const QString& target_path,
+                                   const vector<TagRun>& runs,
+                                   const MetadataItem* original_metadata);
+
+    /**
+     * @brief 把kept中的tag写成独立的FLV文件，时间戳减去base，失败时抛出QString
+     *
+     * 写出的tag数、修正数和输出大小累加到report
+     */
+    static void writeTags(const uchar* mapped,
+                          const QString& target_path,
+                          const TagIndex& index,
+                          const vector<size_t>& kept,
+                          uint32_t base,
+                          const MetadataItem* original_metadata,
+                          CutReport& report);
+};
@@ -0,0 +1,325 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "FlvDiff.h"
+#include "Log.h"
+#include "ModelWidget.h"
+#include "TagHash.h"
+#include "Utils.h"
+#include <QBuffer>
+#include <QFile>
+#include <QStringList>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <unordered_map>
+
+namespace {
+
+// 同一个key下的tag下标，按顺序逐个取出配对
+struct Bucket {
+    vector<int64_t> m_items;
+    size_t m_next = 0;
+};
+
+class BucketMap {
+  public:
+    void add(uint64_t key, int64_t item) {
+        m_buckets[key].m_items.push_back(item);
+    }
+
+    // 取出key下第一个未使用的tag，没有时返回-1
+    int64_t take(uint64_t key) {
+        auto it = m_buckets.find(key);
+        if (it == m_buckets.end() || it->second.m_next >= it->second.m_items.size())
+            return -1;
+        return it->second.m_items[it->second.m_next++];
+    }
+
+    void reserve(size_t count) {
+        m_buckets.reserve(count);
+    }
+
+  private:
+    unordered_map<uint64_t, Bucket> m_buckets;
+};
+
+uint64_t hashKey(uint64_t hash, uint8_t type) {
+    return hash ^ (static_cast<uint64_t>(type) * 0x9E3779B97F4A7C15ULL);
+}
+
+uint64_t timeKey(int64_t timestamp, uint8_t type) {
+    return (static_cast<uint64_t>(timestamp) << 8) | type;
+}
+
+QString metadataValueText(const property_variant& value) {
+    if (auto pd = std::get_if<double>(&value))
+        return QString("%1").arg(*pd, 0, 'g', 10);
+    if (auto pb = std::get_if<bool>(&value))
+        return *pb ? "true" : "false";
+    if (auto ps = std::get_if<std::string>(&value))
+        return QString::fromStdString(*ps);
+    return QString();
+}
+
+// 展开为 "key.child" -> 值，strict array只比较长度（如keyframes.times）
+void flattenMetadata(const MetadataItem& item, const QString& prefix, map<QString, QString>& out) {
+    QString key = prefix.isEmpty() ? item.key : prefix + "." + item.key;
+    if (item.type == AMF_STRICT_ARRAY) {
+        out[key] = QString("[%1]").arg(item.obj_value.size());
+        return;
+    }
+    if (item.type == AMF_OBJECT || item.type == AMF_ECMA_ARRAY) {
+        for (auto& child : item.obj_value) {
+            flattenMetadata(child, key, out);
+        }
+        return;
+    }
+    out[key] = metadataValueText(item.value);
+}
+
+// 解码index中第一个script tag的onMetaData，没有时返回false
+bool readFirstMetadata(const uchar* data, const TagIndex& index, MetadataItem& metadata) {
+    for (size_t i = 0; i < index.size(); ++i) {
+        if (index.m_type[i] != TAG_TYPE_SCRIPT)
+            continue;
+
+        QByteArray bytes = QByteArray::fromRawData(reinterpret_cast<const char*>(data + index.m_offset[i] + 11),
+                                                   static_cast<int>(index.m_data_size[i]));
+        QBuffer buffer(&bytes);
+        buffer.open(QIODevice::ReadOnly);
+        QDataStream stream(&buffer);
+        DataTagInfo info(nullptr);
+        info.ReadFromStream(stream);
+        metadata = std::move(info.m_metadata_values);
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+const MetadataItem* FlvDiff::firstMetadata(ModelTagList& model) {
+    for (auto& tag : model.getTagList()) {
+        if (tag->metadata_info)
+            return &tag->metadata_info->m_metadata_values;
+    }
+    return nullptr;
+}
+
+QString DiffResult::summary() const {
+    QString text = QString("A：%1 个tag，B：%2 个tag，B的时间戳偏移 %3 ms\n")
+                       .arg(m_index_a.size())
+                       .arg(m_index_b.size())
+                       .arg(m_ts_offset);
+    QStringList counts;
+    for (int kind = 0; kind < DIFF_KIND_COUNT; ++kind) {
+        counts.append(QString("%1 %2").arg(getDiffKind(kind)).arg(m_counts[kind]));
+    }
+    text += counts.join("，");
+    text += QString("，onMetaData差异 %1 项").arg(m_metadata.size());
+    return text;
+}
+
+void FlvDiff::compare(const vector<uint64_t>& hash_a, const vector<uint64_t>& hash_b, DiffResult& result) {
+    const TagIndex& a = result.m_index_a;
+    const TagIndex& b = result.m_index_b;
+    size_t count_a = a.size();
+    size_t count_b = b.size();
+    vector<int64_t> match_a(count_a, -1);
+    vector<int64_t> match_b(count_b, -1);
+    vector<uint8_t> kind_a(count_a, DIFF_DROPPED);
+
+    // 1. 类型+负载哈希相同的tag按顺序配对，重复的负载（如重发的sequence header）一一对应
+    {
+        BucketMap buckets;
+        buckets.reserve(count_b);
+        for (size_t j = 0; j < count_b; ++j) {
+            buckets.add(hashKey(hash_b[j], b.m_type[j]), j);
+        }
+        for (size_t i = 0; i < count_a; ++i) {
+            int64_t j = buckets.take(hashKey(hash_a[i], a.m_type[i]));
+            if (j >= 0) {
+                match_a[i] = j;
+                match_b[j] = i;
+            }
+        }
+    }
+
+    // 2. 最常见的时间戳偏移，CDN转推常整体平移时间戳
+    {
+        unordered_map<int64_t, size_t> offsets;
+        for (size_t i = 0; i < count_a; ++i) {
+            if (match_a[i] >= 0)
+                ++offsets[static_cast<int64_t>(b.m_timestamp[match_a[i]]) - a.m_timestamp[i]];
+        }
+        size_t best = 0;
+        for (auto& [offset, n] : offsets) {
+            if (n > best || (n == best && llabs(offset) < llabs(result.m_ts_offset))) {
+                best = n;
+                result.m_ts_offset = offset;
+            }
+        }
+    }
+
+    // 3. 配对中B下标的最长递增子序列保持了相对顺序，其余为重排
+    {
+        vector<size_t> sequence; // 按A顺序的已配对tag
+        for (size_t i = 0; i < count_a; ++i) {
+            if (match_a[i] >= 0)
+                sequence.push_back(i);
+        }
+
+        vector<int64_t> tail_value;
+        vector<size_t> tail_pos;
+        vector<int64_t> prev(sequence.size(), -1);
+        for (size_t k = 0; k < sequence.size(); ++k) {
+            int64_t value = match_a[sequence[k]];
+            size_t len = lower_bound(tail_value.begin(), tail_value.end(), value) - tail_value.begin();
+            if (len > 0)
+                prev[k] = static_cast<int64_t>(tail_pos[len - 1]);
+            if (len == tail_value.size()) {
+                tail_value.push_back(value);
+                tail_pos.push_back(k);
+            } else {
+                tail_value[len] = value;
+                tail_pos[len] = k;
+            }
+        }
+
+        for (size_t i : sequence) {
+            kind_a[i] = DIFF_REORDERED;
+        }
+        for (int64_t k = tail_pos.empty() ? -1 : static_cast<int64_t>(tail_pos.back()); k >= 0; k = prev[k]) {
+            size_t i = sequence[k];
+            int64_t delta = static_cast<int64_t>(b.m_timestamp[match_a[i]]) - a.m_timestamp[i];
+            kind_a[i] = delta == result.m_ts_offset ? DIFF_SAME : DIFF_TIMESTAMP;
+        }
+    }
+
+    // 4. 剩下的按类型+偏移后的时间戳配对，视为内容改变
+    {
+        BucketMap buckets;
+        for (size_t j = 0; j < count_b; ++j) {
+            if (match_b[j] < 0)
+                buckets.add(timeKey(b.m_timestamp[j], b.m_type[j]), j);
+        }
+        for (size_t i = 0; i < count_a; ++i) {
+            if (match_a[i] >= 0)
+                continue;
+            int64_t j = buckets.take(timeKey(static_cast<int64_t>(a.m_timestamp[i]) + result.m_ts_offset, a.m_type[i]));
+            if (j >= 0) {
+                match_a[i] = j;
+                match_b[j] = i;
+                kind_a[i] = DIFF_ALTERED;
+            }
+        }
+    }
+
+    // 5. 并排输出：B独有的tag放在B中前面已对齐的tag（对应A下标取最大值）之后
+    vector<pair<int64_t, int64_t>> inserted; // (A中的锚点, B下标)
+    int64_t anchor = -1;
+    for (size_t j = 0; j < count_b; ++j) {
+        if (match_b[j] >= 0)
+            anchor = max(anchor, match_b[j]);
+        else
+            inserted.emplace_back(anchor, j);
+    }
+
+    result.m_rows.clear();
+    result.m_rows.reserve(count_a + inserted.size());
+    result.m_counts.fill(0);
+    auto emitRow = [&](int64_t i, int64_t j, uint8_t kind) {
+        result.m_rows.push_back({i, j, kind});
+        ++result.m_counts[kind];
+    };
+
+    size_t next = 0;
+    for (; next < inserted.size() && inserted[next].first < 0; ++next) {
+        emitRow(-1, inserted[next].second, DIFF_INSERTED);
+    }
+    for (size_t i = 0; i < count_a; ++i) {
+        emitRow(i, match_a[i], kind_a[i]);
+        for (; next < inserted.size() && inserted[next].first == static_cast<int64_t>(i); ++next) {
+            emitRow(-1, inserted[next].second, DIFF_INSERTED);
+        }
+    }
+}
+
+vector<MetadataDiff> FlvDiff::compareMetadata(const MetadataItem* a, const MetadataItem* b) {
+    map<QString, QString> values_a;
+    map<QString, QString> values_b;
+    if (a)
+        flattenMetadata(*a, QString(), values_a);
+    if (b)
+        flattenMetadata(*b, QString(), values_b);
+
+    vector<MetadataDiff> diffs;
+    auto it_a = values_a.begin();
+    auto it_b = values_b.begin();
+    while (it_a != values_a.end() || it_b != values_b.end()) {
+        if (it_b == values_b.end() || (it_a != values_a.end() && it_a->first < it_b->first)) {
+            diffs.push_back({it_a->first, it_a->second, QString()});
+            ++it_a;
+        } else if (it_a == values_a.end() || it_b->first < it_a->first) {
+            diffs.push_back({it_b->first, QString(), it_b->second});
+            ++it_b;
+        } else {
+            if (it_a->second != it_b->second)
+                diffs.push_back({it_a->first, it_a->second, it_b->second});
+            ++it_a;
+            ++it_b;
+        }
+    }
+    return diffs;
+}
+
+DiffResult FlvDiff::compareFiles(const QString& path_a,
+                                 const TagIndex& index_a,
+                                 const MetadataItem* metadata_a,
+                                 const QString& path_b) {
+    QFile file_b(path_b);
+    if (!file_b.open(QIODevice::ReadOnly)) {
+        throw QString("打开文件失败：%1").arg(file_b.errorString());
+    }
+    int64_t size_b = file_b.size();
+    if (size_b < FLV_HEADER_SIZE) {
+        throw QString("不是有效的FLV文件：%1").arg(path_b);
+    }
+    uchar* mapped = file_b.map(0, size_b);
+    if (!mapped) {
+        throw QString("映射文件失败：%1").arg(file_b.errorString());
+    }
+    if (memcmp(mapped, "FLV", 3) != 0) {
+        file_b.unmap(mapped);
+        throw QString("不是有效的FLV文件：%1").arg(path_b);
+    }
+
+    DiffResult result;
+    result.m_path_a = path_a;
+    result.m_path_b = path_b;
+    result.m_index_a = index_a;
+    result.m_index_b.scanHeaders(mapped, size_b);
+
+    // TagHash按整个tag数据计算，与两侧是否解析了音视频头无关
+    vector<uint64_t> hash_a = TagHash::hashFile(path_a, result.m_index_a);
+    vector<uint64_t> hash_b = TagHash::hashPayloads(mapped, size_b, result.m_index_b);
+    MetadataItem metadata_b;
+    bool has_metadata_b = readFirstMetadata(mapped, result.m_index_b, metadata_b);
+    file_b.unmap(mapped);
+
+    compare(hash_a, hash_b, result);
+    result.m_metadata = compareMetadata(metadata_a, has_metadata_b ? &metadata_b : nullptr);
+
+    qCInfo(runLog) << QString("[flv-diff] event[finished] tags_a[%1] tags_b[%2] ts_offset[%3] dropped[%4] inserted[%5] "
+                              "altered[%6] reordered[%7]")
+                          .arg(result.m_index_a.size())
+                          .arg(result.m_index_b.size())
+                          .arg(result.m_ts_offset)
+                          .arg(result.m_counts[DIFF_DROPPED])
+                          .arg(result.m_counts[DIFF_INSERTED])
+                          .arg(result.m_counts[DIFF_ALTERED])
+                          .arg(result.m_counts[DIFF_REORDERED]);
+    return result;
+}
@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "TagIndex.h"
+#include "TagInfo.h"
+#include <QString>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+class ModelTagList;
+
+// 对齐结果中每一行的差异类型
+enum DIFF_KIND : uint8_t {
+    DIFF_SAME = 0,  // 负载相同，时间戳按整体偏移后相同
+    DIFF_TIMESTAMP, // 负载相同，时间戳不同
+    DIFF_ALTERED,   // 同类型同时间戳，负载不同
+    DIFF_REORDERED, // 负载相同，但相对其他tag的顺序变了
+    DIFF_DROPPED,   // 只在A中
+    DIFF_INSERTED,  // 只在B中
+    DIFF_KIND_COUNT
+};
+
+inline const char* getDiffKind(uint8_t kind) {
+    switch (kind) {
+    case DIFF_SAME:
+        return "same";
+    case DIFF_TIMESTAMP:
+        return "timestamp";
+    case DIFF_ALTERED:
+        return "altered";
+    case DIFF_REORDERED:
+        return "reordered";
+    case DIFF_DROPPED:
+        return "dropped";
+    case DIFF_INSERTED:
+        return "inserted";
+    default:
+        return "unknown";
+    }
+}
+
+/**
+ * @class DiffRow
+ * @brief 并排对齐的一行，m_a/m_b为两边的tag下标，-1表示该侧没有对应tag
+ */
+struct DiffRow {
+    int64_t m_a = -1;
+    int64_t m_b = -1;
+    uint8_t m_kind = DIFF_SAME;
+};
+
+/**
+ * @class MetadataDiff
+ * @brief onMetaData中取值不同的字段，缺失的一侧为空
+ */
+struct MetadataDiff {
+    QString m_key;
+    QString m_a;
+    QString m_b;
+};
+
+/**
+ * @class DiffResult
+ * @brief 两个文件的结构化比较结果
+ */
+struct DiffResult {
+    QString m_path_a;
+    QString m_path_b;
+    TagIndex m_index_a;
+    TagIndex m_index_b;
+
+    vector<DiffRow> m_rows; // 按A的顺序，B独有的tag插在B中前一个已对齐tag之后
+    vector<MetadataDiff> m_metadata;
+    int64_t m_ts_offset = 0; // B相对A最常见的时间戳偏移(ms)
+    array<size_t, DIFF_KIND_COUNT> m_counts{};
+
+    QString summary() const;
+};
+
+/**
+ * @class FlvDiff
+ * @brief 按负载哈希和时间戳对齐两个FLV文件的tag
+ *
+ * 1. 类型+负载哈希相同的tag按各自顺序依次配对
+ * 2. 配对中B下标的最长递增子序列之外的为重排，其余按最常见的时间戳偏移判断时间戳是否改变
+ * 3. 未配对的tag再按类型+时间戳配对为内容改变，剩下的为丢失/新增
+ */
+class FlvDiff {
+  public:
+    static void compare(const vector<uint64_t>& hash_a, const vector<uint64_t>& hash_b, DiffResult& result);
+
+    static vector<MetadataDiff> compareMetadata(const MetadataItem* a, const MetadataItem* b);
+
+    // 第一个script tag的onMetaData，没有时返回空
+    static const MetadataItem* firstMetadata(ModelTagList& model);
+
+    /**
+     * @brief 与已加载的A比较，失败时抛出QString
+     *
+     * B只遍历tag头建立索引，不解析音视频头，只解码第一个script tag；
+     * 不访问A的模型，可在池线程中执行，index_a和metadata_a需在调用期间有效
+     */
+    static DiffResult compareFiles(const QString& path_a,
+                                   const TagIndex& index_a,
+                                   const MetadataItem* metadata_a,
+                                   const QString& path_b);
+};
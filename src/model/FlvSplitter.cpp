@@ -0,0 +1,188 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "FlvSplitter.h"
+#include "FlvCutter.h"
+#include "Log.h"
+#include "Parallel.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <algorithm>
+
+namespace {
+
+bool isMediaFrame(const TagIndex& index, size_t i) {
+    return (index.m_type[i] == TAG_TYPE_AUDIO || index.m_type[i] == TAG_TYPE_VIDEO) &&
+           !(index.m_flags[i] & (TAG_FLAG_GARBAGE | TAG_FLAG_SEQUENCE_HEADER));
+}
+
+} // namespace
+
+QString SplitReport::toString() const {
+    return QString("分割为%1个文件，写出%2个tag，输出%3字节\n"
+                   "各段带入sequence header共%4个")
+        .arg(m_files.size())
+        .arg(m_tags_written)
+        .arg(m_output_size)
+        .arg(m_sequence_headers);
+}
+
+vector<size_t> FlvSplitter::splitPoints(const TagIndex& index, const SplitOptions& options) {
+    bool has_video = false;
+    for (size_t i = 0; i < index.size() && !has_video; ++i) {
+        has_video = isMediaFrame(index, i) && index.m_type[i] == TAG_TYPE_VIDEO;
+    }
+
+    vector<size_t> points;
+    int64_t part_start = -1; // 当前段第一个可切分位置
+    uint64_t keyframes = 0;
+    for (size_t i = 0; i < index.size(); ++i) {
+        if (!isMediaFrame(index, i))
+            continue;
+        bool candidate = has_video ? index.m_type[i] == TAG_TYPE_VIDEO && (index.m_flags[i] & TAG_FLAG_KEYFRAME)
+                                   : true;
+        if (!candidate)
+            continue;
+        if (part_start < 0) {
+            points.push_back(0);
+            part_start = i;
+            keyframes = 1;
+            continue;
+        }
+
+        bool reached = false;
+        switch (options.m_mode) {
+        case SplitOptions::MODE_DURATION:
+            reached = index.m_timestamp[i] >= index.m_timestamp[part_start] + options.m_value;
+            break;
+        case SplitOptions::MODE_SIZE:
+            reached = index.m_offset[i] - index.m_offset[part_start] >= options.m_value;
+            break;
+        case SplitOptions::MODE_KEYFRAMES:
+            reached = keyframes >= options.m_value;
+            break;
+        }
+        if (reached) {
+            points.push_back(i);
+            part_start = i;
+            keyframes = 0;
+        }
+        ++keyframes;
+    }
+    return points;
+}
+
+bool FlvSplitter::split(const QString& source_path,
+                        const QString& output_dir,
+                        const vector<unique_ptr<FLVTag>>& tags,
+                        const TagIndex& index,
+                        const SplitOptions& options,
+                        SplitReport& report) {
+    report = SplitReport();
+    QFile source(source_path);
+    uchar* mapped = nullptr;
+
+    try {
+        if (options.m_value == 0) {
+            throw QString("分割阈值必须大于0");
+        }
+        vector<size_t> points = splitPoints(index, options);
+        if (points.empty()) {
+            throw QString("没有可作为分割点的音视频帧");
+        }
+        if (!QDir(output_dir).exists()) {
+            throw QString("输出目录不存在：%1").arg(output_dir);
+        }
+        if (!source.open(QIODevice::ReadOnly)) {
+            throw QString("打开源文件失败：%1").arg(source.errorString());
+        }
+        uint64_t source_size = source.size();
+        mapped = source.map(0, source_size);
+        if (!mapped) {
+            throw QString("映射源文件失败：%1").arg(source.errorString());
+        }
+
+        // 每段的tag列表：之前最近的sequence header + [分割点, 下一个分割点)内的完整tag，onMetaData重新生成
+        const MetadataItem* metadata = FlvCutter::findOnMetaData(tags);
+        size_t part_count = points.size();
+        vector<vector<size_t>> kept(part_count);
+        vector<uint32_t> base(part_count, 0);
+        vector<uint64_t> carried(part_count, 0);
+        QStringList files;
+        QFileInfo info(source_path);
+        for (size_t p = 0; p < part_count; ++p) {
+            size_t begin = points[p];
+            size_t end = p + 1 < part_count ? points[p + 1] : index.size();
+            if (p > 0) {
+                kept[p] = FlvCutter::carriedSequenceHeaders(index, begin, source_size);
+                carried[p] = kept[p].size();
+            }
+            bool found = false;
+            for (size_t i = begin; i < end; ++i) {
+                if ((index.m_flags[i] & TAG_FLAG_GARBAGE) || index.m_offset[i] + index.tagSpan(i) > source_size)
+                    continue;
+                const FLVTag& tag = *tags[i];
+                if (tag.metadata_info && tag.metadata_info->m_metadata_values.key == "onMetaData")
+                    continue;
+                if (isMediaFrame(index, i)) {
+                    base[p] = found ? min(base[p], index.m_timestamp[i]) : index.m_timestamp[i];
+                    found = true;
+                }
+                kept[p].push_back(i);
+            }
+            QString name = QString("%1_%2.flv")
+                               .arg(info.completeBaseName())
+                               .arg(static_cast<qulonglong>(p + 1), 3, 10, QChar('0'));
+            files.append(QDir(output_dir).filePath(name));
+        }
+
+        // 各段读取的字节区间互不重叠，并行写出
+        vector<CutReport> part_reports(part_count);
+        parallelFor(
+            part_count,
+            [&](size_t begin, size_t end) {
+                for (size_t p = begin; p < end; ++p) {
+                    try {
+                        FlvCutter::writeTags(mapped, files[p], index, kept[p], base[p], metadata, part_reports[p]);
+                    } catch (const QString& error) {
+                        part_reports[p].m_error = error;
+                    }
+                }
+            },
+            1);
+
+        source.unmap(mapped);
+        mapped = nullptr;
+        // 有一段失败时删掉已写出的其他段
+        for (size_t p = 0; p < part_count; ++p) {
+            if (part_reports[p].m_error.isEmpty())
+                continue;
+            for (size_t q = 0; q < part_count; ++q) {
+                if (part_reports[q].m_error.isEmpty())
+                    QFile::remove(files[q]);
+            }
+            throw QString("%1：%2").arg(QFileInfo(files[p]).fileName(), part_reports[p].m_error);
+        }
+        for (size_t p = 0; p < part_count; ++p) {
+            report.m_tags_written += part_reports[p].m_tags_written;
+            report.m_output_size += part_reports[p].m_output_size;
+            report.m_sequence_headers += carried[p];
+        }
+        report.m_files = files;
+
+        qCInfo(runLog) << QString("[flv-split] event[finished] source[%1] parts[%2] tags[%3] size[%4]")
+                              .arg(source_path)
+                              .arg(part_count)
+                              .arg(report.m_tags_written)
+                              .arg(report.m_output_size);
+        return true;
+    } catch (const QString& error) {
+        qCInfo(runLog) << QString("[flv-split] event[failed] error[%1]").arg(error);
+        report.m_error = error;
+        if (mapped)
+            source.unmap(mapped);
+        return false;
+    }
+}
@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "TagIndex.h"
+#include "TagInfo.h"
+#include <QString>
+#include <QStringList>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @class SplitOptions
+ * @brief 分割方式，每一段在达到阈值后的第一个关键帧处结束
+ */
+struct SplitOptions {
+    enum MODE : uint8_t {
+        MODE_DURATION = 0, // m_value为每段时长(ms)
+        MODE_SIZE,         // m_value为每段字节数
+        MODE_KEYFRAMES     // m_value为每段关键帧数
+    };
+
+    MODE m_mode = MODE_DURATION;
+    uint64_t m_value = 3600 * 1000;
+};
+
+/**
+ * @class SplitReport
+ * @brief 分割结果统计
+ */
+struct SplitReport {
+    QStringList m_files;
+    uint64_t m_tags_written = 0;
+    uint64_t m_sequence_headers = 0; // 各段从前面带入的sequence header
+    uint64_t m_output_size = 0;
+    QString m_error;
+
+    QString toString() const;
+};
+
+/**
+ * @class FlvSplitter
+ * @brief 按时长、大小或关键帧数把FLV无损分割为多个独立的文件
+ *
+ * 只在tag索引上选择分割点（视频关键帧，没有视频时为音频帧），每段带上之前最近的sequence header，
+ * 时间戳从0开始并重建onMetaData。源文件映射一次，各段对应互不重叠的字节区间，由多个线程同时写出
+ */
+class FlvSplitter {
+  public:
+    // 每段第一个tag的下标，第一段从0开始
+    static vector<size_t> splitPoints(const TagIndex& index, const SplitOptions& options);
+
+    // 输出为output_dir/<源文件名>_001.flv、_002.flv...
+    static bool split(const QString& source_path,
+                      const QString& output_dir,
+                      const vector<unique_ptr<FLVTag>>& tags,
+                      const TagIndex& index,
+                      const SplitOptions& options,
+                      SplitReport& report);
+};
@@ -0,0 +1,108 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "GopMap.h"
+#include <algorithm>
+
+static uint8_t frameKind(const TagIndex& index, size_t i) {
+    if (index.m_flags[i] & TAG_FLAG_SEQUENCE_HEADER)
+        return GopMap::KIND_SEQUENCE_HEADER;
+    switch (index.m_frame_type[i]) {
+    case 1: // key frame
+    case 4: // generated key frame
+        return GopMap::KIND_KEYFRAME;
+    case 2: // inter frame
+        return GopMap::KIND_INTER;
+    case 3: // disposable inter frame
+        return GopMap::KIND_DISPOSABLE;
+    default:
+        return GopMap::KIND_OTHER;
+    }
+}
+
+// 时间戳回退时记为0
+static uint32_t span(const TagIndex& index, uint32_t first_tag, uint32_t last_tag) {
+    uint32_t first = index.m_timestamp[first_tag];
+    uint32_t last = index.m_timestamp[last_tag];
+    return last > first ? last - first : 0;
+}
+
+void GopMap::build(const TagIndex& index) {
+    clear();
+    for (size_t i = 0; i < index.size(); ++i) {
+        if (index.m_type[i] != TAG_TYPE_VIDEO || (index.m_flags[i] & TAG_FLAG_GARBAGE))
+            continue;
+        m_tag.push_back(static_cast<uint32_t>(i));
+        m_size.push_back(index.m_data_size[i]);
+        m_kind.push_back(frameKind(index, i));
+        m_max_size = max(m_max_size, index.m_data_size[i]);
+    }
+
+    // 每个关键帧开始一个GOP，时长到下一个GOP的第一帧
+    uint32_t frame_count = static_cast<uint32_t>(m_tag.size());
+    for (uint32_t f = 0; f < frame_count; ++f) {
+        if (m_kind[f] != KIND_KEYFRAME)
+            continue;
+        if (!m_gops.empty()) {
+            Gop& last = m_gops.back();
+            last.m_frames = f - last.m_first_frame;
+            last.m_duration_ms = span(index, m_tag[last.m_first_frame], m_tag[f]);
+        }
+        Gop gop;
+        gop.m_first_frame = f;
+        m_gops.push_back(gop);
+    }
+    if (m_gops.empty())
+        return;
+    Gop& last = m_gops.back();
+    last.m_frames = frame_count - last.m_first_frame;
+    last.m_duration_ms = span(index, m_tag[last.m_first_frame], m_tag[frame_count - 1]);
+
+    // 最后一个GOP通常不完整，不参与中位数和不规则判断
+    size_t complete = m_gops.size() > 1 ? m_gops.size() - 1 : m_gops.size();
+    vector<uint32_t> lengths(complete);
+    for (size_t g = 0; g < complete; ++g) {
+        lengths[g] = m_gops[g].m_frames;
+    }
+    nth_element(lengths.begin(), lengths.begin() + complete / 2, lengths.end());
+    m_median_gop = lengths[complete / 2];
+    for (size_t g = 0; g < complete; ++g) {
+        uint32_t frames = m_gops[g].m_frames;
+        m_gops[g].m_irregular = frames * 2 < m_median_gop || frames > m_median_gop + m_median_gop / 2;
+    }
+}
+
+void GopMap::clear() {
+    m_tag.clear();
+    m_size.clear();
+    m_kind.clear();
+    m_gops.clear();
+    m_max_size = 0;
+    m_median_gop = 0;
+}
+
+int64_t GopMap::gopAt(size_t frame) const {
+    auto it = upper_bound(m_gops.begin(), m_gops.end(), frame, [](size_t f, const Gop& gop) {
+        return f < gop.m_first_frame;
+    });
+    return it == m_gops.begin() ? -1 : (it - m_gops.begin()) - 1;
+}
+
+size_t GopMap::frameOfTag(size_t tag_index) const {
+    return lower_bound(m_tag.begin(), m_tag.end(), tag_index) - m_tag.begin();
+}
+
+const char* GopMap::kindName(uint8_t kind) {
+    static const char* const names[KIND_COUNT] = {"关键帧", "帧间预测帧", "可丢弃帧", "sequence header", "其他"};
+    return kind < KIND_COUNT ? names[kind] : "";
+}
+
+QString GopMap::summary() const {
+    size_t irregular = count_if(m_gops.begin(), m_gops.end(), [](const Gop& gop) { return gop.m_irregular; });
+    return QString("%1 帧，%2 个GOP，GOP长度中位数 %3 帧，不规则GOP %4 个")
+        .arg(m_tag.size())
+        .arg(m_gops.size())
+        .arg(m_median_gop)
+        .arg(irregular);
+}
@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "TagIndex.h"
+#include <QString>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @class GopMap
+ * @brief 视频帧序列的GOP结构，每个视频tag一格，列式存储，供GOP结构图按像素区间聚合
+ *
+ * 帧类别取自视频tag头的frame type（VideoTagInfo::m_tag_type，已在tag索引中），sequence header单独一类；
+ * GOP从关键帧开始，帧数与中位数相差超过一半的GOP标记为不规则
+ */
+struct GopMap {
+    enum FRAME_KIND : uint8_t {
+        KIND_KEYFRAME = 0,    // 关键帧、生成的关键帧
+        KIND_INTER,           // 帧间预测帧
+        KIND_DISPOSABLE,      // 可丢弃的帧间预测帧（H.263）
+        KIND_SEQUENCE_HEADER, // 解码配置
+        KIND_OTHER,           // 命令帧等
+        KIND_COUNT
+    };
+
+    struct Gop {
+        uint32_t m_first_frame = 0;
+        uint32_t m_frames = 0;
+        uint32_t m_duration_ms = 0;
+        bool m_irregular = false;
+    };
+
+    vector<uint32_t> m_tag;  // 帧对应的tag下标（不含FLV Header行），升序
+    vector<uint32_t> m_size; // tag数据长度
+    vector<uint8_t> m_kind;  // FRAME_KIND
+    vector<Gop> m_gops;      // 第一个关键帧之前的帧不属于任何GOP
+    uint32_t m_max_size = 0;
+    uint32_t m_median_gop = 0; // GOP帧数的中位数
+
+    void build(const TagIndex& index);
+    void clear();
+
+    size_t size() const {
+        return m_tag.size();
+    }
+
+    // 帧所在的GOP下标，第一个GOP之前返回-1
+    int64_t gopAt(size_t frame) const;
+    // tag对应的帧，不是视频tag时返回之后最近的帧
+    size_t frameOfTag(size_t tag_index) const;
+
+    static const char* kindName(uint8_t kind);
+    QString summary() const;
+};
@@ -0,0 +1,185 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "LogIndex.h"
+#include "FileSearch.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const char* const LEVEL_PREFIX[LOG_LEVEL_COUNT] = {"[debug]", "[info]", "[warning]", "[critical]", "[fatal]"};
+
+} // namespace
+
+bool LogIndex::open(const QString& path, QString& error) {
+    if (m_file.isOpen() && m_file.fileName() != path) {
+        close();
+    }
+    if (!m_file.isOpen()) {
+        m_file.setFileName(path);
+        if (!m_file.open(QIODevice::ReadOnly)) {
+            error = QString("无法打开日志文件: %1").arg(path);
+            return false;
+        }
+    }
+
+    int64_t size = m_file.size();
+    if (size < m_indexed) {
+        // 文件被截断，从头索引
+        QString file_path = m_file.fileName();
+        close();
+        return open(file_path, error);
+    }
+    if (size == m_size && m_data) {
+        return true;
+    }
+
+    // 已有的行偏移不变，只需要重新映射
+    if (m_data) {
+        m_file.unmap(const_cast<uchar*>(m_data));
+        m_data = nullptr;
+    }
+    m_size = 0;
+    if (size > 0) {
+        m_data = m_file.map(0, size);
+        if (!m_data) {
+            error = QString("映射日志文件失败: %1").arg(m_file.errorString());
+            close();
+            return false;
+        }
+        m_size = size;
+    }
+    return true;
+}
+
+void LogIndex::close() {
+    if (m_data) {
+        m_file.unmap(const_cast<uchar*>(m_data));
+        m_data = nullptr;
+    }
+    m_file.close();
+    m_size = 0;
+    m_indexed = 0;
+    m_line_offset.clear();
+    for (auto& bits : m_level_bits) {
+        bits.clear();
+    }
+    m_last_level = LOG_LEVEL_INFO;
+}
+
+bool LogIndex::indexNext(int64_t max_bytes) {
+    int64_t end = min(m_size, m_indexed + max_bytes);
+    int64_t pos = m_indexed;
+    while (pos < end) {
+        // 行可以越过块的末尾
+        const void* newline = memchr(m_data + pos, '\n', static_cast<size_t>(m_size - pos));
+        if (!newline) {
+            m_indexed = pos;
+            return false;
+        }
+        int64_t line_end = static_cast<const uchar*>(newline) - m_data + 1;
+        addLine(pos, line_end);
+        pos = line_end;
+    }
+    m_indexed = pos;
+    return m_indexed < m_size && memchr(m_data + m_indexed, '\n', static_cast<size_t>(m_size - m_indexed));
+}
+
+void LogIndex::addLine(int64_t begin, int64_t end) {
+    const char* text = reinterpret_cast<const char*>(m_data + begin);
+    size_t length = static_cast<size_t>(end - begin);
+    if (length > 0 && text[0] == '[') {
+        for (int level = 0; level < LOG_LEVEL_COUNT; ++level) {
+            size_t prefix_length = strlen(LEVEL_PREFIX[level]);
+            if (length >= prefix_length && memcmp(text, LEVEL_PREFIX[level], prefix_length) == 0) {
+                m_last_level = static_cast<LOG_LEVEL>(level);
+                break;
+            }
+        }
+    }
+
+    size_t line = m_line_offset.size();
+    m_line_offset.push_back(begin);
+    if (line % 64 == 0) {
+        for (auto& bits : m_level_bits) {
+            bits.push_back(0);
+        }
+    }
+    m_level_bits[m_last_level][line / 64] |= uint64_t(1) << (line % 64);
+}
+
+LOG_LEVEL LogIndex::level(size_t line) const {
+    for (int level = 0; level < LOG_LEVEL_COUNT; ++level) {
+        if (m_level_bits[level][line / 64] & (uint64_t(1) << (line % 64)))
+            return static_cast<LOG_LEVEL>(level);
+    }
+    return LOG_LEVEL_INFO;
+}
+
+QString LogIndex::line(size_t line) const {
+    int64_t begin = m_line_offset[line];
+    int64_t end = lineEnd(line);
+    while (end > begin && (m_data[end - 1] == '\n' || m_data[end - 1] == '\r')) {
+        --end;
+    }
+    return QString::fromUtf8(reinterpret_cast<const char*>(m_data + begin), static_cast<int>(end - begin));
+}
+
+void LogIndex::select(size_t first,
+                      size_t last,
+                      uint32_t level_mask,
+                      const QByteArray& text,
+                      vector<uint32_t>& rows) const {
+    last = min(last, lineCount());
+    if (first >= last)
+        return;
+
+    auto levelMatched = [&](size_t line) {
+        uint64_t bit = uint64_t(1) << (line % 64);
+        for (int level = 0; level < LOG_LEVEL_COUNT; ++level) {
+            if ((level_mask & (1u << level)) && (m_level_bits[level][line / 64] & bit))
+                return true;
+        }
+        return false;
+    };
+
+    if (text.isEmpty()) {
+        // 先合并选中级别的位图字，整字为0时跳过64行
+        for (size_t word = first / 64; word * 64 < last; ++word) {
+            uint64_t bits = 0;
+            for (int level = 0; level < LOG_LEVEL_COUNT; ++level) {
+                if (level_mask & (1u << level))
+                    bits |= m_level_bits[level][word];
+            }
+            for (size_t line = max(first, word * 64); bits && line < min(last, word * 64 + 64); ++line) {
+                if (bits & (uint64_t(1) << (line % 64)))
+                    rows.push_back(static_cast<uint32_t>(line));
+            }
+        }
+        return;
+    }
+
+    // 命中按偏移升序，换算为行号后去重；只在已索引的范围内查找
+    vector<SearchPattern> patterns = {SearchPattern{text, "text"}};
+    int64_t end = lineEnd(last - 1);
+    auto it = m_line_offset.begin() + first;
+    int64_t last_line = -1;
+    for (int64_t begin = m_line_offset[first]; begin < end; begin += BLOCK_SIZE) {
+        vector<SearchHit> hits =
+            FileSearch::find(m_data, end, begin, min(end, begin + BLOCK_SIZE), patterns, SIZE_MAX);
+        for (const SearchHit& hit : hits) {
+            it = upper_bound(it, m_line_offset.begin() + last, hit.m_offset);
+            size_t line = static_cast<size_t>(it - m_line_offset.begin()) - 1;
+            --it;
+            if (static_cast<int64_t>(line) == last_line || !levelMatched(line))
+                continue;
+            // 跨行的命中不算
+            if (hit.m_offset + text.size() > lineEnd(line))
+                continue;
+            rows.push_back(static_cast<uint32_t>(line));
+            last_line = line;
+        }
+    }
+}
@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// 日志级别，与qSetMessagePattern("[%{type}] %{message}")输出的前缀对应
+enum LOG_LEVEL : uint8_t {
+    LOG_LEVEL_DEBUG = 0,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_WARNING,
+    LOG_LEVEL_CRITICAL,
+    LOG_LEVEL_FATAL,
+    LOG_LEVEL_COUNT
+};
+
+/**
+ * @class LogIndex
+ * @brief 映射日志文件后建立行偏移索引和每个级别一张的行位图，按块增量建立，文件变大后可继续索引
+ *
+ * 行内容在显示时才解码，过滤时在位图上整字跳过不匹配的行，文本过滤在映射的字节上多线程查找后换算为行号
+ */
+class LogIndex {
+  public:
+    // 每次索引的数据量，块之间回到事件循环
+    static constexpr int64_t BLOCK_SIZE = 16 << 20;
+
+    // 打开或重新映射日志文件；同一文件变大时保留已有索引，变小时从头索引。失败时返回false并填写error
+    bool open(const QString& path, QString& error);
+    void close();
+
+    // 索引下一块中的完整行（最后一行没有换行时等文件变大后再索引），返回是否还有未索引的完整行
+    bool indexNext(int64_t max_bytes = BLOCK_SIZE);
+
+    size_t lineCount() const {
+        return m_line_offset.size();
+    }
+    int64_t indexedSize() const {
+        return m_indexed;
+    }
+    int64_t fileSize() const {
+        return m_size;
+    }
+
+    LOG_LEVEL level(size_t line) const;
+    QString line(size_t line) const;
+
+    // [first, last)内级别在level_mask（1 << LOG_LEVEL）中、且包含text（为空时不限）的行号，追加到rows
+    void select(size_t first, size_t last, uint32_t level_mask, const QByteArray& text, vector<uint32_t>& rows) const;
+
+  private:
+    int64_t lineEnd(size_t line) const {
+        return line + 1 < m_line_offset.size() ? m_line_offset[line + 1] : m_indexed;
+    }
+    void addLine(int64_t begin, int64_t end);
+
+    QFile m_file;
+    const uchar* m_data = nullptr;
+    int64_t m_size = 0;    // 映射的长度
+    int64_t m_indexed = 0; // 已索引到的偏移，总在行首
+
+    vector<int64_t> m_line_offset;                         // 每行的起始偏移
+    array<vector<uint64_t>, LOG_LEVEL_COUNT> m_level_bits; // 每个级别的行位图
+    LOG_LEVEL m_last_level = LOG_LEVEL_INFO;               // 没有级别前缀的行沿用上一行的级别
+};
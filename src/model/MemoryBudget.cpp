@@ -0,0 +1,133 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "MemoryBudget.h"
+#include "Log.h"
+#include "TagInfo.h"
+
+namespace {
+
+// 字段树每个节点：TreeItem、QList中的指针和分配开销
+constexpr uint64_t TREE_NODE_COST = sizeof(TreeItem) + sizeof(void*) + 16;
+
+uint64_t treeSize(const TreeItem* item) {
+    uint64_t size = TREE_NODE_COST;
+    for (const TreeItem* child : item->childItems) {
+        size += treeSize(child);
+    }
+    return size;
+}
+
+} // namespace
+
+MemoryBudget& MemoryBudget::instance() {
+    static MemoryBudget budget;
+    return budget;
+}
+
+const char* MemoryBudget::categoryName(MEMORY_CATEGORY category) {
+    static const char* const names[MEMORY_CATEGORY_COUNT] = {
+        "tag索引", "二进制数据缓存", "字段树缓存", "tag字段", "十六进制视图"};
+    return names[category];
+}
+
+void MemoryBudget::setLimit(uint64_t bytes) {
+    m_limit.store(bytes, memory_order_relaxed);
+    trim();
+}
+
+uint64_t MemoryBudget::total() const {
+    uint64_t sum = 0;
+    for (int i = 0; i < MEMORY_CATEGORY_COUNT; ++i) {
+        sum += used(static_cast<MEMORY_CATEGORY>(i));
+    }
+    return sum;
+}
+
+void MemoryBudget::touch(FLVTag* tag, bool evict) {
+    uint32_t payload = tag->m_bin_data ? tag->m_bin_size : 0;
+    uint64_t tree = tag->m_info_tree ? treeSize(tag->m_info_tree.get()) : 0;
+
+    lock_guard<mutex> locker(m_mutex);
+    add(MEMORY_PAYLOAD, static_cast<int64_t>(payload) - tag->m_cached_payload);
+    add(MEMORY_TREE, static_cast<int64_t>(tree) - tag->m_cached_tree);
+    tag->m_cached_payload = payload;
+    tag->m_cached_tree = static_cast<uint32_t>(tree);
+
+    unlink(tag);
+    if (payload == 0 && tree == 0)
+        return;
+    tag->m_lru_next = m_head;
+    if (m_head)
+        m_head->m_lru_prev = tag;
+    m_head = tag;
+    if (!m_tail)
+        m_tail = tag;
+    tag->m_lru_linked = true;
+    if (evict)
+        enforce(tag);
+}
+
+void MemoryBudget::trim() {
+    lock_guard<mutex> locker(m_mutex);
+    enforce(nullptr);
+}
+
+void MemoryBudget::forget(FLVTag* tag) {
+    lock_guard<mutex> locker(m_mutex);
+    add(MEMORY_PAYLOAD, -static_cast<int64_t>(tag->m_cached_payload));
+    add(MEMORY_TREE, -static_cast<int64_t>(tag->m_cached_tree));
+    tag->m_cached_payload = 0;
+    tag->m_cached_tree = 0;
+    unlink(tag);
+}
+
+QString MemoryBudget::toString() const {
+    QString text;
+    for (int i = 0; i < MEMORY_CATEGORY_COUNT; ++i) {
+        auto category = static_cast<MEMORY_CATEGORY>(i);
+        text += QString("%1：%2 MB\n").arg(categoryName(category)).arg(used(category) / 1048576.0, 0, 'f', 1);
+    }
+    text += QString("合计：%1 MB / 预算 %2 MB").arg(total() / 1048576.0, 0, 'f', 1).arg(limit() >> 20);
+    return text;
+}
+
+void MemoryBudget::unlink(FLVTag* tag) {
+    if (!tag->m_lru_linked)
+        return;
+    (tag->m_lru_prev ? tag->m_lru_prev->m_lru_next : m_head) = tag->m_lru_next;
+    (tag->m_lru_next ? tag->m_lru_next->m_lru_prev : m_tail) = tag->m_lru_prev;
+    tag->m_lru_prev = nullptr;
+    tag->m_lru_next = nullptr;
+    tag->m_lru_linked = false;
+}
+
+// 释放缓存，仍在使用的数据由十六进制视图、字段树视图各自持有的shared_ptr保留到视图关闭
+void MemoryBudget::release(FLVTag* tag) {
+    add(MEMORY_PAYLOAD, -static_cast<int64_t>(tag->m_cached_payload));
+    add(MEMORY_TREE, -static_cast<int64_t>(tag->m_cached_tree));
+    tag->m_cached_payload = 0;
+    tag->m_cached_tree = 0;
+    tag->m_bin_data.reset();
+    tag->m_info_tree.reset();
+    unlink(tag);
+}
+
+void MemoryBudget::enforce(const FLVTag* keep) {
+    uint64_t limit = this->limit();
+    if (total() <= limit)
+        return;
+
+    uint64_t released = 0;
+    int64_t before = static_cast<int64_t>(total());
+    while (total() > limit && m_tail && m_tail != keep) {
+        release(m_tail);
+        ++released;
+    }
+    qCDebug(runLog) << QString("[flv-memory] event[evicted] tags[%1] released[%2] total[%3] limit[%4]")
+                           .arg(released)
+                           .arg(before - static_cast<int64_t>(total()))
+                           .arg(total())
+                           .arg(limit);
+}
@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <QString>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+using namespace std;
+
+struct FLVTag;
+
+// 内存记账的分类
+enum MEMORY_CATEGORY : uint8_t {
+    MEMORY_TAG_INDEX = 0, // 列式tag索引
+    MEMORY_PAYLOAD,       // tag二进制数据缓存（m_bin_data），可释放
+    MEMORY_TREE,          // 字段树缓存（m_info_tree），可释放
+    MEMORY_METADATA,      // FLVTag对象和解析出的字段，按字段个数估算
+    MEMORY_HEX_MODEL,     // 十六进制视图持有的二进制数据
+    MEMORY_CATEGORY_COUNT
+};
+
+/**
+ * @class MemoryBudget
+ * @brief 进程内所有已打开文件共用的内存记账和预算
+ *
+ * 加载过二进制数据或字段树的tag挂在一条侵入式LRU链表上，总量超出预算时从最久未用的tag开始释放这两项缓存，
+ * 之后需要时再从文件读取或重新构建。tag索引和解析出的字段不会被释放，只参与记账
+ */
+class MemoryBudget {
+  public:
+    static constexpr uint64_t DEFAULT_LIMIT = 2048ull << 20;
+
+    static MemoryBudget& instance();
+    static const char* categoryName(MEMORY_CATEGORY category);
+
+    // 调低预算时立即释放超出的缓存
+    void setLimit(uint64_t bytes);
+    uint64_t limit() const {
+        return m_limit.load(memory_order_relaxed);
+    }
+
+    void add(MEMORY_CATEGORY category, int64_t bytes) {
+        m_used[category].fetch_add(bytes, memory_order_relaxed);
+    }
+    uint64_t used(MEMORY_CATEGORY category) const {
+        return static_cast<uint64_t>(max<int64_t>(0, m_used[category].load(memory_order_relaxed)));
+    }
+    uint64_t total() const;
+    bool overLimit() const {
+        return total() > limit();
+    }
+
+    // tag的二进制数据或字段树加载、使用后调用：更新记账并移到链表头，超出预算时释放最久未用的tag（不含本tag）
+    // 后台解析时evict为false，只记账不释放，避免释放界面线程正在查看的其他文件的tag
+    void touch(FLVTag* tag, bool evict = true);
+    // 在界面线程调用，释放超出预算的缓存
+    void trim();
+    // tag析构时调用，扣除已记账的缓存并移出链表
+    void forget(FLVTag* tag);
+
+    // 各分类的用量，每行一项
+    QString toString() const;
+
+  private:
+    MemoryBudget() = default;
+
+    void unlink(FLVTag* tag);
+    void release(FLVTag* tag);
+    void enforce(const FLVTag* keep);
+
+    array<atomic<int64_t>, MEMORY_CATEGORY_COUNT> m_used = {};
+    atomic<uint64_t> m_limit{DEFAULT_LIMIT};
+
+    mutex m_mutex;            // 保护LRU链表和tag中已记账的字节数
+    FLVTag* m_head = nullptr; // 最近使用
+    FLVTag* m_tail = nullptr; // 最久未用
+};
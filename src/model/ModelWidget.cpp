@@ -4,13 +4,91 @@
 
 #include "ModelWidget.h"
 #include "Log.h"
+#include "MemoryBudget.h"
+#include "TagHash.h"
+#include "TagRecovery.h"
+#include "TagSorter.h"
+#include "Trace.h"
 #include "Utils.h"
 #include <QApplication>
 #include <QBuffer>
+#include <QElapsedTimer>
 #include <QMessageBox>
 #include <QSize>
+#include <numeric>
 #include <vector>
 
+namespace {
+
+// 字段块：N个PropertyItem加一次分配的shared_ptr控制块和分配开销
+template <size_t N>
+constexpr uint64_t fieldBlockSize() {
+    return sizeof(FieldBlock<N>) + 32;
+}
+
+uint64_t metadataItemSize(const MetadataItem& item) {
+    uint64_t size = sizeof(MetadataItem);
+    for (const MetadataItem& child : item.obj_value) {
+        size += metadataItemSize(child);
+    }
+    return size;
+}
+
+// FLVTag及其解析出的字段的估算大小
+uint64_t tagMetadataSize(const FLVTag& tag) {
+    constexpr uint64_t TRACK_COST = sizeof(AVTrackInfo) + fieldBlockSize<TRACK_FIELD_COUNT>();
+    uint64_t size = sizeof(unique_ptr<FLVTag>) + sizeof(FLVTag) + fieldBlockSize<TAG_FIELD_COUNT>();
+    if (tag.v_info)
+        size += sizeof(VideoTagInfo) + fieldBlockSize<VIDEO_FIELD_COUNT>() +
+                tag.v_info->m_tracks.capacity() * TRACK_COST;
+    if (tag.a_info)
+        size += sizeof(AudioTagInfo) + fieldBlockSize<AUDIO_FIELD_COUNT>() +
+                tag.a_info->m_tracks.capacity() * TRACK_COST;
+    if (tag.metadata_info)
+        size += sizeof(DataTagInfo) + metadataItemSize(tag.metadata_info->m_metadata_values);
+    return size;
+}
+
+} // namespace
+
+ModelTagList::~ModelTagList() {
+    MemoryBudget::instance().add(MEMORY_TAG_INDEX, -static_cast<int64_t>(m_index_memory));
+    MemoryBudget::instance().add(MEMORY_METADATA, -static_cast<int64_t>(m_metadata_memory));
+}
+
+void ModelTagList::updateMemoryUsage() {
+    uint64_t index_memory = m_tag_index.memoryUsage();
+    uint64_t metadata_memory = m_tagList.capacity() * sizeof(unique_ptr<FLVTag>);
+    for (const auto& tag : m_tagList) {
+        metadata_memory += tagMetadataSize(*tag);
+    }
+
+    MemoryBudget& budget = MemoryBudget::instance();
+    budget.add(MEMORY_TAG_INDEX, static_cast<int64_t>(index_memory) - static_cast<int64_t>(m_index_memory));
+    budget.add(MEMORY_METADATA, static_cast<int64_t>(metadata_memory) - static_cast<int64_t>(m_metadata_memory));
+    m_index_memory = index_memory;
+    m_metadata_memory = metadata_memory;
+}
+
+bool ModelTagList::ensureBinary(FLVTag& tag) {
+    if (tag.m_bin_data || tag.m_bin_size == 0) {
+        return true;
+    }
+
+    QFile file(m_file_path);
+    shared_ptr<uchar[]> data(new uchar[tag.m_bin_size]);
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(tag.m_offset) ||
+        file.read(reinterpret_cast<char*>(data.get()), tag.m_bin_size) != tag.m_bin_size) {
+        qCWarning(runLog) << QString("[flv-memory] event[reload-failed] offset[0x%1] error[%2]")
+                                 .arg(tag.m_offset, 0, 16)
+                                 .arg(file.errorString());
+        return false;
+    }
+    tag.m_bin_data = std::move(data);
+    MemoryBudget::instance().touch(&tag);
+    return true;
+}
+
 int ModelTagList::rowCount(const QModelIndex& parent) const {
     return m_tagList.size() + (m_flv_header ? 1 : 0);
 }
@@ -18,6 +96,45 @@ int ModelTagList::columnCount(const QModelIndex& parent) const {
     return ModelTagList::column_size;
 }
 
+// 多轨包的轨道列表，取自tag索引的轨道列，与排序和查询一致；单轨包返回空
+static QString tagTrackText(const TagIndex& index, size_t i) {
+    QStringList ids;
+    for (size_t k = index.trackBegin(i); k < index.trackEnd(i); ++k) {
+        ids.append(QString::number(index.m_track_id[k]));
+    }
+    return ids.join(",");
+}
+
+// 详细信息列：编码、帧类型、包类型
+static QString tagDetailText(const FLVTag& tag) {
+    if (tag.v_info) {
+        auto& info = *tag.v_info;
+        QString codec = info.fourCC() ? fourCCToString(info.fourCC())
+                                      : QString(getCodec(static_cast<uint8_t>(get<double>(info.m_codec->value))));
+        QString packet = info.m_is_ex_header ? getVideoPacketType(info.packetType())
+                                             : (info.fourCC() ? getDetailType(info.packetType()) : "");
+        QString text = QString("%1, %2").arg(codec).arg(getTagType(info.frameType()));
+        if (!packet.isEmpty())
+            text += ", " + packet;
+        if (info.cts() != 0)
+            text += QString(", cts=%1").arg(info.cts());
+        return text;
+    }
+    if (tag.a_info) {
+        auto& info = *tag.a_info;
+        QString codec = info.fourCC() ? fourCCToString(info.fourCC()) : QString(getSoundFormat(info.soundFormat()));
+        if (info.m_is_ex_header)
+            return QString("%1, %2").arg(codec).arg(getAudioPacketType(info.packetType()));
+        if (info.soundFormat() == AAC)
+            return QString("%1, %2").arg(codec).arg(info.isSequenceHeader() ? "sequence header" : "raw");
+        return codec;
+    }
+    if (tag.metadata_info) {
+        return tag.metadata_info->m_metadata_values.key;
+    }
+    return QString();
+}
+
 QVariant ModelTagList::data(const QModelIndex& index, int role) const {
     if (!index.isValid() || index.column() >= ModelTagList::column_size) {
         return {};
@@ -57,6 +174,23 @@ QVariant ModelTagList::data(const QModelIndex& index, int role) const {
             {TAG_TYPE_AUDIO, "Audio"}, {TAG_TYPE_VIDEO, "Video"}, {TAG_TYPE_SCRIPT, "Script"}};
         // 枚举映射结束
 
+        if (m_tagList[row]->m_is_garbage) {
+            switch (column) {
+            case 0:
+                return QString("0x%1").arg(QString::number(m_tagList[row]->m_offset, 16).rightJustified(8, '0'));
+            case 1:
+                return QString("Garbage");
+            case 2:
+                return QString("%1").arg(m_tagList[row]->m_size);
+            case 5:
+                return QString("skipped during recovery");
+            case 6:
+                return hashText(row);
+            default:
+                return {};
+            }
+        }
+
         switch (column) {
         case 0:
             return QString("0x%1").arg(QString::number(m_tagList[row]->m_offset, 16).rightJustified(8, '0'));
@@ -68,6 +202,14 @@ QVariant ModelTagList::data(const QModelIndex& index, int role) const {
             return QString("%1").arg(m_tagList[row]->m_size);
         case 3:
             return QString("%1").arg(get<double>(m_tagList[row]->m_timestamp->value), 0, 'g', 10);
+        case 4:
+            return tagTrackText(m_tag_index, row);
+        case 5:
+            if (m_tagList[row]->m_header_error)
+                return tagDetailText(*m_tagList[row]) + ", ex-header error";
+            return tagDetailText(*m_tagList[row]);
+        case 6:
+            return hashText(row);
         default:
             return {};
         }
@@ -92,6 +234,9 @@ QVariant ModelTagList::data(const QModelIndex& index, int role) const {
             return makeTagColor(240);
         }
 
+        if (m_tagList[row]->m_is_garbage)
+            return makeTagColor(0);
+
         int tag = static_cast<int>(get<double>(m_tagList[row]->m_tag_type->value));
         if (tag == TAG_TYPE_SCRIPT)
             return makeTagColor(180);
@@ -107,34 +252,123 @@ QVariant ModelTagList::data(const QModelIndex& index, int role) const {
 QVariant ModelTagList::headerData(int section, Qt::Orientation orientation, int role) const {
     if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
         // 根据列索引返回相应的表头数据
-        array<const char*, ModelTagList::column_size> header = {"偏移地址", "tag类型", "长度", "时间戳", "详细信息"};
+        array<const char*, ModelTagList::column_size> header = {
+            "偏移地址", "tag类型", "长度", "时间戳", "轨道", "详细信息", "哈希"};
         if (section < ModelTagList::column_size)
             return QString(header[section]);
     }
     return QAbstractTableModel::headerData(section, orientation, role);
 }
 
-int ModelTagList::readFromFile(QFile& file) {
+QString ModelTagList::hashText(int row) const {
+    if (!m_tag_index.hasPayloadHash())
+        return QString();
+    QString text = QString("%1").arg(m_tag_index.m_payload_hash[row], 16, 16, QChar('0'));
+    if (m_tag_index.m_flags[row] & TAG_FLAG_DUPLICATE)
+        text += " (dup)";
+    return text;
+}
+
+vector<ValidationIssue> ModelTagList::computePayloadHashes(const QString& path) {
+    QElapsedTimer timer;
+    timer.start();
+    vector<uint64_t> track_hashes;
+    m_tag_index.m_payload_hash = TagHash::hashFile(path, m_tag_index, &track_hashes);
+    m_tag_index.m_track_hash = std::move(track_hashes);
+    updateMemoryUsage();
+    vector<ValidationIssue> duplicates = TagHash::findDuplicates(m_tag_index);
+
+    qCInfo(runLog) << QString("[flv-hash] event[finished] tags[%1] duplicates[%2] elapsed[%3ms]")
+                          .arg(m_tag_index.size())
+                          .arg(duplicates.size())
+                          .arg(timer.elapsed());
+    if (rowCount() > 0)
+        emit dataChanged(index(0, 6), index(rowCount() - 1, 6));
+    return duplicates;
+}
+
+int ModelTagList::readFromFile(QFile& file, bool recover, bool keep_binary) {
+    m_file_path = file.fileName();
     QDataStream stream(&file);
     vector<unique_ptr<FLVTag>> tag_vec;
 
-    auto flv_header = make_unique<FLVHeader>();
-    if (!flv_header->readfromStream(stream)) {
-        return 0;
+    {
+        TRACE_SCOPE("header_read");
+        auto flv_header = make_unique<FLVHeader>();
+        if (!flv_header->readfromStream(stream)) {
+            return 0;
+        }
+        m_flv_header = std::move(flv_header);
+        TRACE_COUNT(TRACE_BYTES_READ, FLV_HEADER_SIZE);
+    }
+
+    // 恢复模式需要映射整个文件用于重同步扫描
+    int64_t file_size = file.size();
+    uchar* mapped = nullptr;
+    if (recover) {
+        mapped = file.map(0, file_size);
+        if (!mapped) {
+            qCInfo(runLog) << "[flv-parsing] event[recovery disabled] reason[map failed]";
+            recover = false;
+        }
     }
-    m_flv_header = std::move(flv_header);
 
     // 读取tag
+    TRACE_SCOPE("tag_walk");
+    MemoryBudget& budget = MemoryBudget::instance();
+    uint64_t parsed_end = FLV_HEADER_SIZE;
     while (!stream.atEnd()) {
+        int64_t tag_start = stream.device()->pos();
         unique_ptr<FLVTag> tag_info = make_unique<FLVTag>();
-        if (!tag_info->readfromStream(stream)) {
-            break;
+        bool tag_ok = tag_info->readfromStream(stream, keep_binary && !budget.overLimit());
+
+        // 恢复模式下，PreviousTagSize不一致且后面也不是合法tag头时，同样视为损坏
+        if (tag_ok && recover) {
+            int64_t tag_end = tag_info->m_offset + tag_info->m_size;
+            uint32_t expected = 11 + static_cast<uint32_t>(get<double>(tag_info->m_tag_size->value));
+            if (static_cast<uint32_t>(get<double>(tag_info->m_previous_tag_size->value)) != expected &&
+                tag_end + 11 <= file_size && !TagRecovery::isPlausibleHeader(mapped, file_size, tag_end)) {
+                tag_ok = false;
+            }
+        }
+
+        if (!tag_ok) {
+            if (!recover) {
+                break;
+            }
+
+            // 向后查找下一个自洽的tag，中间的数据记为垃圾行，超过MAX_GARBAGE_SPAN时拆成多行
+            int64_t next = TagRecovery::findNextTag(mapped, file_size, tag_start + 1);
+            stream.resetStatus();
+            for (int64_t start = tag_start; start < next; start += FLVTag::MAX_GARBAGE_SPAN) {
+                auto garbage = make_unique<FLVTag>();
+                garbage->readGarbage(stream, start, min<int64_t>(next - start, FLVTag::MAX_GARBAGE_SPAN), keep_binary);
+                if (garbage->m_bin_data) {
+                    TRACE_COUNT(TRACE_BYTES_READ, garbage->m_bin_size);
+                    budget.touch(garbage.get(), false);
+                }
+                tag_vec.emplace_back(std::move(garbage));
+            }
+            parsed_end = next;
+            continue;
         }
 
+        parsed_end = tag_info->m_offset + tag_info->m_size;
+        TRACE_COUNT(TRACE_BYTES_READ, tag_info->m_size);
+        TRACE_COUNT(TRACE_TAGS_PARSED, 1);
+        if (tag_info->m_bin_data)
+            budget.touch(tag_info.get(), false);
         tag_vec.emplace_back(std::move(tag_info));
     }
 
+    if (mapped) {
+        file.unmap(mapped);
+    }
+
     m_tagList.swap(tag_vec);
+    TRACE_SCOPE("tag_index_build");
+    m_tag_index.build(m_tagList, file_size, parsed_end);
+    updateMemoryUsage();
     return 0;
 }
 
@@ -187,8 +421,22 @@ QModelIndex ModelTagInfoTree::index(int row, int column, const QModelIndex& pare
  @class ModelTagBinary
 */
 
+ModelTagBinary::ModelTagBinary(BinaryData& data, QObject* parent) : QAbstractTableModel(parent) {
+    m_data.m_bin_data = data.m_bin_data;
+    m_data.m_offset = data.m_offset;
+    m_data.m_size = data.m_size;
+    m_data.m_bin_size = data.m_bin_data ? data.m_bin_size : 0;
+    m_accounted = m_data.m_bin_size;
+    MemoryBudget::instance().add(MEMORY_HEX_MODEL, m_accounted);
+}
+
+ModelTagBinary::~ModelTagBinary() {
+    MemoryBudget::instance().add(MEMORY_HEX_MODEL, -static_cast<int64_t>(m_accounted));
+}
+
 int ModelTagBinary::rowCount(const QModelIndex& parent) const {
-    return m_data.m_size / 16 + 1;
+    // 二进制数据未能加载时不显示
+    return m_data.m_bin_data ? m_data.m_bin_size / 16 + 1 : 0;
 }
 
 int ModelTagBinary::columnCount(const QModelIndex& parent) const {
@@ -196,7 +444,7 @@ int ModelTagBinary::columnCount(const QModelIndex& parent) const {
 }
 
 QVariant ModelTagBinary::data(const QModelIndex& index, int role) const {
-    if (!index.isValid() || index.row() >= (m_data.m_size / 16 + 1) || index.column() >= 16) {
+    if (!index.isValid() || index.row() >= rowCount() || index.column() >= 16) {
         return {};
     }
 
@@ -206,7 +454,7 @@ QVariant ModelTagBinary::data(const QModelIndex& index, int role) const {
     int row = index.row();
     int column = index.column();
 
-    if (row * 16 + column < m_data.m_size)
+    if (row * 16 + column < m_data.m_bin_size)
         return QString("%1").arg(
             QString::number((uint) m_data.m_bin_data[row * 16 + column], 16).rightJustified(2, '0').toUpper());
     return {};
@@ -220,7 +468,7 @@ bool ModelTagBinary::setData(const QModelIndex& index, const QVariant& value, in
     int column = index.column();
     int offset = row * 16 + column;
 
-    if (offset >= m_data.m_size)
+    if (offset >= m_data.m_bin_size)
         return false;
 
     // 解析输入的十六进制字符串
@@ -269,7 +517,7 @@ Qt::ItemFlags ModelTagBinary::flags(const QModelIndex& index) const {
     Qt::ItemFlags flags = QAbstractTableModel::flags(index);
 
     // 只有有效数据范围内的单元格可编辑
-    if (offset < m_data.m_size) {
+    if (offset < m_data.m_bin_size) {
         flags |= Qt::ItemIsEditable;
     }
 
@@ -288,9 +536,526 @@ QVariant ModelTagBinary::headerData(int section, Qt::Orientation orientation, in
 
     if (orientation == Qt::Vertical) {
         // 根据列索引返回相应的表头数据
-        if (section < (m_data.m_size / 16 + 1))
+        if (section < (m_data.m_bin_size / 16 + 1))
             return QString("%1").arg(QString::number(m_data.m_offset + section * 16, 16).rightJustified(8, '0'));
     }
 
     return {};
 }
+
+/**
+ @class ModelTagRows
+*/
+
+void ModelTagRows::setSourceModel(QAbstractItemModel* source) {
+    beginResetModel();
+    if (sourceModel()) {
+        disconnect(sourceModel(), nullptr, this, nullptr);
+    }
+    QAbstractProxyModel::setSourceModel(source);
+    m_filtered = false;
+    m_filter_rows.clear();
+    m_reverse.clear();
+    rebuildRows(); // 保留之前的排序key，新文件按同样的列排序
+
+    // 源模型重置、插入行后之前的行号失效，回到显示全部；删除行时保留过滤结果并重新编号
+    if (source) {
+        connect(source, &QAbstractItemModel::modelReset, this, &ModelTagRows::showAll);
+        connect(source, &QAbstractItemModel::rowsRemoved, this, &ModelTagRows::removeSourceRows);
+        connect(source, &QAbstractItemModel::rowsInserted, this, &ModelTagRows::showAll);
+        connect(source, &QAbstractItemModel::dataChanged, this, [this](const QModelIndex& tl, const QModelIndex& br) {
+            QModelIndex top = mapFromSource(tl);
+            QModelIndex bottom = mapFromSource(br);
+            if (top.isValid() && bottom.isValid())
+                emit dataChanged(top, bottom);
+        });
+    }
+    endResetModel();
+}
+
+void ModelTagRows::setTagRows(vector<int> tag_rows) {
+    beginResetModel();
+    m_filtered = true;
+    m_filter_rows = std::move(tag_rows);
+    rebuildRows();
+    endResetModel();
+}
+
+void ModelTagRows::removeSourceRows(const QModelIndex& parent, int first, int last) {
+    beginResetModel();
+    // 源行号含第0行的FLV Header，过滤结果为tag下标
+    int first_tag = first - 1;
+    int count = last - first + 1;
+    vector<int> rows;
+    rows.reserve(m_filter_rows.size());
+    for (int row : m_filter_rows) {
+        if (row < first_tag)
+            rows.push_back(row);
+        else if (row > last - 1)
+            rows.push_back(row - count);
+    }
+    m_filter_rows.swap(rows);
+    rebuildRows();
+    endResetModel();
+}
+
+void ModelTagRows::showAll() {
+    beginResetModel();
+    m_filtered = false;
+    m_filter_rows.clear();
+    rebuildRows();
+    endResetModel();
+}
+
+void ModelTagRows::sort(int column, Qt::SortOrder order) {
+    TagSorter::KEY key = TagSorter::keyForColumn(column);
+    if (key == TagSorter::KEY_NONE && column >= 0)
+        return;
+    sortByKey(key, order);
+}
+
+void ModelTagRows::sortByKey(int key, Qt::SortOrder order) {
+    if (key == m_sort_key && (key < 0 || order == m_sort_order))
+        return;
+
+    // 只改变行顺序，用layoutChanged保持选中项和当前项
+    emit layoutAboutToBeChanged();
+    QModelIndexList persistent = persistentIndexList();
+    QModelIndexList source_persistent;
+    source_persistent.reserve(persistent.size());
+    for (const QModelIndex& index : persistent) {
+        source_persistent.append(mapToSource(index));
+    }
+
+    m_sort_key = key;
+    m_sort_order = order;
+    rebuildRows();
+
+    QModelIndexList updated;
+    updated.reserve(persistent.size());
+    for (const QModelIndex& index : source_persistent) {
+        updated.append(mapFromSource(index));
+    }
+    changePersistentIndexList(persistent, updated);
+    emit layoutChanged();
+}
+
+void ModelTagRows::rebuildRows() {
+    m_rows.clear();
+    m_reverse.clear();
+    if (!isMapped() || !sourceModel() || sourceModel()->rowCount() == 0)
+        return;
+
+    auto tag_list = qobject_cast<ModelTagList*>(sourceModel());
+    if (!tag_list)
+        return;
+    const TagIndex& tag_index = tag_list->getTagIndex();
+
+    vector<int> tags;
+    if (m_filtered) {
+        tags = m_filter_rows;
+    } else {
+        tags.resize(tag_index.size());
+        iota(tags.begin(), tags.end(), 0);
+    }
+
+    if (m_sort_key >= 0) {
+        QElapsedTimer timer;
+        timer.start();
+        tags = TagSorter::sort(
+            tag_index, tags, static_cast<TagSorter::KEY>(m_sort_key), m_sort_order == Qt::DescendingOrder);
+        qCInfo(runLog) << QString("[flv-sort] event[finished] key[%1] order[%2] rows[%3] elapsed[%4ms]")
+                              .arg(m_sort_key)
+                              .arg(m_sort_order == Qt::DescendingOrder ? "desc" : "asc")
+                              .arg(tags.size())
+                              .arg(timer.elapsed());
+    }
+
+    m_rows.reserve(tags.size() + 1);
+    m_rows.push_back(0); // FLV Header
+    for (int tag : tags) {
+        m_rows.push_back(tag + 1);
+    }
+}
+
+int ModelTagRows::rowCount(const QModelIndex& parent) const {
+    if (parent.isValid() || !sourceModel())
+        return 0;
+    return isMapped() ? static_cast<int>(m_rows.size()) : sourceModel()->rowCount();
+}
+
+int ModelTagRows::columnCount(const QModelIndex& parent) const {
+    if (parent.isValid() || !sourceModel())
+        return 0;
+    return sourceModel()->columnCount();
+}
+
+QModelIndex ModelTagRows::index(int row, int column, const QModelIndex& parent) const {
+    if (parent.isValid() || row < 0 || column < 0 || row >= rowCount() || column >= columnCount())
+        return QModelIndex();
+    return createIndex(row, column);
+}
+
+QModelIndex ModelTagRows::parent(const QModelIndex& child) const {
+    return QModelIndex();
+}
+
+QModelIndex ModelTagRows::mapToSource(const QModelIndex& proxy_index) const {
+    if (!proxy_index.isValid() || !sourceModel())
+        return QModelIndex();
+    int row = isMapped() ? m_rows[proxy_index.row()] : proxy_index.row();
+    return sourceModel()->index(row, proxy_index.column());
+}
+
+QModelIndex ModelTagRows::mapFromSource(const QModelIndex& source_index) const {
+    if (!source_index.isValid() || !sourceModel())
+        return QModelIndex();
+    if (!isMapped())
+        return index(source_index.row(), source_index.column());
+
+    if (m_reverse.empty()) {
+        m_reverse.assign(sourceModel()->rowCount(), -1);
+        for (size_t i = 0; i < m_rows.size(); ++i) {
+            m_reverse[m_rows[i]] = static_cast<int>(i);
+        }
+    }
+    int row = source_index.row() < static_cast<int>(m_reverse.size()) ? m_reverse[source_index.row()] : -1;
+    return row < 0 ? QModelIndex() : index(row, source_index.column());
+}
+
+/**
+ @class ModelValidationIssues
+*/
+
+int ModelValidationIssues::rowCount(const QModelIndex& parent) const {
+    return static_cast<int>(m_issues.size());
+}
+
+int ModelValidationIssues::columnCount(const QModelIndex& parent) const {
+    return ModelValidationIssues::column_size;
+}
+
+QVariant ModelValidationIssues::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= static_cast<int>(m_issues.size())) {
+        return {};
+    }
+
+    const ValidationIssue& issue = m_issues[index.row()];
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case 0:
+            return QString("0x%1").arg(QString::number(issue.m_offset, 16).rightJustified(8, '0'));
+        case 1:
+            return issue.m_tag_index < 0 ? QString("-") : QString::number(issue.m_tag_index);
+        case 2:
+            return QString(issue.m_severity == SEVERITY_ERROR ? "error" : "warning");
+        case 3:
+            return QString(getIssueType(issue.m_type));
+        case 4:
+            return issue.m_message;
+        default:
+            return {};
+        }
+    }
+
+    if (role == Qt::ForegroundRole && index.column() == 2 && issue.m_severity == SEVERITY_ERROR) {
+        return QColor(200, 40, 40);
+    }
+    return {};
+}
+
+QVariant ModelValidationIssues::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        array<const char*, ModelValidationIssues::column_size> header = {"偏移地址", "tag序号", "级别", "类型", "说明"};
+        if (section < ModelValidationIssues::column_size)
+            return QString(header[section]);
+    }
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+void ModelValidationIssues::sort(int column, Qt::SortOrder order) {
+    auto key_less = [column](const ValidationIssue& a, const ValidationIssue& b) {
+        switch (column) {
+        case 1:
+            return a.m_tag_index < b.m_tag_index;
+        case 2:
+            return a.m_severity < b.m_severity;
+        case 3:
+            return a.m_type < b.m_type;
+        case 4:
+            return a.m_message < b.m_message;
+        default:
+            return a.m_offset < b.m_offset;
+        }
+    };
+
+    emit layoutAboutToBeChanged();
+    if (order == Qt::AscendingOrder)
+        stable_sort(m_issues.begin(), m_issues.end(), key_less);
+    else
+        stable_sort(m_issues.begin(), m_issues.end(), [&](const ValidationIssue& a, const ValidationIssue& b) {
+            return key_less(b, a);
+        });
+    emit layoutChanged();
+}
+
+/**
+ @class ModelSearchResults
+*/
+
+int ModelSearchResults::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(m_hits.size());
+}
+
+int ModelSearchResults::columnCount(const QModelIndex& parent) const {
+    return ModelSearchResults::column_size;
+}
+
+ModelSearchResults::ModelSearchResults(ModelTagList* tag_model, vector<SearchPattern> patterns, QObject* parent)
+    : QAbstractTableModel(parent), m_tag_model(tag_model), m_patterns(std::move(patterns)) {
+    if (m_tag_model) {
+        connect(m_tag_model, &QAbstractItemModel::rowsRemoved, this, &ModelSearchResults::removeTagRows);
+        connect(m_tag_model, &QAbstractItemModel::modelReset, this, [this]() {
+            beginResetModel();
+            m_hits.clear();
+            m_fields.clear();
+            endResetModel();
+        });
+    }
+}
+
+void ModelSearchResults::appendHits(vector<SearchHit> hits) {
+    if (hits.empty())
+        return;
+
+    // 字段路径在这里算好，data()中不构建字段树；同一tag的多个命中共用一棵临时树，不进入字段树缓存
+    vector<QString> fields;
+    fields.reserve(hits.size());
+    int64_t tree_tag = -1;
+    shared_ptr<TreeItem> tree;
+    for (const SearchHit& hit : hits) {
+        if (m_tag_model && hit.m_tag_index >= 0 &&
+            hit.m_tag_index < static_cast<int64_t>(m_tag_model->getTagList().size()) && hit.m_tag_index != tree_tag) {
+            tree = m_tag_model->getTagList()[hit.m_tag_index]->buildTreeInfo();
+            tree_tag = hit.m_tag_index;
+        }
+        fields.push_back(fieldText(hit, hit.m_tag_index == tree_tag ? tree.get() : nullptr));
+    }
+
+    int first = static_cast<int>(m_hits.size());
+    beginInsertRows(QModelIndex(), first, first + static_cast<int>(hits.size()) - 1);
+    m_hits.insert(m_hits.end(), hits.begin(), hits.end());
+    m_fields.insert(m_fields.end(), fields.begin(), fields.end());
+    endInsertRows();
+}
+
+QString ModelSearchResults::fieldText(const SearchHit& hit, TreeItem* tree) const {
+    if (!m_tag_model)
+        return QString();
+    if (hit.m_tag_index == HIT_IN_HEADER && m_tag_model->getFlvHeader())
+        return "flv_header/" + FileSearch::fieldPath(m_tag_model->getFlvHeader()->getTreeInfo().get(), 0, hit.m_offset);
+    if (!tree)
+        return QString();
+    return FileSearch::fieldPath(tree, m_tag_model->getTagList()[hit.m_tag_index]->m_offset, hit.m_offset);
+}
+
+void ModelSearchResults::removeTagRows(const QModelIndex& parent, int first, int last) {
+    // tag模型的第0行为FLV Header，tag序号为行号减1
+    int64_t first_tag = first - 1;
+    int64_t last_tag = last - 1;
+    int64_t count = last - first + 1;
+
+    beginResetModel();
+    size_t kept = 0;
+    for (size_t i = 0; i < m_hits.size(); ++i) {
+        SearchHit hit = m_hits[i];
+        if (hit.m_tag_index >= first_tag && hit.m_tag_index <= last_tag)
+            continue;
+        if (hit.m_tag_index > last_tag)
+            hit.m_tag_index -= count;
+        m_hits[kept] = hit;
+        if (kept != i)
+            m_fields[kept] = std::move(m_fields[i]);
+        ++kept;
+    }
+    m_hits.resize(kept);
+    m_fields.resize(kept);
+    endResetModel();
+}
+
+QVariant ModelSearchResults::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= static_cast<int>(m_hits.size()) || role != Qt::DisplayRole) {
+        return {};
+    }
+
+    const SearchHit& hit = m_hits[index.row()];
+    switch (index.column()) {
+    case 0:
+        return QString("0x%1").arg(QString::number(hit.m_offset, 16).rightJustified(8, '0'));
+    case 1:
+        if (hit.m_tag_index == HIT_IN_HEADER)
+            return QString("header");
+        return hit.m_tag_index < 0 ? QString("-") : QString::number(hit.m_tag_index);
+    case 2:
+        return m_fields[index.row()];
+    case 3:
+        return hit.m_pattern < m_patterns.size() ? m_patterns[hit.m_pattern].m_label : QString();
+    case 4: {
+        QByteArray bytes(reinterpret_cast<const char*>(hit.m_context.data()), hit.m_context_size);
+        return QString::fromLatin1(bytes.toHex(' '));
+    }
+    default:
+        return {};
+    }
+}
+
+QVariant ModelSearchResults::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        array<const char*, ModelSearchResults::column_size> header = {"偏移地址", "tag序号", "字段", "匹配", "数据"};
+        if (section < ModelSearchResults::column_size)
+            return QString(header[section]);
+    }
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+/**
+ @class ModelDiffRows
+*/
+
+ModelDiffRows::ModelDiffRows(const DiffResult* result, QObject* parent) : QAbstractTableModel(parent), m_result(result) {
+}
+
+int ModelDiffRows::rowCount(const QModelIndex& parent) const {
+    if (parent.isValid())
+        return 0;
+    return static_cast<int>(m_diff_only ? m_visible.size() : m_result->m_rows.size());
+}
+
+int ModelDiffRows::columnCount(const QModelIndex& parent) const {
+    return ModelDiffRows::column_size;
+}
+
+void ModelDiffRows::setDiffOnly(bool diff_only) {
+    beginResetModel();
+    m_diff_only = diff_only;
+    m_visible.clear();
+    if (diff_only) {
+        for (size_t i = 0; i < m_result->m_rows.size(); ++i) {
+            if (m_result->m_rows[i].m_kind != DIFF_SAME)
+                m_visible.push_back(i);
+        }
+    }
+    endResetModel();
+}
+
+QVariant ModelDiffRows::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= rowCount()) {
+        return {};
+    }
+
+    const DiffRow& row = getRow(index.row());
+    if (role == Qt::DisplayRole) {
+        // 第0~3列为A，第4列为差异类型，第5~8列为B
+        if (index.column() == 4)
+            return QString(getDiffKind(row.m_kind));
+
+        bool side_a = index.column() < 4;
+        int64_t tag = side_a ? row.m_a : row.m_b;
+        if (tag < 0)
+            return {};
+        const TagIndex& tag_index = side_a ? m_result->m_index_a : m_result->m_index_b;
+        switch (side_a ? index.column() : index.column() - 5) {
+        case 0:
+            return QString("0x%1").arg(QString::number(tag_index.m_offset[tag], 16).rightJustified(8, '0'));
+        case 1:
+            return QString::number(tag_index.m_timestamp[tag]);
+        case 2:
+            if (tag_index.m_flags[tag] & TAG_FLAG_GARBAGE)
+                return QString("Garbage");
+            return QString(tag_index.m_type[tag] == TAG_TYPE_VIDEO   ? "Video"
+                           : tag_index.m_type[tag] == TAG_TYPE_AUDIO ? "Audio"
+                                                                     : "Script");
+        case 3:
+            return QString::number(tag_index.m_data_size[tag]);
+        default:
+            return {};
+        }
+    }
+
+    if (role == Qt::BackgroundRole) {
+        QColor windowColor = qApp->palette().color(QPalette::Window);
+        bool darkTheme = windowColor.lightnessF() < 0.5;
+        auto makeColor = [&](int hue) -> QColor {
+            return darkTheme ? QColor::fromHsv(hue, 80, 95) : QColor::fromHsv(hue, 30, 245);
+        };
+
+        switch (row.m_kind) {
+        case DIFF_DROPPED:
+            return makeColor(0);
+        case DIFF_INSERTED:
+            return makeColor(120);
+        case DIFF_ALTERED:
+            return makeColor(45);
+        case DIFF_REORDERED:
+            return makeColor(210);
+        case DIFF_TIMESTAMP:
+            return makeColor(280);
+        default:
+            return {};
+        }
+    }
+    return {};
+}
+
+QVariant ModelDiffRows::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        array<const char*, ModelDiffRows::column_size> header = {
+            "A偏移", "A时间戳", "A类型", "A长度", "差异", "B偏移", "B时间戳", "B类型", "B长度"};
+        if (section < ModelDiffRows::column_size)
+            return QString(header[section]);
+    }
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+/**
+ @class ModelLogLines
+*/
+
+int ModelLogLines::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(m_rows.size());
+}
+
+QVariant ModelLogLines::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= static_cast<int>(m_rows.size())) {
+        return {};
+    }
+
+    uint32_t line = m_rows[index.row()];
+    if (role == Qt::DisplayRole) {
+        return m_index->line(line);
+    }
+    if (role == Qt::ForegroundRole) {
+        LOG_LEVEL level = m_index->level(line);
+        if (level >= LOG_LEVEL_WARNING)
+            return QColor(200, 40, 40);
+        if (level == LOG_LEVEL_DEBUG)
+            return QColor(120, 120, 120);
+    }
+    return {};
+}
+
+void ModelLogLines::setRows(vector<uint32_t> rows) {
+    beginResetModel();
+    m_rows = std::move(rows);
+    endResetModel();
+}
+
+void ModelLogLines::appendRows(const vector<uint32_t>& rows) {
+    if (rows.empty())
+        return;
+
+    int first = static_cast<int>(m_rows.size());
+    beginInsertRows(QModelIndex(), first, first + static_cast<int>(rows.size()) - 1);
+    m_rows.insert(m_rows.end(), rows.begin(), rows.end());
+    endInsertRows();
+}
@@ -4,8 +4,14 @@
 
 #pragma once
 
+#include "FileSearch.h"
+#include "FlvDiff.h"
+#include "LogIndex.h"
+#include "StreamValidator.h"
+#include "TagIndex.h"
 #include "taginfo.h"
 #include <QAbstractItemModel>
+#include <QAbstractProxyModel>
 #include <QFile>
 using namespace std;
 
@@ -19,6 +25,7 @@ class ModelTagList : public QAbstractTableModel {
     // view相关
     explicit ModelTagList(QObject* parent = nullptr) : QAbstractTableModel(parent) {
     }
+    ~ModelTagList() override;
     int rowCount(const QModelIndex& parent = QModelIndex()) const override;
     int columnCount(const QModelIndex& parent = QModelIndex()) const override;
     QVariant data(const QModelIndex& index, int role) const override;
@@ -31,21 +38,96 @@ class ModelTagList : public QAbstractTableModel {
     vector<unique_ptr<FLVTag>>& getTagList() {
         return m_tagList;
     }
+    const TagIndex& getTagIndex() const {
+        return m_tag_index;
+    }
 
-    int readFromFile(QFile& path);
-    static const int column_size = 5;
+    // recover为true时，遇到损坏的tag会向后重同步并插入垃圾数据行，而不是停止解析
+    // 超出内存预算后不再保留tag的二进制数据；keep_binary为false时只解析tag头和音视频头，负载直接跳过，
+    // 用于批量扫描等不显示十六进制视图的场合，需要时由ensureBinary读取
+    int readFromFile(QFile& path, bool recover = false, bool keep_binary = true);
+
+    // 二进制数据未加载或已被内存预算释放时从文件重新读取
+    bool ensureBinary(FLVTag& tag);
+    static const int column_size = 7;
+
+    // 映射文件计算每个tag的负载哈希并标记重复tag，返回重复项，失败时抛出QString
+    vector<ValidationIssue> computePayloadHashes(const QString& path);
 
     // 添加删除方法
     bool removeRow(int row, const QModelIndex& parent = QModelIndex()) {
         beginRemoveRows(parent, row, row);
         m_tagList.erase(m_tagList.begin() + row);
+        m_tag_index.build(m_tagList, m_tag_index.m_file_size, m_tag_index.m_parsed_end);
+        updateMemoryUsage();
         endRemoveRows();
         return true;
     }
 
   private:
+    // 哈希列，未计算时为空
+    QString hashText(int row) const;
+    // 重新统计tag索引和tag字段的内存并更新记账
+    void updateMemoryUsage();
+
     unique_ptr<FLVHeader> m_flv_header;
     vector<unique_ptr<FLVTag>> m_tagList;
+    TagIndex m_tag_index;
+
+    QString m_file_path;
+    uint64_t m_index_memory = 0;    // 已记账的tag索引字节数
+    uint64_t m_metadata_memory = 0; // 已记账的tag字段字节数
+};
+
+/**
+ * @class ModelTagRows
+ * @brief tag列表的行代理，只保存要显示的源行号（过滤、排序结果），FLV Header行始终在最前
+ */
+class ModelTagRows : public QAbstractProxyModel {
+    Q_OBJECT
+  public:
+    explicit ModelTagRows(QObject* parent = nullptr) : QAbstractProxyModel(parent) {
+    }
+
+    void setSourceModel(QAbstractItemModel* source) override;
+
+    // tag_rows为tag下标（不含Header行），升序；设置了排序时按排序key重排后显示
+    void setTagRows(vector<int> tag_rows);
+    void showAll();
+    // 源模型删除了[first, last]行，过滤结果中去掉这些行并重新编号
+    void removeSourceRows(const QModelIndex& parent, int first, int last);
+    bool isFiltered() const {
+        return m_filtered;
+    }
+
+    // 表头点击排序，不支持排序的列保持当前顺序，column为-1时恢复文件顺序
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+    // key为TagSorter::KEY，KEY_NONE恢复文件顺序
+    void sortByKey(int key, Qt::SortOrder order);
+    int sortKey() const {
+        return m_sort_key;
+    }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& child) const override;
+    QModelIndex mapToSource(const QModelIndex& proxy_index) const override;
+    QModelIndex mapFromSource(const QModelIndex& source_index) const override;
+
+  private:
+    // 根据过滤结果和排序key重新生成m_rows
+    void rebuildRows();
+    bool isMapped() const {
+        return m_filtered || m_sort_key >= 0;
+    }
+
+    bool m_filtered = false;
+    vector<int> m_filter_rows; // 过滤结果（tag下标，升序）
+    int m_sort_key = -1;       // TagSorter::KEY
+    Qt::SortOrder m_sort_order = Qt::AscendingOrder;
+    vector<int> m_rows;            // 代理行 -> 源行
+    mutable vector<int> m_reverse; // 源行 -> 代理行，按需构建
 };
 
 /**
@@ -108,8 +190,8 @@ class ModelTagInfoTree : public QAbstractItemModel {
 class ModelTagBinary : public QAbstractTableModel {
     Q_OBJECT
   public:
-    explicit ModelTagBinary(BinaryData& data, QObject* parent = nullptr) : QAbstractTableModel(parent), m_data(data) {
-    }
+    explicit ModelTagBinary(BinaryData& data, QObject* parent = nullptr);
+    ~ModelTagBinary() override;
 
     // 设置文件路径（用于编辑后保存）
     void setFilePath(const QString& filePath) {
@@ -131,7 +213,7 @@ class ModelTagBinary : public QAbstractTableModel {
     static const int column_size = 5;
 
     // 获取数据
-    BinaryData& getData() {
+    const BinaryData& getData() const {
         return m_data;
     }
 
@@ -139,6 +221,125 @@ class ModelTagBinary : public QAbstractTableModel {
     void dataModified();
 
   private:
+    // 构造时的快照，与tag共享二进制数据，tag的缓存被内存预算释放后仍可显示
     BinaryData m_data;
+    uint32_t m_accounted = 0; // 构造时记入MEMORY_HEX_MODEL的字节数
     QString m_filePath;
 };
+
+/**
+ * @class ModelValidationIssues
+ * @brief 校验结果表，和tableView绑定，支持按列排序
+ */
+class ModelValidationIssues : public QAbstractTableModel {
+    Q_OBJECT
+  public:
+    explicit ModelValidationIssues(vector<ValidationIssue> issues, QObject* parent = nullptr)
+        : QAbstractTableModel(parent), m_issues(std::move(issues)) {
+    }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    static const int column_size = 5;
+
+    const ValidationIssue& getIssue(int row) const {
+        return m_issues[row];
+    }
+
+  private:
+    vector<ValidationIssue> m_issues;
+};
+
+/**
+ * @class ModelSearchResults
+ * @brief 搜索结果表，结果分批追加；字段列在追加时用临时字段树算好，显示时不再构建字段树
+ */
+class ModelSearchResults : public QAbstractTableModel {
+    Q_OBJECT
+  public:
+    // tag_model用于查找命中位置所在的字段，需保证在本模型使用期间有效
+    ModelSearchResults(ModelTagList* tag_model, vector<SearchPattern> patterns, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    void appendHits(vector<SearchHit> hits);
+
+    static const int column_size = 5;
+
+    const SearchHit& getHit(int row) const {
+        return m_hits[row];
+    }
+    size_t hitCount() const {
+        return m_hits.size();
+    }
+
+  private:
+    // 命中位置所在字段的路径，tree为命中所在tag的字段树（FLV Header时为空）
+    QString fieldText(const SearchHit& hit, TreeItem* tree) const;
+    // tag模型删除了[first, last]行：去掉落在这些tag中的结果，之后的tag序号前移
+    void removeTagRows(const QModelIndex& parent, int first, int last);
+
+    ModelTagList* m_tag_model;
+    vector<SearchPattern> m_patterns;
+    vector<SearchHit> m_hits;
+    vector<QString> m_fields; // 与m_hits一一对应
+};
+
+/**
+ * @class ModelDiffRows
+ * @brief 两个文件的并排对齐结果，可只显示有差异的行
+ */
+class ModelDiffRows : public QAbstractTableModel {
+    Q_OBJECT
+  public:
+    // result需保证在本模型使用期间有效
+    explicit ModelDiffRows(const DiffResult* result, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    void setDiffOnly(bool diff_only);
+
+    static const int column_size = 9;
+
+    const DiffRow& getRow(int row) const {
+        return m_result->m_rows[m_diff_only ? m_visible[row] : row];
+    }
+
+  private:
+    const DiffResult* m_result;
+    bool m_diff_only = false;
+    vector<size_t> m_visible; // 只显示差异时的行号
+};
+
+/**
+ * @class ModelLogLines
+ * @brief 日志行列表，只保存过滤后的行号，行内容在显示时才从映射的日志文件解码
+ */
+class ModelLogLines : public QAbstractListModel {
+    Q_OBJECT
+  public:
+    // index需保证在本模型使用期间有效
+    explicit ModelLogLines(const LogIndex* index, QObject* parent = nullptr)
+        : QAbstractListModel(parent), m_index(index) {
+    }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role) const override;
+
+    void setRows(vector<uint32_t> rows);
+    void appendRows(const vector<uint32_t>& rows);
+
+  private:
+    const LogIndex* m_index;
+    vector<uint32_t> m_rows;
+};
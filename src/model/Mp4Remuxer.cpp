@@ -0,0 +1,834 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "Mp4Remuxer.h"
+#include "BitReader.h"
+#include "BufferedWriter.h"
+#include "Log.h"
+#include "Utils.h"
+#include <QByteArray>
+#include <QFile>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// 默认样本时长(ms)，分片最后一个样本之后还没有下一个样本时使用
+constexpr uint32_t DEFAULT_VIDEO_DURATION = 40;
+constexpr uint32_t DEFAULT_AUDIO_DURATION = 23;
+
+// trun中的sample_flags
+constexpr uint32_t SAMPLE_FLAGS_SYNC = 0x02000000;     // sample_depends_on = 2
+constexpr uint32_t SAMPLE_FLAGS_NON_SYNC = 0x01010000; // sample_depends_on = 1, sample_is_non_sync_sample
+
+const uint32_t AAC_SAMPLE_RATES[13] = {
+    96000, 88200, 64000, 48000, 44100, 32000, 24000, 22050, 16000, 12000, 11025, 8000, 7350};
+
+/**
+ * @class BoxBuilder
+ * @brief 在内存中拼装ISO BMFF box，begin/end配对，end时回填box长度
+ */
+class BoxBuilder {
+  public:
+    void begin(const char* type) {
+        m_stack.push_back(m_data.size());
+        u32(0);
+        m_data.append(type, 4);
+    }
+
+    void beginFull(const char* type, uint8_t version, uint32_t flags) {
+        begin(type);
+        u32((static_cast<uint32_t>(version) << 24) | (flags & 0xFFFFFF));
+    }
+
+    void end() {
+        qsizetype start = m_stack.back();
+        m_stack.pop_back();
+        patch32(start, static_cast<uint32_t>(m_data.size() - start));
+    }
+
+    void u8(uint8_t value) {
+        m_data.append(static_cast<char>(value));
+    }
+
+    void u16(uint16_t value) {
+        u8(value >> 8);
+        u8(value & 0xFF);
+    }
+
+    void u32(uint32_t value) {
+        u16(value >> 16);
+        u16(value & 0xFFFF);
+    }
+
+    void u64(uint64_t value) {
+        u32(static_cast<uint32_t>(value >> 32));
+        u32(static_cast<uint32_t>(value));
+    }
+
+    void bytes(const char* data, qsizetype size) {
+        m_data.append(data, size);
+    }
+
+    void bytes(const QByteArray& data) {
+        m_data.append(data);
+    }
+
+    void zeros(int count) {
+        m_data.append(count, '\0');
+    }
+
+    // 3x3变换矩阵，单位矩阵
+    void matrix() {
+        const uint32_t values[9] = {0x00010000, 0, 0, 0, 0x00010000, 0, 0, 0, 0x40000000};
+        for (uint32_t value : values) {
+            u32(value);
+        }
+    }
+
+    qsizetype pos() const {
+        return m_data.size();
+    }
+
+    void patch32(qsizetype pos, uint32_t value) {
+        uchar buffer[4];
+        bigend_utoc32(buffer, value);
+        memcpy(m_data.data() + pos, buffer, 4);
+    }
+
+    const QByteArray& data() const {
+        return m_data;
+    }
+
+    void clear() {
+        m_data.resize(0);
+        m_stack.clear();
+    }
+
+  private:
+    QByteArray m_data;
+    vector<qsizetype> m_stack;
+};
+
+// 去掉防竞争字节（00 00 03）得到RBSP
+QByteArray unescapeRbsp(const uchar* p, uint32_t size) {
+    QByteArray rbsp;
+    rbsp.reserve(size);
+    int zeros = 0;
+    for (uint32_t i = 0; i < size; ++i) {
+        if (zeros >= 2 && p[i] == 0x03) {
+            zeros = 0;
+            continue;
+        }
+        zeros = p[i] == 0 ? zeros + 1 : 0;
+        rbsp.append(static_cast<char>(p[i]));
+    }
+    return rbsp;
+}
+
+void skipScalingList(BitReader& bits, int size) {
+    int32_t last = 8;
+    int32_t next = 8;
+    for (int j = 0; j < size; ++j) {
+        if (next != 0)
+            next = (last + bits.readSE() + 256) % 256;
+        last = next == 0 ? last : next;
+    }
+}
+
+// H.264 SPS中的显示宽高（已减去裁剪）
+bool parseAvcSps(const uchar* p, uint32_t size, uint32_t& width, uint32_t& height) {
+    QByteArray rbsp = unescapeRbsp(p, size);
+    BitReader bits(reinterpret_cast<const uchar*>(rbsp.constData()), rbsp.size());
+    bits.skip(8); // NALU头
+    uint32_t profile = bits.read(8);
+    bits.skip(16); // constraint_set_flags, level_idc
+    bits.readUE(); // seq_parameter_set_id
+
+    uint32_t chroma_format = 1;
+    static const uint32_t high_profiles[] = {100, 110, 122, 244, 44, 83, 86, 118, 128, 138, 139, 134, 135};
+    if (find(begin(high_profiles), end(high_profiles), profile) != end(high_profiles)) {
+        chroma_format = bits.readUE();
+        if (chroma_format == 3)
+            bits.skip(1); // separate_colour_plane_flag
+        bits.readUE();    // bit_depth_luma_minus8
+        bits.readUE();    // bit_depth_chroma_minus8
+        bits.skip(1);     // qpprime_y_zero_transform_bypass_flag
+        if (bits.read(1)) {
+            for (int i = 0; i < (chroma_format != 3 ? 8 : 12); ++i) {
+                if (bits.read(1))
+                    skipScalingList(bits, i < 6 ? 16 : 64);
+            }
+        }
+    }
+
+    bits.readUE(); // log2_max_frame_num_minus4
+    uint32_t poc_type = bits.readUE();
+    if (poc_type == 0) {
+        bits.readUE();
+    } else if (poc_type == 1) {
+        bits.skip(1);
+        bits.readSE();
+        bits.readSE();
+        uint32_t cycle = bits.readUE();
+        for (uint32_t i = 0; i < cycle && !bits.overflow(); ++i) {
+            bits.readSE();
+        }
+    }
+    bits.readUE(); // max_num_ref_frames
+    bits.skip(1);  // gaps_in_frame_num_value_allowed_flag
+    uint32_t width_mbs = bits.readUE() + 1;
+    uint32_t height_map_units = bits.readUE() + 1;
+    uint32_t frame_mbs_only = bits.read(1);
+    if (!frame_mbs_only)
+        bits.skip(1); // mb_adaptive_frame_field_flag
+    bits.skip(1);     // direct_8x8_inference_flag
+
+    uint32_t crop[4] = {0, 0, 0, 0};
+    if (bits.read(1)) {
+        for (uint32_t& value : crop) {
+            value = bits.readUE();
+        }
+    }
+    if (bits.overflow())
+        return false;
+
+    uint32_t crop_x = chroma_format == 0 || chroma_format == 3 ? 1 : 2;
+    uint32_t crop_y = (chroma_format == 1 ? 2 : 1) * (2 - frame_mbs_only);
+    width = width_mbs * 16 - (crop[0] + crop[1]) * crop_x;
+    height = (2 - frame_mbs_only) * height_map_units * 16 - (crop[2] + crop[3]) * crop_y;
+    return true;
+}
+
+// HEVC SPS中的显示宽高（已减去conformance window）
+bool parseHevcSps(const uchar* p, uint32_t size, uint32_t& width, uint32_t& height) {
+    QByteArray rbsp = unescapeRbsp(p, size);
+    BitReader bits(reinterpret_cast<const uchar*>(rbsp.constData()), rbsp.size());
+    bits.skip(16); // NALU头
+    bits.skip(4);  // sps_video_parameter_set_id
+    uint32_t max_sub_layers = bits.read(3);
+    bits.skip(1); // sps_temporal_id_nesting_flag
+
+    // profile_tier_level
+    bits.skip(96);
+    bool profile_present[8] = {};
+    bool level_present[8] = {};
+    for (uint32_t i = 0; i < max_sub_layers; ++i) {
+        profile_present[i] = bits.read(1);
+        level_present[i] = bits.read(1);
+    }
+    if (max_sub_layers > 0) {
+        bits.skip(2 * (8 - max_sub_layers));
+    }
+    for (uint32_t i = 0; i < max_sub_layers; ++i) {
+        bits.skip((profile_present[i] ? 88 : 0) + (level_present[i] ? 8 : 0));
+    }
+
+    bits.readUE(); // sps_seq_parameter_set_id
+    uint32_t chroma_format = bits.readUE();
+    if (chroma_format == 3)
+        bits.skip(1); // separate_colour_plane_flag
+    width = bits.readUE();
+    height = bits.readUE();
+    if (bits.read(1)) {
+        uint32_t sub_width = chroma_format == 1 || chroma_format == 2 ? 2 : 1;
+        uint32_t sub_height = chroma_format == 1 ? 2 : 1;
+        uint32_t left = bits.readUE();
+        uint32_t right = bits.readUE();
+        uint32_t top = bits.readUE();
+        uint32_t bottom = bits.readUE();
+        width -= (left + right) * sub_width;
+        height -= (top + bottom) * sub_height;
+    }
+    return !bits.overflow();
+}
+
+// 从解码配置记录中找到第一个SPS并取宽高
+bool parseDimensions(uint32_t codec, const QByteArray& config, uint32_t& width, uint32_t& height) {
+    const uchar* p = reinterpret_cast<const uchar*>(config.constData());
+    uint32_t size = config.size();
+    if (codec == FOURCC_AVC1) {
+        if (size < 8 || (p[5] & 0x1F) == 0)
+            return false;
+        uint32_t len = (p[6] << 8) | p[7];
+        return 8 + len <= size && parseAvcSps(p + 8, len, width, height);
+    }
+    if (codec == FOURCC_HVC1) {
+        if (size < 23)
+            return false;
+        uint32_t pos = 23;
+        for (int a = 0; a < p[22] && pos + 3 <= size; ++a) {
+            uint8_t type = p[pos] & 0x3F;
+            uint32_t count = (p[pos + 1] << 8) | p[pos + 2];
+            pos += 3;
+            for (uint32_t n = 0; n < count && pos + 2 <= size; ++n) {
+                uint32_t len = (p[pos] << 8) | p[pos + 1];
+                pos += 2;
+                if (pos + len > size)
+                    return false;
+                if (type == 33)
+                    return parseHevcSps(p + pos, len, width, height);
+                pos += len;
+            }
+        }
+    }
+    return false;
+}
+
+// AudioSpecificConfig中的采样率和声道数
+bool parseAudioConfig(const QByteArray& config, uint32_t& sample_rate, uint32_t& channels) {
+    BitReader bits(reinterpret_cast<const uchar*>(config.constData()), config.size());
+    if (bits.read(5) == 31)
+        bits.skip(6);
+    uint32_t frequency_index = bits.read(4);
+    sample_rate = frequency_index == 15 ? bits.read(24) : frequency_index < 13 ? AAC_SAMPLE_RATES[frequency_index] : 0;
+    channels = bits.read(4);
+    return !bits.overflow() && sample_rate > 0;
+}
+
+// onMetaData中的数值字段
+double metadataNumber(const vector<unique_ptr<FLVTag>>& tags, const QString& key) {
+    for (auto& tag : tags) {
+        if (!tag->metadata_info || tag->metadata_info->m_metadata_values.key != "onMetaData")
+            continue;
+        for (const auto& item : tag->metadata_info->m_metadata_values.obj_value) {
+            if (item.key == key && holds_alternative<double>(item.value))
+                return get<double>(item.value);
+        }
+    }
+    return 0;
+}
+
+// 描述符长度，固定用4字节的扩展形式
+void descriptorLength(BoxBuilder& box, uint32_t length) {
+    box.u8(0x80 | ((length >> 21) & 0x7F));
+    box.u8(0x80 | ((length >> 14) & 0x7F));
+    box.u8(0x80 | ((length >> 7) & 0x7F));
+    box.u8(length & 0x7F);
+}
+
+/**
+ * @brief 分片中的一个样本，负载留在源文件映射中
+ */
+struct Sample {
+    uint64_t m_offset; // 负载在源文件中的偏移
+    uint32_t m_size;
+    uint32_t m_dts;
+    int32_t m_cts;
+    bool m_key;
+};
+
+/**
+ * @brief 一个输出轨道
+ */
+struct Track {
+    uint32_t m_id = 0;
+    uint8_t m_tag_type = 0;
+    uint32_t m_codec = 0;
+    QByteArray m_config; // 第一个sequence header的负载：解码配置记录或AudioSpecificConfig
+    uint32_t m_sample_rate = 0;
+    uint32_t m_channels = 0;
+
+    vector<Sample> m_samples; // 当前分片的样本
+    vector<uint32_t> m_durations;
+    uint32_t m_last_dts = 0;
+    uint32_t m_last_duration = 0;
+
+    bool valid() const {
+        return m_id != 0;
+    }
+};
+
+bool isSupported(uint8_t tag_type, uint32_t codec) {
+    if (tag_type == TAG_TYPE_VIDEO)
+        return codec == FOURCC_AVC1 || codec == FOURCC_HVC1 || codec == FOURCC_AV01;
+    return codec == FOURCC_AAC;
+}
+
+// 流的codec和第一个sequence header，codec不支持时轨道无效
+void findTrack(const TagIndex& index, const uchar* mapped, uint64_t source_size, uint8_t tag_type, Track& track) {
+    for (size_t i = 0; i < index.size(); ++i) {
+        if (index.m_type[i] != tag_type || (index.m_flags[i] & (TAG_FLAG_GARBAGE | TAG_FLAG_MULTITRACK)) ||
+            index.m_codec[i] == 0)
+            continue;
+        if (track.m_codec == 0) {
+            track.m_codec = index.m_codec[i];
+            if (!isSupported(tag_type, track.m_codec))
+                return;
+        }
+        if (index.m_codec[i] == track.m_codec && (index.m_flags[i] & TAG_FLAG_SEQUENCE_HEADER) &&
+            index.m_offset[i] + 11 + index.m_data_size[i] <= source_size) {
+            track.m_config = QByteArray(reinterpret_cast<const char*>(mapped + index.m_offset[i] +
+                                                                      index.m_payload_offset[i]),
+                                        index.m_payload_size[i]);
+            track.m_tag_type = tag_type;
+            return;
+        }
+    }
+}
+
+void writeFtyp(BoxBuilder& box, const Track& video) {
+    box.begin("ftyp");
+    box.bytes("iso6", 4);
+    box.u32(0);
+    box.bytes("iso6", 4);
+    box.bytes("isom", 4);
+    box.bytes("mp41", 4);
+    if (video.valid() && video.m_codec == FOURCC_AV01)
+        box.bytes("av01", 4);
+    box.end();
+}
+
+void writeSampleEntry(BoxBuilder& box, const Track& track, uint32_t width, uint32_t height) {
+    if (track.m_tag_type == TAG_TYPE_VIDEO) {
+        const char* type = track.m_codec == FOURCC_AVC1 ? "avc1" : track.m_codec == FOURCC_HVC1 ? "hvc1" : "av01";
+        const char* config = track.m_codec == FOURCC_AVC1 ? "avcC" : track.m_codec == FOURCC_HVC1 ? "hvcC" : "av1C";
+        box.begin(type);
+        box.zeros(6);
+        box.u16(1);  // data_reference_index
+        box.zeros(16);
+        box.u16(width);
+        box.u16(height);
+        box.u32(0x00480000); // 72 dpi
+        box.u32(0x00480000);
+        box.u32(0);
+        box.u16(1);  // frame_count
+        box.zeros(32); // compressorname
+        box.u16(0x0018);
+        box.u16(0xFFFF);
+        box.begin(config);
+        box.bytes(track.m_config);
+        box.end();
+        box.end();
+        return;
+    }
+
+    box.begin("mp4a");
+    box.zeros(6);
+    box.u16(1);
+    box.zeros(8);
+    box.u16(track.m_channels);
+    box.u16(16);
+    box.u32(0);
+    box.u32(track.m_sample_rate <= 0xFFFF ? track.m_sample_rate << 16 : 0);
+
+    // ES_Descriptor > DecoderConfigDescriptor > DecoderSpecificInfo(AudioSpecificConfig), SLConfigDescriptor
+    uint32_t specific_size = track.m_config.size();
+    uint32_t decoder_size = 13 + 5 + specific_size;
+    box.beginFull("esds", 0, 0);
+    box.u8(0x03);
+    descriptorLength(box, 3 + 5 + decoder_size + 5 + 1);
+    box.u16(0); // ES_ID
+    box.u8(0);
+    box.u8(0x04);
+    descriptorLength(box, decoder_size);
+    box.u8(0x40); // objectTypeIndication: MPEG-4 Audio
+    box.u8(0x15); // streamType: audio
+    box.zeros(3 + 4 + 4);
+    box.u8(0x05);
+    descriptorLength(box, specific_size);
+    box.bytes(track.m_config);
+    box.u8(0x06);
+    descriptorLength(box, 1);
+    box.u8(0x02);
+    box.end();
+    box.end();
+}
+
+void writeTrak(BoxBuilder& box, const Track& track, uint32_t width, uint32_t height) {
+    bool video = track.m_tag_type == TAG_TYPE_VIDEO;
+    box.begin("trak");
+    box.beginFull("tkhd", 0, 0x03); // enabled | in_movie
+    box.zeros(8);
+    box.u32(track.m_id);
+    box.zeros(4 + 4 + 8);
+    box.u16(0); // layer
+    box.u16(0); // alternate_group
+    box.u16(video ? 0 : 0x0100);
+    box.u16(0);
+    box.matrix();
+    box.u32(video ? width << 16 : 0);
+    box.u32(video ? height << 16 : 0);
+    box.end();
+
+    box.begin("mdia");
+    box.beginFull("mdhd", 0, 0);
+    box.zeros(8);
+    box.u32(1000); // timescale
+    box.u32(0);
+    box.u16(0x55C4); // und
+    box.u16(0);
+    box.end();
+
+    box.beginFull("hdlr", 0, 0);
+    box.u32(0);
+    box.bytes(video ? "vide" : "soun", 4);
+    box.zeros(12);
+    box.bytes(video ? "VideoHandler" : "SoundHandler", 13);
+    box.end();
+
+    box.begin("minf");
+    if (video) {
+        box.beginFull("vmhd", 0, 1);
+        box.zeros(8);
+    } else {
+        box.beginFull("smhd", 0, 0);
+        box.zeros(4);
+    }
+    box.end();
+    box.begin("dinf");
+    box.beginFull("dref", 0, 0);
+    box.u32(1);
+    box.beginFull("url ", 0, 1); // 数据在同一文件中
+    box.end();
+    box.end();
+    box.end();
+
+    // 样本表为空，样本都在moof中描述
+    box.begin("stbl");
+    box.beginFull("stsd", 0, 0);
+    box.u32(1);
+    writeSampleEntry(box, track, width, height);
+    box.end();
+    for (const char* type : {"stts", "stsc", "stco"}) {
+        box.beginFull(type, 0, 0);
+        box.u32(0);
+        box.end();
+    }
+    box.beginFull("stsz", 0, 0);
+    box.u32(0);
+    box.u32(0);
+    box.end();
+    box.end(); // stbl
+    box.end(); // minf
+    box.end(); // mdia
+    box.end(); // trak
+}
+
+void writeMoov(BoxBuilder& box, const vector<Track*>& tracks, uint32_t width, uint32_t height, uint32_t duration) {
+    box.begin("moov");
+    box.beginFull("mvhd", 0, 0);
+    box.zeros(8);
+    box.u32(1000);
+    box.u32(0);
+    box.u32(0x00010000); // rate 1.0
+    box.u16(0x0100);     // volume 1.0
+    box.zeros(2 + 8);
+    box.matrix();
+    box.zeros(24);
+    box.u32(tracks.back()->m_id + 1);
+    box.end();
+
+    for (Track* track : tracks) {
+        writeTrak(box, *track, width, height);
+    }
+
+    box.begin("mvex");
+    box.beginFull("mehd", 0, 0);
+    box.u32(duration);
+    box.end();
+    for (Track* track : tracks) {
+        box.beginFull("trex", 0, 0);
+        box.u32(track->m_id);
+        box.u32(1); // default_sample_description_index
+        box.zeros(12);
+        box.end();
+    }
+    box.end();
+    box.end();
+}
+
+/**
+ * @class FragmentWriter
+ * @brief 攒一个分片的样本，flush时写出moof和mdat，mdat的负载直接从源文件映射拷贝
+ */
+class FragmentWriter {
+  public:
+    FragmentWriter(BufferedWriter& writer, const uchar* mapped, RemuxReport& report)
+        : m_writer(writer), m_mapped(mapped), m_report(report) {
+    }
+
+    // next_video_dts为下一个分片第一个视频样本的时间，用于计算本分片最后一个视频样本的时长，未知时为-1
+    void flush(const vector<Track*>& tracks, int64_t next_video_dts) {
+        bool empty = true;
+        for (Track* track : tracks) {
+            empty &= track->m_samples.empty();
+        }
+        if (empty)
+            return;
+
+        // 样本时长取与下一个样本的时间差，分片最后一个样本沿用上一个时长
+        for (Track* track : tracks) {
+            auto& samples = track->m_samples;
+            track->m_durations.resize(samples.size());
+            for (size_t k = 0; k < samples.size(); ++k) {
+                if (k + 1 < samples.size()) {
+                    track->m_durations[k] = samples[k + 1].m_dts - samples[k].m_dts;
+                } else if (track->m_tag_type == TAG_TYPE_VIDEO && next_video_dts >= samples[k].m_dts) {
+                    track->m_durations[k] = static_cast<uint32_t>(next_video_dts - samples[k].m_dts);
+                } else {
+                    track->m_durations[k] = track->m_last_duration;
+                }
+                if (track->m_durations[k] > 0)
+                    track->m_last_duration = track->m_durations[k];
+            }
+        }
+
+        m_box.clear();
+        m_box.begin("moof");
+        m_box.beginFull("mfhd", 0, 0);
+        m_box.u32(++m_sequence);
+        m_box.end();
+
+        vector<qsizetype> data_offset_pos;
+        for (Track* track : tracks) {
+            if (track->m_samples.empty())
+                continue;
+            bool video = track->m_tag_type == TAG_TYPE_VIDEO;
+            m_box.begin("traf");
+            m_box.beginFull("tfhd", 0, 0x020000); // default-base-is-moof
+            m_box.u32(track->m_id);
+            m_box.end();
+            m_box.beginFull("tfdt", 1, 0);
+            m_box.u64(track->m_samples.front().m_dts);
+            m_box.end();
+
+            // data-offset | sample-duration | sample-size | sample-flags | sample-composition-time-offset
+            m_box.beginFull("trun", 1, 0x000F01);
+            m_box.u32(track->m_samples.size());
+            data_offset_pos.push_back(m_box.pos());
+            m_box.u32(0);
+            for (size_t k = 0; k < track->m_samples.size(); ++k) {
+                const Sample& sample = track->m_samples[k];
+                m_box.u32(track->m_durations[k]);
+                m_box.u32(sample.m_size);
+                m_box.u32(!video || sample.m_key ? SAMPLE_FLAGS_SYNC : SAMPLE_FLAGS_NON_SYNC);
+                m_box.u32(static_cast<uint32_t>(sample.m_cts));
+            }
+            m_box.end();
+            m_box.end();
+        }
+        m_box.end();
+
+        // 回填每个轨道在mdat中的数据偏移（相对moof起始）
+        uint64_t mdat_payload = 0;
+        size_t traf = 0;
+        for (Track* track : tracks) {
+            if (track->m_samples.empty())
+                continue;
+            m_box.patch32(data_offset_pos[traf++], static_cast<uint32_t>(m_box.pos() + 8 + mdat_payload));
+            for (const Sample& sample : track->m_samples) {
+                mdat_payload += sample.m_size;
+            }
+        }
+        if (8 + mdat_payload > 0xFFFFFFFFu) {
+            throw QString("分片数据超过4GB");
+        }
+
+        m_writer.write(m_box.data().constData(), m_box.data().size());
+        uchar mdat[8];
+        bigend_utoc32(mdat, static_cast<uint32_t>(8 + mdat_payload));
+        memcpy(mdat + 4, "mdat", 4);
+        m_writer.write(mdat, 8);
+        for (Track* track : tracks) {
+            for (const Sample& sample : track->m_samples) {
+                m_writer.write(m_mapped + sample.m_offset, sample.m_size);
+            }
+            (track->m_tag_type == TAG_TYPE_VIDEO ? m_report.m_video_samples : m_report.m_audio_samples) +=
+                track->m_samples.size();
+            track->m_samples.clear();
+        }
+        ++m_report.m_fragments;
+    }
+
+  private:
+    BufferedWriter& m_writer;
+    const uchar* m_mapped;
+    RemuxReport& m_report;
+    BoxBuilder m_box;
+    uint32_t m_sequence = 0;
+};
+
+} // namespace
+
+QString RemuxReport::toString() const {
+    return QString("视频%1 %2x%3，%4个样本；音频%5，%6个样本\n"
+                   "%7个分片，输出%8字节\n"
+                   "跳过%9个tag，中途改变的sequence header %10个（沿用第一个）")
+        .arg(m_video_codec ? fourCCToString(m_video_codec) : QString("无"))
+        .arg(m_width)
+        .arg(m_height)
+        .arg(m_video_samples)
+        .arg(m_audio_codec ? fourCCToString(m_audio_codec) : QString("无"))
+        .arg(m_audio_samples)
+        .arg(m_fragments)
+        .arg(m_output_size)
+        .arg(m_skipped)
+        .arg(m_config_changes);
+}
+
+bool Mp4Remuxer::remux(const QString& source_path,
+                       const QString& target_path,
+                       const vector<unique_ptr<FLVTag>>& tags,
+                       const TagIndex& index,
+                       RemuxReport& report) {
+    report = RemuxReport();
+    QString temp_path = target_path + "_temp";
+
+    QFile source(source_path);
+    QFile target(temp_path);
+    uchar* mapped = nullptr;
+
+    try {
+        if (!source.open(QIODevice::ReadOnly)) {
+            throw QString("打开源文件失败：%1").arg(source.errorString());
+        }
+        uint64_t source_size = source.size();
+        mapped = source.map(0, source_size);
+        if (!mapped) {
+            throw QString("映射源文件失败：%1").arg(source.errorString());
+        }
+
+        // 轨道和解码配置
+        Track video;
+        Track audio;
+        findTrack(index, mapped, source_size, TAG_TYPE_VIDEO, video);
+        findTrack(index, mapped, source_size, TAG_TYPE_AUDIO, audio);
+        vector<Track*> tracks;
+        for (Track* track : {&video, &audio}) {
+            if (track->m_tag_type == 0) {
+                if (track->m_codec != 0)
+                    qCInfo(runLog) << QString("[flv-remux] event[track dropped] codec[%1]")
+                                          .arg(fourCCToString(track->m_codec));
+                continue;
+            }
+            track->m_id = static_cast<uint32_t>(tracks.size() + 1);
+            track->m_last_duration = track == &video ? DEFAULT_VIDEO_DURATION : DEFAULT_AUDIO_DURATION;
+            tracks.push_back(track);
+        }
+        if (tracks.empty()) {
+            throw QString("没有可转封装的轨道，目前支持H.264、HEVC、AV1视频和AAC音频，且需要sequence header");
+        }
+        if (audio.valid() && !parseAudioConfig(audio.m_config, audio.m_sample_rate, audio.m_channels)) {
+            throw QString("AudioSpecificConfig不完整");
+        }
+        report.m_video_codec = video.valid() ? video.m_codec : 0;
+        report.m_audio_codec = audio.valid() ? audio.m_codec : 0;
+        if (video.valid() && !parseDimensions(video.m_codec, video.m_config, report.m_width, report.m_height)) {
+            report.m_width = static_cast<uint32_t>(metadataNumber(tags, "width"));
+            report.m_height = static_cast<uint32_t>(metadataNumber(tags, "height"));
+        }
+
+        // 时间戳从第一帧开始
+        auto track_of = [&](size_t i) -> Track* {
+            Track* track = index.m_type[i] == TAG_TYPE_VIDEO ? &video : index.m_type[i] == TAG_TYPE_AUDIO ? &audio
+                                                                                                        : nullptr;
+            return track && track->valid() ? track : nullptr;
+        };
+        bool found = false;
+        uint32_t base = 0;
+        uint32_t last = 0;
+        for (size_t i = 0; i < index.size(); ++i) {
+            Track* track = track_of(i);
+            if (!track || index.m_codec[i] != track->m_codec ||
+                (index.m_flags[i] & (TAG_FLAG_GARBAGE | TAG_FLAG_SEQUENCE_HEADER)))
+                continue;
+            base = found ? min(base, index.m_timestamp[i]) : index.m_timestamp[i];
+            last = found ? max(last, index.m_timestamp[i]) : index.m_timestamp[i];
+            found = true;
+        }
+
+        if (!target.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            throw QString("创建输出文件失败：%1").arg(target.errorString());
+        }
+        BufferedWriter writer(target, WRITE_BUFFER_SIZE);
+        BoxBuilder header;
+        writeFtyp(header, video);
+        writeMoov(header, tracks, report.m_width, report.m_height, last - base);
+        writer.write(header.data().constData(), header.data().size());
+
+        FragmentWriter fragments(writer, mapped, report);
+        bool fragment_empty = true;
+        uint32_t fragment_start = 0;
+        for (size_t i = 0; i < index.size(); ++i) {
+            Track* track = track_of(i);
+            if (!track || (index.m_flags[i] & TAG_FLAG_GARBAGE))
+                continue;
+            if (index.m_codec[i] != track->m_codec || (index.m_flags[i] & TAG_FLAG_MULTITRACK) ||
+                index.m_offset[i] + 11 + index.m_data_size[i] > source_size) {
+                ++report.m_skipped;
+                continue;
+            }
+
+            const uchar* payload = mapped + index.m_offset[i] + index.m_payload_offset[i];
+            uint32_t payload_size = index.m_payload_size[i];
+            if (index.m_flags[i] & TAG_FLAG_SEQUENCE_HEADER) {
+                if (payload_size != static_cast<uint32_t>(track->m_config.size()) ||
+                    memcmp(payload, track->m_config.constData(), payload_size) != 0)
+                    ++report.m_config_changes;
+                continue;
+            }
+            uint8_t packet_type = index.m_packet_type[i];
+            bool coded = track == &video
+                             ? packet_type == VIDEO_PACKET_CODED_FRAMES || packet_type == VIDEO_PACKET_CODED_FRAMES_X
+                             : packet_type == AUDIO_PACKET_CODED_FRAMES;
+            if (!coded || payload_size == 0)
+                continue;
+
+            // 时间戳回退时按前一个样本处理，保证解码时间单调
+            uint32_t dts = max(index.m_timestamp[i] > base ? index.m_timestamp[i] - base : 0, track->m_last_dts);
+            track->m_last_dts = dts;
+            bool key = track == &video && (index.m_flags[i] & TAG_FLAG_KEYFRAME);
+
+            // 有视频时每个关键帧开始一个分片，纯音频按固定时长分片
+            bool boundary = video.valid() ? key : dts - fragment_start >= AUDIO_FRAGMENT_DURATION;
+            if (boundary && !fragment_empty) {
+                fragments.flush(tracks, track == &video ? static_cast<int64_t>(dts) : -1);
+                fragment_empty = true;
+            }
+            if (fragment_empty) {
+                fragment_start = dts;
+                fragment_empty = false;
+            }
+            track->m_samples.push_back({static_cast<uint64_t>(payload - mapped),
+                                        payload_size,
+                                        dts,
+                                        track == &video ? index.m_cts[i] : 0,
+                                        key});
+        }
+        fragments.flush(tracks, -1);
+
+        writer.flush();
+        report.m_output_size = writer.written();
+        target.close();
+        source.unmap(mapped);
+        mapped = nullptr;
+        source.close();
+
+        if (QFile::exists(target_path) && !QFile::remove(target_path)) {
+            throw QString("删除原目标文件失败");
+        }
+        if (!QFile::rename(temp_path, target_path)) {
+            throw QString("重命名临时文件失败");
+        }
+
+        qCInfo(runLog) << QString("[flv-remux] event[finished] target[%1] video[%2] audio[%3] fragments[%4] "
+                                  "size[%5] skipped[%6]")
+                              .arg(target_path)
+                              .arg(report.m_video_samples)
+                              .arg(report.m_audio_samples)
+                              .arg(report.m_fragments)
+                              .arg(report.m_output_size)
+                              .arg(report.m_skipped);
+        return true;
+    } catch (const QString& error) {
+        qCInfo(runLog) << QString("[flv-remux] event[failed] error[%1]").arg(error);
+        report.m_error = error;
+        if (mapped)
+            source.unmap(mapped);
+        target.close();
+        QFile::remove(temp_path);
+        return false;
+    }
+}
@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "TagIndex.h"
+#include "TagInfo.h"
+#include <QString>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @class RemuxReport
+ * @brief 转封装结果统计
+ */
+struct RemuxReport {
+    uint32_t m_video_codec = 0; // FourCC，没有视频轨时为0
+    uint32_t m_audio_codec = 0;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    uint64_t m_video_samples = 0;
+    uint64_t m_audio_samples = 0;
+    uint64_t m_fragments = 0;
+    uint64_t m_skipped = 0;        // 跳过的tag：codec不一致、多轨、截断
+    uint64_t m_config_changes = 0; // 中途改变的sequence header，fMP4只有一个sample entry，沿用第一个
+    uint64_t m_output_size = 0;
+    QString m_error;
+
+    QString toString() const;
+};
+
+/**
+ * @class Mp4Remuxer
+ * @brief 不重新编码，把FLV转封装为fragmented MP4（ISO BMFF）
+ *
+ * - ftyp/moov由第一个sequence header中的解码配置（avcC/hvcC/av1C、AudioSpecificConfig）生成，宽高取自SPS，
+ *   解析不了时取onMetaData
+ * - 每个GOP（视频关键帧）一个moof/mdat分片，纯音频按固定时长分片，两个轨道的timescale都是1000，与FLV时间戳一致
+ * - 源文件映射后，分片内只保存样本的位置和时间，负载从映射直接拷贝到大块输出缓冲，内存占用与文件大小无关
+ *
+ * 支持H.264、HEVC、AV1视频和AAC音频，其他codec的轨道不输出
+ */
+class Mp4Remuxer {
+  public:
+    static bool remux(const QString& source_path,
+                      const QString& target_path,
+                      const vector<unique_ptr<FLVTag>>& tags,
+                      const TagIndex& index,
+                      RemuxReport& report);
+
+    static constexpr int64_t WRITE_BUFFER_SIZE = 16 * 1024 * 1024;
+    static constexpr uint32_t AUDIO_FRAGMENT_DURATION = 1000; // 纯音频时每个分片的时长(ms)
+};
@@ -0,0 +1,350 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "RepairWriter.h"
+#include "BufferedWriter.h"
+#include "Log.h"
+#include "Utils.h"
+#include <QFile>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+
+void appendAmfKey(QByteArray& out, const QByteArray& key) {
+    uchar len[2] = {static_cast<uchar>(key.size() >> 8), static_cast<uchar>(key.size() & 0xFF)};
+    out.append((const char*) len, 2);
+    out.append(key);
+}
+
+void appendAmfNumber(QByteArray& out, double value) {
+    uint64_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    uchar buffer[9] = {AMF_NUMBER};
+    for (int i = 0; i < 8; ++i) {
+        buffer[1 + i] = static_cast<uchar>(bits >> (56 - 8 * i));
+    }
+    out.append((const char*) buffer, 9);
+}
+
+void appendAmfBoolean(QByteArray& out, bool value) {
+    out.append(char(AMF_BOOLEAN));
+    out.append(char(value ? 1 : 0));
+}
+
+void appendAmfString(QByteArray& out, const QByteArray& value) {
+    out.append(char(AMF_STRING));
+    appendAmfKey(out, value);
+}
+
+void appendAmfStrictArray(QByteArray& out, const vector<double>& values) {
+    uchar count[5] = {AMF_STRICT_ARRAY};
+    bigend_utoc32(count + 1, static_cast<uint32_t>(values.size()));
+    out.append((const char*) count, 5);
+    for (double value : values) {
+        appendAmfNumber(out, value);
+    }
+}
+
+void appendAmfObjectEnd(QByteArray& out) {
+    out.append('\0');
+    out.append('\0');
+    out.append(char(AMF_OBJECT_END));
+}
+
+// 判断是否为onMetaData script tag
+bool isOnMetaData(const FLVTag& tag) {
+    return tag.metadata_info && tag.metadata_info->m_metadata_values.key == "onMetaData";
+}
+
+// sequence header去重的键：tag类型 + codec
+uint64_t sequenceKey(const TagIndex& index, size_t i) {
+    return (static_cast<uint64_t>(index.m_type[i]) << 32) | index.m_codec[i];
+}
+
+} // namespace
+
+QString RepairReport::toString() const {
+    return QString("写入%1个tag，输出%2字节\n"
+                   "丢弃垃圾数据段%3个（%4字节）\n"
+                   "修正PreviousTagSize %5处\n"
+                   "移除重复sequence header %6个\n"
+                   "时间戳基准%7ms，关键帧%8个")
+        .arg(m_tags_written)
+        .arg(m_output_size)
+        .arg(m_garbage_spans)
+        .arg(m_garbage_bytes)
+        .arg(m_previous_tag_size_fixed)
+        .arg(m_sequence_headers_removed)
+        .arg(m_timestamp_base)
+        .arg(m_keyframes);
+}
+
+QByteArray RepairWriter::buildMetadataTag(const MetadataItem* original,
+                                          double duration,
+                                          double file_size,
+                                          const vector<double>& keyframe_times,
+                                          const vector<double>& keyframe_positions) {
+    QByteArray body;
+    appendAmfString(body, "onMetaData");
+
+    // ECMA数组，先占位元素个数
+    body.append(char(AMF_ECMA_ARRAY));
+    int count_pos = body.size();
+    body.append(4, '\0');
+    uint32_t count = 0;
+
+    // 保留原始元数据中的简单字段，需要重算的字段跳过
+    if (original) {
+        for (const auto& item : original->obj_value) {
+            if (item.key == "duration" || item.key == "filesize" || item.key == "keyframes")
+                continue;
+
+            QByteArray key = item.key.toUtf8();
+            if (item.type == AMF_NUMBER && holds_alternative<double>(item.value)) {
+                appendAmfKey(body, key);
+                appendAmfNumber(body, get<double>(item.value));
+            } else if (item.type == AMF_BOOLEAN && holds_alternative<bool>(item.value)) {
+                appendAmfKey(body, key);
+                appendAmfBoolean(body, get<bool>(item.value));
+            } else if (item.type == AMF_STRING && holds_alternative<string>(item.value)) {
+                appendAmfKey(body, key);
+                appendAmfString(body, QByteArray::fromStdString(get<string>(item.value)));
+            } else {
+                continue;
+            }
+            ++count;
+        }
+    }
+
+    appendAmfKey(body, "duration");
+    appendAmfNumber(body, duration);
+    appendAmfKey(body, "filesize");
+    appendAmfNumber(body, file_size);
+    appendAmfKey(body, "keyframes");
+    body.append(char(AMF_OBJECT));
+    appendAmfKey(body, "filepositions");
+    appendAmfStrictArray(body, keyframe_positions);
+    appendAmfKey(body, "times");
+    appendAmfStrictArray(body, keyframe_times);
+    appendAmfObjectEnd(body);
+    count += 3;
+
+    appendAmfObjectEnd(body);
+    bigend_utoc32((uchar*) body.data() + count_pos, count);
+
+    // 组装tag头和PreviousTagSize
+    QByteArray tag(11, '\0');
+    tag[0] = char(TAG_TYPE_SCRIPT);
+    bigend_utoc24((uchar*) tag.data() + 1, static_cast<uint32_t>(body.size()));
+    tag.append(body);
+    uchar prev[4];
+    bigend_utoc32(prev, static_cast<uint32_t>(11 + body.size()));
+    tag.append((const char*) prev, 4);
+    return tag;
+}
+
+bool RepairWriter::repair(const QString& source_path,
+                          const QString& target_path,
+                          const vector<unique_ptr<FLVTag>>& tags,
+                          const TagIndex& index,
+                          const RepairOptions& options,
+                          RepairReport& report) {
+    report = RepairReport();
+    QString temp_path = target_path + "_temp";
+
+    QFile source(source_path);
+    QFile target(temp_path);
+    uchar* mapped = nullptr;
+
+    try {
+        if (!source.open(QIODevice::ReadOnly)) {
+            throw QString("打开源文件失败：%1").arg(source.errorString());
+        }
+        int64_t source_size = source.size();
+        mapped = source.map(0, source_size);
+        if (!mapped) {
+            throw QString("映射源文件失败：%1").arg(source.errorString());
+        }
+
+        // 第一遍：确定保留哪些tag
+        vector<size_t> kept;
+        kept.reserve(index.size());
+        const MetadataItem* original_metadata = nullptr;
+        unordered_map<uint64_t, size_t> last_sequence_header;
+        bool has_audio = false;
+        bool has_video = false;
+
+        for (size_t i = 0; i < index.size(); ++i) {
+            if (index.m_flags[i] & TAG_FLAG_GARBAGE) {
+                if (options.m_drop_garbage) {
+                    ++report.m_garbage_spans;
+                    report.m_garbage_bytes += index.m_data_size[i];
+                    continue;
+                }
+            } else if (index.m_offset[i] + index.tagSpan(i) > static_cast<uint64_t>(source_size)) {
+                // 截断的tag无法完整复制
+                continue;
+            }
+
+            uint8_t type = index.m_type[i];
+            if (type == TAG_TYPE_SCRIPT && options.m_rebuild_metadata && isOnMetaData(*tags[i])) {
+                if (!original_metadata)
+                    original_metadata = &tags[i]->metadata_info->m_metadata_values;
+                continue;
+            }
+
+            if (options.m_dedupe_sequence_header && (index.m_flags[i] & TAG_FLAG_SEQUENCE_HEADER)) {
+                uint64_t key = sequenceKey(index, i);
+                auto it = last_sequence_header.find(key);
+                if (it != last_sequence_header.end()) {
+                    size_t last = it->second;
+                    if (index.m_data_size[last] == index.m_data_size[i] &&
+                        memcmp(mapped + index.m_offset[last] + 11, mapped + index.m_offset[i] + 11, index.m_data_size[i]) ==
+                            0) {
+                        ++report.m_sequence_headers_removed;
+                        continue;
+                    }
+                }
+                last_sequence_header[key] = i;
+            }
+
+            has_audio |= (type == TAG_TYPE_AUDIO);
+            has_video |= (type == TAG_TYPE_VIDEO);
+            kept.push_back(i);
+        }
+
+        // 时间戳基准：音视频数据帧的最小时间戳，sequence header不参与
+        uint32_t base = 0;
+        if (options.m_rebase_timestamp) {
+            bool found = false;
+            for (size_t i : kept) {
+                uint8_t type = index.m_type[i];
+                if ((type == TAG_TYPE_AUDIO || type == TAG_TYPE_VIDEO) && !(index.m_flags[i] & TAG_FLAG_SEQUENCE_HEADER) &&
+                    (!found || index.m_timestamp[i] < base)) {
+                    base = index.m_timestamp[i];
+                    found = true;
+                }
+            }
+        }
+        report.m_timestamp_base = base;
+        auto rebased = [&](size_t i) -> uint32_t {
+            return index.m_timestamp[i] > base ? index.m_timestamp[i] - base : 0;
+        };
+
+        // 第二遍：计算输出布局，onMetaData长度只和关键帧个数有关
+        vector<double> keyframe_times;
+        vector<double> keyframe_positions;
+        double duration = 0;
+        for (size_t i : kept) {
+            if (index.m_type[i] == TAG_TYPE_AUDIO || index.m_type[i] == TAG_TYPE_VIDEO)
+                duration = max(duration, rebased(i) / 1000.0);
+            if (index.m_type[i] == TAG_TYPE_VIDEO && (index.m_flags[i] & TAG_FLAG_KEYFRAME) &&
+                !(index.m_flags[i] & TAG_FLAG_SEQUENCE_HEADER)) {
+                keyframe_times.push_back(rebased(i) / 1000.0);
+            }
+        }
+        keyframe_positions.resize(keyframe_times.size());
+
+        QByteArray metadata_tag;
+        uint64_t out_pos = FLV_HEADER_SIZE;
+        if (options.m_rebuild_metadata) {
+            metadata_tag = buildMetadataTag(original_metadata, duration, 0, keyframe_times, keyframe_positions);
+            out_pos += metadata_tag.size();
+        }
+
+        size_t keyframe = 0;
+        for (size_t i : kept) {
+            if (index.m_type[i] == TAG_TYPE_VIDEO && (index.m_flags[i] & TAG_FLAG_KEYFRAME) &&
+                !(index.m_flags[i] & TAG_FLAG_SEQUENCE_HEADER)) {
+                keyframe_positions[keyframe++] = static_cast<double>(out_pos);
+            }
+            out_pos += index.tagSpan(i);
+        }
+        report.m_keyframes = keyframe;
+
+        if (options.m_rebuild_metadata) {
+            metadata_tag = buildMetadataTag(
+                original_metadata, duration, static_cast<double>(out_pos), keyframe_times, keyframe_positions);
+        }
+
+        // 第三遍：顺序写出
+        if (!target.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            throw QString("创建输出文件失败：%1").arg(target.errorString());
+        }
+        BufferedWriter writer(target, WRITE_BUFFER_SIZE);
+
+        uchar header[FLV_HEADER_SIZE] = {'F', 'L', 'V', 1, 0, 0, 0, 0, 9, 0, 0, 0, 0};
+        header[4] = (has_audio ? 0x04 : 0) | (has_video ? 0x01 : 0);
+        writer.write((const char*) header, FLV_HEADER_SIZE);
+        writer.write(metadata_tag.constData(), metadata_tag.size());
+
+        for (size_t i : kept) {
+            const uchar* src = mapped + index.m_offset[i];
+
+            // 垃圾数据段原样保留
+            if (index.m_flags[i] & TAG_FLAG_GARBAGE) {
+                writer.write((const char*) src, index.m_data_size[i]);
+                ++report.m_tags_written;
+                continue;
+            }
+
+            uint32_t data_size = index.m_data_size[i];
+            uchar tag_header[11];
+            memcpy(tag_header, src, 11);
+            uint32_t timestamp = rebased(i);
+            bigend_utoc24(tag_header + 4, timestamp & 0xFFFFFF);
+            tag_header[7] = static_cast<uchar>(timestamp >> 24);
+            bigend_utoc24(tag_header + 8, 0);
+            writer.write((const char*) tag_header, 11);
+            writer.write((const char*) src + 11, data_size);
+
+            uint32_t expected = 11 + data_size;
+            uchar prev[4];
+            memcpy(prev, src + 11 + data_size, 4);
+            if (bigend_ctou32(prev) != expected) {
+                if (options.m_fix_previous_tag_size) {
+                    bigend_utoc32(prev, expected);
+                    ++report.m_previous_tag_size_fixed;
+                }
+            }
+            writer.write((const char*) prev, 4);
+            ++report.m_tags_written;
+        }
+
+        writer.flush();
+        report.m_output_size = writer.written();
+        target.close();
+        source.unmap(mapped);
+        mapped = nullptr;
+        source.close();
+
+        // 替换目标文件
+        if (QFile::exists(target_path) && !QFile::remove(target_path)) {
+            throw QString("删除原目标文件失败");
+        }
+        if (!QFile::rename(temp_path, target_path)) {
+            throw QString("重命名临时文件失败");
+        }
+
+        qCInfo(runLog) << QString("[flv-repairing] event[finished] target[%1] tags[%2] size[%3] garbage[%4] "
+                                  "prev_fixed[%5] seq_removed[%6] base[%7]")
+                              .arg(target_path)
+                              .arg(report.m_tags_written)
+                              .arg(report.m_output_size)
+                              .arg(report.m_garbage_spans)
+                              .arg(report.m_previous_tag_size_fixed)
+                              .arg(report.m_sequence_headers_removed)
+                              .arg(report.m_timestamp_base);
+        return true;
+    } catch (const QString& error) {
+        qCInfo(runLog) << QString("[flv-repairing] event[failed] error[%1]").arg(error);
+        report.m_error = error;
+        if (mapped)
+            source.unmap(mapped);
+        target.close();
+        QFile::remove(temp_path);
+        return false;
+    }
+}
@@ -0,0 +1,67 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "TagIndex.h"
+#include "TagInfo.h"
+#include <QByteArray>
+#include <QString>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @class RepairOptions
+ * @brief 修复另存为的各项处理开关，默认全部开启
+ */
+struct RepairOptions {
+    bool m_drop_garbage = true;           // 丢弃恢复模式跳过的数据段
+    bool m_fix_previous_tag_size = true;  // 按实际长度重写PreviousTagSize
+    bool m_rebase_timestamp = true;       // 时间戳从0开始
+    bool m_dedupe_sequence_header = true; // 去掉内容相同的重复sequence header
+    bool m_rebuild_metadata = true;       // 重建onMetaData的duration/filesize/keyframes
+};
+
+/**
+ * @class RepairReport
+ * @brief 修复结果统计
+ */
+struct RepairReport {
+    uint64_t m_garbage_spans = 0;
+    uint64_t m_garbage_bytes = 0;
+    uint64_t m_previous_tag_size_fixed = 0;
+    uint64_t m_sequence_headers_removed = 0;
+    uint32_t m_timestamp_base = 0;
+    uint64_t m_tags_written = 0;
+    uint64_t m_keyframes = 0;
+    uint64_t m_output_size = 0;
+    QString m_error;
+
+    QString toString() const;
+};
+
+/**
+ * @class RepairWriter
+ * @brief 一次顺序写出修复后的FLV：源文件映射读取，输出经大块缓冲写入临时文件后替换目标文件
+ */
+class RepairWriter {
+  public:
+    static bool repair(const QString& source_path,
+                       const QString& target_path,
+                       const vector<unique_ptr<FLVTag>>& tags,
+                       const TagIndex& index,
+                       const RepairOptions& options,
+                       RepairReport& report);
+
+    // 生成完整的onMetaData script tag（含11字节tag头和PreviousTagSize），original中的其他简单字段会保留
+    static QByteArray buildMetadataTag(const MetadataItem* original,
+                                       double duration,
+                                       double file_size,
+                                       const vector<double>& keyframe_times,
+                                       const vector<double>& keyframe_positions);
+
+    static constexpr int64_t WRITE_BUFFER_SIZE = 8 * 1024 * 1024;
+};
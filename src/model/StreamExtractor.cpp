@@ -0,0 +1,224 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "StreamExtractor.h"
+#include "BufferedWriter.h"
+#include "CodecConfig.h"
+#include "Log.h"
+#include "Utils.h"
+#include <QByteArray>
+#include <QFile>
+#include <vector>
+
+namespace {
+
+/**
+ * @class VideoGather
+ * @brief 长度前缀的NALU逐个加起始码写出，关键帧没有带内参数集时先写入sequence header中的参数集
+ */
+class VideoGather {
+  public:
+    VideoGather(BufferedWriter& writer, uint32_t codec, ExtractReport& report)
+        : m_writer(writer), m_codec(codec), m_report(report) {
+    }
+
+    void setSequenceHeader(const uchar* p, uint32_t size) {
+        ParameterSets sets;
+        bool ok = m_codec == FOURCC_AVC1 ? parseAvcConfig(p, size, sets) : parseHevcConfig(p, size, sets);
+        if (ok) {
+            m_sets = sets;
+        } else {
+            ++m_report.m_skipped;
+        }
+    }
+
+    void writeFrame(const uchar* p, uint32_t size, bool keyframe) {
+        // 先检查NALU边界是否完整，同时看是否自带参数集
+        bool has_parameter_sets = false;
+        if (!splitNalus(p, size, m_sets.m_length_size, m_codec, m_nalus, has_parameter_sets)) {
+            ++m_report.m_skipped;
+            return;
+        }
+        if (m_nalus.empty())
+            return;
+
+        if (keyframe && !has_parameter_sets && !m_sets.m_annexb.isEmpty()) {
+            m_writer.write(m_sets.m_annexb.constData(), m_sets.m_annexb.size());
+            ++m_report.m_parameter_sets;
+        }
+        for (auto& [start, len] : m_nalus) {
+            m_writer.write(START_CODE, 4);
+            m_writer.write(p + start, len);
+        }
+        ++m_report.m_frames;
+    }
+
+  private:
+    BufferedWriter& m_writer;
+    uint32_t m_codec;
+    ExtractReport& m_report;
+    ParameterSets m_sets;
+    vector<pair<uint32_t, uint32_t>> m_nalus; // 复用，避免每帧分配
+};
+
+// 轨道的编码，取第一个带该轨道的tag
+uint32_t trackCodec(const TagIndex& index, uint8_t tag_type, uint8_t track_id) {
+    for (size_t i = 0; i < index.size(); ++i) {
+        if (index.m_type[i] != tag_type || (index.m_flags[i] & (TAG_FLAG_GARBAGE | TAG_FLAG_BAD_HEADER)))
+            continue;
+        uint32_t codec = 0, payload_offset = 0, payload_size = 0;
+        if (index.findTrack(i, track_id, codec, payload_offset, payload_size) && codec != 0)
+            return codec;
+    }
+    return 0;
+}
+
+} // namespace
+
+QString ExtractReport::toString() const {
+    return QString("格式%1，轨道%2，写出%3帧，输出%4字节\n"
+                   "关键帧前插入参数集%5次，跳过%6个tag")
+        .arg(m_format)
+        .arg(m_track_id)
+        .arg(m_frames)
+        .arg(m_output_size)
+        .arg(m_parameter_sets)
+        .arg(m_skipped);
+}
+
+QString StreamExtractor::outputFormat(const TagIndex& index, TRACK track, uint8_t track_id) {
+    uint32_t codec = trackCodec(index, track == TRACK_VIDEO ? TAG_TYPE_VIDEO : TAG_TYPE_AUDIO, track_id);
+    switch (codec) {
+    case FOURCC_AVC1:
+        return track == TRACK_VIDEO ? "h264" : QString();
+    case FOURCC_HVC1:
+        return track == TRACK_VIDEO ? "h265" : QString();
+    case FOURCC_AAC:
+        return track == TRACK_AUDIO ? "aac" : QString();
+    case FOURCC_MP3:
+        return track == TRACK_AUDIO ? "mp3" : QString();
+    default:
+        return QString();
+    }
+}
+
+bool StreamExtractor::extract(const QString& source_path,
+                              const QString& target_path,
+                              const TagIndex& index,
+                              TRACK track,
+                              ExtractReport& report,
+                              uint8_t track_id) {
+    report = ExtractReport();
+    report.m_format = outputFormat(index, track, track_id);
+    report.m_track_id = track_id;
+    uint8_t tag_type = track == TRACK_VIDEO ? TAG_TYPE_VIDEO : TAG_TYPE_AUDIO;
+    uint32_t codec = trackCodec(index, tag_type, track_id);
+
+    QFile source(source_path);
+    QFile target(target_path);
+    uchar* mapped = nullptr;
+
+    try {
+        if (report.m_format.isEmpty()) {
+            throw QString("没有可导出的%1流，或编码%2不支持导出")
+                .arg(track == TRACK_VIDEO ? "视频" : "音频")
+                .arg(fourCCToString(codec));
+        }
+        if (!source.open(QIODevice::ReadOnly)) {
+            throw QString("打开源文件失败：%1").arg(source.errorString());
+        }
+        int64_t source_size = source.size();
+        mapped = source.map(0, source_size);
+        if (!mapped) {
+            throw QString("映射源文件失败：%1").arg(source.errorString());
+        }
+        if (!target.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            throw QString("创建输出文件失败：%1").arg(target.errorString());
+        }
+
+        BufferedWriter writer(target, WRITE_BUFFER_SIZE);
+        VideoGather video(writer, codec, report);
+        AdtsConfig adts;
+        bool has_adts = false;
+        QString config_error;
+
+        for (size_t i = 0; i < index.size(); ++i) {
+            if (index.m_type[i] != tag_type || (index.m_flags[i] & TAG_FLAG_GARBAGE))
+                continue;
+            uint32_t tag_codec = 0, payload_offset = 0, payload_size = 0;
+            bool bad_header = index.m_flags[i] & TAG_FLAG_BAD_HEADER;
+            if (!bad_header && !index.findTrack(i, track_id, tag_codec, payload_offset, payload_size))
+                continue; // 其他轨道的tag
+            if (bad_header || tag_codec != codec ||
+                index.m_offset[i] + 11 + index.m_data_size[i] > static_cast<uint64_t>(source_size)) {
+                ++report.m_skipped;
+                continue;
+            }
+
+            const uchar* payload = mapped + index.m_offset[i] + payload_offset;
+            bool sequence_header = index.m_flags[i] & TAG_FLAG_SEQUENCE_HEADER;
+            uint8_t packet_type = index.m_packet_type[i];
+
+            if (track == TRACK_VIDEO) {
+                if (sequence_header) {
+                    video.setSequenceHeader(payload, payload_size);
+                } else if (packet_type == VIDEO_PACKET_CODED_FRAMES || packet_type == VIDEO_PACKET_CODED_FRAMES_X) {
+                    video.writeFrame(payload, payload_size, index.m_flags[i] & TAG_FLAG_KEYFRAME);
+                }
+                continue;
+            }
+
+            if (codec == FOURCC_MP3) {
+                writer.write(payload, payload_size);
+                ++report.m_frames;
+                continue;
+            }
+
+            // AAC
+            if (sequence_header) {
+                has_adts = parseAudioSpecificConfig(payload, payload_size, adts, config_error);
+                if (!has_adts)
+                    throw config_error;
+                continue;
+            }
+            if (packet_type != AUDIO_PACKET_CODED_FRAMES || !has_adts || 7 + payload_size > MAX_ADTS_FRAME) {
+                ++report.m_skipped;
+                continue;
+            }
+            uchar header[7];
+            makeAdtsHeader(header, adts, payload_size);
+            writer.write(header, 7);
+            writer.write(payload, payload_size);
+            ++report.m_frames;
+        }
+
+        writer.flush();
+        report.m_output_size = writer.written();
+        target.close();
+        source.unmap(mapped);
+        mapped = nullptr;
+        source.close();
+
+        qCInfo(runLog) << QString("[flv-extract] event[finished] target[%1] format[%2] track[%3] frames[%4] size[%5] "
+                                  "parameter_sets[%6] skipped[%7]")
+                              .arg(target_path)
+                              .arg(report.m_format)
+                              .arg(report.m_track_id)
+                              .arg(report.m_frames)
+                              .arg(report.m_output_size)
+                              .arg(report.m_parameter_sets)
+                              .arg(report.m_skipped);
+        return true;
+    } catch (const QString& error) {
+        qCInfo(runLog) << QString("[flv-extract] event[failed] error[%1]").arg(error);
+        report.m_error = error;
+        if (mapped)
+            source.unmap(mapped);
+        if (target.isOpen()) {
+            target.close();
+            QFile::remove(target_path);
+        }
+        return false;
+    }
+}
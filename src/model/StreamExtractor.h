@@ -0,0 +1,54 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "TagIndex.h"
+#include <QString>
+#include <cstdint>
+
+using namespace std;
+
+/**
+ * @class ExtractReport
+ * @brief 导出结果统计
+ */
+struct ExtractReport {
+    QString m_format;              // 输出格式，见StreamExtractor::outputFormat
+    uint8_t m_track_id = 0;        // 导出的轨道
+    uint64_t m_frames = 0;         // 写出的帧数
+    uint64_t m_skipped = 0;        // 跳过的tag：codec不一致、扩展头解析失败、截断、负载不完整
+    uint64_t m_parameter_sets = 0; // 在关键帧前插入参数集的次数
+    uint64_t m_output_size = 0;
+    QString m_error;
+
+    QString toString() const;
+};
+
+/**
+ * @class StreamExtractor
+ * @brief 导出裸码流：H.264/HEVC转为Annex-B（关键帧前插入sequence header中的参数集），AAC加ADTS头，MP3原样输出
+ *
+ * 源文件映射后按tag顺序把负载直接拼接到大块输出缓冲，不经过FLVTag解析树；
+ * 多轨文件按轨道号导出，单轨包视为轨道0，不含该轨道的tag不参与
+ */
+class StreamExtractor {
+  public:
+    enum TRACK : uint8_t {
+        TRACK_VIDEO = 0,
+        TRACK_AUDIO
+    };
+
+    // 流的输出格式（h264/h265/aac/mp3，也用作扩展名），没有该流或codec不支持导出时返回空
+    static QString outputFormat(const TagIndex& index, TRACK track, uint8_t track_id = 0);
+
+    static bool extract(const QString& source_path,
+                        const QString& target_path,
+                        const TagIndex& index,
+                        TRACK track,
+                        ExtractReport& report,
+                        uint8_t track_id = 0);
+
+    static constexpr int64_t WRITE_BUFFER_SIZE = 16 * 1024 * 1024;
+};
@@ -0,0 +1,187 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "StreamValidator.h"
+#include "Parallel.h"
+#include "Utils.h"
+#include <algorithm>
+#include <mutex>
+
+// 需要先收到sequence header才能解码的编码
+static bool codecNeedsSequenceHeader(uint32_t codec) {
+    return codec != 0 && codec != FOURCC_MP3;
+}
+
+vector<ValidationIssue> StreamValidator::validate(const FLVHeader* header, const TagIndex& index) {
+    vector<ValidationIssue> issues;
+    validateHeader(header, index, issues);
+
+    // 逐tag检查按区间并行，各区间结果最后合并
+    mutex issues_mutex;
+    parallelFor(index.size(), [&](size_t begin, size_t end) {
+        vector<ValidationIssue> local;
+        validateRange(index, begin, end, local);
+
+        lock_guard<mutex> lock(issues_mutex);
+        issues.insert(issues.end(), make_move_iterator(local.begin()), make_move_iterator(local.end()));
+    });
+
+    validateSequenceHeaders(index, issues);
+
+    stable_sort(issues.begin(), issues.end(), [](const ValidationIssue& a, const ValidationIssue& b) {
+        return a.m_offset < b.m_offset;
+    });
+    return issues;
+}
+
+void StreamValidator::validateHeader(const FLVHeader* header, const TagIndex& index, vector<ValidationIssue>& issues) {
+    if (!header) {
+        return;
+    }
+
+    auto addIssue = [&](uint64_t offset, const QString& message) {
+        issues.push_back({-1, offset, ISSUE_HEADER, SEVERITY_ERROR, message});
+    };
+
+    uint32_t data_offset = static_cast<uint32_t>(get<double>(header->m_data_offset->value));
+    if (data_offset != 9) {
+        addIssue(5, QString("data_offset is %1, expected 9").arg(data_offset));
+    }
+
+    uint32_t previous_tag_size = static_cast<uint32_t>(get<double>(header->m_previous_tag_size->value));
+    if (previous_tag_size != 0) {
+        addIssue(9, QString("PreviousTagSize0 is %1, expected 0").arg(previous_tag_size));
+    }
+
+    // 文件末尾存在无法解析的数据
+    if (index.m_parsed_end < index.m_file_size) {
+        issues.push_back({-1,
+                          index.m_parsed_end,
+                          ISSUE_TRAILING_DATA,
+                          SEVERITY_ERROR,
+                          QString("%1 bytes after offset 0x%2 could not be parsed")
+                              .arg(index.m_file_size - index.m_parsed_end)
+                              .arg(index.m_parsed_end, 8, 16, QChar('0'))});
+    }
+}
+
+void StreamValidator::validateRange(const TagIndex& index, size_t begin, size_t end, vector<ValidationIssue>& issues) {
+    auto addIssue = [&](size_t i, uint8_t type, uint8_t severity, const QString& message) {
+        issues.push_back({static_cast<int64_t>(i), index.m_offset[i], type, severity, message});
+    };
+
+    // 区间起点之前同类流的最后一个时间戳
+    int64_t last_audio_ts = -1;
+    int64_t last_video_ts = -1;
+    for (size_t i = begin; i > 0 && (last_audio_ts < 0 || last_video_ts < 0); --i) {
+        if (index.m_type[i - 1] == TAG_TYPE_AUDIO && last_audio_ts < 0)
+            last_audio_ts = index.m_timestamp[i - 1];
+        else if (index.m_type[i - 1] == TAG_TYPE_VIDEO && last_video_ts < 0)
+            last_video_ts = index.m_timestamp[i - 1];
+    }
+
+    for (size_t i = begin; i < end; ++i) {
+        uint8_t type = index.m_type[i];
+
+        // 恢复模式跳过的数据段只报告一次，不做tag字段检查
+        if (index.m_flags[i] & TAG_FLAG_GARBAGE) {
+            addIssue(i,
+                     ISSUE_GARBAGE,
+                     SEVERITY_ERROR,
+                     QString("%1 bytes skipped during recovery").arg(index.m_data_size[i]));
+            continue;
+        }
+
+        // PreviousTagSize应等于11字节tag头加数据长度
+        uint32_t expected_size = 11 + index.m_data_size[i];
+        if (index.m_prev_tag_size[i] != expected_size) {
+            addIssue(i,
+                     ISSUE_PREVIOUS_TAG_SIZE,
+                     SEVERITY_ERROR,
+                     QString("PreviousTagSize is %1, expected %2").arg(index.m_prev_tag_size[i]).arg(expected_size));
+        }
+
+        // tag应当紧接上一个tag
+        uint64_t expected_offset = (i == 0) ? FLV_HEADER_SIZE : index.m_offset[i - 1] + index.tagSpan(i - 1);
+        if (index.m_offset[i] != expected_offset) {
+            addIssue(i,
+                     ISSUE_SIZE_OVERFLOW,
+                     SEVERITY_ERROR,
+                     QString("tag starts at 0x%1, expected 0x%2")
+                         .arg(index.m_offset[i], 8, 16, QChar('0'))
+                         .arg(expected_offset, 8, 16, QChar('0')));
+        }
+
+        if (index.m_offset[i] + index.tagSpan(i) > index.m_file_size) {
+            addIssue(i,
+                     ISSUE_SIZE_OVERFLOW,
+                     SEVERITY_ERROR,
+                     QString("tag ends at 0x%1, beyond file size 0x%2")
+                         .arg(index.m_offset[i] + index.tagSpan(i), 8, 16, QChar('0'))
+                         .arg(index.m_file_size, 8, 16, QChar('0')));
+        }
+
+        if (index.m_stream_id[i] != 0) {
+            addIssue(i, ISSUE_STREAM_ID, SEVERITY_WARNING, QString("stream_id is %1, expected 0").arg(index.m_stream_id[i]));
+        }
+
+        if (type != TAG_TYPE_AUDIO && type != TAG_TYPE_VIDEO && type != TAG_TYPE_SCRIPT) {
+            addIssue(i, ISSUE_TAG_TYPE, SEVERITY_ERROR, QString("unknown tag type %1").arg(type));
+            continue;
+        }
+
+        if (index.m_flags[i] & TAG_FLAG_BAD_HEADER) {
+            addIssue(i, ISSUE_BAD_HEADER, SEVERITY_ERROR, QString("enhanced rtmp ex-header could not be parsed"));
+        }
+
+        // 同类流时间戳单调不减
+        int64_t& last_ts = (type == TAG_TYPE_AUDIO) ? last_audio_ts : last_video_ts;
+        if (type != TAG_TYPE_SCRIPT) {
+            if (last_ts >= 0 && index.m_timestamp[i] < last_ts) {
+                addIssue(i,
+                         ISSUE_TIMESTAMP_BACKWARD,
+                         SEVERITY_WARNING,
+                         QString("timestamp %1 < previous %2").arg(index.m_timestamp[i]).arg(last_ts));
+            }
+            last_ts = index.m_timestamp[i];
+        }
+
+        if (type == TAG_TYPE_VIDEO) {
+            int32_t cts = index.m_cts[i];
+            if (cts < 0 || cts > MAX_SANE_CTS) {
+                addIssue(i, ISSUE_CTS, SEVERITY_WARNING, QString("cts %1 out of range [0, %2]").arg(cts).arg(MAX_SANE_CTS));
+            } else if (cts != 0 && (index.m_flags[i] & TAG_FLAG_SEQUENCE_HEADER)) {
+                addIssue(i, ISSUE_CTS, SEVERITY_WARNING, QString("sequence header has non-zero cts %1").arg(cts));
+            }
+        }
+    }
+}
+
+void StreamValidator::validateSequenceHeaders(const TagIndex& index, vector<ValidationIssue>& issues) {
+    // 每种流只报告第一个出现在sequence header之前的媒体tag
+    bool seen_header[2] = {false, false};
+    bool reported[2] = {false, false};
+    for (size_t i = 0; i < index.size() && !(reported[0] && reported[1]); ++i) {
+        uint8_t type = index.m_type[i];
+        if (type != TAG_TYPE_AUDIO && type != TAG_TYPE_VIDEO)
+            continue;
+
+        int stream = (type == TAG_TYPE_VIDEO) ? 1 : 0;
+        if (index.m_flags[i] & TAG_FLAG_SEQUENCE_HEADER) {
+            seen_header[stream] = true;
+            continue;
+        }
+        if (seen_header[stream] || reported[stream] || !codecNeedsSequenceHeader(index.m_codec[i]))
+            continue;
+
+        reported[stream] = true;
+        issues.push_back({static_cast<int64_t>(i),
+                          index.m_offset[i],
+                          ISSUE_SEQUENCE_HEADER_MISSING,
+                          SEVERITY_ERROR,
+                          QString("%1 %2 tag before any sequence header")
+                              .arg(fourCCToString(index.m_codec[i]))
+                              .arg(type == TAG_TYPE_VIDEO ? "video" : "audio")});
+    }
+}
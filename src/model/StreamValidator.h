@@ -0,0 +1,99 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "TagIndex.h"
+#include <QString>
+#include <vector>
+
+using namespace std;
+
+// 校验问题类型
+enum VALIDATION_ISSUE_TYPE : uint8_t {
+    ISSUE_HEADER = 0,
+    ISSUE_PREVIOUS_TAG_SIZE,
+    ISSUE_TIMESTAMP_BACKWARD,
+    ISSUE_CTS,
+    ISSUE_SEQUENCE_HEADER_MISSING,
+    ISSUE_STREAM_ID,
+    ISSUE_TAG_TYPE,
+    ISSUE_SIZE_OVERFLOW,
+    ISSUE_TRAILING_DATA,
+    ISSUE_GARBAGE,
+    ISSUE_TIMESTAMP_GAP,
+    ISSUE_AV_DRIFT,
+    ISSUE_DUPLICATE,
+    ISSUE_BAD_HEADER
+};
+
+// 问题严重程度
+enum VALIDATION_SEVERITY : uint8_t {
+    SEVERITY_WARNING = 0,
+    SEVERITY_ERROR = 1
+};
+
+inline const char* getIssueType(uint8_t type) {
+    switch (type) {
+    case ISSUE_HEADER:
+        return "flv header";
+    case ISSUE_PREVIOUS_TAG_SIZE:
+        return "previous tag size";
+    case ISSUE_TIMESTAMP_BACKWARD:
+        return "timestamp backward";
+    case ISSUE_CTS:
+        return "cts";
+    case ISSUE_SEQUENCE_HEADER_MISSING:
+        return "sequence header missing";
+    case ISSUE_STREAM_ID:
+        return "stream id";
+    case ISSUE_TAG_TYPE:
+        return "tag type";
+    case ISSUE_SIZE_OVERFLOW:
+        return "size overflow";
+    case ISSUE_TRAILING_DATA:
+        return "trailing data";
+    case ISSUE_GARBAGE:
+        return "garbage";
+    case ISSUE_TIMESTAMP_GAP:
+        return "timestamp gap";
+    case ISSUE_AV_DRIFT:
+        return "a/v drift";
+    case ISSUE_DUPLICATE:
+        return "duplicate";
+    case ISSUE_BAD_HEADER:
+        return "bad ex-header";
+    default:
+        return "unknown";
+    }
+}
+
+/**
+ * @class ValidationIssue
+ * @brief 单条校验结果，tag_index为-1表示文件级问题
+ */
+struct ValidationIssue {
+    int64_t m_tag_index = -1;
+    uint64_t m_offset = 0;
+    uint8_t m_type = ISSUE_HEADER;
+    uint8_t m_severity = SEVERITY_WARNING;
+    QString m_message;
+};
+
+/**
+ * @class StreamValidator
+ * @brief 基于tag索引的整文件校验，逐tag检查可并行执行
+ */
+class StreamValidator {
+  public:
+    // CTS超过该值视为异常(ms)
+    static constexpr int32_t MAX_SANE_CTS = 10000;
+
+    static vector<ValidationIssue> validate(const FLVHeader* header, const TagIndex& index);
+
+  private:
+    static void validateHeader(const FLVHeader* header, const TagIndex& index, vector<ValidationIssue>& issues);
+    static void validateRange(const TagIndex& index, size_t begin, size_t end, vector<ValidationIssue>& issues);
+    static void validateSequenceHeaders(const TagIndex& index, vector<ValidationIssue>& issues);
+};
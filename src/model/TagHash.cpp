@@ -0,0 +1,164 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "TagHash.h"
+#include "Hash.h"
+#include "Parallel.h"
+#include <QFile>
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+
+// 太短的负载（如AVC end of sequence）本来就会重复，不参与比较
+constexpr uint32_t MIN_DUPLICATE_PAYLOAD = 16;
+
+uint64_t timedKey(uint64_t hash, uint32_t timestamp) {
+    return hash ^ (static_cast<uint64_t>(timestamp) * 0x9E3779B97F4A7C15ULL);
+}
+
+// 不同轨道的相同负载不算重复
+uint64_t trackKey(uint64_t hash, uint8_t track_id) {
+    return hash ^ ((static_cast<uint64_t>(track_id) + 1) * 0xC2B2AE3D27D4EB4FULL);
+}
+
+} // namespace
+
+vector<uint64_t> TagHash::hashPayloads(const uchar* data, int64_t size, const TagIndex& index) {
+    vector<uint64_t> hashes(index.size(), 0);
+
+    // 按tag切分，单个tag负载通常为几KB到几百KB，每个区间至少256个tag
+    parallelFor(
+        index.size(),
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                // 垃圾段没有tag头，整段参与计算
+                int64_t start = static_cast<int64_t>(index.m_offset[i]);
+                if (!(index.m_flags[i] & TAG_FLAG_GARBAGE))
+                    start += 11;
+                int64_t stop = min<int64_t>(size, start + index.m_data_size[i]);
+                hashes[i] = start < stop ? xxhash64(data + start, static_cast<size_t>(stop - start)) : xxhash64(nullptr, 0);
+            }
+        },
+        256);
+    return hashes;
+}
+
+vector<uint64_t> TagHash::hashTracks(const uchar* data, int64_t size, const TagIndex& index) {
+    vector<uint64_t> hashes(index.m_track_id.size(), 0);
+    parallelFor(
+        index.size(),
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                for (size_t k = index.trackBegin(i); k < index.trackEnd(i); ++k) {
+                    int64_t start = static_cast<int64_t>(index.m_offset[i]) + index.m_track_payload_offset[k];
+                    int64_t stop = min<int64_t>(size, start + index.m_track_payload_size[k]);
+                    hashes[k] = start < stop ? xxhash64(data + start, static_cast<size_t>(stop - start))
+                                             : xxhash64(nullptr, 0);
+                }
+            }
+        },
+        256);
+    return hashes;
+}
+
+vector<uint64_t> TagHash::hashFile(const QString& path, const TagIndex& index, vector<uint64_t>* track_hashes) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw QString("打开文件失败：%1").arg(file.errorString());
+    }
+
+    int64_t size = file.size();
+    if (size == 0) {
+        if (track_hashes)
+            track_hashes->assign(index.m_track_id.size(), xxhash64(nullptr, 0));
+        return vector<uint64_t>(index.size(), xxhash64(nullptr, 0));
+    }
+    uchar* mapped = file.map(0, size);
+    if (!mapped) {
+        throw QString("映射文件失败：%1").arg(file.errorString());
+    }
+
+    vector<uint64_t> hashes = hashPayloads(mapped, size, index);
+    if (track_hashes)
+        *track_hashes = hashTracks(mapped, size, index);
+    file.unmap(mapped);
+    return hashes;
+}
+
+vector<ValidationIssue> TagHash::findDuplicates(TagIndex& index) {
+    vector<ValidationIssue> issues;
+    if (!index.hasPayloadHash())
+        return issues;
+
+    unordered_map<uint64_t, size_t> video_frames; // 哈希 -> 第一次出现的tag
+    unordered_map<uint64_t, size_t> audio_frames; // 哈希+时间戳 -> 第一次出现的tag
+    int64_t last_header[2] = {-1, -1};            // 音频/视频上一个sequence header
+    video_frames.reserve(index.size());
+
+    auto addIssue = [&](size_t i, size_t first, const QString& what) {
+        index.m_flags[i] |= TAG_FLAG_DUPLICATE;
+        issues.push_back({static_cast<int64_t>(i),
+                          index.m_offset[i],
+                          ISSUE_DUPLICATE,
+                          SEVERITY_WARNING,
+                          QString("%1 identical to tag #%2 at 0x%3")
+                              .arg(what)
+                              .arg(first)
+                              .arg(index.m_offset[first], 8, 16, QChar('0'))});
+    };
+
+    for (size_t i = 0; i < index.size(); ++i) {
+        index.m_flags[i] &= ~TAG_FLAG_DUPLICATE;
+        uint8_t type = index.m_type[i];
+        if ((index.m_flags[i] & TAG_FLAG_GARBAGE) || (type != TAG_TYPE_AUDIO && type != TAG_TYPE_VIDEO))
+            continue;
+
+        uint64_t hash = index.m_payload_hash[i];
+        int stream = (type == TAG_TYPE_VIDEO) ? 1 : 0;
+        if (index.m_flags[i] & TAG_FLAG_SEQUENCE_HEADER) {
+            int64_t last = last_header[stream];
+            if (last >= 0 && index.m_payload_hash[last] == hash && index.m_codec[last] == index.m_codec[i])
+                addIssue(i, last, "repeated sequence header");
+            last_header[stream] = i;
+            continue;
+        }
+        if (index.m_data_size[i] < MIN_DUPLICATE_PAYLOAD)
+            continue;
+
+        // 多轨包逐条轨道查找，一个tag只报告一次
+        bool multitrack = (index.m_flags[i] & TAG_FLAG_MULTITRACK) && index.trackBegin(i) < index.trackEnd(i);
+        if (multitrack && index.hasTrackHash()) {
+            bool reported = false;
+            for (size_t k = index.trackBegin(i); k < index.trackEnd(i); ++k) {
+                if (index.m_track_payload_size[k] < MIN_DUPLICATE_PAYLOAD)
+                    continue;
+                uint64_t key = trackKey(index.m_track_hash[k], index.m_track_id[k]);
+                auto& frames = type == TAG_TYPE_VIDEO ? video_frames : audio_frames;
+                auto [it, inserted] =
+                    frames.try_emplace(type == TAG_TYPE_VIDEO ? key : timedKey(key, index.m_timestamp[i]), i);
+                if (!inserted && !reported) {
+                    addIssue(i,
+                             it->second,
+                             QString("%1 on track %2")
+                                 .arg(type == TAG_TYPE_VIDEO ? "video frame" : "re-sent audio packet")
+                                 .arg(index.m_track_id[k]));
+                    reported = true;
+                }
+            }
+            continue;
+        }
+
+        if (type == TAG_TYPE_VIDEO) {
+            auto [it, inserted] = video_frames.try_emplace(hash, i);
+            if (!inserted)
+                addIssue(i, it->second, "video frame");
+        } else {
+            auto [it, inserted] = audio_frames.try_emplace(timedKey(hash, index.m_timestamp[i]), i);
+            if (!inserted)
+                addIssue(i, it->second, "re-sent audio packet");
+        }
+    }
+    return issues;
+}
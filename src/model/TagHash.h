@@ -0,0 +1,39 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "StreamValidator.h"
+#include "TagIndex.h"
+#include <QString>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @class TagHash
+ * @brief tag负载（不含11字节tag头和PreviousTagSize）的XXH64哈希，按tag并行计算
+ */
+class TagHash {
+  public:
+    // data为映射的整个文件；超出文件的部分按截断后的负载计算
+    static vector<uint64_t> hashPayloads(const uchar* data, int64_t size, const TagIndex& index);
+    // 多轨包中每条轨道负载的哈希，与index.m_track_id一一对应
+    static vector<uint64_t> hashTracks(const uchar* data, int64_t size, const TagIndex& index);
+
+    // 映射文件后计算，track_hashes不为空时同时计算轨道哈希，失败时抛出QString
+    static vector<uint64_t>
+    hashFile(const QString& path, const TagIndex& index, vector<uint64_t>* track_hashes = nullptr);
+
+    /**
+     * @brief 根据index.m_payload_hash查找重复的tag，设置TAG_FLAG_DUPLICATE并返回对应的问题
+     *
+     * - sequence header：与同类流上一个sequence header完全相同
+     * - 视频帧：负载与之前任一视频帧相同
+     * - 音频帧：负载和时间戳都与之前的音频帧相同，静音AAC帧内容本来就会重复
+     * - 多轨包：计算了轨道哈希时按轨道比较，任一轨道与之前同一轨道的负载相同即为重复
+     */
+    static vector<ValidationIssue> findDuplicates(TagIndex& index);
+};
@@ -0,0 +1,219 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "TagIndex.h"
+#include "Parallel.h"
+#include "Utils.h"
+#include <algorithm>
+#include <array>
+
+// 多轨包的轨道列表，单轨包和扩展头解析失败的tag返回nullptr
+static const vector<AVTrackInfo>* tagTracks(const FLVTag& tag) {
+    if (tag.m_is_garbage || tag.m_header_error)
+        return nullptr;
+    if (tag.v_info && tag.v_info->m_is_multitrack)
+        return &tag.v_info->m_tracks;
+    if (tag.a_info && tag.a_info->m_is_multitrack)
+        return &tag.a_info->m_tracks;
+    return nullptr;
+}
+
+void TagIndex::build(const vector<unique_ptr<FLVTag>>& tags, uint64_t file_size, uint64_t parsed_end) {
+    size_t count = tags.size();
+    m_offset.resize(count);
+    m_data_size.resize(count);
+    m_timestamp.resize(count);
+    m_cts.resize(count);
+    m_prev_tag_size.resize(count);
+    m_stream_id.resize(count);
+    m_codec.resize(count);
+    m_type.resize(count);
+    m_frame_type.resize(count);
+    m_packet_type.resize(count);
+    m_payload_offset.resize(count);
+    m_payload_size.resize(count);
+    m_flags.resize(count);
+    m_payload_hash.clear(); // tag变化后需重新计算
+    m_file_size = file_size;
+    m_parsed_end = parsed_end;
+
+    // 先统计轨道数，确定每个tag在轨道列中的起点，之后各tag可以并行填写
+    m_track_first.resize(count + 1);
+    uint32_t track_count = 0;
+    for (size_t i = 0; i < count; ++i) {
+        m_track_first[i] = track_count;
+        if (const vector<AVTrackInfo>* tracks = tagTracks(*tags[i]))
+            track_count += static_cast<uint32_t>(tracks->size());
+    }
+    m_track_first[count] = track_count;
+    m_track_id.resize(track_count);
+    m_track_codec.resize(track_count);
+    m_track_cts.resize(track_count);
+    m_track_payload_offset.resize(track_count);
+    m_track_payload_size.resize(track_count);
+    m_track_hash.clear();
+
+    parallelFor(count, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const FLVTag& tag = *tags[i];
+            m_offset[i] = tag.m_offset;
+            m_data_size[i] = static_cast<uint32_t>(get<double>(tag.m_tag_size->value));
+            m_timestamp[i] = static_cast<uint32_t>(get<double>(tag.m_timestamp->value));
+            m_prev_tag_size[i] = static_cast<uint32_t>(get<double>(tag.m_previous_tag_size->value));
+            m_stream_id[i] = static_cast<uint32_t>(get<double>(tag.m_stream_id->value));
+            m_type[i] = static_cast<uint8_t>(get<double>(tag.m_tag_type->value));
+
+            int32_t cts = 0;
+            uint32_t codec = 0;
+            uint8_t frame_type = 0;
+            uint8_t packet_type = TAG_PACKET_TYPE_NONE;
+            uint32_t payload_offset = 11;
+            uint32_t payload_size = m_data_size[i];
+            uint8_t flags = 0;
+            if (tag.m_is_garbage) {
+                flags |= TAG_FLAG_GARBAGE;
+                payload_offset = 0;
+            } else if (tag.m_header_error) {
+                // 扩展头中的字段不可信，不能当作正常的音视频tag参与统计和导出
+                flags |= TAG_FLAG_EX_HEADER | TAG_FLAG_BAD_HEADER;
+            } else if (tag.v_info) {
+                cts = tag.v_info->cts();
+                codec = tag.v_info->fourCC();
+                frame_type = tag.v_info->frameType();
+                if (tag.v_info->m_is_ex_header || codec != 0)
+                    packet_type = tag.v_info->packetType();
+                payload_offset = tag.v_info->m_payload_offset;
+                payload_size = tag.v_info->m_payload_size;
+                if (tag.v_info->isKeyFrame())
+                    flags |= TAG_FLAG_KEYFRAME;
+                if (tag.v_info->isSequenceHeader())
+                    flags |= TAG_FLAG_SEQUENCE_HEADER;
+                if (tag.v_info->m_is_ex_header)
+                    flags |= TAG_FLAG_EX_HEADER;
+                if (tag.v_info->m_is_multitrack)
+                    flags |= TAG_FLAG_MULTITRACK;
+            } else if (tag.a_info) {
+                codec = tag.a_info->fourCC();
+                if (tag.a_info->m_is_ex_header || tag.a_info->soundFormat() == AAC)
+                    packet_type = tag.a_info->packetType();
+                payload_offset = tag.a_info->m_payload_offset;
+                payload_size = tag.a_info->m_payload_size;
+                if (tag.a_info->isSequenceHeader())
+                    flags |= TAG_FLAG_SEQUENCE_HEADER;
+                if (tag.a_info->m_is_ex_header)
+                    flags |= TAG_FLAG_EX_HEADER;
+                if (tag.a_info->m_is_multitrack)
+                    flags |= TAG_FLAG_MULTITRACK;
+            }
+            m_cts[i] = cts;
+            m_codec[i] = codec;
+            m_frame_type[i] = frame_type;
+            m_packet_type[i] = packet_type;
+            m_payload_offset[i] = payload_offset;
+            m_payload_size[i] = payload_size;
+            m_flags[i] = flags;
+
+            if (const vector<AVTrackInfo>* tracks = tagTracks(tag)) {
+                size_t k = m_track_first[i];
+                for (const AVTrackInfo& track : *tracks) {
+                    m_track_id[k] = track.trackId();
+                    m_track_codec[k] = track.fourCC();
+                    m_track_cts[k] = track.cts();
+                    m_track_payload_offset[k] = track.m_payload_offset;
+                    m_track_payload_size[k] = track.m_payload_size;
+                    ++k;
+                }
+            }
+        }
+    });
+}
+
+bool TagIndex::findTrack(size_t i,
+                         uint8_t track_id,
+                         uint32_t& codec,
+                         uint32_t& payload_offset,
+                         uint32_t& payload_size) const {
+    if (!(m_flags[i] & TAG_FLAG_MULTITRACK)) {
+        if (track_id != 0)
+            return false;
+        codec = m_codec[i];
+        payload_offset = m_payload_offset[i];
+        payload_size = m_payload_size[i];
+        return true;
+    }
+
+    for (size_t k = trackBegin(i); k < trackEnd(i); ++k) {
+        if (m_track_id[k] == track_id) {
+            codec = m_track_codec[k];
+            payload_offset = m_track_payload_offset[k];
+            payload_size = m_track_payload_size[k];
+            return true;
+        }
+    }
+    return false;
+}
+
+vector<uint8_t> TagIndex::trackIds(uint8_t tag_type) const {
+    array<bool, 256> seen = {};
+    for (size_t i = 0; i < size(); ++i) {
+        if (m_type[i] != tag_type || (m_flags[i] & (TAG_FLAG_GARBAGE | TAG_FLAG_BAD_HEADER)))
+            continue;
+        if (!(m_flags[i] & TAG_FLAG_MULTITRACK)) {
+            seen[0] = true;
+            continue;
+        }
+        for (size_t k = trackBegin(i); k < trackEnd(i); ++k)
+            seen[m_track_id[k]] = true;
+    }
+
+    vector<uint8_t> ids;
+    for (size_t id = 0; id < seen.size(); ++id) {
+        if (seen[id])
+            ids.push_back(static_cast<uint8_t>(id));
+    }
+    return ids;
+}
+
+void TagIndex::scanHeaders(const uchar* data, uint64_t size) {
+    *this = TagIndex();
+    m_track_first.push_back(0);
+    m_file_size = size;
+    m_parsed_end = min<uint64_t>(size, FLV_HEADER_SIZE);
+
+    uint64_t pos = m_parsed_end;
+    while (pos + 11 + 4 <= size) {
+        const uchar* header = data + pos;
+        uint32_t data_size = bigend_ctou24(header + 1);
+        uint64_t end = pos + 11 + data_size;
+        if (end + 4 > size)
+            break;
+
+        m_offset.push_back(pos);
+        m_data_size.push_back(data_size);
+        m_timestamp.push_back(bigend_ctou24(header + 4) | (static_cast<uint32_t>(header[7]) << 24));
+        m_cts.push_back(0);
+        m_prev_tag_size.push_back(bigend_ctou32(data + end));
+        m_stream_id.push_back(bigend_ctou24(header + 8));
+        m_codec.push_back(0);
+        m_type.push_back(header[0]);
+        m_frame_type.push_back(0);
+        m_packet_type.push_back(TAG_PACKET_TYPE_NONE);
+        m_payload_offset.push_back(11);
+        m_payload_size.push_back(data_size);
+        m_flags.push_back(0);
+        m_track_first.push_back(0);
+
+        pos = end + 4;
+        m_parsed_end = pos;
+    }
+}
+
+uint64_t TagIndex::memoryUsage() const {
+    auto bytes = [](const auto& column) -> uint64_t { return column.capacity() * sizeof(column[0]); };
+    return bytes(m_offset) + bytes(m_data_size) + bytes(m_timestamp) + bytes(m_cts) + bytes(m_prev_tag_size) +
+           bytes(m_stream_id) + bytes(m_codec) + bytes(m_type) + bytes(m_frame_type) + bytes(m_packet_type) +
+           bytes(m_payload_offset) + bytes(m_payload_size) + bytes(m_flags) + bytes(m_payload_hash) +
+           bytes(m_track_first) + bytes(m_track_id) + bytes(m_track_codec) + bytes(m_track_cts) +
+           bytes(m_track_payload_offset) + bytes(m_track_payload_size) + bytes(m_track_hash);
+}
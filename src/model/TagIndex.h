@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "TagInfo.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+// tag索引中的标志位
+enum TAG_INDEX_FLAG : uint8_t {
+    TAG_FLAG_KEYFRAME = 0x01,
+    TAG_FLAG_SEQUENCE_HEADER = 0x02,
+    TAG_FLAG_EX_HEADER = 0x04,
+    TAG_FLAG_MULTITRACK = 0x08,
+    TAG_FLAG_GARBAGE = 0x10,   // 恢复模式跳过的数据段，m_data_size为整段长度
+    TAG_FLAG_DUPLICATE = 0x20, // 负载与之前的tag重复，计算哈希后才会设置
+    TAG_FLAG_BAD_HEADER = 0x40 // 扩展头解析失败，codec、帧类型等列未填写，负载按整个tag数据计
+};
+
+constexpr uint8_t TAG_PACKET_TYPE_NONE = 0xFF;
+
+/**
+ * @class TagIndex
+ * @brief 列式tag索引，每列一个连续数组，供校验、统计等批量计算使用
+ *
+ * 多轨包的各条轨道另存在m_track_*列中，按tag顺序连续存放，
+ * tag i的轨道为[trackBegin(i), trackEnd(i))；单轨包没有轨道项，视为只有轨道0
+ */
+struct TagIndex {
+    vector<uint64_t> m_offset;        // tag在文件中的起始偏移
+    vector<uint32_t> m_data_size;     // tag数据长度（tag头中的DataSize）
+    vector<uint32_t> m_timestamp;     // 时间戳(ms)，即DTS
+    vector<int32_t> m_cts;            // 视频CTS(ms)
+    vector<uint32_t> m_prev_tag_size; // tag之后的PreviousTagSize
+    vector<uint32_t> m_stream_id;
+    vector<uint32_t> m_codec; // FourCC，传统codec id已映射
+    vector<uint8_t> m_type;   // TAG_TYPE
+    vector<uint8_t> m_frame_type;
+    vector<uint8_t> m_packet_type; // 归一化的packet type（见VIDEO/AUDIO_PACKET_TYPE），没有该字段的codec为0xFF
+    vector<uint32_t> m_payload_offset; // 编码负载相对tag起始的偏移（含11字节tag头），多轨包为第一条轨道
+    vector<uint32_t> m_payload_size;
+    vector<uint8_t> m_flags;         // TAG_INDEX_FLAG
+    vector<uint64_t> m_payload_hash; // 负载的XXH64，按需计算，未计算时为空
+
+    // 多轨包的轨道列
+    vector<uint32_t> m_track_first; // 每个tag第一条轨道的下标，共size() + 1项，最后一项为轨道总数
+    vector<uint8_t> m_track_id;
+    vector<uint32_t> m_track_codec; // FourCC
+    vector<int32_t> m_track_cts;
+    vector<uint32_t> m_track_payload_offset; // 相对tag起始的偏移（含11字节tag头）
+    vector<uint32_t> m_track_payload_size;
+    vector<uint64_t> m_track_hash; // 轨道负载的XXH64，与m_payload_hash一起计算，未计算时为空
+
+    uint64_t m_file_size = 0;
+    uint64_t m_parsed_end = 0; // 解析停止的位置，小于文件大小时说明后续数据未能解析
+
+    size_t size() const {
+        return m_offset.size();
+    }
+
+    bool hasPayloadHash() const {
+        return !m_offset.empty() && m_payload_hash.size() == m_offset.size();
+    }
+
+    bool hasTrackHash() const {
+        return hasPayloadHash() && m_track_hash.size() == m_track_id.size();
+    }
+
+    size_t trackBegin(size_t i) const {
+        return m_track_first.empty() ? 0 : m_track_first[i];
+    }
+    size_t trackEnd(size_t i) const {
+        return m_track_first.empty() ? 0 : m_track_first[i + 1];
+    }
+
+    // tag i中轨道track_id的codec和负载位置，单轨包只有轨道0；没有该轨道时返回false
+    bool findTrack(size_t i, uint8_t track_id, uint32_t& codec, uint32_t& payload_offset, uint32_t& payload_size) const;
+
+    // tag_type类型的tag中出现过的轨道号，升序
+    vector<uint8_t> trackIds(uint8_t tag_type) const;
+
+    // 每个tag在文件中占用的字节数（11字节头 + 数据 + 4字节PreviousTagSize），垃圾段为其原始长度
+    uint64_t tagSpan(size_t i) const {
+        if (m_flags[i] & TAG_FLAG_GARBAGE)
+            return m_data_size[i];
+        return 11 + static_cast<uint64_t>(m_data_size[i]) + 4;
+    }
+
+    void build(const vector<unique_ptr<FLVTag>>& tags, uint64_t file_size, uint64_t parsed_end);
+
+    /**
+     * @brief 只遍历tag头建立索引，不创建FLVTag也不读取负载
+     *
+     * data为映射的整个文件（含FLV文件头），遇到超出文件的tag时停止；
+     * 只填充tag头中的字段，codec、帧类型等列取默认值，负载按整个tag数据计，没有轨道项
+     */
+    void scanHeaders(const uchar* data, uint64_t size);
+
+    // 各列占用的字节数
+    uint64_t memoryUsage() const;
+};
@@ -4,10 +4,13 @@
 
 #include "taginfo.h"
 #include "Log.h"
+#include "MemoryBudget.h"
+#include "Trace.h"
 #include "Utils.h"
 #include <QBuffer>
 #include <QMessageBox>
 #include <QSize>
+#include <iterator>
 #include <vector>
 
 // 解析AMF字符串
@@ -79,9 +82,9 @@ void DataTagInfo::parseAMFObjectOrArray(QDataStream& stream, MetadataItem& item)
         // 根据类型解析值
         switch (property_value) {
         case AMF_NUMBER: {
-            printLogWithPos(QtDebugMsg,
-                            stream,
-                            QString("tag[script] amf-info[%1,%2]").arg(property_name).arg((int) property_value));
+            LOG_WITH_POS(QtDebugMsg,
+                         stream,
+                         QString("tag[script] amf-info[%1,%2]").arg(property_name).arg((int) property_value));
 
             double value = parseAMFNumber(stream);
             item.obj_value.emplace_back(
@@ -90,9 +93,9 @@ void DataTagInfo::parseAMFObjectOrArray(QDataStream& stream, MetadataItem& item)
             break;
         }
         case AMF_BOOLEAN: {
-            printLogWithPos(QtDebugMsg,
-                            stream,
-                            QString("tag[script] amf-info[%1,%2]").arg(property_name).arg((int) property_value));
+            LOG_WITH_POS(QtDebugMsg,
+                         stream,
+                         QString("tag[script] amf-info[%1,%2]").arg(property_name).arg((int) property_value));
 
             bool value = parseAMFBoolean(stream);
             item.obj_value.emplace_back(
@@ -101,9 +104,9 @@ void DataTagInfo::parseAMFObjectOrArray(QDataStream& stream, MetadataItem& item)
             break;
         }
         case AMF_STRING: {
-            printLogWithPos(QtDebugMsg,
-                            stream,
-                            QString("tag[script] amf-info[%1,%2]").arg(property_name).arg((int) property_value));
+            LOG_WITH_POS(QtDebugMsg,
+                         stream,
+                         QString("tag[script] amf-info[%1,%2]").arg(property_name).arg((int) property_value));
 
             QString value = parseAMFString(stream);
             item.obj_value.emplace_back(
@@ -115,9 +118,9 @@ void DataTagInfo::parseAMFObjectOrArray(QDataStream& stream, MetadataItem& item)
         case AMF_ECMA_ARRAY:
         case AMF_STRICT_ARRAY: {
             // 递归解析对象
-            printLogWithPos(QtDebugMsg,
-                            stream,
-                            QString("tag[script] amf-info[%1,%2]").arg(property_name).arg((int) property_value));
+            LOG_WITH_POS(QtDebugMsg,
+                         stream,
+                         QString("tag[script] amf-info[%1,%2]").arg(property_name).arg((int) property_value));
 
             MetadataItem subItem(property_value, property_name, startPos, 0);
             item.obj_value.emplace_back(move(subItem));
@@ -127,9 +130,9 @@ void DataTagInfo::parseAMFObjectOrArray(QDataStream& stream, MetadataItem& item)
         }
         default: {
             // 对于其他类型，简单跳过
-            printLogWithPos(QtDebugMsg,
-                            stream,
-                            QString("tag[script] amf-info[%1,%2]").arg(property_name).arg((int) property_value));
+            LOG_WITH_POS(QtDebugMsg,
+                         stream,
+                         QString("tag[script] amf-info[%1,%2]").arg(property_name).arg((int) property_value));
 
             item.obj_value.emplace_back(MetadataItem{property_value, property_name});
             item.obj_value.back().value = "null/undefined";
@@ -141,6 +144,7 @@ void DataTagInfo::parseAMFObjectOrArray(QDataStream& stream, MetadataItem& item)
 
 // 解析AMF数据
 bool DataTagInfo::ReadFromStream(QDataStream& stream) {
+    TRACE_SCOPE("amf_decode");
     try {
         int64_t startPos = stream.device()->pos();
 
@@ -150,7 +154,7 @@ bool DataTagInfo::ReadFromStream(QDataStream& stream) {
 
         if (type != AMF_STRING) {
             m_metadata_values.key = QString("error type: 0x%1").arg(type, 2, 16, QChar('0'));
-            printLogWithPos(
+            LOG_WITH_POS(
                 QtWarningMsg,
                 stream,
                 QString("tag[script] error[script tag should start with AMF_STRING] error-type[%1]").arg((int) type));
@@ -167,15 +171,15 @@ bool DataTagInfo::ReadFromStream(QDataStream& stream) {
                 m_metadata_values.offset = startPos;
                 m_metadata_values.size = stream.device()->pos() - startPos;
             } else {
-                printLogWithPos(
+                LOG_WITH_POS(
                     QtWarningMsg, stream, QString("tag[script] unknown-type[%1]").arg((int) m_metadata_values.type));
                 return true;
             }
         }
     } catch (const exception& e) {
-        printLogWithPos(QtWarningMsg, stream, QString("tag[script] error[%1]").arg(e.what()));
+        LOG_WITH_POS(QtWarningMsg, stream, QString("tag[script] error[%1]").arg(e.what()));
     } catch (...) {
-        printLogWithPos(QtWarningMsg, stream, QString("tag[script] error[unknown]"));
+        LOG_WITH_POS(QtWarningMsg, stream, QString("tag[script] error[unknown]"));
     }
     return true;
 }
@@ -230,28 +234,387 @@ TreeItem* MetadataItem::toTreeObj() {
     }
 }
 
+// 字段显示格式：名称加原始数值
+template <const char* (*NAME)(uint8_t)>
+static QString labeled(double value) {
+    return QString("%1 (%2)").arg(NAME(static_cast<uint8_t>(value))).arg(value);
+}
+
+static QString formatFourCC(double value) {
+    uint32_t fourcc = static_cast<uint32_t>(value);
+    return QString("%1 (0x%2)").arg(fourCCToString(fourcc)).arg(fourcc, 8, 16, QChar('0'));
+}
+
+static QString formatTypeFlags(double value) {
+    int flags = static_cast<int>(value);
+    if ((flags & 0x05) == 0x05)
+        return QString("has audio and video (%1)").arg(value);
+    else if ((flags & 0x04) == 0x04)
+        return QString("has video (%1)").arg(value);
+    else if (flags & 0x01)
+        return QString("has audio (%1)").arg(value);
+    else
+        return QString("%1").arg(value);
+}
+
+// 字段表，下标见TagInfo.h中的各字段枚举，偏移相对文件头或tag起始
+static constexpr FieldDesc HEADER_FIELDS[] = {
+    {"signature", 0, 3, 0, 0, FIELD_ASCII},
+    {"version", 3, 1},
+    {"type_flags", 4, 1, 0, 0, FIELD_BIG_ENDIAN, false, formatTypeFlags},
+    {"data_offset", 5, 4},
+    {"previous_tag_size", 9, 4},
+};
+
+static constexpr FieldDesc TAG_FIELDS[] = {
+    {"tag_type", 0, 1, 0, 0, FIELD_BIG_ENDIAN, false, labeled<getFlvTagType>},
+    {"tag_size", 1, 3},
+    {"timestamp", 4, 4, 0, 0, FIELD_EXTENDED_TIMESTAMP},
+    {"stream_id", 8, 3},
+    {"previous_tag_size", 0, 4}, // 在tag数据之后，从字段起始处解码
+};
+
+static constexpr FieldDesc VIDEO_FIELDS[] = {
+    {"tag_type", 11, 1, 4, 4, FIELD_BIG_ENDIAN, false, labeled<getTagType>},
+    {"codec", 11, 1, 0, 4, FIELD_BIG_ENDIAN, false, labeled<getCodec>},
+    {"detail_type", 12, 1, 0, 0, FIELD_BIG_ENDIAN, false, labeled<getDetailType>},
+    {"cts", 13, 3, 0, 0, FIELD_BIG_ENDIAN, true},
+    {"packet_type", 11, 1, 0, 4, FIELD_BIG_ENDIAN, false, labeled<getVideoPacketType>},
+    {"fourcc", 12, 4, 0, 0, FIELD_BIG_ENDIAN, false, formatFourCC},
+    {"multitrack_type", 12, 1, 4, 4, FIELD_BIG_ENDIAN, false, labeled<getMultitrackType>},
+    {"timestamp_offset_nano", 13, 3},
+    {"video_command", 12, 1},
+};
+
+// Enhanced RTMP视频首字节：最高位为IsExHeader，之后3位为帧类型，只用于解码
+enum VIDEO_EX_FLAG {
+    VIDEO_EX_IS_EX_HEADER,
+    VIDEO_EX_FRAME_TYPE
+};
+static constexpr FieldDesc VIDEO_EX_FLAGS[] = {
+    {"is_ex_header", 11, 1, 7, 1},
+    {"tag_type", 11, 1, 4, 3},
+};
+
+static constexpr FieldDesc AUDIO_FIELDS[] = {
+    {"sound_format", 11, 1, 4, 4, FIELD_BIG_ENDIAN, false, labeled<getSoundFormat>},
+    {"sound_rate", 11, 1, 2, 2, FIELD_BIG_ENDIAN, false, labeled<getSoundRate>},
+    {"sound_size", 11, 1, 1, 1, FIELD_BIG_ENDIAN, false, labeled<getSoundSize>},
+    {"sound_type", 11, 1, 0, 1, FIELD_BIG_ENDIAN, false, labeled<getSoundType>},
+    {"detail_type", 12, 1, 0, 0, FIELD_BIG_ENDIAN, false, labeled<getAudioDetailType>},
+    {"packet_type", 11, 1, 0, 4, FIELD_BIG_ENDIAN, false, labeled<getAudioPacketType>},
+    {"fourcc", 12, 4, 0, 0, FIELD_BIG_ENDIAN, false, formatFourCC},
+    {"multitrack_type", 12, 1, 4, 4, FIELD_BIG_ENDIAN, false, labeled<getMultitrackType>},
+    {"timestamp_offset_nano", 13, 3},
+};
+
+// 多轨包中各轨道的字段位置都不固定
+static constexpr FieldDesc TRACK_FIELDS[] = {
+    {"track_id", 0, 1},
+    {"fourcc", 0, 4, 0, 0, FIELD_BIG_ENDIAN, false, formatFourCC},
+    {"track_size", 0, 3},
+    {"cts", 0, 3, 0, 0, FIELD_BIG_ENDIAN, true},
+};
+
+static_assert(size(HEADER_FIELDS) == HEADER_FIELD_COUNT, "HEADER_FIELDS mismatch");
+static_assert(size(TAG_FIELDS) == TAG_FIELD_COUNT, "TAG_FIELDS mismatch");
+static_assert(size(VIDEO_FIELDS) == VIDEO_FIELD_COUNT, "VIDEO_FIELDS mismatch");
+static_assert(size(AUDIO_FIELDS) == AUDIO_FIELD_COUNT, "AUDIO_FIELDS mismatch");
+static_assert(size(TRACK_FIELDS) == TRACK_FIELD_COUNT, "TRACK_FIELDS mismatch");
+static_assert(fieldEnd(HEADER_FIELDS[HEADER_FIELD_PREVIOUS_TAG_SIZE]) == FLV_HEADER_SIZE, "FLV header size");
+
+static constexpr int64_t TAG_HEADER_SIZE = fieldEnd(TAG_FIELDS[TAG_FIELD_STREAM_ID]);
+static constexpr int64_t PREVIOUS_TAG_SIZE_BYTES = TAG_FIELDS[TAG_FIELD_PREVIOUS_TAG_SIZE].m_size;
+
+static PropertyItem makeProperty(const FieldDesc& field, const QString& name) {
+    PropertyItem item(name,
+                      -static_cast<int64_t>(field.m_offset),
+                      field.m_size,
+                      field.m_encoding == FIELD_ASCII ? property_variant(string()) : property_variant(0.0));
+    if (field.m_formatter) {
+        item.toStringFunc = [format = field.m_formatter](PropertyItem& it) {
+            if (auto pd = std::get_if<double>(&it.value))
+                return format(*pd);
+            return QString();
+        };
+    }
+    return item;
+}
+
+// 按字段表一次分配全部字段，名称字符串每张表只构造一次，之后各字段共享
+template <const auto& SCHEMA, size_t... I>
+static auto buildFieldBlock(index_sequence<I...>) {
+    using Block = FieldBlock<sizeof...(I)>;
+    static const QString names[] = {QString(SCHEMA[I].m_name)...};
+    return make_shared<Block>(Block{{makeProperty(SCHEMA[I], names[I])...}});
+}
+
+template <const auto& SCHEMA>
+static auto makeFieldBlock() {
+    return buildFieldBlock<SCHEMA>(make_index_sequence<size(SCHEMA)>());
+}
+
+// 字段块中的第index个字段，与字段块共享所有权，不另外分配
+template <size_t N>
+static shared_ptr<PropertyItem> fieldOf(const shared_ptr<FieldBlock<N>>& block, size_t index) {
+    return shared_ptr<PropertyItem>(block, &block->m_items[index]);
+}
+
+template <const auto& SCHEMA, size_t I>
+static property_variant decodeProperty(const uint8_t* data) {
+    if constexpr (SCHEMA[I].m_encoding == FIELD_ASCII)
+        return decodeString<SCHEMA, I>(data);
+    else
+        return decodeField<SCHEMA, I>(data);
+}
+
+// 按字段表把data（所属结构起始）中的字段I...解码到字段块
+template <const auto& SCHEMA, size_t... I, size_t N>
+static void decodeFields(const uint8_t* data, FieldBlock<N>& block) {
+    ((block.m_items[I].value = decodeProperty<SCHEMA, I>(data)), ...);
+}
+
+// 从流中读到字段I的末尾，buffer[0]对应位于start的结构起始，已读过的部分不重复读
+template <const auto& SCHEMA, size_t I>
+static void readThrough(QDataStream& stream, uint8_t* buffer, int64_t start) {
+    constexpr int64_t end = fieldEnd(SCHEMA[I]);
+    int64_t read = stream.device()->pos() - start;
+    if (read >= 0 && read < end)
+        stream.readRawData(reinterpret_cast<char*>(buffer + read), static_cast<int>(end - read));
+}
+
+// 把字段块中[first, last]的字段按字段表的顺序加到parent下
+template <size_t N>
+static void appendFields(TreeItem* parent, const shared_ptr<FieldBlock<N>>& block, size_t first, size_t last) {
+    for (size_t i = first; i <= last; ++i) {
+        parent->appendChild(new TreeItem(fieldOf(block, i), parent));
+    }
+}
+
+// Enhanced RTMP 解析辅助函数
+
+// 按大端读取bytes字节，超出tag数据范围时抛出异常
+static uint32_t readExBigEndian(QDataStream& stream, int bytes, int64_t data_end) {
+    uint8_t buffer[4] = {0};
+    if (stream.device()->pos() + bytes > data_end || stream.readRawData(reinterpret_cast<char*>(buffer), bytes) != bytes) {
+        throw QString("exceed tag size");
+    }
+    uint32_t value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value = (value << 8) | buffer[i];
+    }
+    return value;
+}
+
+// 读取有符号24位CTS
+static int readExCts(QDataStream& stream, int64_t data_end) {
+    uint32_t value = readExBigEndian(stream, 3, data_end);
+    uint8_t buffer[3] = {static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value)};
+    return bigend_ctoi24(buffer);
+}
+
+// 设置字段在tag内的相对偏移（负值表示相对tag起始位置）
+static void markOffset(shared_ptr<PropertyItem>& item, QDataStream& stream, int64_t tag_offset) {
+    item->offset = -(stream.device()->pos() - tag_offset);
+}
+
+// 视频CodedFrames只有AVC/HEVC/VVC携带CTS
+static bool videoHasCts(uint32_t fourcc, uint8_t packet_type) {
+    return packet_type == VIDEO_PACKET_CODED_FRAMES &&
+           (fourcc == FOURCC_AVC1 || fourcc == FOURCC_HVC1 || fourcc == FOURCC_VVC1);
+}
+
+// 解析ModEx链，返回最终的包类型
+static uint8_t readModEx(QDataStream& stream,
+                         int64_t tag_offset,
+                         int64_t data_end,
+                         uint8_t packet_type,
+                         uint8_t mod_ex_packet,
+                         shared_ptr<PropertyItem>& timestamp_offset_nano,
+                         bool& has_timestamp_offset) {
+    while (packet_type == mod_ex_packet) {
+        uint32_t mod_ex_size = readExBigEndian(stream, 1, data_end) + 1;
+        if (mod_ex_size == 256) {
+            mod_ex_size = readExBigEndian(stream, 2, data_end) + 1;
+        }
+
+        int64_t data_pos = stream.device()->pos();
+        if (data_pos + mod_ex_size > data_end) {
+            throw QString("exceed tag size");
+        }
+        QByteArray mod_ex_data(mod_ex_size, 0);
+        stream.readRawData(mod_ex_data.data(), mod_ex_size);
+
+        uint8_t flags = readExBigEndian(stream, 1, data_end);
+        uint8_t mod_ex_type = flags >> 4;
+        packet_type = flags & 0x0F;
+
+        if (mod_ex_type == MOD_EX_TIMESTAMP_OFFSET_NANO && mod_ex_size >= 3) {
+            timestamp_offset_nano->offset = -(data_pos - tag_offset);
+            timestamp_offset_nano->value =
+                (double) bigend_ctou24(reinterpret_cast<const unsigned char*>(mod_ex_data.constData()));
+            has_timestamp_offset = true;
+        }
+    }
+    return packet_type;
+}
+
+// 解析多轨包中的各条轨道，shared_fourcc为0时每条轨道自带FourCC
+static void readTracks(QDataStream& stream,
+                       int64_t tag_offset,
+                       int64_t data_end,
+                       uint8_t multitrack_type,
+                       uint32_t shared_fourcc,
+                       uint8_t packet_type,
+                       bool is_video,
+                       vector<AVTrackInfo>& tracks) {
+    while (stream.device()->pos() < data_end) {
+        AVTrackInfo track;
+
+        uint32_t fourcc = shared_fourcc;
+        if (multitrack_type == MULTITRACK_MANY_TRACKS_MANY_CODECS) {
+            markOffset(track.m_fourcc, stream, tag_offset);
+            fourcc = readExBigEndian(stream, 4, data_end);
+        }
+        track.m_fourcc->value = (double) fourcc;
+
+        markOffset(track.m_track_id, stream, tag_offset);
+        track.m_track_id->value = (double) readExBigEndian(stream, 1, data_end);
+
+        int64_t track_size = 0;
+        if (multitrack_type != MULTITRACK_ONE_TRACK) {
+            markOffset(track.m_track_size, stream, tag_offset);
+            track_size = readExBigEndian(stream, 3, data_end);
+        } else {
+            track.m_track_size->offset = -(stream.device()->pos() - tag_offset);
+            track.m_track_size->size = 0;
+            track_size = data_end - stream.device()->pos();
+        }
+        track.m_track_size->value = (double) track_size;
+
+        int64_t body_end = stream.device()->pos() + track_size;
+        if (body_end > data_end) {
+            throw QString("track size exceed tag size");
+        }
+
+        if (is_video && videoHasCts(fourcc, packet_type)) {
+            markOffset(track.m_cts, stream, tag_offset);
+            track.m_cts->value = (double) readExCts(stream, body_end);
+        }
+
+        track.m_payload_offset = static_cast<uint32_t>(stream.device()->pos() - tag_offset);
+        track.m_payload_size = static_cast<uint32_t>(body_end - stream.device()->pos());
+        stream.device()->seek(body_end);
+        tracks.emplace_back(std::move(track));
+
+        if (multitrack_type == MULTITRACK_ONE_TRACK) {
+            break;
+        }
+    }
+}
+
+// AVTrackInfo 实现
+AVTrackInfo::AVTrackInfo() : m_fields(makeFieldBlock<TRACK_FIELDS>()) {
+    m_track_id = fieldOf(m_fields, TRACK_FIELD_ID);
+    m_fourcc = fieldOf(m_fields, TRACK_FIELD_FOURCC);
+    m_track_size = fieldOf(m_fields, TRACK_FIELD_SIZE);
+    m_cts = fieldOf(m_fields, TRACK_FIELD_CTS);
+}
+
+TreeItem* AVTrackInfo::toTreeObj() {
+    auto track_tree = new TreeItem(
+        make_shared<PropertyItem>(QString("track[%1]").arg(trackId()), m_track_id->offset, 0, std::string()), nullptr);
+    track_tree->appendChild(new TreeItem(m_track_id, track_tree));
+    track_tree->appendChild(new TreeItem(m_fourcc, track_tree));
+    if (m_track_size->size > 0)
+        track_tree->appendChild(new TreeItem(m_track_size, track_tree));
+    if (m_cts->offset != 0)
+        track_tree->appendChild(new TreeItem(m_cts, track_tree));
+    return track_tree;
+}
+
 // VideoTagInfo 实现
-VideoTagInfo::VideoTagInfo(FLVTag* m_tag_ptr) : m_tag_ptr(m_tag_ptr) {
-    m_tag_type.reset(new PropertyItem("tag_type", -11, 1, 0.0));
-    m_codec.reset(new PropertyItem("codec", -11, 1, 0.0));
-    m_detail_type.reset(new PropertyItem("detail_type", -12, 1, 0.0));
-    m_cts.reset(new PropertyItem("cts", -13, 3, 0.0));
-
-    m_tag_type->toStringFunc = [](PropertyItem& item) {
-        if (auto pd = std::get_if<double>(&item.value))
-            return QString("%1 (%2)").arg(getTagType(*pd)).arg(*pd);
-        return QString();
-    };
-    m_codec->toStringFunc = [](PropertyItem& item) {
-        if (auto pd = std::get_if<double>(&item.value))
-            return QString("%1 (%2)").arg(getCodec(*pd)).arg(*pd);
-        return QString();
-    };
-    m_detail_type->toStringFunc = [](PropertyItem& item) {
-        if (auto pd = std::get_if<double>(&item.value))
-            return QString("%1 (%2)").arg(getDetailType(*pd)).arg(*pd);
-        return QString();
-    };
+VideoTagInfo::VideoTagInfo(FLVTag* m_tag_ptr)
+    : m_fields(makeFieldBlock<VIDEO_FIELDS>()), m_tag_ptr(m_tag_ptr) {
+    m_tag_type = fieldOf(m_fields, VIDEO_FIELD_FRAME_TYPE);
+    m_codec = fieldOf(m_fields, VIDEO_FIELD_CODEC);
+    m_detail_type = fieldOf(m_fields, VIDEO_FIELD_DETAIL_TYPE);
+    m_cts = fieldOf(m_fields, VIDEO_FIELD_CTS);
+    m_packet_type = fieldOf(m_fields, VIDEO_FIELD_PACKET_TYPE);
+    m_fourcc = fieldOf(m_fields, VIDEO_FIELD_FOURCC);
+    m_multitrack_type = fieldOf(m_fields, VIDEO_FIELD_MULTITRACK_TYPE);
+    m_timestamp_offset_nano = fieldOf(m_fields, VIDEO_FIELD_TIMESTAMP_OFFSET_NANO);
+    m_video_command = fieldOf(m_fields, VIDEO_FIELD_COMMAND);
+}
+
+bool VideoTagInfo::readExHeader(QDataStream& stream, const uint8_t* tag_header, int64_t data_end) {
+    int64_t tag_offset = m_tag_ptr->m_offset;
+    m_is_ex_header = true;
+    m_tag_type->value = decodeField<VIDEO_EX_FLAGS, VIDEO_EX_FRAME_TYPE>(tag_header);
+    uint8_t packet_type = static_cast<uint8_t>(decodeField<VIDEO_FIELDS, VIDEO_FIELD_PACKET_TYPE>(tag_header));
+
+    try {
+        packet_type = readModEx(stream,
+                                tag_offset,
+                                data_end,
+                                packet_type,
+                                VIDEO_PACKET_MOD_EX,
+                                m_timestamp_offset_nano,
+                                m_has_timestamp_offset);
+        m_packet_type->value = (double) packet_type;
+
+        // 命令帧只有一个VideoCommand字节
+        if (packet_type != VIDEO_PACKET_METADATA && frameType() == 5) {
+            m_is_command = true;
+            markOffset(m_video_command, stream, tag_offset);
+            m_video_command->value = (double) readExBigEndian(stream, 1, data_end);
+            m_payload_offset = static_cast<uint32_t>(stream.device()->pos() - tag_offset);
+            m_payload_size = static_cast<uint32_t>(data_end - stream.device()->pos());
+            return true;
+        }
+
+        if (packet_type == VIDEO_PACKET_MULTITRACK) {
+            m_is_multitrack = true;
+            markOffset(m_multitrack_type, stream, tag_offset);
+            uint8_t multitrack_flags = readExBigEndian(stream, 1, data_end);
+            uint8_t multitrack_type = multitrack_flags >> 4;
+            packet_type = multitrack_flags & 0x0F;
+            m_multitrack_type->value = (double) multitrack_type;
+            m_packet_type->offset = m_multitrack_type->offset;
+            m_packet_type->value = (double) packet_type;
+
+            uint32_t shared_fourcc = 0;
+            if (multitrack_type != MULTITRACK_MANY_TRACKS_MANY_CODECS) {
+                markOffset(m_fourcc, stream, tag_offset);
+                shared_fourcc = readExBigEndian(stream, 4, data_end);
+            }
+            readTracks(stream, tag_offset, data_end, multitrack_type, shared_fourcc, packet_type, true, m_tracks);
+
+            // 汇总字段取第一条轨道，便于列表展示
+            if (!m_tracks.empty()) {
+                m_fourcc->value = (double) m_tracks.front().fourCC();
+                m_cts->value = (double) m_tracks.front().cts();
+                m_payload_offset = m_tracks.front().m_payload_offset;
+                m_payload_size = m_tracks.front().m_payload_size;
+            }
+            return true;
+        }
+
+        markOffset(m_fourcc, stream, tag_offset);
+        m_fourcc->value = (double) readExBigEndian(stream, 4, data_end);
+
+        if (videoHasCts(fourCC(), packet_type)) {
+            markOffset(m_cts, stream, tag_offset);
+            m_cts->value = (double) readExCts(stream, data_end);
+        }
+
+        m_payload_offset = static_cast<uint32_t>(stream.device()->pos() - tag_offset);
+        m_payload_size = static_cast<uint32_t>(data_end - stream.device()->pos());
+    } catch (const QString& error) {
+        LOG_WITH_POS(QtWarningMsg, stream, QString("tag[video] ex-header error[%1]").arg(error));
+        return false;
+    }
+    return true;
 }
 
 TreeItem* VideoTagInfo::toTreeObj() {
@@ -259,51 +622,101 @@ TreeItem* VideoTagInfo::toTreeObj() {
     if (m_tag_ptr && m_tag_ptr->m_tag_size) {
         tagSize = static_cast<int>(get<double>(m_tag_ptr->m_tag_size->value));
     }
-    auto info_tree = new TreeItem(make_shared<PropertyItem>("video_info", -11, tagSize, std::string()), nullptr);
+    auto info_tree =
+        new TreeItem(make_shared<PropertyItem>("video_info", -TAG_HEADER_SIZE, tagSize, std::string()), nullptr);
+    if (!m_is_ex_header) {
+        appendFields(info_tree, m_fields, VIDEO_FIELD_FRAME_TYPE, VIDEO_FIELD_CTS);
+        return info_tree;
+    }
+
     info_tree->appendChild(new TreeItem(m_tag_type, info_tree));
-    info_tree->appendChild(new TreeItem(m_codec, info_tree));
-    info_tree->appendChild(new TreeItem(m_detail_type, info_tree));
-    info_tree->appendChild(new TreeItem(m_cts, info_tree));
+    if (m_has_timestamp_offset)
+        info_tree->appendChild(new TreeItem(m_timestamp_offset_nano, info_tree));
+    if (m_is_multitrack)
+        info_tree->appendChild(new TreeItem(m_multitrack_type, info_tree));
+    info_tree->appendChild(new TreeItem(m_packet_type, info_tree));
+    if (m_is_command) {
+        info_tree->appendChild(new TreeItem(m_video_command, info_tree));
+        return info_tree;
+    }
+
+    if (!m_is_multitrack) {
+        info_tree->appendChild(new TreeItem(m_fourcc, info_tree));
+        if (videoHasCts(fourCC(), packetType()))
+            info_tree->appendChild(new TreeItem(m_cts, info_tree));
+        return info_tree;
+    }
+
+    for (auto& track : m_tracks) {
+        info_tree->appendChild(track.toTreeObj());
+    }
     return info_tree;
 }
 
 // AudioTagInfo 实现
-AudioTagInfo::AudioTagInfo(FLVTag* m_tag_ptr) : m_tag_ptr(m_tag_ptr) {
-    m_sound_format.reset(new PropertyItem("sound_format", -11, 1, 0.0));
-    m_sound_rate.reset(new PropertyItem("sound_rate", -11, 1, 0.0));
-    m_sound_size.reset(new PropertyItem("sound_size", -11, 1, 0.0));
-    m_sound_type.reset(new PropertyItem("sound_type", -11, 1, 0.0));
-    m_detail_type.reset(new PropertyItem("detail_type", -12, 1, 0.0));
-
-    static const QMap<uint8_t, const char*> soundSizeMap = {{0, "8-bit samples"}, {1, "16-bit samples"}};
-    static const QMap<uint8_t, const char*> soundTypeMap = {{0, "Mono sound"}, {1, "Stereo sound"}};
-    static const QMap<uint8_t, const char*> audioDataType = {{0, "Sequence header"}, {1, "normal data"}};
-
-    m_sound_format->toStringFunc = [](PropertyItem& item) {
-        if (auto pd = std::get_if<double>(&item.value))
-            return QString("%1 (%2)").arg(getSoundFormat(*pd)).arg(*pd);
-        return QString();
-    };
-    m_sound_rate->toStringFunc = [](PropertyItem& item) {
-        if (auto pd = std::get_if<double>(&item.value))
-            return QString("%1 (%2)").arg(getSoundRate(*pd)).arg(*pd);
-        return QString();
-    };
-    m_sound_size->toStringFunc = [](PropertyItem& item) {
-        if (auto pd = std::get_if<double>(&item.value))
-            return QString("%1 (%2)").arg(soundSizeMap.value(*pd, "unknown")).arg(*pd);
-        return QString();
-    };
-    m_sound_type->toStringFunc = [](PropertyItem& item) {
-        if (auto pd = std::get_if<double>(&item.value))
-            return QString("%1 (%2)").arg(soundTypeMap.value(*pd, "unknown")).arg(*pd);
-        return QString();
-    };
-    m_detail_type->toStringFunc = [](PropertyItem& item) {
-        if (auto pd = std::get_if<double>(&item.value))
-            return QString("%1 (%2)").arg(audioDataType.value(*pd, "unknown")).arg(*pd);
-        return QString();
-    };
+AudioTagInfo::AudioTagInfo(FLVTag* m_tag_ptr)
+    : m_fields(makeFieldBlock<AUDIO_FIELDS>()), m_tag_ptr(m_tag_ptr) {
+    m_sound_format = fieldOf(m_fields, AUDIO_FIELD_SOUND_FORMAT);
+    m_sound_rate = fieldOf(m_fields, AUDIO_FIELD_SOUND_RATE);
+    m_sound_size = fieldOf(m_fields, AUDIO_FIELD_SOUND_SIZE);
+    m_sound_type = fieldOf(m_fields, AUDIO_FIELD_SOUND_TYPE);
+    m_detail_type = fieldOf(m_fields, AUDIO_FIELD_DETAIL_TYPE);
+    m_packet_type = fieldOf(m_fields, AUDIO_FIELD_PACKET_TYPE);
+    m_fourcc = fieldOf(m_fields, AUDIO_FIELD_FOURCC);
+    m_multitrack_type = fieldOf(m_fields, AUDIO_FIELD_MULTITRACK_TYPE);
+    m_timestamp_offset_nano = fieldOf(m_fields, AUDIO_FIELD_TIMESTAMP_OFFSET_NANO);
+}
+
+bool AudioTagInfo::readExHeader(QDataStream& stream, const uint8_t* tag_header, int64_t data_end) {
+    int64_t tag_offset = m_tag_ptr->m_offset;
+    m_is_ex_header = true;
+    uint8_t packet_type = static_cast<uint8_t>(decodeField<AUDIO_FIELDS, AUDIO_FIELD_PACKET_TYPE>(tag_header));
+
+    try {
+        packet_type = readModEx(stream,
+                                tag_offset,
+                                data_end,
+                                packet_type,
+                                AUDIO_PACKET_MOD_EX,
+                                m_timestamp_offset_nano,
+                                m_has_timestamp_offset);
+        m_packet_type->value = (double) packet_type;
+
+        if (packet_type == AUDIO_PACKET_MULTITRACK) {
+            m_is_multitrack = true;
+            markOffset(m_multitrack_type, stream, tag_offset);
+            uint8_t multitrack_flags = readExBigEndian(stream, 1, data_end);
+            uint8_t multitrack_type = multitrack_flags >> 4;
+            packet_type = multitrack_flags & 0x0F;
+            m_multitrack_type->value = (double) multitrack_type;
+            m_packet_type->offset = m_multitrack_type->offset;
+            m_packet_type->value = (double) packet_type;
+
+            uint32_t shared_fourcc = 0;
+            if (multitrack_type != MULTITRACK_MANY_TRACKS_MANY_CODECS) {
+                markOffset(m_fourcc, stream, tag_offset);
+                shared_fourcc = readExBigEndian(stream, 4, data_end);
+            }
+            readTracks(stream, tag_offset, data_end, multitrack_type, shared_fourcc, packet_type, false, m_tracks);
+
+            if (!m_tracks.empty()) {
+                m_fourcc->value = (double) m_tracks.front().fourCC();
+                m_payload_offset = m_tracks.front().m_payload_offset;
+                m_payload_size = m_tracks.front().m_payload_size;
+            }
+            return true;
+        }
+
+        markOffset(m_fourcc, stream, tag_offset);
+        m_fourcc->value = (double) readExBigEndian(stream, 4, data_end);
+
+        m_payload_offset = static_cast<uint32_t>(stream.device()->pos() - tag_offset);
+        m_payload_size = static_cast<uint32_t>(data_end - stream.device()->pos());
+    } catch (const QString& error) {
+        LOG_WITH_POS(QtWarningMsg, stream, QString("tag[audio] ex-header error[%1]").arg(error));
+        return false;
+    }
+    return true;
 }
 
 TreeItem* AudioTagInfo::toTreeObj() {
@@ -311,12 +724,26 @@ TreeItem* AudioTagInfo::toTreeObj() {
     if (m_tag_ptr && m_tag_ptr->m_tag_size) {
         tagSize = static_cast<int>(get<double>(m_tag_ptr->m_tag_size->value));
     }
-    auto info_tree = new TreeItem(make_shared<PropertyItem>("audio_info", -11, tagSize, std::string()), nullptr);
+    auto info_tree =
+        new TreeItem(make_shared<PropertyItem>("audio_info", -TAG_HEADER_SIZE, tagSize, std::string()), nullptr);
+    if (!m_is_ex_header) {
+        appendFields(info_tree, m_fields, AUDIO_FIELD_SOUND_FORMAT, AUDIO_FIELD_DETAIL_TYPE);
+        return info_tree;
+    }
+
     info_tree->appendChild(new TreeItem(m_sound_format, info_tree));
-    info_tree->appendChild(new TreeItem(m_sound_rate, info_tree));
-    info_tree->appendChild(new TreeItem(m_sound_size, info_tree));
-    info_tree->appendChild(new TreeItem(m_sound_type, info_tree));
-    info_tree->appendChild(new TreeItem(m_detail_type, info_tree));
+    if (m_has_timestamp_offset)
+        info_tree->appendChild(new TreeItem(m_timestamp_offset_nano, info_tree));
+    if (m_is_multitrack)
+        info_tree->appendChild(new TreeItem(m_multitrack_type, info_tree));
+    info_tree->appendChild(new TreeItem(m_packet_type, info_tree));
+    if (!m_is_multitrack) {
+        info_tree->appendChild(new TreeItem(m_fourcc, info_tree));
+        return info_tree;
+    }
+    for (auto& track : m_tracks) {
+        info_tree->appendChild(track.toTreeObj());
+    }
     return info_tree;
 }
 
@@ -326,34 +753,34 @@ TreeItem* DataTagInfo::toTreeObj() {
     if (m_tag_ptr && m_tag_ptr->m_tag_size) {
         tagSize = static_cast<int>(get<double>(m_tag_ptr->m_tag_size->value));
     }
-    auto info_tree = new TreeItem(make_shared<PropertyItem>("data_info", -11, tagSize, std::string()), nullptr);
+    auto info_tree =
+        new TreeItem(make_shared<PropertyItem>("data_info", -TAG_HEADER_SIZE, tagSize, std::string()), nullptr);
     // 遍历所有元数据字段并添加到树中
     info_tree->appendChild(m_metadata_values.toTreeObj());
     return info_tree;
 }
 
-bool FLVTag::readfromStream(QDataStream& stream) {
-    uint8_t buffer[64] = {0};
-
-    m_offset = stream.device()->pos();
-    uint8_t tag_type = 0;
-    stream >> tag_type;
-    m_tag_type->value = (double) tag_type; // metadata,音视频
-
-    stream.readRawData(reinterpret_cast<char*>(buffer), 3);
-    m_tag_size->value = (double) bigend_ctou24(buffer);
-    m_size = get<double>(m_tag_size->value) + 11 + 4;
+FLVTag::FLVTag() : m_fields(makeFieldBlock<TAG_FIELDS>()) {
+    m_tag_type = fieldOf(m_fields, TAG_FIELD_TYPE);
+    m_tag_size = fieldOf(m_fields, TAG_FIELD_SIZE);
+    m_timestamp = fieldOf(m_fields, TAG_FIELD_TIMESTAMP);
+    m_stream_id = fieldOf(m_fields, TAG_FIELD_STREAM_ID);
+    m_previous_tag_size = fieldOf(m_fields, TAG_FIELD_PREVIOUS_TAG_SIZE);
+}
 
-    stream.readRawData(reinterpret_cast<char*>(buffer), 3);
-    m_timestamp->value = (double) bigend_ctou24(buffer);
-    stream.readRawData(reinterpret_cast<char*>(buffer), 1);
-    m_timestamp->value = get<double>(m_timestamp->value) + (static_cast<uint32_t>(buffer[0]) << 24);
+bool FLVTag::readfromStream(QDataStream& stream, bool keep_binary) {
+    uint8_t buffer[64] = {0}; // buffer[0]对应tag起始，tag头和音视频头都按字段表从中解码
 
-    stream.readRawData(reinterpret_cast<char*>(buffer), 3);
-    m_stream_id->value = (double) bigend_ctou24(buffer);
+    m_offset = stream.device()->pos();
+    readThrough<TAG_FIELDS, TAG_FIELD_STREAM_ID>(stream, buffer, m_offset);
+    decodeFields<TAG_FIELDS, TAG_FIELD_TYPE, TAG_FIELD_SIZE, TAG_FIELD_TIMESTAMP, TAG_FIELD_STREAM_ID>(buffer,
+                                                                                                     *m_fields);
+    m_size = get<double>(m_tag_size->value) + TAG_HEADER_SIZE + PREVIOUS_TAG_SIZE_BYTES;
 
     int type = static_cast<int>(get<double>(m_tag_type->value));
-    printLogWithPos(QtDebugMsg, stream, QString("event[tag_read] type[%1]").arg(type));
+    LOG_WITH_POS(QtDebugMsg, stream, QString("event[tag_read] type[%1]").arg(type));
+
+    int64_t data_end = m_offset + TAG_HEADER_SIZE + static_cast<int64_t>(get<double>(m_tag_size->value));
 
     switch (type) {
     case TAG_TYPE_SCRIPT: {
@@ -366,119 +793,188 @@ bool FLVTag::readfromStream(QDataStream& stream) {
         a_info = make_unique<AudioTagInfo>(this);
 
         // 读取音频帧头信息(1字节)
-        stream.readRawData(reinterpret_cast<char*>(buffer), 1);
-        a_info->m_sound_format->value = (double) ((buffer[0] & 0xF0) >> 4); // 高4位
-        a_info->m_sound_rate->value = (double) ((buffer[0] & 0x0C) >> 2);   // 3-2位
-        a_info->m_sound_size->value = (double) ((buffer[0] & 0x02) >> 1);   // 1位
-        a_info->m_sound_type->value = (double) (buffer[0] & 0x01);          // 0位
+        readThrough<AUDIO_FIELDS, AUDIO_FIELD_SOUND_FORMAT>(stream, buffer, m_offset);
+        decodeFields<AUDIO_FIELDS, AUDIO_FIELD_SOUND_FORMAT>(buffer, *a_info->m_fields);
+
+        if (a_info->soundFormat() == AUDIO_EX_HEADER) {
+            // Enhanced RTMP：低4位为AudioPacketType，之后为FourCC
+            m_header_error = !a_info->readExHeader(stream, buffer, data_end);
+            break;
+        }
 
-        if (get<double>(a_info->m_sound_format->value) == AAC) {
+        decodeFields<AUDIO_FIELDS, AUDIO_FIELD_SOUND_RATE, AUDIO_FIELD_SOUND_SIZE, AUDIO_FIELD_SOUND_TYPE>(
+            buffer, *a_info->m_fields);
+
+        if (a_info->soundFormat() == AAC) {
             // AAC
-            stream.readRawData(reinterpret_cast<char*>(buffer), 1);
-            a_info->m_detail_type->value = (double) buffer[0];
+            readThrough<AUDIO_FIELDS, AUDIO_FIELD_DETAIL_TYPE>(stream, buffer, m_offset);
+            decodeFields<AUDIO_FIELDS, AUDIO_FIELD_DETAIL_TYPE>(buffer, *a_info->m_fields);
         }
+        a_info->m_payload_offset = static_cast<uint32_t>(stream.device()->pos() - m_offset);
+        a_info->m_payload_size = static_cast<uint32_t>(max<int64_t>(data_end - stream.device()->pos(), 0));
     } break;
     case TAG_TYPE_VIDEO: {
         v_info = make_unique<VideoTagInfo>(this);
 
         // 读取视频帧头信息(1字节)
-        stream.readRawData(reinterpret_cast<char*>(buffer), 1);
-        v_info->m_tag_type->value = (double) ((buffer[0] & 0xF0) >> 4); // 高4位
-        v_info->m_codec->value = (double) (buffer[0] & 0x0F);           // 低4位
+        readThrough<VIDEO_FIELDS, VIDEO_FIELD_FRAME_TYPE>(stream, buffer, m_offset);
 
-        // 如果是AVC(H.264)需要额外读取CTS
-        if (get<double>(v_info->m_codec->value) == AVC || get<double>(v_info->m_codec->value) == HEVC ||
-            get<double>(v_info->m_codec->value) == AV1 || get<double>(v_info->m_codec->value) == VVC) {
-            stream.readRawData(reinterpret_cast<char*>(buffer), 1);
-            v_info->m_detail_type->value = (double) buffer[0];
+        if (decodeField<VIDEO_EX_FLAGS, VIDEO_EX_IS_EX_HEADER>(buffer)) {
+            // Enhanced RTMP：最高位为IsExHeader，低4位为VideoPacketType，之后为FourCC
+            m_header_error = !v_info->readExHeader(stream, buffer, data_end);
+            break;
+        }
 
-            stream.readRawData(reinterpret_cast<char*>(buffer), 3);
-            v_info->m_cts->value = static_cast<double>(bigend_ctoi24(buffer));
+        decodeFields<VIDEO_FIELDS, VIDEO_FIELD_FRAME_TYPE, VIDEO_FIELD_CODEC>(buffer, *v_info->m_fields);
+
+        // 如果是AVC(H.264)需要额外读取CTS
+        uint8_t codec = static_cast<uint8_t>(get<double>(v_info->m_codec->value));
+        if (codec == AVC || codec == HEVC || codec == AV1 || codec == VVC) {
+            readThrough<VIDEO_FIELDS, VIDEO_FIELD_CTS>(stream, buffer, m_offset);
+            decodeFields<VIDEO_FIELDS, VIDEO_FIELD_DETAIL_TYPE, VIDEO_FIELD_CTS>(buffer, *v_info->m_fields);
         }
+        v_info->m_payload_offset = static_cast<uint32_t>(stream.device()->pos() - m_offset);
+        v_info->m_payload_size = static_cast<uint32_t>(max<int64_t>(data_end - stream.device()->pos(), 0));
     } break;
     default:
         break;
     }
 
     // 读取previous_tag_size
-    int64_t offset_in_tag = 11 + get<double>(m_tag_size->value);
+    int64_t offset_in_tag = TAG_HEADER_SIZE + get<double>(m_tag_size->value);
     m_previous_tag_size->offset = -offset_in_tag;
     if (stream.device()->pos() > m_offset + offset_in_tag) {
-        printLogWithPos(QtWarningMsg, stream, QString("event[tag_content_error] reason[exceed tag size]"));
+        LOG_WITH_POS(QtWarningMsg, stream, QString("event[tag_content_error] reason[exceed tag size]"));
         return false;
     }
 
     stream.device()->seek(m_offset + offset_in_tag);
-    stream.readRawData(reinterpret_cast<char*>(buffer), 4);
-    m_previous_tag_size->value = (double) bigend_ctou32(buffer);
+    stream.readRawData(reinterpret_cast<char*>(buffer), PREVIOUS_TAG_SIZE_BYTES);
+    m_previous_tag_size->value = decodeField<TAG_FIELDS, TAG_FIELD_PREVIOUS_TAG_SIZE>(buffer);
 
     // 读取帧的二进制数据
-    m_bin_data.reset(new uchar[offset_in_tag + 4]);
-    stream.device()->seek(m_offset);
-    stream.readRawData((char*) m_bin_data.get(), offset_in_tag + 4);
+    m_bin_size = offset_in_tag + PREVIOUS_TAG_SIZE_BYTES;
+    if (keep_binary) {
+        m_bin_data.reset(new uchar[m_bin_size]);
+        stream.device()->seek(m_offset);
+        stream.readRawData((char*) m_bin_data.get(), m_bin_size);
+    }
 
     if (stream.status() != QDataStream::Ok) {
-        printLogWithPos(QtInfoMsg, stream, QString("event[finished]"));
+        LOG_WITH_POS(QtInfoMsg, stream, QString("event[finished]"));
         return false;
     }
 
     return true;
 }
 
+// 将[offset, offset + size)记为垃圾数据段，读取结束后流位于段尾
+bool FLVTag::readGarbage(QDataStream& stream, int64_t offset, int64_t size, bool keep_binary) {
+    m_is_garbage = true;
+    m_offset = offset;
+    m_size = static_cast<uint32_t>(size);
+    m_tag_size->value = (double) size;
+    m_tag_size->offset = 0;
+    m_tag_size->size = 0;
+
+    m_bin_size = static_cast<uint32_t>(min<int64_t>(size, MAX_GARBAGE_PREVIEW));
+    int read_size = static_cast<int>(m_bin_size);
+    if (keep_binary) {
+        m_bin_data.reset(new uchar[m_bin_size]);
+        stream.device()->seek(offset);
+        read_size = stream.readRawData((char*) m_bin_data.get(), m_bin_size);
+    }
+    stream.device()->seek(offset + size);
+
+    LOG_WITH_POS(QtWarningMsg,
+                 stream,
+                 QString("event[garbage_skipped] offset[0x%1] size[%2]").arg(offset, 0, 16).arg(size));
+    return read_size == static_cast<int>(m_bin_size);
+}
+
 // FLVTag::getTreeInfo 实现
+FLVTag::~FLVTag() {
+    if (m_lru_linked || m_cached_payload || m_cached_tree) {
+        MemoryBudget::instance().forget(this);
+    }
+}
+
 shared_ptr<TreeItem>& FLVTag::getTreeInfo() {
     if (m_info_tree) {
+        MemoryBudget::instance().touch(this);
         return m_info_tree;
     }
 
-    m_info_tree.reset(new TreeItem(make_shared<PropertyItem>("tag_info", 0, 1, std::string()), nullptr));
-    m_info_tree->appendChild(new TreeItem(m_tag_type, m_info_tree.get()));
-    m_info_tree->appendChild(new TreeItem(m_tag_size, m_info_tree.get()));
-    m_info_tree->appendChild(new TreeItem(m_timestamp, m_info_tree.get()));
-    m_info_tree->appendChild(new TreeItem(m_stream_id, m_info_tree.get()));
+    m_info_tree = buildTreeInfo();
+    MemoryBudget::instance().touch(this);
+    return m_info_tree;
+}
+
+shared_ptr<TreeItem> FLVTag::buildTreeInfo() {
+    TRACE_SCOPE("tree_build");
+    shared_ptr<TreeItem> tree;
+    if (m_is_garbage) {
+        tree.reset(new TreeItem(make_shared<PropertyItem>("garbage", 0, 0, std::string()), nullptr));
+        tree->appendChild(
+            new TreeItem(make_shared<PropertyItem>("skipped_size", 0, m_bin_size, (double) m_size), tree.get()));
+        return tree;
+    }
+
+    tree.reset(new TreeItem(make_shared<PropertyItem>("tag_info", 0, 1, std::string()), nullptr));
+    appendFields(tree.get(), m_fields, TAG_FIELD_TYPE, TAG_FIELD_STREAM_ID);
 
     if (get<double>(m_tag_type->value) == TAG_TYPE_SCRIPT && metadata_info) {
-        m_info_tree->appendChild(metadata_info->toTreeObj());
+        tree->appendChild(metadata_info->toTreeObj());
     } else if (get<double>(m_tag_type->value) == TAG_TYPE_VIDEO && v_info) {
-        m_info_tree->appendChild(v_info->toTreeObj());
+        tree->appendChild(v_info->toTreeObj());
     } else if (get<double>(m_tag_type->value) == TAG_TYPE_AUDIO && a_info) {
-        m_info_tree->appendChild(a_info->toTreeObj());
+        tree->appendChild(a_info->toTreeObj());
     } else {
-        auto unknown = new TreeItem(make_shared<PropertyItem>("unknown", 0, 1, 0.0), m_info_tree.get());
-        m_info_tree->appendChild(unknown);
+        auto unknown = new TreeItem(make_shared<PropertyItem>("unknown", 0, 1, 0.0), tree.get());
+        tree->appendChild(unknown);
     }
 
-    m_info_tree->appendChild(new TreeItem(m_previous_tag_size, m_info_tree.get()));
-    return m_info_tree;
+    tree->appendChild(new TreeItem(m_previous_tag_size, tree.get()));
+    return tree;
+}
+
+FLVHeader::FLVHeader() : m_fields(makeFieldBlock<HEADER_FIELDS>()) {
+    m_signature = fieldOf(m_fields, HEADER_FIELD_SIGNATURE);
+    m_version = fieldOf(m_fields, HEADER_FIELD_VERSION);
+    m_type_flags = fieldOf(m_fields, HEADER_FIELD_TYPE_FLAGS);
+    m_data_offset = fieldOf(m_fields, HEADER_FIELD_DATA_OFFSET);
+    m_previous_tag_size = fieldOf(m_fields, HEADER_FIELD_PREVIOUS_TAG_SIZE);
 }
 
 bool FLVHeader::readfromStream(QDataStream& stream) {
     m_offset = 0;
-    m_size = 13;
+    m_size = FLV_HEADER_SIZE;
 
     uint8_t buffer[16] = {0};
-    stream.readRawData(reinterpret_cast<char*>(buffer), 13);
+    stream.readRawData(reinterpret_cast<char*>(buffer), FLV_HEADER_SIZE);
 
     if (stream.status() != QDataStream::Ok) {
-        printLogWithPos(QtInfoMsg, stream, QString("event[finished]"));
+        LOG_WITH_POS(QtInfoMsg, stream, QString("event[finished]"));
         return false;
     }
 
     if (0 != memcmp(buffer, "FLV", 3)) {
-        printLogWithPos(QtWarningMsg, stream, QString("event[flv_header_error]"));
+        LOG_WITH_POS(QtWarningMsg, stream, QString("event[flv_header_error]"));
         return false;
     }
 
-    m_signature->value = string((const char*) (buffer), 3);
-    m_version->value = (double) buffer[3];
-    m_type_flags->value = (double) buffer[4];
-    m_data_offset->value = (double) bigend_ctou32(buffer + 5);
-    m_previous_tag_size->value = (double) bigend_ctou32(buffer + 9);
+    decodeFields<HEADER_FIELDS,
+                 HEADER_FIELD_SIGNATURE,
+                 HEADER_FIELD_VERSION,
+                 HEADER_FIELD_TYPE_FLAGS,
+                 HEADER_FIELD_DATA_OFFSET,
+                 HEADER_FIELD_PREVIOUS_TAG_SIZE>(buffer, *m_fields);
 
     // 读取帧的二进制数据
-    m_bin_data.reset(new uchar[13]);
+    m_bin_data.reset(new uchar[FLV_HEADER_SIZE]);
+    m_bin_size = FLV_HEADER_SIZE;
     stream.device()->seek(0);
-    stream.readRawData((char*) m_bin_data.get(), 13);
+    stream.readRawData((char*) m_bin_data.get(), FLV_HEADER_SIZE);
 
     return true;
 }
@@ -488,12 +984,9 @@ shared_ptr<TreeItem>& FLVHeader::getTreeInfo() {
         return m_info_tree;
     }
 
+    TRACE_SCOPE("tree_build");
     m_info_tree.reset(new TreeItem(make_shared<PropertyItem>("flv_header", 0, 9, std::string()), nullptr));
-    m_info_tree->appendChild(new TreeItem(m_signature, m_info_tree.get()));
-    m_info_tree->appendChild(new TreeItem(m_version, m_info_tree.get()));
-    m_info_tree->appendChild(new TreeItem(m_type_flags, m_info_tree.get()));
-    m_info_tree->appendChild(new TreeItem(m_data_offset, m_info_tree.get()));
-    m_info_tree->appendChild(new TreeItem(m_previous_tag_size, m_info_tree.get()));
+    appendFields(m_info_tree.get(), m_fields, HEADER_FIELD_SIGNATURE, HEADER_FIELD_PREVIOUS_TAG_SIZE);
 
     return m_info_tree;
 }
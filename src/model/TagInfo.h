@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "FieldSchema.h"
 #include <QList>
 #include <QMap>
 #include <QObject>
@@ -22,6 +23,8 @@ enum TAG_TYPE {
 };
 
 enum FLV_AUDIO_CODEC {
+    MP3 = 2,
+    AUDIO_EX_HEADER = 9, // Enhanced RTMP，低4位为AudioPacketType
     AAC = 10
 };
 
@@ -32,6 +35,99 @@ enum FLV_VIDEO_CODEC {
     VVC = 14
 };
 
+// Enhanced RTMP 视频包类型（IsExHeader置位时，视频首字节低4位）
+enum VIDEO_PACKET_TYPE {
+    VIDEO_PACKET_SEQUENCE_START = 0,
+    VIDEO_PACKET_CODED_FRAMES = 1,
+    VIDEO_PACKET_SEQUENCE_END = 2,
+    VIDEO_PACKET_CODED_FRAMES_X = 3,
+    VIDEO_PACKET_METADATA = 4,
+    VIDEO_PACKET_MPEG2TS_SEQUENCE_START = 5,
+    VIDEO_PACKET_MULTITRACK = 6,
+    VIDEO_PACKET_MOD_EX = 7
+};
+
+// Enhanced RTMP 音频包类型（SoundFormat为9时，音频首字节低4位）
+enum AUDIO_PACKET_TYPE {
+    AUDIO_PACKET_SEQUENCE_START = 0,
+    AUDIO_PACKET_CODED_FRAMES = 1,
+    AUDIO_PACKET_SEQUENCE_END = 2,
+    AUDIO_PACKET_MULTICHANNEL_CONFIG = 4,
+    AUDIO_PACKET_MULTITRACK = 5,
+    AUDIO_PACKET_MOD_EX = 7
+};
+
+// Enhanced RTMP 多轨类型
+enum AV_MULTITRACK_TYPE {
+    MULTITRACK_ONE_TRACK = 0,
+    MULTITRACK_MANY_TRACKS = 1,
+    MULTITRACK_MANY_TRACKS_MANY_CODECS = 2
+};
+
+// ModEx 扩展类型
+enum PACKET_MOD_EX_TYPE {
+    MOD_EX_TIMESTAMP_OFFSET_NANO = 0
+};
+
+constexpr uint32_t makeFourCC(const char* s) {
+    return (static_cast<uint32_t>(static_cast<uint8_t>(s[0])) << 24) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(s[1])) << 16) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(s[2])) << 8) | static_cast<uint32_t>(static_cast<uint8_t>(s[3]));
+}
+
+enum FOURCC : uint32_t {
+    FOURCC_AVC1 = makeFourCC("avc1"),
+    FOURCC_HVC1 = makeFourCC("hvc1"),
+    FOURCC_VVC1 = makeFourCC("vvc1"),
+    FOURCC_AV01 = makeFourCC("av01"),
+    FOURCC_VP08 = makeFourCC("vp08"),
+    FOURCC_VP09 = makeFourCC("vp09"),
+    FOURCC_AC3 = makeFourCC("ac-3"),
+    FOURCC_EAC3 = makeFourCC("ec-3"),
+    FOURCC_OPUS = makeFourCC("Opus"),
+    FOURCC_MP3 = makeFourCC(".mp3"),
+    FOURCC_FLAC = makeFourCC("fLaC"),
+    FOURCC_AAC = makeFourCC("mp4a")
+};
+
+inline QString fourCCToString(uint32_t fourcc) {
+    if (fourcc == 0)
+        return QString();
+    char text[5] = {static_cast<char>(fourcc >> 24),
+                    static_cast<char>(fourcc >> 16),
+                    static_cast<char>(fourcc >> 8),
+                    static_cast<char>(fourcc),
+                    0};
+    return QString::fromLatin1(text, 4);
+}
+
+// 传统codec id到FourCC的映射，无对应FourCC时返回0
+inline uint32_t videoCodecToFourCC(uint8_t codec) {
+    switch (codec) {
+    case AVC:
+        return FOURCC_AVC1;
+    case HEVC:
+        return FOURCC_HVC1;
+    case AV1:
+        return FOURCC_AV01;
+    case VVC:
+        return FOURCC_VVC1;
+    default:
+        return 0;
+    }
+}
+
+inline uint32_t audioCodecToFourCC(uint8_t sound_format) {
+    switch (sound_format) {
+    case MP3:
+        return FOURCC_MP3;
+    case AAC:
+        return FOURCC_AAC;
+    default:
+        return 0;
+    }
+}
+
 /**
  * @class PropertyItem
  * @brief 字段类，用于树型结构展示
@@ -66,6 +162,68 @@ struct PropertyItem {
     }
 };
 
+/**
+ * @struct FieldBlock
+ * @brief 按字段表一次分配的一组字段，各字段的shared_ptr共享这次分配，字段表见TagInfo.cpp
+ */
+template <size_t N>
+struct FieldBlock {
+    PropertyItem m_items[N];
+};
+
+// 各字段表的下标，顺序即字段树中的显示顺序
+enum FLV_HEADER_FIELD {
+    HEADER_FIELD_SIGNATURE,
+    HEADER_FIELD_VERSION,
+    HEADER_FIELD_TYPE_FLAGS,
+    HEADER_FIELD_DATA_OFFSET,
+    HEADER_FIELD_PREVIOUS_TAG_SIZE,
+    HEADER_FIELD_COUNT
+};
+
+enum TAG_HEADER_FIELD {
+    TAG_FIELD_TYPE,
+    TAG_FIELD_SIZE,
+    TAG_FIELD_TIMESTAMP,
+    TAG_FIELD_STREAM_ID,
+    TAG_FIELD_PREVIOUS_TAG_SIZE,
+    TAG_FIELD_COUNT
+};
+
+enum VIDEO_HEADER_FIELD {
+    VIDEO_FIELD_FRAME_TYPE,
+    VIDEO_FIELD_CODEC,
+    VIDEO_FIELD_DETAIL_TYPE,
+    VIDEO_FIELD_CTS,
+    VIDEO_FIELD_PACKET_TYPE,
+    VIDEO_FIELD_FOURCC,
+    VIDEO_FIELD_MULTITRACK_TYPE,
+    VIDEO_FIELD_TIMESTAMP_OFFSET_NANO,
+    VIDEO_FIELD_COMMAND,
+    VIDEO_FIELD_COUNT
+};
+
+enum AUDIO_HEADER_FIELD {
+    AUDIO_FIELD_SOUND_FORMAT,
+    AUDIO_FIELD_SOUND_RATE,
+    AUDIO_FIELD_SOUND_SIZE,
+    AUDIO_FIELD_SOUND_TYPE,
+    AUDIO_FIELD_DETAIL_TYPE,
+    AUDIO_FIELD_PACKET_TYPE,
+    AUDIO_FIELD_FOURCC,
+    AUDIO_FIELD_MULTITRACK_TYPE,
+    AUDIO_FIELD_TIMESTAMP_OFFSET_NANO,
+    AUDIO_FIELD_COUNT
+};
+
+enum TRACK_HEADER_FIELD {
+    TRACK_FIELD_ID,
+    TRACK_FIELD_FOURCC,
+    TRACK_FIELD_SIZE,
+    TRACK_FIELD_CTS,
+    TRACK_FIELD_COUNT
+};
+
 /**
  * @class TreeItem
  * @brief 和树型QAbstractItemModel绑定的通用类
@@ -186,6 +344,19 @@ struct DataTagInfo {
     TreeItem* toTreeObj();
 };
 
+inline const char* getFlvTagType(uint8_t tag_type) {
+    switch (tag_type) {
+    case TAG_TYPE_AUDIO:
+        return "audio";
+    case TAG_TYPE_VIDEO:
+        return "video";
+    case TAG_TYPE_SCRIPT:
+        return "script";
+    default:
+        return "unknown";
+    }
+}
+
 inline const char* getTagType(uint8_t tag_type) {
     switch (tag_type) {
     case 1:
@@ -260,7 +431,7 @@ inline const char* getSoundFormat(uint8_t sound_format) {
     case 8:
         return "G.711 mu-law";
     case 9:
-        return "reserved";
+        return "ExHeader";
     case 10:
         return "AAC";
     case 11:
@@ -287,6 +458,117 @@ inline const char* getSoundRate(uint8_t sound_rate) {
         return "unknown sound rate";
     }
 }
+inline const char* getSoundSize(uint8_t sound_size) {
+    switch (sound_size) {
+    case 0:
+        return "8-bit samples";
+    case 1:
+        return "16-bit samples";
+    default:
+        return "unknown";
+    }
+}
+inline const char* getSoundType(uint8_t sound_type) {
+    switch (sound_type) {
+    case 0:
+        return "Mono sound";
+    case 1:
+        return "Stereo sound";
+    default:
+        return "unknown";
+    }
+}
+inline const char* getAudioDetailType(uint8_t detail_type) {
+    switch (detail_type) {
+    case 0:
+        return "Sequence header";
+    case 1:
+        return "normal data";
+    default:
+        return "unknown";
+    }
+}
+
+inline const char* getVideoPacketType(uint8_t packet_type) {
+    switch (packet_type) {
+    case VIDEO_PACKET_SEQUENCE_START:
+        return "sequence start";
+    case VIDEO_PACKET_CODED_FRAMES:
+        return "coded frames";
+    case VIDEO_PACKET_SEQUENCE_END:
+        return "sequence end";
+    case VIDEO_PACKET_CODED_FRAMES_X:
+        return "coded frames X";
+    case VIDEO_PACKET_METADATA:
+        return "metadata";
+    case VIDEO_PACKET_MPEG2TS_SEQUENCE_START:
+        return "MPEG-2 TS sequence start";
+    case VIDEO_PACKET_MULTITRACK:
+        return "multitrack";
+    case VIDEO_PACKET_MOD_EX:
+        return "ModEx";
+    default:
+        return "unknown packet type";
+    }
+}
+inline const char* getAudioPacketType(uint8_t packet_type) {
+    switch (packet_type) {
+    case AUDIO_PACKET_SEQUENCE_START:
+        return "sequence start";
+    case AUDIO_PACKET_CODED_FRAMES:
+        return "coded frames";
+    case AUDIO_PACKET_SEQUENCE_END:
+        return "sequence end";
+    case AUDIO_PACKET_MULTICHANNEL_CONFIG:
+        return "multichannel config";
+    case AUDIO_PACKET_MULTITRACK:
+        return "multitrack";
+    case AUDIO_PACKET_MOD_EX:
+        return "ModEx";
+    default:
+        return "unknown packet type";
+    }
+}
+inline const char* getMultitrackType(uint8_t multitrack_type) {
+    switch (multitrack_type) {
+    case MULTITRACK_ONE_TRACK:
+        return "one track";
+    case MULTITRACK_MANY_TRACKS:
+        return "many tracks";
+    case MULTITRACK_MANY_TRACKS_MANY_CODECS:
+        return "many tracks many codecs";
+    default:
+        return "unknown multitrack type";
+    }
+}
+
+/**
+ * @class AVTrackInfo
+ * @brief Enhanced RTMP 多轨包中的单条轨道
+ */
+struct AVTrackInfo {
+    shared_ptr<PropertyItem> m_track_id;
+    shared_ptr<PropertyItem> m_fourcc;
+    shared_ptr<PropertyItem> m_track_size;
+    shared_ptr<PropertyItem> m_cts;
+    shared_ptr<FieldBlock<TRACK_FIELD_COUNT>> m_fields; // 以上字段共享的存储
+
+    // 轨道负载在tag二进制中的相对位置
+    uint32_t m_payload_offset = 0;
+    uint32_t m_payload_size = 0;
+
+    AVTrackInfo();
+    uint8_t trackId() const {
+        return static_cast<uint8_t>(get<double>(m_track_id->value));
+    }
+    uint32_t fourCC() const {
+        return static_cast<uint32_t>(get<double>(m_fourcc->value));
+    }
+    int32_t cts() const {
+        return static_cast<int32_t>(get<double>(m_cts->value));
+    }
+    TreeItem* toTreeObj();
+};
 
 /**
  * @class VideoTagInfo
@@ -300,11 +582,52 @@ struct VideoTagInfo {
     shared_ptr<PropertyItem> m_detail_type;
     shared_ptr<PropertyItem> m_cts;
 
+    // Enhanced RTMP 扩展字段
+    bool m_is_ex_header = false;
+    bool m_is_multitrack = false;
+    bool m_has_timestamp_offset = false;
+    bool m_is_command = false;
+    shared_ptr<PropertyItem> m_packet_type;
+    shared_ptr<PropertyItem> m_fourcc;
+    shared_ptr<PropertyItem> m_multitrack_type;
+    shared_ptr<PropertyItem> m_timestamp_offset_nano;
+    shared_ptr<PropertyItem> m_video_command;
+    vector<AVTrackInfo> m_tracks; // 仅多轨包
+    shared_ptr<FieldBlock<VIDEO_FIELD_COUNT>> m_fields; // 以上字段共享的存储
+
+    // 编码负载在tag二进制中的相对位置（单轨）
+    uint32_t m_payload_offset = 0;
+    uint32_t m_payload_size = 0;
+
     // 指向所属的FLVTag，便于修改
     FLVTag* m_tag_ptr = nullptr;
 
     VideoTagInfo(FLVTag* m_tag_ptr);
+    // tag_header为已读入的tag头和视频首字节
+    bool readExHeader(QDataStream& stream, const uint8_t* tag_header, int64_t data_end);
     TreeItem* toTreeObj();
+
+    uint8_t frameType() const {
+        return static_cast<uint8_t>(get<double>(m_tag_type->value));
+    }
+    // 统一为VideoPacketType语义，传统头的AVCPacketType 0/1/2与其一致
+    uint8_t packetType() const {
+        return static_cast<uint8_t>(get<double>((m_is_ex_header ? m_packet_type : m_detail_type)->value));
+    }
+    uint32_t fourCC() const {
+        if (m_is_ex_header)
+            return static_cast<uint32_t>(get<double>(m_fourcc->value));
+        return videoCodecToFourCC(static_cast<uint8_t>(get<double>(m_codec->value)));
+    }
+    int32_t cts() const {
+        return static_cast<int32_t>(get<double>(m_cts->value));
+    }
+    bool isKeyFrame() const {
+        return frameType() == 1;
+    }
+    bool isSequenceHeader() const {
+        return packetType() == VIDEO_PACKET_SEQUENCE_START && (m_is_ex_header || fourCC() != 0);
+    }
 };
 
 /**
@@ -320,11 +643,44 @@ struct AudioTagInfo {
     shared_ptr<PropertyItem> m_sound_type;
     shared_ptr<PropertyItem> m_detail_type;
 
+    // Enhanced RTMP 扩展字段
+    bool m_is_ex_header = false;
+    bool m_is_multitrack = false;
+    bool m_has_timestamp_offset = false;
+    shared_ptr<PropertyItem> m_packet_type;
+    shared_ptr<PropertyItem> m_fourcc;
+    shared_ptr<PropertyItem> m_multitrack_type;
+    shared_ptr<PropertyItem> m_timestamp_offset_nano;
+    vector<AVTrackInfo> m_tracks; // 仅多轨包
+    shared_ptr<FieldBlock<AUDIO_FIELD_COUNT>> m_fields; // 以上字段共享的存储
+
+    // 编码负载在tag二进制中的相对位置（单轨）
+    uint32_t m_payload_offset = 0;
+    uint32_t m_payload_size = 0;
+
     // 指向所属的FLVTag，便于修改
     FLVTag* m_tag_ptr = nullptr;
 
     AudioTagInfo(FLVTag* m_tag_ptr);
+    // tag_header为已读入的tag头和音频首字节
+    bool readExHeader(QDataStream& stream, const uint8_t* tag_header, int64_t data_end);
     TreeItem* toTreeObj();
+
+    uint8_t soundFormat() const {
+        return static_cast<uint8_t>(get<double>(m_sound_format->value));
+    }
+    // 统一为AudioPacketType语义，AACPacketType 0/1与其一致
+    uint8_t packetType() const {
+        return static_cast<uint8_t>(get<double>((m_is_ex_header ? m_packet_type : m_detail_type)->value));
+    }
+    uint32_t fourCC() const {
+        if (m_is_ex_header)
+            return static_cast<uint32_t>(get<double>(m_fourcc->value));
+        return audioCodecToFourCC(soundFormat());
+    }
+    bool isSequenceHeader() const {
+        return packetType() == AUDIO_PACKET_SEQUENCE_START && (m_is_ex_header || soundFormat() == AAC);
+    }
 };
 
 /**
@@ -338,6 +694,7 @@ struct BinaryData {
     shared_ptr<uchar[]> m_bin_data;
     uint64_t m_offset = 0;
     uint32_t m_size = 0;
+    uint32_t m_bin_size = 0; // m_bin_data中实际加载的字节数，垃圾数据段可能小于m_size
 
 };
 
@@ -352,34 +709,43 @@ struct FLVTag : public BinaryData {
     shared_ptr<PropertyItem> m_timestamp;
     shared_ptr<PropertyItem> m_stream_id;
     shared_ptr<PropertyItem> m_previous_tag_size;
+    shared_ptr<FieldBlock<TAG_FIELD_COUNT>> m_fields; // 以上字段共享的存储
 
     // 帧信息
     unique_ptr<DataTagInfo> metadata_info;
     unique_ptr<VideoTagInfo> v_info;
     unique_ptr<AudioTagInfo> a_info;
 
+    // 恢复模式下跳过的无法解析的数据段
+    bool m_is_garbage = false;
+    // Enhanced RTMP扩展头解析失败，v_info/a_info中只有部分字段有效
+    bool m_header_error = false;
+
     // 树状信息指针
     shared_ptr<TreeItem> m_info_tree;
 
-    FLVTag() {
-        m_tag_type.reset(new PropertyItem("tag_type", 0, 1, 0.0));
-        m_tag_size.reset(new PropertyItem("tag_size", -1, 3, 0.0));
-        m_timestamp.reset(new PropertyItem("timestamp", -4, 4, 0.0));
-        m_stream_id.reset(new PropertyItem("stream_id", -8, 3, 0.0));
-        m_previous_tag_size.reset(new PropertyItem("previous_tag_size", 0, 4, 0.0));
+    // 内存预算的LRU链表和已记账的缓存字节数，由MemoryBudget维护
+    FLVTag* m_lru_prev = nullptr;
+    FLVTag* m_lru_next = nullptr;
+    bool m_lru_linked = false;
+    uint32_t m_cached_payload = 0;
+    uint32_t m_cached_tree = 0;
 
-        static const QMap<uint8_t, const char*> tagTypeMap = {
-            {TAG_TYPE_AUDIO, "audio"}, {TAG_TYPE_VIDEO, "video"}, {TAG_TYPE_SCRIPT, "script"}};
+    FLVTag();
+    ~FLVTag() override;
 
-        m_tag_type->toStringFunc = [](PropertyItem& item) {
-            if (auto pd = std::get_if<double>(&item.value))
-                return QString("%1 (%2)").arg(tagTypeMap.value(*pd, "unknown")).arg(*pd);
-            return QString();
-        };
-    }
-
-    bool readfromStream(QDataStream& stream);
+    // keep_binary为false时不加载二进制数据，只记录m_bin_size，需要时由ModelTagList::ensureBinary读取
+    bool readfromStream(QDataStream& stream, bool keep_binary = true);
+    // size不超过MAX_GARBAGE_SPAN，更长的垃圾数据由调用方拆成多段；keep_binary为false时不加载预览
+    bool readGarbage(QDataStream& stream, int64_t offset, int64_t size, bool keep_binary = true);
     shared_ptr<TreeItem>& getTreeInfo();
+    // 构建一棵新的字段树，不写入缓存也不参与内存预算，用于临时查找字段
+    shared_ptr<TreeItem> buildTreeInfo();
+
+    // 垃圾数据段最多加载的字节数，仅用于二进制预览
+    static constexpr uint32_t MAX_GARBAGE_PREVIEW = 1024 * 1024;
+    // 单个垃圾数据段的最大长度，m_size和索引中的m_data_size均为32位
+    static constexpr uint32_t MAX_GARBAGE_SPAN = 0x80000000;
 };
 
 /**
@@ -392,33 +758,12 @@ struct FLVHeader : public BinaryData {
     shared_ptr<PropertyItem> m_type_flags;
     shared_ptr<PropertyItem> m_data_offset;
     shared_ptr<PropertyItem> m_previous_tag_size;
+    shared_ptr<FieldBlock<HEADER_FIELD_COUNT>> m_fields; // 以上字段共享的存储
 
     // 树状信息指针
     shared_ptr<TreeItem> m_info_tree;
 
-    FLVHeader() {
-        m_signature.reset(new PropertyItem("signature", 0, 3, string()));
-        m_version.reset(new PropertyItem("version", -3, 1, 0.0));
-        m_type_flags.reset(new PropertyItem("type_flags", -4, 1, 0.0));
-        m_data_offset.reset(new PropertyItem("data_offset", -5, 4, 0.0));
-        m_previous_tag_size.reset(new PropertyItem("previous_tag_size", -9, 4, 0.0));
-
-        m_type_flags->toStringFunc = [](PropertyItem& item) {
-            if (auto ps = std::get_if<double>(&item.value)) {
-                int flags = static_cast<int>(*ps);
-                if ((flags & 0x05) == 0x05)
-                    return QString("has audio and video (%1)").arg(*ps);
-                else if ((flags & 0x04) == 0x04)
-                    return QString("has video (%1)").arg(*ps);
-                else if (flags & 0x01)
-                    return QString("has audio (%1)").arg(*ps);
-                else
-                    return QString("%1").arg(*ps);
-            }
-            return QString();
-        };
-    }
-
+    FLVHeader();
     bool readfromStream(QDataStream& stream);
     shared_ptr<TreeItem>& getTreeInfo();
 };
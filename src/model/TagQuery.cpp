@@ -0,0 +1,589 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "TagQuery.h"
+#include "Parallel.h"
+#include <QMap>
+#include <QStringList>
+#include <algorithm>
+
+namespace {
+
+// 按块求值，块内的掩码可以留在缓存中
+constexpr size_t QUERY_CHUNK = 64 * 1024;
+
+struct Token {
+    enum KIND { END, WORD, OP, LPAREN, RPAREN };
+    KIND m_kind = END;
+    QString m_text;
+    int m_pos = 0;
+};
+
+bool isWordChar(const QString& text, int i) {
+    QChar c = text[i];
+    if (c.isLetterOrNumber() || c == '_')
+        return true;
+    // 小数点可以出现在词中，但".."是区间分隔符
+    if (c == '.')
+        return !(i + 1 < text.size() && text[i + 1] == '.') && !(i > 0 && text[i - 1] == '.');
+    return c == '-';
+}
+
+vector<Token> tokenize(const QString& text) {
+    static const QStringList two_char_ops = {"&&", "||", "==", "!=", "<=", ">=", ".."};
+
+    vector<Token> tokens;
+    int i = 0;
+    while (i < text.size()) {
+        QChar c = text[i];
+        if (c.isSpace()) {
+            ++i;
+            continue;
+        }
+
+        QString two = text.mid(i, 2);
+        if (two_char_ops.contains(two)) {
+            tokens.push_back({Token::OP, two, i});
+            i += 2;
+        } else if (c == '(' || c == ')') {
+            tokens.push_back({c == '(' ? Token::LPAREN : Token::RPAREN, QString(c), i});
+            ++i;
+        } else if (c == '!' || c == '<' || c == '>' || c == '=') {
+            tokens.push_back({Token::OP, QString(c), i});
+            ++i;
+        } else if (isWordChar(text, i) && c != '.') {
+            int start = i;
+            while (i < text.size() && isWordChar(text, i)) {
+                ++i;
+            }
+            tokens.push_back({Token::WORD, text.mid(start, i - start), start});
+        } else {
+            throw QString("位置%1：无法识别的字符 '%2'").arg(i + 1).arg(c);
+        }
+    }
+    tokens.push_back({Token::END, QString(), static_cast<int>(text.size())});
+    return tokens;
+}
+
+uint32_t fourCCFromText(const QString& text) {
+    QByteArray bytes = text.toLatin1();
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value = (value << 8) | static_cast<uint8_t>(bytes[i]);
+    }
+    return value;
+}
+
+class QueryParser {
+  public:
+    explicit QueryParser(const QString& text) : m_tokens(tokenize(text)) {
+    }
+
+    unique_ptr<TagQuery::Node> parse() {
+        auto node = parseOr();
+        if (peek().m_kind != Token::END) {
+            fail(peek(), "多余的内容");
+        }
+        return node;
+    }
+
+  private:
+    using Node = TagQuery::Node;
+
+    const Token& peek() const {
+        return m_tokens[m_pos];
+    }
+
+    const Token& next() {
+        const Token& token = m_tokens[m_pos];
+        if (token.m_kind != Token::END)
+            ++m_pos;
+        return token;
+    }
+
+    [[noreturn]] void fail(const Token& token, const QString& message) const {
+        QString near = token.m_kind == Token::END ? QString("结尾") : QString("'%1'").arg(token.m_text);
+        throw QString("位置%1（%2）：%3").arg(token.m_pos + 1).arg(near).arg(message);
+    }
+
+    bool acceptOp(const char* op, const char* keyword = nullptr) {
+        const Token& token = peek();
+        if ((token.m_kind == Token::OP && token.m_text == op) ||
+            (keyword && token.m_kind == Token::WORD && token.m_text.compare(keyword, Qt::CaseInsensitive) == 0)) {
+            next();
+            return true;
+        }
+        return false;
+    }
+
+    static unique_ptr<Node> makeNode(uint8_t op) {
+        auto node = make_unique<Node>();
+        node->m_op = op;
+        return node;
+    }
+
+    unique_ptr<Node> parseOr() {
+        auto left = parseAnd();
+        if (!(peek().m_kind == Token::OP && peek().m_text == "||") &&
+            !(peek().m_kind == Token::WORD && peek().m_text.compare("or", Qt::CaseInsensitive) == 0)) {
+            return left;
+        }
+        auto node = makeNode(TagQuery::OP_OR);
+        node->m_children.push_back(std::move(left));
+        while (acceptOp("||", "or")) {
+            node->m_children.push_back(parseAnd());
+        }
+        return node;
+    }
+
+    unique_ptr<Node> parseAnd() {
+        auto left = parseUnary();
+        if (!(peek().m_kind == Token::OP && peek().m_text == "&&") &&
+            !(peek().m_kind == Token::WORD && peek().m_text.compare("and", Qt::CaseInsensitive) == 0)) {
+            return left;
+        }
+        auto node = makeNode(TagQuery::OP_AND);
+        node->m_children.push_back(std::move(left));
+        while (acceptOp("&&", "and")) {
+            node->m_children.push_back(parseUnary());
+        }
+        return node;
+    }
+
+    unique_ptr<Node> parseUnary() {
+        if (acceptOp("!", "not")) {
+            auto node = makeNode(TagQuery::OP_NOT);
+            node->m_children.push_back(parseUnary());
+            return node;
+        }
+        if (peek().m_kind == Token::LPAREN) {
+            next();
+            auto node = parseOr();
+            if (peek().m_kind != Token::RPAREN) {
+                fail(peek(), "缺少 ')'");
+            }
+            next();
+            return node;
+        }
+        return parseTerm();
+    }
+
+    unique_ptr<Node> parseTerm() {
+        static const QMap<QString, uint8_t> flags = {{"keyframe", TAG_FLAG_KEYFRAME},
+                                                     {"seqheader", TAG_FLAG_SEQUENCE_HEADER},
+                                                     {"sequence_header", TAG_FLAG_SEQUENCE_HEADER},
+                                                     {"exheader", TAG_FLAG_EX_HEADER},
+                                                     {"multitrack", TAG_FLAG_MULTITRACK},
+                                                     {"garbage", TAG_FLAG_GARBAGE},
+                                                     {"duplicate", TAG_FLAG_DUPLICATE},
+                                                     {"dup", TAG_FLAG_DUPLICATE},
+                                                     {"bad_header", TAG_FLAG_BAD_HEADER}};
+        static const QMap<QString, uint8_t> fields = {{"type", TagQuery::FIELD_TYPE},
+                                                      {"offset", TagQuery::FIELD_OFFSET},
+                                                      {"pos", TagQuery::FIELD_OFFSET},
+                                                      {"size", TagQuery::FIELD_SIZE},
+                                                      {"len", TagQuery::FIELD_SIZE},
+                                                      {"ts", TagQuery::FIELD_TS},
+                                                      {"dts", TagQuery::FIELD_TS},
+                                                      {"timestamp", TagQuery::FIELD_TS},
+                                                      {"pts", TagQuery::FIELD_PTS},
+                                                      {"cts", TagQuery::FIELD_CTS},
+                                                      {"stream_id", TagQuery::FIELD_STREAM_ID},
+                                                      {"prev_size", TagQuery::FIELD_PREV_SIZE},
+                                                      {"previous_tag_size", TagQuery::FIELD_PREV_SIZE},
+                                                      {"codec", TagQuery::FIELD_CODEC},
+                                                      {"frame_type", TagQuery::FIELD_FRAME_TYPE},
+                                                      {"detail", TagQuery::FIELD_DETAIL},
+                                                      {"packet_type", TagQuery::FIELD_DETAIL},
+                                                      {"hash", TagQuery::FIELD_HASH},
+                                                      {"track", TagQuery::FIELD_TRACK},
+                                                      {"track_id", TagQuery::FIELD_TRACK}};
+
+        const Token& name = next();
+        if (name.m_kind != Token::WORD) {
+            fail(name, "需要字段名");
+        }
+        QString key = name.m_text.toLower();
+
+        if (flags.contains(key)) {
+            auto node = makeNode(TagQuery::OP_FLAG);
+            node->m_flag = flags.value(key);
+            return node;
+        }
+        if (!fields.contains(key)) {
+            fail(name, "未知字段");
+        }
+
+        auto node = makeNode(TagQuery::OP_EQ);
+        node->m_field = fields.value(key);
+
+        if (peek().m_kind == Token::WORD && peek().m_text.compare("between", Qt::CaseInsensitive) == 0) {
+            next();
+            node->m_op = TagQuery::OP_BETWEEN;
+            node->m_values.push_back(parseSingleValue(node->m_field));
+            if (!acceptOp("..")) {
+                fail(peek(), "between需要 a..b");
+            }
+            node->m_values.push_back(parseSingleValue(node->m_field));
+            if (node->m_values[0] > node->m_values[1]) {
+                swap(node->m_values[0], node->m_values[1]);
+            }
+            return node;
+        }
+
+        static const QMap<QString, uint8_t> ops = {{"=", TagQuery::OP_EQ},
+                                                   {"==", TagQuery::OP_EQ},
+                                                   {"!=", TagQuery::OP_NE},
+                                                   {"<", TagQuery::OP_LT},
+                                                   {"<=", TagQuery::OP_LE},
+                                                   {">", TagQuery::OP_GT},
+                                                   {">=", TagQuery::OP_GE}};
+        const Token& op = next();
+        if (op.m_kind != Token::OP || !ops.contains(op.m_text)) {
+            fail(op, "需要比较运算符或between");
+        }
+        node->m_op = ops.value(op.m_text);
+
+        if (node->m_op == TagQuery::OP_EQ || node->m_op == TagQuery::OP_NE) {
+            node->m_values = parseValues(node->m_field);
+        } else {
+            node->m_values.push_back(parseSingleValue(node->m_field));
+        }
+        return node;
+    }
+
+    int64_t parseSingleValue(uint8_t field) {
+        const Token& token = peek();
+        vector<int64_t> values = parseValues(field);
+        if (values.size() != 1) {
+            fail(token, "该值不能用于大小比较");
+        }
+        return values[0];
+    }
+
+    // 解析一个值，名称类的值可能对应多个数值（如coded_frames对应1和3）
+    vector<int64_t> parseValues(uint8_t field) {
+        const Token& token = next();
+        if (token.m_kind != Token::WORD) {
+            fail(token, "需要值");
+        }
+        QString text = token.m_text.toLower();
+
+        switch (field) {
+        case TagQuery::FIELD_TYPE: {
+            static const QMap<QString, int64_t> names = {
+                {"audio", TAG_TYPE_AUDIO}, {"video", TAG_TYPE_VIDEO}, {"script", TAG_TYPE_SCRIPT}, {"garbage", 0}};
+            if (names.contains(text))
+                return {names.value(text)};
+            break;
+        }
+        case TagQuery::FIELD_CODEC: {
+            static const QMap<QString, int64_t> names = {
+                {"avc", FOURCC_AVC1},   {"h264", FOURCC_AVC1}, {"hevc", FOURCC_HVC1}, {"h265", FOURCC_HVC1},
+                {"vvc", FOURCC_VVC1},   {"h266", FOURCC_VVC1}, {"av1", FOURCC_AV01},  {"vp8", FOURCC_VP08},
+                {"vp9", FOURCC_VP09},   {"aac", FOURCC_AAC},   {"mp3", FOURCC_MP3},   {"opus", FOURCC_OPUS},
+                {"flac", FOURCC_FLAC},  {"ac3", FOURCC_AC3},   {"eac3", FOURCC_EAC3}};
+            if (names.contains(text))
+                return {names.value(text)};
+            // 直接写FourCC，区分大小写
+            if (token.m_text.size() == 4)
+                return {fourCCFromText(token.m_text)};
+            break;
+        }
+        case TagQuery::FIELD_DETAIL: {
+            if (text == "sequence_header" || text == "seqheader" || text == "sequence_start")
+                return {VIDEO_PACKET_SEQUENCE_START};
+            if (text == "coded_frames" || text == "nalu" || text == "frame")
+                return {VIDEO_PACKET_CODED_FRAMES, VIDEO_PACKET_CODED_FRAMES_X};
+            if (text == "end_of_sequence" || text == "sequence_end")
+                return {VIDEO_PACKET_SEQUENCE_END};
+            if (text == "metadata")
+                return {VIDEO_PACKET_METADATA};
+            break;
+        }
+        case TagQuery::FIELD_FRAME_TYPE: {
+            static const QMap<QString, int64_t> names = {
+                {"key", 1}, {"keyframe", 1}, {"inter", 2}, {"disposable", 3}, {"generated", 4}, {"command", 5}};
+            if (names.contains(text))
+                return {names.value(text)};
+            break;
+        }
+        case TagQuery::FIELD_HASH: {
+            // 与哈希列相同的16位十六进制，0x可省略
+            bool ok = false;
+            uint64_t hash = (text.startsWith("0x") ? text.mid(2) : text).toULongLong(&ok, 16);
+            if (!ok)
+                fail(token, "哈希需要十六进制数");
+            return {static_cast<int64_t>(hash)};
+        }
+        default:
+            break;
+        }
+
+        bool ok = false;
+        int64_t value = parseNumber(field, text, ok);
+        if (!ok) {
+            fail(token, "无法识别的值");
+        }
+        return {value};
+    }
+
+    // 数字，时间字段支持ms/s/m/min/h，长度字段支持k/m/g，偏移支持0x
+    static int64_t parseNumber(uint8_t field, const QString& text, bool& ok) {
+        ok = false;
+        if (text.startsWith("0x")) {
+            return static_cast<int64_t>(text.mid(2).toULongLong(&ok, 16));
+        }
+
+        int unit_pos = 0;
+        while (unit_pos < text.size() && (text[unit_pos].isDigit() || text[unit_pos] == '.' || text[unit_pos] == '-')) {
+            ++unit_pos;
+        }
+        double number = text.left(unit_pos).toDouble(&ok);
+        if (!ok) {
+            return 0;
+        }
+
+        QString unit = text.mid(unit_pos);
+        double scale = 1;
+        bool is_time = field == TagQuery::FIELD_TS || field == TagQuery::FIELD_PTS || field == TagQuery::FIELD_CTS;
+        bool is_size = field == TagQuery::FIELD_SIZE || field == TagQuery::FIELD_OFFSET || field == TagQuery::FIELD_PREV_SIZE;
+        if (unit.isEmpty() || (is_time && unit == "ms")) {
+            scale = 1;
+        } else if (is_time && unit == "s") {
+            scale = 1000;
+        } else if (is_time && (unit == "m" || unit == "min")) {
+            scale = 60 * 1000;
+        } else if (is_time && unit == "h") {
+            scale = 3600 * 1000;
+        } else if (is_size && (unit == "k" || unit == "kb")) {
+            scale = 1024;
+        } else if (is_size && (unit == "m" || unit == "mb")) {
+            scale = 1024 * 1024;
+        } else if (is_size && (unit == "g" || unit == "gb")) {
+            scale = 1024.0 * 1024 * 1024;
+        } else {
+            ok = false;
+            return 0;
+        }
+        return static_cast<int64_t>(number * scale);
+    }
+
+    vector<Token> m_tokens;
+    size_t m_pos = 0;
+};
+
+// 对一列做比较，循环体只有一次比较，便于编译器向量化
+template <typename T>
+void compareColumn(const T* column, size_t n, uint8_t op, const vector<int64_t>& values, uint8_t* out) {
+    int64_t a = values.empty() ? 0 : values[0];
+    int64_t b = values.size() > 1 ? values[1] : a;
+    switch (op) {
+    case TagQuery::OP_EQ:
+        for (size_t i = 0; i < n; ++i)
+            out[i] = (static_cast<int64_t>(column[i]) == a) | (static_cast<int64_t>(column[i]) == b);
+        break;
+    case TagQuery::OP_NE:
+        for (size_t i = 0; i < n; ++i)
+            out[i] = (static_cast<int64_t>(column[i]) != a) & (static_cast<int64_t>(column[i]) != b);
+        break;
+    case TagQuery::OP_LT:
+        for (size_t i = 0; i < n; ++i)
+            out[i] = static_cast<int64_t>(column[i]) < a;
+        break;
+    case TagQuery::OP_LE:
+        for (size_t i = 0; i < n; ++i)
+            out[i] = static_cast<int64_t>(column[i]) <= a;
+        break;
+    case TagQuery::OP_GT:
+        for (size_t i = 0; i < n; ++i)
+            out[i] = static_cast<int64_t>(column[i]) > a;
+        break;
+    case TagQuery::OP_GE:
+        for (size_t i = 0; i < n; ++i)
+            out[i] = static_cast<int64_t>(column[i]) >= a;
+        break;
+    case TagQuery::OP_BETWEEN:
+        for (size_t i = 0; i < n; ++i)
+            out[i] = (static_cast<int64_t>(column[i]) >= a) & (static_cast<int64_t>(column[i]) <= b);
+        break;
+    default:
+        break;
+    }
+}
+
+// 多轨包逐条轨道比较，任一轨道满足即匹配；value(i, k)为tag i第k个轨道项的值
+template <typename F>
+void compareTracks(const TagIndex& index, size_t begin, size_t n, const TagQuery::Node& node, F value, uint8_t* out) {
+    if (index.m_track_id.empty())
+        return;
+
+    vector<int64_t> values;
+    vector<uint8_t> matched;
+    for (size_t i = begin; i < begin + n; ++i) {
+        size_t first = index.trackBegin(i);
+        size_t last = index.trackEnd(i);
+        if (first == last)
+            continue;
+        values.clear();
+        for (size_t k = first; k < last; ++k)
+            values.push_back(value(i, k));
+        matched.resize(values.size());
+        compareColumn(values.data(), values.size(), node.m_op, node.m_values, matched.data());
+        out[i - begin] = any_of(matched.begin(), matched.end(), [](uint8_t m) { return m != 0; });
+    }
+}
+
+} // namespace
+
+unique_ptr<TagQuery> TagQuery::compile(const QString& text) {
+    auto query = unique_ptr<TagQuery>(new TagQuery());
+    query->m_text = text.trimmed();
+    if (!query->m_text.isEmpty()) {
+        query->m_root = QueryParser(query->m_text).parse();
+    }
+    return query;
+}
+
+void TagQuery::evaluate(const Node& node, const TagIndex& index, size_t begin, size_t end, uint8_t* out) {
+    size_t n = end - begin;
+
+    switch (node.m_op) {
+    case OP_AND:
+    case OP_OR: {
+        evaluate(*node.m_children[0], index, begin, end, out);
+        vector<uint8_t> temp(n);
+        for (size_t c = 1; c < node.m_children.size(); ++c) {
+            evaluate(*node.m_children[c], index, begin, end, temp.data());
+            if (node.m_op == OP_AND) {
+                for (size_t i = 0; i < n; ++i)
+                    out[i] &= temp[i];
+            } else {
+                for (size_t i = 0; i < n; ++i)
+                    out[i] |= temp[i];
+            }
+        }
+        return;
+    }
+    case OP_NOT:
+        evaluate(*node.m_children[0], index, begin, end, out);
+        for (size_t i = 0; i < n; ++i)
+            out[i] ^= 1;
+        return;
+    case OP_FLAG: {
+        const uint8_t* flags = index.m_flags.data() + begin;
+        for (size_t i = 0; i < n; ++i)
+            out[i] = (flags[i] & node.m_flag) != 0;
+        return;
+    }
+    default:
+        break;
+    }
+
+    switch (node.m_field) {
+    case FIELD_TYPE:
+        compareColumn(index.m_type.data() + begin, n, node.m_op, node.m_values, out);
+        break;
+    case FIELD_OFFSET:
+        compareColumn(index.m_offset.data() + begin, n, node.m_op, node.m_values, out);
+        break;
+    case FIELD_SIZE:
+        compareColumn(index.m_data_size.data() + begin, n, node.m_op, node.m_values, out);
+        break;
+    case FIELD_TS:
+        compareColumn(index.m_timestamp.data() + begin, n, node.m_op, node.m_values, out);
+        break;
+    case FIELD_PTS: {
+        vector<int64_t> pts(n);
+        for (size_t i = 0; i < n; ++i)
+            pts[i] = static_cast<int64_t>(index.m_timestamp[begin + i]) + index.m_cts[begin + i];
+        compareColumn(pts.data(), n, node.m_op, node.m_values, out);
+        compareTracks(
+            index,
+            begin,
+            n,
+            node,
+            [&](size_t i, size_t k) { return static_cast<int64_t>(index.m_timestamp[i]) + index.m_track_cts[k]; },
+            out);
+        break;
+    }
+    case FIELD_CTS:
+        compareColumn(index.m_cts.data() + begin, n, node.m_op, node.m_values, out);
+        compareTracks(
+            index, begin, n, node, [&](size_t, size_t k) { return static_cast<int64_t>(index.m_track_cts[k]); }, out);
+        break;
+    case FIELD_STREAM_ID:
+        compareColumn(index.m_stream_id.data() + begin, n, node.m_op, node.m_values, out);
+        break;
+    case FIELD_PREV_SIZE:
+        compareColumn(index.m_prev_tag_size.data() + begin, n, node.m_op, node.m_values, out);
+        break;
+    case FIELD_CODEC:
+        compareColumn(index.m_codec.data() + begin, n, node.m_op, node.m_values, out);
+        compareTracks(
+            index, begin, n, node, [&](size_t, size_t k) { return static_cast<int64_t>(index.m_track_codec[k]); }, out);
+        break;
+    case FIELD_FRAME_TYPE:
+        compareColumn(index.m_frame_type.data() + begin, n, node.m_op, node.m_values, out);
+        break;
+    case FIELD_DETAIL:
+        compareColumn(index.m_packet_type.data() + begin, n, node.m_op, node.m_values, out);
+        break;
+    case FIELD_HASH:
+        if (index.hasPayloadHash())
+            compareColumn(index.m_payload_hash.data() + begin, n, node.m_op, node.m_values, out);
+        else
+            fill(out, out + n, 0);
+        break;
+    case FIELD_TRACK: {
+        vector<uint8_t> track(n, 0); // 单轨包为轨道0
+        compareColumn(track.data(), n, node.m_op, node.m_values, out);
+        compareTracks(
+            index, begin, n, node, [&](size_t, size_t k) { return static_cast<int64_t>(index.m_track_id[k]); }, out);
+        break;
+    }
+    default:
+        fill(out, out + n, 0);
+        break;
+    }
+}
+
+vector<int> TagQuery::run(const TagIndex& index) const {
+    size_t count = index.size();
+    vector<int> result;
+
+    if (!m_root) {
+        result.resize(count);
+        for (size_t i = 0; i < count; ++i)
+            result[i] = static_cast<int>(i);
+        return result;
+    }
+
+    // 每块独立求值并收集匹配下标，最后按块顺序拼接
+    size_t chunks = (count + QUERY_CHUNK - 1) / QUERY_CHUNK;
+    vector<vector<int>> parts(chunks);
+    parallelFor(
+        chunks,
+        [&](size_t chunk_begin, size_t chunk_end) {
+            vector<uint8_t> mask(QUERY_CHUNK);
+            for (size_t c = chunk_begin; c < chunk_end; ++c) {
+                size_t begin = c * QUERY_CHUNK;
+                size_t end = min(count, begin + QUERY_CHUNK);
+                evaluate(*m_root, index, begin, end, mask.data());
+                for (size_t i = 0; i < end - begin; ++i) {
+                    if (mask[i])
+                        parts[c].push_back(static_cast<int>(begin + i));
+                }
+            }
+        },
+        1);
+
+    size_t total = 0;
+    for (const auto& part : parts)
+        total += part.size();
+    result.reserve(total);
+    for (const auto& part : parts)
+        result.insert(result.end(), part.begin(), part.end());
+    return result;
+}
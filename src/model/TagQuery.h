@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "TagIndex.h"
+#include <QString>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @class TagQuery
+ * @brief tag过滤表达式，编译一次后在列式tag索引上按块批量求值
+ *
+ * 语法示例：
+ *   type=video && keyframe && size>200000 && ts between 10s..20s
+ *   codec=hevc && detail=sequence_header
+ *   !(type=audio) || cts<0
+ *   hash=9c1e0f3a5b7d2e48 || duplicate
+ *   multitrack && track=1 && codec=opus
+ * 字段：type offset size ts pts cts stream_id prev_size codec frame_type detail hash track
+ * 标志：keyframe seqheader exheader multitrack garbage duplicate bad_header
+ * hash和duplicate需要先计算负载哈希，否则不匹配任何tag
+ * 多轨包的codec、cts、pts、track逐条轨道比较，任一轨道满足即匹配；单轨包视为只有轨道0
+ */
+class TagQuery {
+  public:
+    enum FIELD : uint8_t {
+        FIELD_TYPE = 0,
+        FIELD_OFFSET,
+        FIELD_SIZE,
+        FIELD_TS,
+        FIELD_PTS,
+        FIELD_CTS,
+        FIELD_STREAM_ID,
+        FIELD_PREV_SIZE,
+        FIELD_CODEC,
+        FIELD_FRAME_TYPE,
+        FIELD_DETAIL,
+        FIELD_HASH,
+        FIELD_TRACK
+    };
+
+    enum OP : uint8_t {
+        OP_AND = 0,
+        OP_OR,
+        OP_NOT,
+        OP_FLAG,    // (flags & m_flag) != 0
+        OP_EQ,      // 等于m_values中任意一个
+        OP_NE,
+        OP_LT,
+        OP_LE,
+        OP_GT,
+        OP_GE,
+        OP_BETWEEN // m_values[0] <= v <= m_values[1]
+    };
+
+    struct Node {
+        uint8_t m_op = OP_AND;
+        uint8_t m_field = FIELD_TYPE;
+        uint8_t m_flag = 0;
+        vector<int64_t> m_values;
+        vector<unique_ptr<Node>> m_children;
+    };
+
+    // 编译表达式，语法错误时抛出QString；空表达式匹配全部tag
+    static unique_ptr<TagQuery> compile(const QString& text);
+
+    // 返回匹配的tag下标（升序）
+    vector<int> run(const TagIndex& index) const;
+
+    const QString& text() const {
+        return m_text;
+    }
+
+  private:
+    static void evaluate(const Node& node, const TagIndex& index, size_t begin, size_t end, uint8_t* out);
+
+    QString m_text;
+    unique_ptr<Node> m_root;
+};
@@ -0,0 +1,75 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "TagRecovery.h"
+#include "TagInfo.h"
+#include "Utils.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define FLV_RECOVERY_SSE2
+#endif
+
+// 11字节tag头 + 4字节PreviousTagSize
+static constexpr int64_t MIN_TAG_SPAN = 15;
+
+static inline bool isTagTypeByte(uchar type) {
+    return type == TAG_TYPE_AUDIO || type == TAG_TYPE_VIDEO || type == TAG_TYPE_SCRIPT;
+}
+
+bool TagRecovery::isPlausibleHeader(const uchar* data, int64_t size, int64_t pos) {
+    if (pos + 11 > size || !isTagTypeByte(data[pos])) {
+        return false;
+    }
+    return bigend_ctou24(data + pos + 8) == 0;
+}
+
+bool TagRecovery::isConsistentTag(const uchar* data, int64_t size, int64_t pos) {
+    if (pos + MIN_TAG_SPAN > size || !isPlausibleHeader(data, size, pos)) {
+        return false;
+    }
+
+    uint32_t data_size = bigend_ctou24(data + pos + 1);
+    int64_t end = pos + 11 + data_size;
+    if (data_size == 0 || end + 4 > size) {
+        return false;
+    }
+    if (bigend_ctou32(data + end) != 11 + data_size) {
+        return false;
+    }
+
+    // 再确认下一个tag头（文件末尾除外），避免负载中的巧合字节
+    int64_t next = end + 4;
+    return next + 11 > size || isPlausibleHeader(data, size, next);
+}
+
+int64_t TagRecovery::findNextTag(const uchar* data, int64_t size, int64_t from) {
+    int64_t pos = from;
+    int64_t last = size - MIN_TAG_SPAN; // 最后一个可能的tag起点
+
+#ifdef FLV_RECOVERY_SSE2
+    // 每次比较16字节，只对类型字节命中的位置做完整检查
+    const __m128i audio = _mm_set1_epi8(TAG_TYPE_AUDIO);
+    const __m128i video = _mm_set1_epi8(TAG_TYPE_VIDEO);
+    const __m128i script = _mm_set1_epi8(TAG_TYPE_SCRIPT);
+    for (; pos + 16 <= last + 1; pos += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, audio), _mm_cmpeq_epi8(block, video)),
+                                   _mm_cmpeq_epi8(block, script));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+        for (int bit = 0; mask != 0; ++bit, mask >>= 1) {
+            if ((mask & 1) && isConsistentTag(data, size, pos + bit)) {
+                return pos + bit;
+            }
+        }
+    }
+#endif
+
+    for (; pos <= last; ++pos) {
+        if (isTagTypeByte(data[pos]) && isConsistentTag(data, size, pos)) {
+            return pos;
+        }
+    }
+    return size;
+}
@@ -0,0 +1,24 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <QtGlobal>
+#include <cstdint>
+
+/**
+ * @class TagRecovery
+ * @brief 损坏/截断文件的重同步：在映射的文件数据中查找下一个自洽的tag起点
+ */
+class TagRecovery {
+  public:
+    // pos处是否为自洽的tag：类型合法、stream_id为0、数据不越界、PreviousTagSize与长度一致
+    static bool isConsistentTag(const uchar* data, int64_t size, int64_t pos);
+
+    // pos处的tag头是否看起来合法（只检查类型和stream_id）
+    static bool isPlausibleHeader(const uchar* data, int64_t size, int64_t pos);
+
+    // 从from开始查找下一个自洽的tag起点，找不到时返回size
+    static int64_t findNextTag(const uchar* data, int64_t size, int64_t from);
+};
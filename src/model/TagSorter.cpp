@@ -0,0 +1,162 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "TagSorter.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <array>
+
+namespace {
+
+struct SortItem {
+    uint64_t m_key;
+    int m_row;
+};
+
+constexpr size_t RADIX_BITS = 8;
+constexpr size_t RADIX_SIZE = 1 << RADIX_BITS;
+constexpr size_t KEY_BYTES = sizeof(uint64_t);
+
+using Histogram = array<size_t, RADIX_SIZE>;
+
+} // namespace
+
+TagSorter::KEY TagSorter::keyForColumn(int column) {
+    // 列顺序见ModelTagList::headerData：偏移地址、tag类型、长度、时间戳、轨道、详细信息、哈希
+    switch (column) {
+    case 0:
+        return KEY_OFFSET;
+    case 1:
+        return KEY_TYPE;
+    case 2:
+        return KEY_SIZE;
+    case 3:
+        return KEY_TIMESTAMP;
+    case 4:
+        return KEY_TRACK;
+    case 5:
+        return KEY_CODEC;
+    case 6:
+        return KEY_HASH;
+    default:
+        return KEY_NONE;
+    }
+}
+
+uint64_t TagSorter::sortKey(const TagIndex& index, size_t i, KEY key) {
+    switch (key) {
+    case KEY_OFFSET:
+        return index.m_offset[i];
+    case KEY_TYPE:
+        return index.m_type[i];
+    case KEY_SIZE:
+        return index.m_data_size[i];
+    case KEY_TIMESTAMP:
+        return index.m_timestamp[i];
+    case KEY_CTS:
+        // 有符号数翻转符号位后按无符号比较
+        return static_cast<uint32_t>(index.m_cts[i]) ^ 0x80000000u;
+    case KEY_CODEC:
+        return index.m_codec[i];
+    case KEY_HASH:
+        return index.hasPayloadHash() ? index.m_payload_hash[i] : 0;
+    case KEY_TRACK: {
+        // 与轨道列的文本顺序一致：最高字节标记多轨包，之后按前7条轨道号逐字节比较
+        size_t first = index.trackBegin(i);
+        size_t last = min(index.trackEnd(i), first + 7);
+        if (first == last)
+            return 0;
+        uint64_t key = uint64_t(1) << 56;
+        for (size_t k = first; k < last; ++k)
+            key |= static_cast<uint64_t>(index.m_track_id[k]) << (8 * (6 - (k - first)));
+        return key;
+    }
+    default:
+        return 0;
+    }
+}
+
+vector<int> TagSorter::sort(const TagIndex& index, const vector<int>& rows, KEY key, bool descending) {
+    size_t count = rows.size();
+    if (key == KEY_NONE || count < 2) {
+        return rows;
+    }
+
+    // 降序时key取反，基数排序本身稳定，相同key仍保持输入顺序
+    uint64_t mask = descending ? ~uint64_t(0) : 0;
+    vector<SortItem> items(count);
+    vector<SortItem> buffer(count);
+
+    size_t chunk_size = parallelChunkSize(count);
+    size_t chunk_count = (count + chunk_size - 1) / chunk_size;
+    vector<array<Histogram, KEY_BYTES>> chunk_total(chunk_count);
+
+    // 生成key，同时统计每个字节的分布，所有元素该字节相同的轮次直接跳过
+    parallelFor(count, [&](size_t begin, size_t end) {
+        auto& total = chunk_total[begin / chunk_size];
+        for (auto& histogram : total) {
+            histogram.fill(0);
+        }
+        for (size_t i = begin; i < end; ++i) {
+            uint64_t value = sortKey(index, rows[i], key) ^ mask;
+            items[i] = {value, rows[i]};
+            for (size_t b = 0; b < KEY_BYTES; ++b) {
+                ++total[b][(value >> (b * RADIX_BITS)) & (RADIX_SIZE - 1)];
+            }
+        }
+    });
+
+    vector<size_t> passes;
+    for (size_t b = 0; b < KEY_BYTES; ++b) {
+        bool uniform = false;
+        for (size_t digit = 0; digit < RADIX_SIZE && !uniform; ++digit) {
+            size_t sum = 0;
+            for (auto& total : chunk_total) {
+                sum += total[b][digit];
+            }
+            uniform = sum == count;
+        }
+        if (!uniform) {
+            passes.push_back(b);
+        }
+    }
+
+    // 每轮：各区间分别统计当前字节 -> 按(digit, 区间)前缀和得到写入位置 -> 各区间并行分发
+    vector<Histogram> chunk_offset(chunk_count);
+    for (size_t b : passes) {
+        size_t shift = b * RADIX_BITS;
+        parallelFor(count, [&](size_t begin, size_t end) {
+            auto& histogram = chunk_offset[begin / chunk_size];
+            histogram.fill(0);
+            for (size_t i = begin; i < end; ++i) {
+                ++histogram[(items[i].m_key >> shift) & (RADIX_SIZE - 1)];
+            }
+        });
+
+        size_t position = 0;
+        for (size_t digit = 0; digit < RADIX_SIZE; ++digit) {
+            for (auto& histogram : chunk_offset) {
+                size_t n = histogram[digit];
+                histogram[digit] = position;
+                position += n;
+            }
+        }
+
+        parallelFor(count, [&](size_t begin, size_t end) {
+            auto& histogram = chunk_offset[begin / chunk_size];
+            for (size_t i = begin; i < end; ++i) {
+                buffer[histogram[(items[i].m_key >> shift) & (RADIX_SIZE - 1)]++] = items[i];
+            }
+        });
+        items.swap(buffer);
+    }
+
+    vector<int> result(count);
+    parallelFor(count, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            result[i] = items[i].m_row;
+        }
+    });
+    return result;
+}
@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "TagIndex.h"
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @class TagSorter
+ * @brief 基于列式tag索引的排序：把排序列映射为无符号整数key，并行LSD基数排序后得到tag下标的排列
+ *
+ * 排序是稳定的，key相同的tag保持输入顺序（降序时也一样）。
+ */
+class TagSorter {
+  public:
+    enum KEY : int {
+        KEY_NONE = -1,
+        KEY_OFFSET = 0,
+        KEY_TYPE,
+        KEY_SIZE,
+        KEY_TIMESTAMP,
+        KEY_CTS,
+        KEY_CODEC,
+        KEY_HASH, // 负载哈希，相同负载的tag排在一起
+        KEY_TRACK // 多轨包的轨道号列表，单轨包排在最前
+    };
+
+    // tag列表的列号对应的排序key，不支持排序的列返回KEY_NONE
+    static KEY keyForColumn(int column);
+
+    // 对rows（tag下标）按key排序，返回新的排列
+    static vector<int> sort(const TagIndex& index, const vector<int>& rows, KEY key, bool descending);
+
+  private:
+    static uint64_t sortKey(const TagIndex& index, size_t i, KEY key);
+};
@@ -0,0 +1,205 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "TimestampAnalyzer.h"
+#include <algorithm>
+#include <cstdlib>
+
+// 参与时间戳分析的音视频数据tag
+static bool isTimedTag(const TagIndex& index, size_t i, uint8_t type) {
+    return index.m_type[i] == type && !(index.m_flags[i] & (TAG_FLAG_SEQUENCE_HEADER | TAG_FLAG_GARBAGE));
+}
+
+static QString streamSummary(const char* name, const StreamTimingStats& stats) {
+    if (stats.m_tag_count == 0) {
+        return QString("%1：无数据").arg(name);
+    }
+    return QString("%1：%2个tag，DTS %3~%4 ms，PTS %5~%6 ms，间隔 %7~%8 ms（平均%9），帧率 %10，断流%11次，回退%12次")
+        .arg(name)
+        .arg(stats.m_tag_count)
+        .arg(stats.m_first_dts)
+        .arg(stats.m_last_dts)
+        .arg(stats.m_min_pts)
+        .arg(stats.m_max_pts)
+        .arg(stats.m_min_delta)
+        .arg(stats.m_max_delta)
+        .arg(stats.m_avg_delta, 0, 'f', 2)
+        .arg(stats.m_frame_rate, 0, 'f', 2)
+        .arg(stats.m_gap_count)
+        .arg(stats.m_backward_count);
+}
+
+QString TimingAnalysis::summary() const {
+    QString text = streamSummary("视频", m_video) + "\n" + streamSummary("音频", m_audio);
+    if (m_video.m_gop_count > 0) {
+        text += QString("\nGOP：%1个，长度 %2~%3 帧（平均%4），最长 %5 ms")
+                    .arg(m_video.m_gop_count)
+                    .arg(m_video.m_min_gop)
+                    .arg(m_video.m_max_gop)
+                    .arg(m_video.m_avg_gop, 0, 'f', 1)
+                    .arg(m_video.m_max_gop_duration);
+    }
+    if (!m_drift.empty()) {
+        text += QString("\n音视频漂移：最大 %1 ms（%2个采样点）").arg(m_max_drift).arg(m_drift.size());
+    }
+    return text;
+}
+
+TimingAnalysis TimestampAnalyzer::analyze(const TagIndex& index) {
+    TimingAnalysis analysis;
+
+    // 按流拆分行号，后续对每路流的连续数组计算
+    vector<uint32_t> audio_rows;
+    vector<uint32_t> video_rows;
+    for (size_t i = 0; i < index.size(); ++i) {
+        if (isTimedTag(index, i, TAG_TYPE_AUDIO))
+            audio_rows.push_back(static_cast<uint32_t>(i));
+        else if (isTimedTag(index, i, TAG_TYPE_VIDEO))
+            video_rows.push_back(static_cast<uint32_t>(i));
+    }
+
+    analyzeStream(index, audio_rows, analysis.m_audio, analysis.m_issues);
+    analyzeStream(index, video_rows, analysis.m_video, analysis.m_issues);
+    analyzeDrift(index, analysis);
+
+    stable_sort(analysis.m_issues.begin(), analysis.m_issues.end(), [](const ValidationIssue& a, const ValidationIssue& b) {
+        return a.m_offset < b.m_offset;
+    });
+    return analysis;
+}
+
+void TimestampAnalyzer::analyzeStream(const TagIndex& index,
+                                      const vector<uint32_t>& rows,
+                                      StreamTimingStats& stats,
+                                      vector<ValidationIssue>& issues) {
+    size_t count = rows.size();
+    stats.m_tag_count = count;
+    if (count == 0) {
+        return;
+    }
+
+    // 先收集DTS/PTS连续数组，再一次遍历求差，便于编译器向量化
+    vector<int64_t> dts(count);
+    vector<int64_t> pts(count);
+    for (size_t k = 0; k < count; ++k) {
+        dts[k] = index.m_timestamp[rows[k]];
+        pts[k] = dts[k] + index.m_cts[rows[k]];
+    }
+
+    vector<int64_t> delta(count > 1 ? count - 1 : 0);
+    for (size_t k = 1; k < count; ++k) {
+        delta[k - 1] = dts[k] - dts[k - 1];
+    }
+
+    stats.m_first_dts = dts.front();
+    stats.m_last_dts = dts.back();
+    auto [min_pts, max_pts] = minmax_element(pts.begin(), pts.end());
+    stats.m_min_pts = *min_pts;
+    stats.m_max_pts = *max_pts;
+
+    if (!delta.empty()) {
+        auto [min_delta, max_delta] = minmax_element(delta.begin(), delta.end());
+        stats.m_min_delta = *min_delta;
+        stats.m_max_delta = *max_delta;
+
+        int64_t sum = 0;
+        for (int64_t d : delta) {
+            sum += d;
+        }
+        stats.m_avg_delta = static_cast<double>(sum) / delta.size();
+    }
+
+    int64_t span = stats.m_last_dts - stats.m_first_dts;
+    if (span > 0) {
+        stats.m_frame_rate = (count - 1) * 1000.0 / span;
+    }
+
+    // 断流和回退
+    for (size_t k = 0; k < delta.size(); ++k) {
+        uint32_t row = rows[k + 1];
+        if (delta[k] < 0) {
+            ++stats.m_backward_count;
+            issues.push_back({row,
+                              index.m_offset[row],
+                              ISSUE_TIMESTAMP_BACKWARD,
+                              SEVERITY_ERROR,
+                              QString("timestamp jumps back %1 ms (%2 -> %3)").arg(-delta[k]).arg(dts[k]).arg(dts[k + 1])});
+        } else if (delta[k] > GAP_THRESHOLD_MS) {
+            ++stats.m_gap_count;
+            issues.push_back({row,
+                              index.m_offset[row],
+                              ISSUE_TIMESTAMP_GAP,
+                              SEVERITY_WARNING,
+                              QString("timestamp gap %1 ms (%2 -> %3)").arg(delta[k]).arg(dts[k]).arg(dts[k + 1])});
+        }
+    }
+
+    // GOP：从一个关键帧到下一个关键帧之前的帧数
+    int64_t gop_start = -1;
+    uint64_t gop_frames_total = 0;
+    for (size_t k = 0; k <= count; ++k) {
+        bool boundary = (k == count) || (index.m_flags[rows[k]] & TAG_FLAG_KEYFRAME);
+        if (!boundary) {
+            continue;
+        }
+        if (gop_start >= 0) {
+            uint32_t frames = static_cast<uint32_t>(k - gop_start);
+            int64_t duration = (k == count ? dts.back() : dts[k]) - dts[gop_start];
+            stats.m_min_gop = stats.m_gop_count == 0 ? frames : min(stats.m_min_gop, frames);
+            stats.m_max_gop = max(stats.m_max_gop, frames);
+            stats.m_max_gop_duration = max(stats.m_max_gop_duration, duration);
+            gop_frames_total += frames;
+            ++stats.m_gop_count;
+        }
+        gop_start = static_cast<int64_t>(k);
+    }
+    if (stats.m_gop_count > 0) {
+        stats.m_avg_gop = static_cast<double>(gop_frames_total) / stats.m_gop_count;
+    }
+}
+
+void TimestampAnalyzer::analyzeDrift(const TagIndex& index, TimingAnalysis& analysis) {
+    int64_t last_audio = -1;
+    int64_t last_video = -1;
+    int64_t next_sample = 0;
+    bool drifting = false;
+
+    for (size_t i = 0; i < index.size(); ++i) {
+        if (isTimedTag(index, i, TAG_TYPE_AUDIO))
+            last_audio = index.m_timestamp[i];
+        else if (isTimedTag(index, i, TAG_TYPE_VIDEO))
+            last_video = index.m_timestamp[i];
+        else
+            continue;
+
+        if (last_audio < 0 || last_video < 0) {
+            continue;
+        }
+
+        int64_t drift = last_video - last_audio;
+        int64_t now = max(last_audio, last_video);
+        if (now >= next_sample) {
+            analysis.m_drift.push_back({now, drift});
+            next_sample = now + DRIFT_SAMPLE_INTERVAL_MS;
+        }
+        if (abs(drift) > abs(analysis.m_max_drift)) {
+            analysis.m_max_drift = drift;
+        }
+
+        // 只在超出阈值的区间开始处报告一次
+        bool over = abs(drift) > MAX_DRIFT_MS;
+        if (over && !drifting) {
+            analysis.m_issues.push_back({static_cast<int64_t>(i),
+                                         index.m_offset[i],
+                                         ISSUE_AV_DRIFT,
+                                         SEVERITY_WARNING,
+                                         QString("video is %1 ms %2 audio (video %3, audio %4)")
+                                             .arg(abs(drift))
+                                             .arg(drift > 0 ? "ahead of" : "behind")
+                                             .arg(last_video)
+                                             .arg(last_audio)});
+        }
+        drifting = over;
+    }
+}
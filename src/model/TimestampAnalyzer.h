@@ -0,0 +1,86 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "StreamValidator.h"
+#include "TagIndex.h"
+#include <QString>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @class StreamTimingStats
+ * @brief 单路流（音频或视频）的时间戳统计，sequence header不参与
+ */
+struct StreamTimingStats {
+    uint64_t m_tag_count = 0;
+    int64_t m_first_dts = -1;
+    int64_t m_last_dts = -1;
+    int64_t m_min_pts = -1; // PTS = DTS + CTS，音频等于DTS
+    int64_t m_max_pts = -1;
+
+    // 相邻tag的DTS差
+    int64_t m_min_delta = 0;
+    int64_t m_max_delta = 0;
+    double m_avg_delta = 0;
+    uint64_t m_gap_count = 0;
+    uint64_t m_backward_count = 0;
+
+    double m_frame_rate = 0; // 有效帧率（tag数/DTS跨度）
+
+    // GOP统计，仅视频：两个关键帧之间的帧数
+    uint64_t m_gop_count = 0;
+    uint32_t m_min_gop = 0;
+    uint32_t m_max_gop = 0;
+    double m_avg_gop = 0;
+    int64_t m_max_gop_duration = 0; // ms
+};
+
+/**
+ * @class DriftSample
+ * @brief 音视频漂移采样：文件顺序上最近的视频DTS减去最近的音频DTS
+ */
+struct DriftSample {
+    int64_t m_dts = 0;
+    int64_t m_drift = 0;
+};
+
+/**
+ * @class TimingAnalysis
+ * @brief 时间戳分析结果
+ */
+struct TimingAnalysis {
+    StreamTimingStats m_audio;
+    StreamTimingStats m_video;
+    vector<DriftSample> m_drift;
+    int64_t m_max_drift = 0; // 绝对值最大的漂移(ms)，带符号
+    vector<ValidationIssue> m_issues;
+
+    QString summary() const;
+};
+
+/**
+ * @class TimestampAnalyzer
+ * @brief 基于tag索引的时间戳分析：间隔、跳变、回退、音视频漂移、帧率和GOP
+ */
+class TimestampAnalyzer {
+  public:
+    // 相邻tag时间戳差超过该值视为断流(ms)
+    static constexpr int64_t GAP_THRESHOLD_MS = 1000;
+    // 音视频漂移超过该值报告问题(ms)
+    static constexpr int64_t MAX_DRIFT_MS = 500;
+    // 漂移采样间隔(ms)
+    static constexpr int64_t DRIFT_SAMPLE_INTERVAL_MS = 1000;
+
+    static TimingAnalysis analyze(const TagIndex& index);
+
+  private:
+    static void analyzeStream(const TagIndex& index,
+                              const vector<uint32_t>& rows,
+                              StreamTimingStats& stats,
+                              vector<ValidationIssue>& issues);
+    static void analyzeDrift(const TagIndex& index, TimingAnalysis& analysis);
+};
@@ -0,0 +1,588 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "TsMuxer.h"
+#include "BufferedWriter.h"
+#include "CodecConfig.h"
+#include "Log.h"
+#include "Parallel.h"
+#include <QByteArray>
+#include <QFile>
+#include <QFileInfo>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr int TS_PACKET_SIZE = 188;
+
+constexpr uint16_t PID_PAT = 0x0000;
+constexpr uint16_t PID_PMT = 0x1000;
+constexpr uint16_t PID_VIDEO = 0x0100;
+constexpr uint16_t PID_AUDIO = 0x0101;
+
+constexpr uint8_t STREAM_ID_VIDEO = 0xE0;
+constexpr uint8_t STREAM_ID_AUDIO = 0xC0;
+
+// 90kHz时钟上的起始偏移和PCR提前量，保证CTS为负时PTS和PCR也不小于0
+constexpr uint64_t TIMESTAMP_OFFSET = 126000;
+constexpr uint64_t PCR_DELAY = 63000;
+
+const uchar AVC_AUD[6] = {0, 0, 0, 1, 0x09, 0xF0};
+const uchar HEVC_AUD[7] = {0, 0, 0, 1, 0x46, 0x01, 0x50};
+
+enum STREAM : int {
+    STREAM_AUDIO = 0,
+    STREAM_VIDEO = 1
+};
+
+uint32_t crc32Mpeg(const uchar* p, int size) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (int i = 0; i < size; ++i) {
+        crc ^= static_cast<uint32_t>(p[i]) << 24;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+// PES头中的33位时间戳，prefix为PTS/DTS标记
+void writeTimestamp(uchar* p, uint8_t prefix, uint64_t ts) {
+    ts &= 0x1FFFFFFFFull;
+    p[0] = static_cast<uchar>((prefix << 4) | ((ts >> 29) & 0x0E) | 1);
+    p[1] = static_cast<uchar>(ts >> 22);
+    p[2] = static_cast<uchar>(((ts >> 14) & 0xFE) | 1);
+    p[3] = static_cast<uchar>(ts >> 7);
+    p[4] = static_cast<uchar>(((ts << 1) & 0xFE) | 1);
+}
+
+uint8_t streamType(uint32_t codec) {
+    switch (codec) {
+    case FOURCC_AVC1:
+        return 0x1B;
+    case FOURCC_HVC1:
+        return 0x24;
+    case FOURCC_AAC:
+        return 0x0F;
+    case FOURCC_MP3:
+        return 0x03;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief 所有分片共用的只读信息
+ */
+struct MuxContext {
+    const TagIndex& m_index;
+    const uchar* m_mapped = nullptr;
+    uint64_t m_source_size = 0;
+    uint32_t m_codec[2] = {0, 0}; // STREAM_AUDIO/STREAM_VIDEO，不支持的流为0
+    uint32_t m_base = 0;
+
+    // tag属于哪个输出流，不输出时返回-1
+    int streamOf(size_t i) const {
+        if (m_index.m_flags[i] & (TAG_FLAG_GARBAGE | TAG_FLAG_MULTITRACK))
+            return -1;
+        int stream = m_index.m_type[i] == TAG_TYPE_VIDEO ? STREAM_VIDEO
+                     : m_index.m_type[i] == TAG_TYPE_AUDIO ? STREAM_AUDIO
+                                                           : -1;
+        if (stream < 0 || m_codec[stream] == 0 || m_index.m_codec[i] != m_codec[stream] ||
+            m_index.m_offset[i] + 11 + m_index.m_data_size[i] > m_source_size)
+            return -1;
+        return stream;
+    }
+
+    uint32_t rebased(size_t i) const {
+        return m_index.m_timestamp[i] > m_base ? m_index.m_timestamp[i] - m_base : 0;
+    }
+};
+
+/**
+ * @brief 一个输出分片：tag区间、开始时生效的sequence header和写出统计
+ */
+struct Segment {
+    size_t m_begin = 0;
+    size_t m_end = 0;
+    int64_t m_header[2] = {-1, -1}; // 分片开始前最近的sequence header
+    uint32_t m_start = 0;           // 第一帧时间(ms)
+    uint32_t m_duration = 0;
+    QString m_path;
+
+    uint64_t m_video_frames = 0;
+    uint64_t m_audio_frames = 0;
+    uint64_t m_parameter_sets = 0;
+    uint64_t m_skipped = 0;
+    uint64_t m_size = 0;
+    QString m_error;
+};
+
+/**
+ * @class TsSegmentWriter
+ * @brief 把一个分片的tag写成TS包，连续计数器在分片内递增
+ */
+class TsSegmentWriter {
+  public:
+    TsSegmentWriter(BufferedWriter& writer, const MuxContext& context, Segment& segment)
+        : m_writer(writer), m_context(context), m_segment(segment) {
+        m_pcr_pid = context.m_codec[STREAM_VIDEO] ? PID_VIDEO : PID_AUDIO;
+    }
+
+    void run() {
+        const TagIndex& index = m_context.m_index;
+        for (int stream : {STREAM_AUDIO, STREAM_VIDEO}) {
+            if (m_segment.m_header[stream] >= 0)
+                setSequenceHeader(stream, m_segment.m_header[stream]);
+        }
+        writeTables();
+
+        for (size_t i = m_segment.m_begin; i < m_segment.m_end; ++i) {
+            int stream = m_context.streamOf(i);
+            if (stream < 0)
+                continue;
+            if (index.m_flags[i] & TAG_FLAG_SEQUENCE_HEADER) {
+                setSequenceHeader(stream, i);
+                continue;
+            }
+            uint8_t packet_type = index.m_packet_type[i];
+            if (stream == STREAM_VIDEO) {
+                if (packet_type == VIDEO_PACKET_CODED_FRAMES || packet_type == VIDEO_PACKET_CODED_FRAMES_X)
+                    writeVideo(i);
+            } else if (m_context.m_codec[STREAM_AUDIO] == FOURCC_MP3 || packet_type == AUDIO_PACKET_CODED_FRAMES) {
+                writeAudio(i);
+            }
+        }
+    }
+
+  private:
+    const uchar* payload(size_t i) const {
+        return m_context.m_mapped + m_context.m_index.m_offset[i] + m_context.m_index.m_payload_offset[i];
+    }
+
+    void setSequenceHeader(int stream, size_t i) {
+        const uchar* p = payload(i);
+        uint32_t size = m_context.m_index.m_payload_size[i];
+        uint32_t codec = m_context.m_codec[stream];
+        if (stream == STREAM_VIDEO) {
+            ParameterSets sets;
+            bool ok = codec == FOURCC_AVC1 ? parseAvcConfig(p, size, sets) : parseHevcConfig(p, size, sets);
+            if (ok) {
+                m_sets = sets;
+            } else {
+                ++m_segment.m_skipped;
+            }
+        } else if (codec == FOURCC_AAC) {
+            QString error;
+            m_has_adts = parseAudioSpecificConfig(p, size, m_adts, error);
+            if (!m_has_adts)
+                throw error;
+        }
+    }
+
+    void writeVideo(size_t i) {
+        const TagIndex& index = m_context.m_index;
+        uint32_t codec = m_context.m_codec[STREAM_VIDEO];
+        const uchar* p = payload(i);
+        bool has_parameter_sets = false;
+        if (!splitNalus(p, index.m_payload_size[i], m_sets.m_length_size, codec, m_nalus, has_parameter_sets)) {
+            ++m_segment.m_skipped;
+            return;
+        }
+        if (m_nalus.empty())
+            return;
+
+        bool keyframe = index.m_flags[i] & TAG_FLAG_KEYFRAME;
+        beginPes(19);
+        if (codec == FOURCC_AVC1) {
+            m_pes.append(reinterpret_cast<const char*>(AVC_AUD), sizeof(AVC_AUD));
+        } else {
+            m_pes.append(reinterpret_cast<const char*>(HEVC_AUD), sizeof(HEVC_AUD));
+        }
+        if (keyframe && !has_parameter_sets && !m_sets.m_annexb.isEmpty()) {
+            m_pes.append(m_sets.m_annexb);
+            ++m_segment.m_parameter_sets;
+        }
+        for (auto& [start, len] : m_nalus) {
+            // 源数据中的AUD已经由上面统一加上
+            uint8_t type = codec == FOURCC_AVC1 ? (p[start] & 0x1F) : ((p[start] >> 1) & 0x3F);
+            if (type == (codec == FOURCC_AVC1 ? 9 : 35))
+                continue;
+            m_pes.append(reinterpret_cast<const char*>(START_CODE), 4);
+            m_pes.append(reinterpret_cast<const char*>(p + start), len);
+        }
+
+        uint64_t dts = m_context.rebased(i) * 90ull + TIMESTAMP_OFFSET;
+        int64_t pts = static_cast<int64_t>(dts) + static_cast<int64_t>(index.m_cts[i]) * 90;
+        if (keyframe && !m_tables_written)
+            writeTables();
+        finishPes(STREAM_ID_VIDEO, max<int64_t>(pts, 0), dts);
+        writePes(PID_VIDEO, dts, keyframe);
+        ++m_segment.m_video_frames;
+    }
+
+    void writeAudio(size_t i) {
+        const uchar* p = payload(i);
+        uint32_t size = m_context.m_index.m_payload_size[i];
+        beginPes(14);
+        if (m_context.m_codec[STREAM_AUDIO] == FOURCC_AAC) {
+            if (!m_has_adts || 7 + size > MAX_ADTS_FRAME) {
+                ++m_segment.m_skipped;
+                return;
+            }
+            uchar header[7];
+            makeAdtsHeader(header, m_adts, size);
+            m_pes.append(reinterpret_cast<const char*>(header), 7);
+        }
+        m_pes.append(reinterpret_cast<const char*>(p), size);
+
+        uint64_t pts = m_context.rebased(i) * 90ull + TIMESTAMP_OFFSET;
+        finishPes(STREAM_ID_AUDIO, pts, pts);
+        writePes(PID_AUDIO, pts, false);
+        ++m_segment.m_audio_frames;
+    }
+
+    // 预留PES头，视频带PTS和DTS共19字节，音频只带PTS共14字节
+    void beginPes(int header_size) {
+        m_pes.resize(header_size);
+    }
+
+    void finishPes(uint8_t stream_id, uint64_t pts, uint64_t dts) {
+        uchar* h = reinterpret_cast<uchar*>(m_pes.data());
+        bool has_dts = stream_id == STREAM_ID_VIDEO;
+        int header_data = has_dts ? 10 : 5;
+        uint32_t length = static_cast<uint32_t>(m_pes.size() - 6);
+        h[0] = 0;
+        h[1] = 0;
+        h[2] = 1;
+        h[3] = stream_id;
+        // 视频PES可能超过65535字节，长度写0表示不限
+        length = has_dts || length > 0xFFFF ? 0 : length;
+        h[4] = static_cast<uchar>(length >> 8);
+        h[5] = static_cast<uchar>(length);
+        h[6] = 0x80;
+        h[7] = has_dts ? 0xC0 : 0x80;
+        h[8] = static_cast<uchar>(header_data);
+        writeTimestamp(h + 9, has_dts ? 0x3 : 0x2, pts);
+        if (has_dts)
+            writeTimestamp(h + 14, 0x1, dts);
+    }
+
+    // 把PES切成TS包，第一个包带PCR（PCR所在流）和随机访问标记，最后一个包用自适应字段填充
+    void writePes(uint16_t pid, uint64_t dts, bool random_access) {
+        const uchar* data = reinterpret_cast<const uchar*>(m_pes.constData());
+        uint32_t size = m_pes.size();
+        uint32_t pos = 0;
+        bool first = true;
+        while (pos < size) {
+            uchar packet[TS_PACKET_SIZE];
+            uchar adaptation[TS_PACKET_SIZE];
+            int adaptation_len = 0; // 自适应字段长度字节之后的内容
+            if (first && (pid == m_pcr_pid || random_access)) {
+                adaptation[0] = (random_access ? 0x40 : 0) | (pid == m_pcr_pid ? 0x10 : 0);
+                adaptation_len = 1;
+                if (pid == m_pcr_pid) {
+                    uint64_t pcr = (dts - PCR_DELAY) & 0x1FFFFFFFFull;
+                    adaptation[1] = static_cast<uchar>(pcr >> 25);
+                    adaptation[2] = static_cast<uchar>(pcr >> 17);
+                    adaptation[3] = static_cast<uchar>(pcr >> 9);
+                    adaptation[4] = static_cast<uchar>(pcr >> 1);
+                    adaptation[5] = static_cast<uchar>(((pcr & 1) << 7) | 0x7E);
+                    adaptation[6] = 0;
+                    adaptation_len = 7;
+                }
+            }
+
+            int adaptation_total = adaptation_len > 0 ? 1 + adaptation_len : 0;
+            uint32_t remaining = size - pos;
+            if (remaining < static_cast<uint32_t>(TS_PACKET_SIZE - 4 - adaptation_total))
+                adaptation_total = TS_PACKET_SIZE - 4 - remaining;
+            uint32_t chunk = TS_PACKET_SIZE - 4 - adaptation_total;
+
+            packet[0] = 0x47;
+            packet[1] = static_cast<uchar>((first ? 0x40 : 0) | ((pid >> 8) & 0x1F));
+            packet[2] = static_cast<uchar>(pid);
+            packet[3] = static_cast<uchar>((adaptation_total > 0 ? 0x30 : 0x10) | nextCounter(pid));
+            uchar* q = packet + 4;
+            if (adaptation_total > 0) {
+                q[0] = static_cast<uchar>(adaptation_total - 1);
+                if (adaptation_total > 1) {
+                    if (adaptation_len == 0) {
+                        adaptation[0] = 0;
+                        adaptation_len = 1;
+                    }
+                    memcpy(q + 1, adaptation, adaptation_len);
+                    memset(q + 1 + adaptation_len, 0xFF, adaptation_total - 1 - adaptation_len);
+                }
+                q += adaptation_total;
+            }
+            memcpy(q, data + pos, chunk);
+            m_writer.write(packet, TS_PACKET_SIZE);
+            pos += chunk;
+            first = false;
+        }
+        m_tables_written = false;
+    }
+
+    void writeSection(uint16_t pid, const uchar* section, int size) {
+        uchar packet[TS_PACKET_SIZE];
+        memset(packet, 0xFF, TS_PACKET_SIZE);
+        packet[0] = 0x47;
+        packet[1] = static_cast<uchar>(0x40 | (pid >> 8));
+        packet[2] = static_cast<uchar>(pid);
+        packet[3] = static_cast<uchar>(0x10 | nextCounter(pid));
+        packet[4] = 0; // pointer_field
+        memcpy(packet + 5, section, size);
+        uint32_t crc = crc32Mpeg(section, size);
+        packet[5 + size] = static_cast<uchar>(crc >> 24);
+        packet[6 + size] = static_cast<uchar>(crc >> 16);
+        packet[7 + size] = static_cast<uchar>(crc >> 8);
+        packet[8 + size] = static_cast<uchar>(crc);
+        m_writer.write(packet, TS_PACKET_SIZE);
+    }
+
+    void writeTables() {
+        const uchar pat[12] = {
+            0x00, 0xB0, 13, 0x00, 0x01, 0xC1, 0x00, 0x00, 0x00, 0x01, 0xE0 | (PID_PMT >> 8), PID_PMT & 0xFF};
+        writeSection(PID_PAT, pat, sizeof(pat));
+
+        uchar pmt[32] = {0x02, 0xB0, 0, 0x00, 0x01, 0xC1, 0x00, 0x00};
+        pmt[8] = static_cast<uchar>(0xE0 | (m_pcr_pid >> 8));
+        pmt[9] = static_cast<uchar>(m_pcr_pid);
+        pmt[10] = 0xF0; // program_info_length = 0
+        pmt[11] = 0x00;
+        int size = 12;
+        for (int stream : {STREAM_VIDEO, STREAM_AUDIO}) {
+            uint32_t codec = m_context.m_codec[stream];
+            if (codec == 0)
+                continue;
+            uint16_t pid = stream == STREAM_VIDEO ? PID_VIDEO : PID_AUDIO;
+            pmt[size++] = streamType(codec);
+            pmt[size++] = static_cast<uchar>(0xE0 | (pid >> 8));
+            pmt[size++] = static_cast<uchar>(pid);
+            pmt[size++] = 0xF0; // ES_info_length = 0
+            pmt[size++] = 0x00;
+        }
+        pmt[2] = static_cast<uchar>(size - 3 + 4); // 包含CRC
+        writeSection(PID_PMT, pmt, size);
+        m_tables_written = true;
+    }
+
+    uint8_t nextCounter(uint16_t pid) {
+        uint8_t& counter = pid == PID_PAT ? m_counter[0] : pid == PID_PMT ? m_counter[1]
+                                                        : pid == PID_VIDEO ? m_counter[2]
+                                                                           : m_counter[3];
+        uint8_t value = counter;
+        counter = (counter + 1) & 0x0F;
+        return value;
+    }
+
+    BufferedWriter& m_writer;
+    const MuxContext& m_context;
+    Segment& m_segment;
+    uint16_t m_pcr_pid;
+    uint8_t m_counter[4] = {0, 0, 0, 0};
+    bool m_tables_written = false; // 刚写过PAT/PMT，关键帧前不必重复
+
+    ParameterSets m_sets;
+    AdtsConfig m_adts;
+    bool m_has_adts = false;
+    QByteArray m_pes;                          // 复用，避免每帧分配
+    vector<pair<uint32_t, uint32_t>> m_nalus;
+};
+
+void writeSegment(const MuxContext& context, Segment& segment) {
+    QFile file(segment.m_path);
+    try {
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            throw QString("创建输出文件失败：%1：%2").arg(segment.m_path, file.errorString());
+        }
+        BufferedWriter writer(file, TsMuxer::SEGMENT_BUFFER_SIZE);
+        TsSegmentWriter(writer, context, segment).run();
+        writer.flush();
+        segment.m_size = writer.written();
+    } catch (const QString& error) {
+        segment.m_error = error;
+    }
+}
+
+QByteArray buildPlaylist(const vector<Segment>& segments, uint32_t max_duration) {
+    QString playlist = QString("#EXTM3U\n"
+                               "#EXT-X-VERSION:3\n"
+                               "#EXT-X-PLAYLIST-TYPE:VOD\n"
+                               "#EXT-X-TARGETDURATION:%1\n"
+                               "#EXT-X-MEDIA-SEQUENCE:0\n")
+                           .arg(static_cast<int>(ceil(max_duration / 1000.0)));
+    for (const Segment& segment : segments) {
+        playlist += QString("#EXTINF:%1,\n%2\n")
+                        .arg(segment.m_duration / 1000.0, 0, 'f', 3)
+                        .arg(QFileInfo(segment.m_path).fileName());
+    }
+    playlist += "#EXT-X-ENDLIST\n";
+    return playlist.toUtf8();
+}
+
+} // namespace
+
+QString TsReport::toString() const {
+    return QString("%1个分片（最长%2ms），视频%3帧，音频%4帧，输出%5字节\n"
+                   "关键帧前插入参数集%6次，跳过%7个tag")
+        .arg(m_segments)
+        .arg(m_max_segment)
+        .arg(m_video_frames)
+        .arg(m_audio_frames)
+        .arg(m_output_size)
+        .arg(m_parameter_sets)
+        .arg(m_skipped);
+}
+
+bool TsMuxer::remux(const QString& source_path,
+                    const QString& target_path,
+                    const TagIndex& index,
+                    const TsOptions& options,
+                    TsReport& report) {
+    report = TsReport();
+    QFile source(source_path);
+    uchar* mapped = nullptr;
+    vector<Segment> segments;
+
+    try {
+        MuxContext context{index};
+        context.m_codec[STREAM_VIDEO] = streamCodec(index, TAG_TYPE_VIDEO);
+        context.m_codec[STREAM_AUDIO] = streamCodec(index, TAG_TYPE_AUDIO);
+        for (uint32_t& codec : context.m_codec) {
+            if (codec != 0 && streamType(codec) == 0) {
+                qCInfo(runLog) << QString("[flv-ts] event[stream dropped] codec[%1]").arg(fourCCToString(codec));
+                codec = 0;
+            }
+        }
+        if (context.m_codec[STREAM_VIDEO] == 0 && context.m_codec[STREAM_AUDIO] == 0) {
+            throw QString("没有可转封装的流，目前支持H.264、HEVC视频和AAC、MP3音频");
+        }
+
+        if (!source.open(QIODevice::ReadOnly)) {
+            throw QString("打开源文件失败：%1").arg(source.errorString());
+        }
+        context.m_source_size = source.size();
+        mapped = source.map(0, context.m_source_size);
+        if (!mapped) {
+            throw QString("映射源文件失败：%1").arg(source.errorString());
+        }
+        context.m_mapped = mapped;
+
+        bool found = false;
+        for (size_t i = 0; i < index.size(); ++i) {
+            if (context.streamOf(i) >= 0 && !(index.m_flags[i] & TAG_FLAG_SEQUENCE_HEADER)) {
+                context.m_base = found ? min(context.m_base, index.m_timestamp[i]) : index.m_timestamp[i];
+                found = true;
+            }
+        }
+
+        // 在索引上划分分片：有视频时在达到目标时长后的第一个关键帧处切分，纯音频按时长切分
+        bool has_video = context.m_codec[STREAM_VIDEO] != 0;
+        int64_t last_header[2] = {-1, -1};
+        uint32_t last_time = 0;
+        uint32_t last_gap = 0;
+        for (size_t i = 0; i < index.size(); ++i) {
+            int stream = context.streamOf(i);
+            if (stream < 0) {
+                bool media = index.m_type[i] == TAG_TYPE_AUDIO || index.m_type[i] == TAG_TYPE_VIDEO;
+                if (media && !(index.m_flags[i] & TAG_FLAG_GARBAGE))
+                    ++report.m_skipped;
+                continue;
+            }
+            if (index.m_flags[i] & TAG_FLAG_SEQUENCE_HEADER) {
+                last_header[stream] = i;
+                continue;
+            }
+            uint32_t ts = context.rebased(i);
+            bool boundary = has_video ? stream == STREAM_VIDEO && (index.m_flags[i] & TAG_FLAG_KEYFRAME) : true;
+            if (segments.empty() ||
+                (options.m_hls && boundary && ts - segments.back().m_start >= options.m_segment_duration)) {
+                if (!segments.empty()) {
+                    segments.back().m_end = i;
+                    segments.back().m_duration = ts - segments.back().m_start;
+                }
+                Segment segment;
+                segment.m_begin = segments.empty() ? 0 : i;
+                segment.m_start = ts;
+                segment.m_header[0] = last_header[0];
+                segment.m_header[1] = last_header[1];
+                segments.push_back(segment);
+            }
+            if (!has_video || stream == STREAM_VIDEO) {
+                last_gap = ts > last_time ? ts - last_time : last_gap;
+                last_time = ts;
+            }
+        }
+        if (segments.empty()) {
+            throw QString("没有可写出的音视频帧");
+        }
+        segments.back().m_end = index.size();
+        segments.back().m_duration = last_time - segments.back().m_start + last_gap;
+
+        QFileInfo info(target_path);
+        QString prefix = info.absolutePath() + "/" + info.completeBaseName();
+        for (size_t s = 0; s < segments.size(); ++s) {
+            segments[s].m_path =
+                options.m_hls ? prefix + QString("_%1.ts").arg(static_cast<qulonglong>(s), 5, 10, QChar('0'))
+                              : target_path;
+        }
+
+        // 分片之间没有依赖，按连续区间分给多个线程
+        parallelFor(
+            segments.size(),
+            [&](size_t begin, size_t end) {
+                for (size_t s = begin; s < end; ++s) {
+                    writeSegment(context, segments[s]);
+                }
+            },
+            1);
+
+        for (const Segment& segment : segments) {
+            if (!segment.m_error.isEmpty())
+                throw segment.m_error;
+            report.m_video_frames += segment.m_video_frames;
+            report.m_audio_frames += segment.m_audio_frames;
+            report.m_parameter_sets += segment.m_parameter_sets;
+            report.m_skipped += segment.m_skipped;
+            report.m_output_size += segment.m_size;
+            report.m_max_segment = max(report.m_max_segment, segment.m_duration);
+        }
+        report.m_segments = segments.size();
+        source.unmap(mapped);
+        mapped = nullptr;
+
+        if (options.m_hls) {
+            QFile playlist(target_path);
+            QByteArray text = buildPlaylist(segments, report.m_max_segment);
+            if (!playlist.open(QIODevice::WriteOnly | QIODevice::Truncate) || playlist.write(text) != text.size()) {
+                throw QString("写入播放列表失败：%1").arg(playlist.errorString());
+            }
+            report.m_output_size += text.size();
+        }
+
+        qCInfo(runLog) << QString("[flv-ts] event[finished] target[%1] segments[%2] video[%3] audio[%4] size[%5] "
+                                  "skipped[%6]")
+                              .arg(target_path)
+                              .arg(report.m_segments)
+                              .arg(report.m_video_frames)
+                              .arg(report.m_audio_frames)
+                              .arg(report.m_output_size)
+                              .arg(report.m_skipped);
+        return true;
+    } catch (const QString& error) {
+        qCInfo(runLog) << QString("[flv-ts] event[failed] error[%1]").arg(error);
+        report.m_error = error;
+        if (mapped)
+            source.unmap(mapped);
+        for (const Segment& segment : segments) {
+            if (!segment.m_path.isEmpty())
+                QFile::remove(segment.m_path);
+        }
+        return false;
+    }
+}
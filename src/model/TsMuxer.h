@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "TagIndex.h"
+#include <QString>
+#include <cstdint>
+
+using namespace std;
+
+/**
+ * @class TsOptions
+ * @brief MPEG-TS转封装选项
+ */
+struct TsOptions {
+    bool m_hls = false;                // 按关键帧切分为HLS分片并生成.m3u8，否则输出单个.ts
+    uint32_t m_segment_duration = 6000; // HLS分片的目标时长(ms)，分片在此之后的第一个关键帧处切分
+};
+
+/**
+ * @class TsReport
+ * @brief MPEG-TS转封装结果统计
+ */
+struct TsReport {
+    uint64_t m_segments = 0;
+    uint64_t m_video_frames = 0;
+    uint64_t m_audio_frames = 0;
+    uint64_t m_parameter_sets = 0; // 在关键帧前插入参数集的次数
+    uint64_t m_skipped = 0;        // 跳过的tag：codec不一致、多轨、截断、负载不完整
+    uint32_t m_max_segment = 0;    // 最长分片的时长(ms)
+    uint64_t m_output_size = 0;
+    QString m_error;
+
+    QString toString() const;
+};
+
+/**
+ * @class TsMuxer
+ * @brief 不重新编码，把FLV转封装为MPEG-TS，可按关键帧切分为HLS分片并生成播放列表
+ *
+ * - 视频转为Annex-B，每帧前加AUD，关键帧没有带内参数集时插入sequence header中的SPS/PPS（HEVC含VPS）
+ * - AAC加ADTS头，MP3原样输出，PTS/DTS由tag时间戳和CTS换算到90kHz
+ * - 先在tag索引上按关键帧划分分片，记下每个分片开始时生效的sequence header，
+ *   再把分片区间分给多个线程，各自从映射的源文件读取并写出自己的分片文件
+ * - 每个分片以PAT/PMT开头、连续计数器从0开始，可独立解码
+ *
+ * 支持H.264、HEVC视频和AAC、MP3音频
+ */
+class TsMuxer {
+  public:
+    // target_path为HLS播放列表(.m3u8)或单个.ts文件，HLS分片命名为<播放列表文件名>_00000.ts，与播放列表同目录
+    static bool remux(const QString& source_path,
+                      const QString& target_path,
+                      const TagIndex& index,
+                      const TsOptions& options,
+                      TsReport& report);
+
+    static constexpr int64_t SEGMENT_BUFFER_SIZE = 4 * 1024 * 1024; // 每个线程的输出缓冲
+};
@@ -0,0 +1,65 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <QtGlobal>
+#include <cstdint>
+
+/**
+ * @class BitReader
+ * @brief 按位读取（高位在前），越界时返回0并置m_overflow，用于解析SPS、AudioSpecificConfig等码流结构
+ */
+class BitReader {
+  public:
+    BitReader(const uchar* data, uint32_t size) : m_data(data), m_size(size) {
+    }
+
+    uint32_t read(int bits) {
+        uint32_t value = 0;
+        for (int i = 0; i < bits; ++i) {
+            if (m_pos >= static_cast<uint64_t>(m_size) * 8) {
+                m_overflow = true;
+                return 0;
+            }
+            value = (value << 1) | ((m_data[m_pos >> 3] >> (7 - (m_pos & 7))) & 1);
+            ++m_pos;
+        }
+        return value;
+    }
+
+    void skip(int bits) {
+        m_pos += bits;
+        if (m_pos > static_cast<uint64_t>(m_size) * 8)
+            m_overflow = true;
+    }
+
+    // 无符号指数哥伦布编码ue(v)
+    uint32_t readUE() {
+        int zeros = 0;
+        while (read(1) == 0) {
+            if (m_overflow || ++zeros > 31) {
+                m_overflow = true;
+                return 0;
+            }
+        }
+        return ((1u << zeros) - 1) + read(zeros);
+    }
+
+    // 有符号指数哥伦布编码se(v)
+    int32_t readSE() {
+        uint32_t value = readUE();
+        return (value & 1) ? static_cast<int32_t>((value + 1) / 2) : -static_cast<int32_t>(value / 2);
+    }
+
+    bool overflow() const {
+        return m_overflow;
+    }
+
+  private:
+    const uchar* m_data;
+    uint32_t m_size;
+    uint64_t m_pos = 0;
+    bool m_overflow = false;
+};
@@ -0,0 +1,63 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <cstdint>
+
+/**
+ * @class BufferedWriter
+ * @brief 输出缓冲，小块数据攒满后一次顺序写入文件，超过缓冲区的大块直接写出，写入失败时抛出QString
+ */
+class BufferedWriter {
+  public:
+    static constexpr int64_t DEFAULT_BUFFER_SIZE = 8 * 1024 * 1024;
+
+    explicit BufferedWriter(QFile& file, int64_t buffer_size = DEFAULT_BUFFER_SIZE)
+        : m_file(file), m_buffer_size(buffer_size) {
+        m_buffer.reserve(m_buffer_size);
+    }
+
+    void write(const char* data, int64_t size) {
+        if (m_buffer.size() + size > m_buffer_size) {
+            flush();
+        }
+        if (size >= m_buffer_size) {
+            writeRaw(data, size);
+            return;
+        }
+        m_buffer.append(data, size);
+    }
+
+    void write(const uchar* data, int64_t size) {
+        write(reinterpret_cast<const char*>(data), size);
+    }
+
+    void flush() {
+        if (!m_buffer.isEmpty()) {
+            writeRaw(m_buffer.constData(), m_buffer.size());
+            m_buffer.resize(0);
+        }
+    }
+
+    uint64_t written() const {
+        return m_written + m_buffer.size();
+    }
+
+  private:
+    void writeRaw(const char* data, int64_t size) {
+        if (m_file.write(data, size) != size) {
+            throw QString("写入文件失败：%1").arg(m_file.errorString());
+        }
+        m_written += size;
+    }
+
+    QFile& m_file;
+    int64_t m_buffer_size;
+    QByteArray m_buffer;
+    uint64_t m_written = 0;
+};
@@ -3,44 +3,204 @@
 // SPDX-License-Identifier: MIT
 
 #include "Log.h"
+#include <QByteArray>
 #include <QFile>
-#include <QMutex>
 #include <QStandardPaths>
-#include <QTextStream>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
 
-Q_LOGGING_CATEGORY(runLog, "runLog")
+Q_LOGGING_CATEGORY(runLog, "runLog", QtInfoMsg)
 
-// 定义全局文件对象和锁（确保线程安全）
-static QFile g_logFile;
-static QMutex g_logMutex;
+namespace {
 
-void initLog() {
-    QMutexLocker locker(&g_logMutex);
+/**
+ * @class AsyncLogWriter
+ * @brief 多生产者单消费者的有界环形队列加后台写线程
+ *
+ * 各线程在消息处理函数里只做格式化和一次CAS入队，不加锁；写线程定时或在队列过半、出现警告时被唤醒，
+ * 把队列中的日志攒成一批写入文件并只刷新一次。队列满时生产者让出CPU等待，写线程运行期间日志不丢弃
+ */
+class AsyncLogWriter {
+  public:
+    static constexpr size_t QUEUE_SIZE = 8192; // 必须是2的幂
+    static constexpr auto FLUSH_INTERVAL = std::chrono::milliseconds(200);
+
+    AsyncLogWriter() : m_slots(new Slot[QUEUE_SIZE]) {
+        for (size_t i = 0; i < QUEUE_SIZE; ++i) {
+            m_slots[i].m_sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~AsyncLogWriter() { stop(); }
+
+    bool start(const QString& path) {
+        stop();
+        m_file.setFileName(path);
+        if (!m_file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+            return false;
+        }
+        m_stopping.store(false, std::memory_order_relaxed);
+        m_thread = std::thread([this] { run(); });
+        m_running.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void stop() {
+        if (!m_running.exchange(false, std::memory_order_acq_rel))
+            return;
+        {
+            std::lock_guard<std::mutex> locker(m_wake_mutex);
+            m_stopping.store(true, std::memory_order_relaxed);
+        }
+        m_wake.notify_one();
+        m_thread.join();
+        drain();
+        m_file.close();
+    }
+
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+
+    void push(QString&& line, bool urgent) {
+        size_t pos = m_tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = m_slots[pos & (QUEUE_SIZE - 1)];
+            size_t sequence = slot.m_sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.m_line = std::move(line);
+                    slot.m_sequence.store(pos + 1, std::memory_order_release);
+                    break;
+                }
+            } else if (diff < 0) {
+                // 队列已满，唤醒写线程后重试；写线程已停止时丢弃
+                if (!isRunning())
+                    return;
+                m_wake.notify_one();
+                std::this_thread::yield();
+                pos = m_tail.load(std::memory_order_relaxed);
+            } else {
+                pos = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+        if (urgent || pos - m_head.load(std::memory_order_relaxed) >= QUEUE_SIZE / 2) {
+            m_wake.notify_one();
+        }
+    }
+
+    // 唤醒写线程并等待它写完当前队列，最多等一个刷新周期
+    void flush() {
+        if (!isRunning())
+            return;
+        std::unique_lock<std::mutex> locker(m_wake_mutex);
+        m_flush_requested = true;
+        m_wake.notify_one();
+        m_flushed.wait_for(locker, FLUSH_INTERVAL, [this] { return !m_flush_requested; });
+    }
+
+  private:
+    struct Slot {
+        std::atomic<size_t> m_sequence{0};
+        QString m_line;
+    };
+
+    void run() {
+        std::unique_lock<std::mutex> locker(m_wake_mutex);
+        while (!m_stopping.load(std::memory_order_relaxed)) {
+            m_wake.wait_for(locker, FLUSH_INTERVAL, [this] {
+                return m_flush_requested || m_stopping.load(std::memory_order_relaxed);
+            });
+            bool flush_requested = m_flush_requested;
+            locker.unlock();
+            drain();
+            locker.lock();
+            if (flush_requested) {
+                m_flush_requested = false;
+                m_flushed.notify_all();
+            }
+        }
+    }
 
+    // 只在写线程（或写线程退出后）调用
+    void drain() {
+        m_batch.clear();
+        size_t head = m_head.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = m_slots[head & (QUEUE_SIZE - 1)];
+            if (slot.m_sequence.load(std::memory_order_acquire) != head + 1)
+                break;
+            m_batch.append(slot.m_line.toUtf8());
+            m_batch.append('\n');
+            slot.m_line.clear();
+            slot.m_sequence.store(head + QUEUE_SIZE, std::memory_order_release);
+            ++head;
+            m_head.store(head, std::memory_order_relaxed);
+        }
+        if (!m_batch.isEmpty()) {
+            m_file.write(m_batch);
+            m_file.flush();
+        }
+    }
+
+    std::unique_ptr<Slot[]> m_slots;
+    alignas(64) std::atomic<size_t> m_tail{0};
+    alignas(64) std::atomic<size_t> m_head{0};
+
+    QFile m_file;
+    QByteArray m_batch;
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_stopping{false};
+    std::mutex m_wake_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_flushed;
+    bool m_flush_requested = false;
+};
+
+AsyncLogWriter g_logWriter;
+
+} // namespace
+
+void initLog() {
     // 设置日志路径（Windows 建议写入用户目录）
     QString logPath = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) + "/flv_parser.log";
-    g_logFile.setFileName(logPath);
-    if (!g_logFile.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate)) {
+    if (!g_logWriter.start(logPath)) {
         qDebug() << "无法打开日志文件!";
     }
 }
 
-void customMessageHandler(QtMsgType type, const QMessageLogContext& context, const QString& msg) {
-    QMutexLocker locker(&g_logMutex);
+void shutdownLog() {
+    g_logWriter.stop();
+}
+
+void flushLog() {
+    g_logWriter.flush();
+}
+
+void setDebugLogEnabled(bool enabled) {
+    QLoggingCategory::setFilterRules(QString("runLog.debug=%1").arg(enabled ? "true" : "false"));
+}
 
-    // 打开文件（如果未打开）
-    if (!g_logFile.isOpen()) {
+void customMessageHandler(QtMsgType type, const QMessageLogContext& context, const QString& msg) {
+    if (!g_logWriter.isRunning()) {
         return;
     }
 
-    // 格式化日志内容
-    QString logMsg = qFormatLogMessage(type, context, msg);
+    // 格式化在调用线程完成，编码和写文件交给写线程
+    g_logWriter.push(qFormatLogMessage(type, context, msg), type != QtDebugMsg && type != QtInfoMsg);
 
-    QTextStream stream(&g_logFile);
-    stream << logMsg << Qt::endl;
+    // fatal之后进程会终止，先把队列写完
+    if (type == QtFatalMsg) {
+        g_logWriter.stop();
+    }
 }
 
 void printLogWithPos(QtMsgType type, const QDataStream& stream, const QString& msg) {
     QString logMsg = QString("[flv-parsing] file-pos[0x%1] %2").arg(stream.device()->pos(), 0, 16).arg(msg);
     qt_message_output(type, QMessageLogContext(), logMsg);
-}
\ No newline at end of file
+}
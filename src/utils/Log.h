@@ -4,10 +4,32 @@
 
 #pragma once
 
+#include <QDataStream>
+#include <QIODevice>
 #include <QLoggingCategory>
 
 Q_DECLARE_LOGGING_CATEGORY(runLog)
 
+// 定义FLV_PARSER_NO_DEBUG_LOG时，LOG_WITH_POS的调试级别日志在编译期去掉
+#ifdef FLV_PARSER_NO_DEBUG_LOG
+#define FLV_LOG_DEBUG_COMPILED false
+#else
+#define FLV_LOG_DEBUG_COMPILED true
+#endif
+
 void initLog();
+// 写出队列中剩余的日志并停止写线程，程序退出前调用
+void shutdownLog();
+// 立即写出队列中的日志，读取日志文件前调用
+void flushLog();
+// runLog默认只记录info及以上级别，也可以通过QT_LOGGING_RULES="runLog.debug=true"打开
+void setDebugLogEnabled(bool enabled);
 void customMessageHandler(QtMsgType type, const QMessageLogContext& context, const QString& msg);
-void printLogWithPos(QtMsgType type, const QDataStream& stream, const QString& msg);
\ No newline at end of file
+void printLogWithPos(QtMsgType type, const QDataStream& stream, const QString& msg);
+
+// 先检查级别再对msg求值，关闭的级别不做任何格式化
+#define LOG_WITH_POS(type, stream, msg)                                                                                \
+    do {                                                                                                               \
+        if (((type) != QtDebugMsg || FLV_LOG_DEBUG_COMPILED) && runLog().isEnabled(type))                              \
+            printLogWithPos((type), (stream), (msg));                                                                  \
+    } while (0)
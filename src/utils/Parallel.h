@@ -0,0 +1,49 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+
+/**
+ * @brief parallelFor对[0, count)切分的区间长度，区间下标为begin / chunk_size
+ */
+inline size_t parallelChunkSize(size_t count, size_t min_chunk = 4096) {
+    if (count == 0) {
+        return 1;
+    }
+
+    size_t thread_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+    size_t chunk_count = std::max<size_t>(1, std::min(thread_count, (count + min_chunk - 1) / min_chunk));
+    return (count + chunk_count - 1) / chunk_count;
+}
+
+/**
+ * @brief 将[0, count)切分为连续区间，在共用的ThreadPool上并行执行func(begin, end)
+ * @param min_chunk 每个区间的最小元素数，数据量小时退化为单线程
+ *
+ * 可以在池线程中嵌套调用：等待其他区间时当前线程只帮忙执行本次调用的区间
+ */
+template <typename Func> void parallelFor(size_t count, Func&& func, size_t min_chunk = 4096) {
+    if (count == 0) {
+        return;
+    }
+
+    size_t chunk_size = parallelChunkSize(count, min_chunk);
+    if (chunk_size >= count) {
+        func(size_t(0), count);
+        return;
+    }
+
+    TaskGroup group;
+    for (size_t begin = chunk_size; begin < count; begin += chunk_size) {
+        size_t end = std::min(count, begin + chunk_size);
+        group.run([&func, begin, end]() { func(begin, end); });
+    }
+    func(size_t(0), std::min(count, chunk_size)); // 当前线程处理第一个区间
+    group.wait();
+}
@@ -0,0 +1,151 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "ThreadPool.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+// 当前线程在池中的下标，池外线程为SIZE_MAX
+thread_local size_t t_worker_index = SIZE_MAX;
+
+} // namespace
+
+ThreadPool& ThreadPool::instance() {
+    static ThreadPool pool;
+    return pool;
+}
+
+ThreadPool::ThreadPool() {
+    size_t thread_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+    for (size_t i = 0; i < thread_count; ++i) {
+        m_workers.emplace_back(new Worker);
+    }
+    for (size_t i = 0; i < thread_count; ++i) {
+        m_threads.emplace_back([this, i] { run(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> locker(m_wake_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+bool ThreadPool::isWorkerThread() {
+    return t_worker_index != SIZE_MAX;
+}
+
+void ThreadPool::submit(std::function<void()> task, TaskGroup* group) {
+    size_t index = t_worker_index;
+    if (index == SIZE_MAX) {
+        index = m_next.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+    }
+
+    Worker& worker = *m_workers[index];
+    {
+        std::lock_guard<std::mutex> locker(worker.m_mutex);
+        worker.m_tasks.push_back(Task{std::move(task), group});
+    }
+    m_pending.fetch_add(1, std::memory_order_release);
+
+    // 先拿锁再通知，避免与正要休眠的线程错过
+    { std::lock_guard<std::mutex> locker(m_wake_mutex); }
+    m_wake.notify_one();
+}
+
+bool ThreadPool::popTask(size_t self, TaskGroup* group, Task& task) {
+    if (m_pending.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+
+    auto matches = [group](const Task& t) { return !group || t.m_group == group; };
+    size_t count = m_workers.size();
+    if (self < count) {
+        Worker& own = *m_workers[self];
+        std::lock_guard<std::mutex> locker(own.m_mutex);
+        auto it = std::find_if(own.m_tasks.rbegin(), own.m_tasks.rend(), matches);
+        if (it != own.m_tasks.rend()) {
+            task = std::move(*it);
+            own.m_tasks.erase(std::next(it).base());
+            m_pending.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    size_t start = self < count ? self + 1 : 0;
+    for (size_t i = 0; i < count; ++i) {
+        Worker& victim = *m_workers[(start + i) % count];
+        std::lock_guard<std::mutex> locker(victim.m_mutex);
+        auto it = std::find_if(victim.m_tasks.begin(), victim.m_tasks.end(), matches);
+        if (it != victim.m_tasks.end()) {
+            task = std::move(*it);
+            victim.m_tasks.erase(it);
+            m_pending.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::runPending(TaskGroup* group) {
+    Task task;
+    if (!isWorkerThread() || !popTask(t_worker_index, group, task)) {
+        return false;
+    }
+    task.m_func();
+    return true;
+}
+
+void ThreadPool::run(size_t self) {
+    t_worker_index = self;
+    Task task;
+    for (;;) {
+        if (popTask(self, nullptr, task)) {
+            task.m_func();
+            task = Task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> locker(m_wake_mutex);
+        m_wake.wait(locker, [this] { return m_stopping || m_pending.load(std::memory_order_acquire) > 0; });
+        if (m_stopping) {
+            return;
+        }
+    }
+}
+
+void TaskGroup::run(std::function<void()> task) {
+    m_remaining.fetch_add(1, std::memory_order_relaxed);
+    ThreadPool::instance().submit(
+        [this, task = std::move(task)] {
+            task();
+            finishTask();
+        },
+        this);
+}
+
+void TaskGroup::finishTask() {
+    // 持锁递减，等待方检查计数和休眠之间不会错过通知
+    std::lock_guard<std::mutex> locker(m_mutex);
+    if (m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        m_done.notify_all();
+    }
+}
+
+void TaskGroup::wait() {
+    // 池线程先帮忙执行本组还在队列中的任务，剩下的都在其他线程上运行时再休眠
+    ThreadPool& pool = ThreadPool::instance();
+    while (!isIdle() && pool.runPending(this)) {
+    }
+
+    std::unique_lock<std::mutex> locker(m_mutex);
+    m_done.wait(locker, [this] { return isIdle(); });
+}
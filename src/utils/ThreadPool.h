@@ -0,0 +1,99 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ * @brief 进程内共用的任务窃取线程池，文件解析、parallelFor和各种分析都在这里执行
+ *
+ * 每个线程有自己的任务队列：池线程提交的任务放在本线程队列尾部并从尾部取（后进先出，数据还在缓存里），
+ * 空闲时从其他线程队列头部窃取；池外线程提交的任务轮流分给各线程。
+ * 池线程等待TaskGroup时只帮忙执行同一组的任务，不会在等待中执行别的长任务（如解析另一个文件）
+ */
+class TaskGroup;
+
+class ThreadPool {
+  public:
+    static ThreadPool& instance();
+
+    // 任务不能抛出异常，group为任务所属的组，可为空
+    void submit(std::function<void()> task, TaskGroup* group = nullptr);
+
+    // 在当前池线程执行group中一个待执行的任务，没有任务或当前线程不在池中时返回false
+    bool runPending(TaskGroup* group);
+
+    // 当前线程是否为池线程
+    static bool isWorkerThread();
+
+    size_t threadCount() const {
+        return m_workers.size();
+    }
+
+  private:
+    struct Task {
+        std::function<void()> m_func;
+        TaskGroup* m_group = nullptr;
+    };
+
+    struct Worker {
+        std::mutex m_mutex;
+        std::deque<Task> m_tasks;
+    };
+
+    ThreadPool();
+    ~ThreadPool();
+
+    // 先取本线程队列尾部，再依次窃取其他线程队列头部；group不为空时只取该组的任务
+    bool popTask(size_t self, TaskGroup* group, Task& task);
+    void run(size_t self);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+    std::atomic<size_t> m_pending{0}; // 已提交未取走的任务数，空闲线程据此休眠
+    std::atomic<size_t> m_next{0};    // 池外提交时轮流选择的线程
+
+    std::mutex m_wake_mutex;
+    std::condition_variable m_wake;
+    bool m_stopping = false;
+};
+
+/**
+ * @class TaskGroup
+ * @brief 一组提交到ThreadPool的任务，wait()等待全部完成
+ *
+ * 池线程等待时帮忙执行本组还没开始的任务，池外线程（如界面线程）不执行任务，阻塞到全部完成
+ */
+class TaskGroup {
+  public:
+    ~TaskGroup() {
+        wait();
+    }
+
+    void run(std::function<void()> task);
+    void wait();
+
+    bool isIdle() const {
+        return m_remaining.load(std::memory_order_acquire) == 0;
+    }
+
+  private:
+    friend class ThreadPool;
+
+    void finishTask();
+
+    std::atomic<size_t> m_remaining{0};
+    std::mutex m_mutex;
+    std::condition_variable m_done;
+};
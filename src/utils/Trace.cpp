@@ -0,0 +1,201 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "Trace.h"
+#include <QByteArray>
+#include <QFile>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+std::atomic<bool> Trace::s_enabled{false};
+
+namespace {
+
+struct TraceEvent {
+    const char* m_name;
+    int64_t m_begin;    // 相对开始跟踪时刻的纳秒数
+    int64_t m_duration; // 纳秒
+    uint64_t m_counters[TRACE_COUNTER_COUNT]; // 区间内的增量
+};
+
+struct ThreadBuffer {
+    int m_tid = 0;
+    bool m_main = false; // 调用start()的线程
+    mutex m_mutex;       // 保护m_events，写入线程和导出线程都要加锁
+    vector<TraceEvent> m_events;
+};
+
+const char* const COUNTER_NAME[TRACE_COUNTER_COUNT] = {"bytes_read", "tags_parsed", "allocations", "allocated_bytes"};
+
+// thread_local均为平凡类型，operator new中和线程退出时访问都是安全的
+thread_local uint64_t t_counters[TRACE_COUNTER_COUNT] = {};
+thread_local ThreadBuffer* t_buffer = nullptr;
+thread_local uint64_t t_generation = 0;
+
+mutex g_buffers_mutex;
+vector<unique_ptr<ThreadBuffer>> g_buffers;
+// 之前各次跟踪的缓冲，其他线程的t_buffer可能还指向它们，只清空事件不释放
+vector<unique_ptr<ThreadBuffer>> g_retired;
+atomic<uint64_t> g_generation{0}; // 每次start()加一，线程据此发现自己的缓冲已过期
+atomic<int64_t> g_start_ns{0};    // 开始跟踪时刻，steady_clock的纳秒数
+thread::id g_start_thread;
+
+int64_t steadyNanoseconds() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+ThreadBuffer* threadBuffer() {
+    uint64_t generation = g_generation.load(memory_order_acquire);
+    if (t_buffer && t_generation == generation) {
+        return t_buffer;
+    }
+
+    lock_guard<mutex> locker(g_buffers_mutex);
+    auto buffer = make_unique<ThreadBuffer>();
+    buffer->m_tid = static_cast<int>(g_buffers.size()) + 1;
+    buffer->m_main = this_thread::get_id() == g_start_thread;
+    t_buffer = buffer.get();
+    t_generation = generation;
+    g_buffers.push_back(std::move(buffer));
+    return t_buffer;
+}
+
+QByteArray formatMicroseconds(int64_t ns) {
+    return QByteArray::number(static_cast<double>(ns) / 1000.0, 'f', 3);
+}
+
+} // namespace
+
+void Trace::start() {
+    lock_guard<mutex> locker(g_buffers_mutex);
+    for (auto& buffer : g_buffers) {
+        lock_guard<mutex> buffer_locker(buffer->m_mutex);
+        vector<TraceEvent>().swap(buffer->m_events);
+        g_retired.push_back(std::move(buffer));
+    }
+    g_buffers.clear();
+    g_start_ns.store(steadyNanoseconds(), memory_order_relaxed);
+    g_start_thread = this_thread::get_id();
+    g_generation.fetch_add(1, memory_order_release);
+    s_enabled.store(true, memory_order_relaxed);
+}
+
+void Trace::stop() {
+    s_enabled.store(false, memory_order_relaxed);
+}
+
+void Trace::addCount(TRACE_COUNTER counter, uint64_t value) {
+    t_counters[counter] += value;
+}
+
+int64_t Trace::now() {
+    return steadyNanoseconds() - g_start_ns.load(memory_order_relaxed);
+}
+
+void Trace::snapshot(uint64_t counters[TRACE_COUNTER_COUNT]) {
+    for (int i = 0; i < TRACE_COUNTER_COUNT; ++i) {
+        counters[i] = t_counters[i];
+    }
+}
+
+void Trace::record(const char* name, int64_t begin, const uint64_t counters[TRACE_COUNTER_COUNT]) {
+    TraceEvent event{name, begin, now() - begin, {}};
+    for (int i = 0; i < TRACE_COUNTER_COUNT; ++i) {
+        event.m_counters[i] = t_counters[i] - counters[i];
+    }
+    // 期间start()可能已让缓冲过期，写入过期缓冲的事件不会被导出
+    ThreadBuffer* buffer = threadBuffer();
+    lock_guard<mutex> locker(buffer->m_mutex);
+    buffer->m_events.push_back(event);
+}
+
+size_t Trace::eventCount() {
+    lock_guard<mutex> locker(g_buffers_mutex);
+    size_t count = 0;
+    for (const auto& buffer : g_buffers) {
+        lock_guard<mutex> buffer_locker(buffer->m_mutex);
+        count += buffer->m_events.size();
+    }
+    return count;
+}
+
+bool Trace::exportChromeJson(const QString& path, QString& error) {
+    QByteArray json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    {
+        lock_guard<mutex> locker(g_buffers_mutex);
+        bool first = true;
+        for (const auto& buffer : g_buffers) {
+            lock_guard<mutex> buffer_locker(buffer->m_mutex);
+            QByteArray tid = QByteArray::number(buffer->m_tid);
+            json += first ? "\n" : ",\n";
+            first = false;
+            json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + tid + ",\"args\":{\"name\":\"" +
+                    (buffer->m_main ? QByteArray("main") : "worker-" + tid) + "\"}}";
+
+            for (const TraceEvent& event : buffer->m_events) {
+                json += ",\n{\"name\":\"" + QByteArray(event.m_name) + "\",\"cat\":\"flv\",\"ph\":\"X\",\"pid\":1";
+                json += ",\"tid\":" + tid + ",\"ts\":" + formatMicroseconds(event.m_begin) +
+                        ",\"dur\":" + formatMicroseconds(event.m_duration) + ",\"args\":{";
+                for (int i = 0; i < TRACE_COUNTER_COUNT; ++i) {
+                    json += (i ? ",\"" : "\"") + QByteArray(COUNTER_NAME[i]) +
+                            "\":" + QByteArray::number(static_cast<qulonglong>(event.m_counters[i]));
+                }
+                json += "}}";
+            }
+        }
+    }
+    json += "\n]}\n";
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size()) {
+        error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+// 替换全局operator new以统计分配次数，未开始跟踪时只多读一次原子变量
+void* operator new(size_t size) {
+    if (Trace::isEnabled()) {
+        ++t_counters[TRACE_ALLOCATIONS];
+        t_counters[TRACE_ALLOCATED_BYTES] += size;
+    }
+    if (size == 0)
+        size = 1;
+    for (;;) {
+        if (void* p = malloc(size))
+            return p;
+        new_handler handler = get_new_handler();
+        if (!handler)
+            throw bad_alloc();
+        handler();
+    }
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept {
+    try {
+        return operator new(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, const nothrow_t&) noexcept {
+    free(p);
+}
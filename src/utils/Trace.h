@@ -0,0 +1,91 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <QString>
+#include <atomic>
+#include <cstdint>
+
+// 每个线程各自累计的计数器，记录在跟踪区间的参数中（区间内的增量）
+enum TRACE_COUNTER : uint8_t {
+    TRACE_BYTES_READ = 0,
+    TRACE_TAGS_PARSED,
+    TRACE_ALLOCATIONS,     // operator new调用次数
+    TRACE_ALLOCATED_BYTES, // operator new申请的字节数
+    TRACE_COUNTER_COUNT
+};
+
+/**
+ * @class Trace
+ * @brief 阶段级性能跟踪，导出为Chrome trace JSON（chrome://tracing、Perfetto可直接打开）
+ *
+ * 每个线程把区间写入自己的缓冲，缓冲的锁只在导出时才有竞争；未开始跟踪时区间和计数器只读一次原子变量
+ */
+class Trace {
+  public:
+    // 清空之前的记录并开始跟踪
+    static void start();
+    static void stop();
+    static bool isEnabled() {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    // 写出之前记录的所有区间，失败时返回false并填写error
+    static bool exportChromeJson(const QString& path, QString& error);
+    static size_t eventCount();
+
+    static void count(TRACE_COUNTER counter, uint64_t value) {
+        if (isEnabled())
+            addCount(counter, value);
+    }
+
+  private:
+    friend class TraceScope;
+
+    static void addCount(TRACE_COUNTER counter, uint64_t value);
+    static int64_t now();
+    static void snapshot(uint64_t counters[TRACE_COUNTER_COUNT]);
+    static void record(const char* name, int64_t begin, const uint64_t counters[TRACE_COUNTER_COUNT]);
+
+    static std::atomic<bool> s_enabled;
+};
+
+/**
+ * @class TraceScope
+ * @brief 记录从构造到析构的一个区间，name须为字符串字面量
+ */
+class TraceScope {
+  public:
+    explicit TraceScope(const char* name) {
+        if (!Trace::isEnabled())
+            return;
+        m_name = name;
+        Trace::snapshot(m_counters);
+        m_begin = Trace::now();
+    }
+    ~TraceScope() {
+        if (m_name)
+            Trace::record(m_name, m_begin, m_counters);
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+  private:
+    const char* m_name = nullptr;
+    int64_t m_begin = 0;
+    uint64_t m_counters[TRACE_COUNTER_COUNT];
+};
+
+// 定义FLV_PARSER_NO_TRACE时跟踪点在编译期去掉
+#ifdef FLV_PARSER_NO_TRACE
+#define TRACE_SCOPE(name)
+#define TRACE_COUNT(counter, value)
+#else
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#define TRACE_COUNT(counter, value) Trace::count((counter), (value))
+#endif
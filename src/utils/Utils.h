@@ -11,13 +11,27 @@ inline unsigned int bigend_ctou24(const unsigned char* data) {
 }
 
 inline int bigend_ctoi24(const unsigned char* data) {
-    return (int) (*(data + 2) + (*(data + 1) << 8) + (*(data) << 16));
+    int value = (int) (*(data + 2) + (*(data + 1) << 8) + (*(data) << 16));
+    return (value ^ 0x800000) - 0x800000; // 符号扩展，CTS可能为负
 }
 
 inline unsigned int bigend_ctou32(const unsigned char* data) {
     return *(data + 3) + (*(data + 2) << 8) + (*(data + 1) << 16) + (*(data) << 24);
 }
 
+inline void bigend_utoc24(unsigned char* data, unsigned int value) {
+    data[0] = (value >> 16) & 0xFF;
+    data[1] = (value >> 8) & 0xFF;
+    data[2] = value & 0xFF;
+}
+
+inline void bigend_utoc32(unsigned char* data, unsigned int value) {
+    data[0] = (value >> 24) & 0xFF;
+    data[1] = (value >> 16) & 0xFF;
+    data[2] = (value >> 8) & 0xFF;
+    data[3] = value & 0xFF;
+}
+
 inline void read_exception(QDataStream& stream, char* buffer, int size) {
     if (size != stream.readRawData(buffer, size)) {
         throw QString("eof");
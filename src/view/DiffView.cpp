@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "DiffView.h"
+#include "ui_diffview.h"
+#include <QFileInfo>
+
+DiffView::DiffView(QWidget* parent) : QWidget(parent), ui(new Ui::DiffView) {
+    ui->setupUi(this);
+
+    connect(ui->diffOnlyCheck, &QCheckBox::toggled, this, [this](bool checked) {
+        if (m_row_model)
+            m_row_model->setDiffOnly(checked);
+    });
+
+    // 双击跳转到当前文件中对应的tag
+    connect(ui->diffTableView, &QTableView::doubleClicked, this, &DiffView::onRowActivated);
+}
+
+DiffView::~DiffView() {
+    delete ui;
+}
+
+void DiffView::setResult(unique_ptr<DiffResult> result, qint64 elapsed_ms) {
+    ui->diffTableView->setModel(nullptr);
+    m_result = std::move(result);
+    m_row_model = make_unique<ModelDiffRows>(m_result.get());
+    m_row_model->setDiffOnly(ui->diffOnlyCheck->isChecked());
+    ui->diffTableView->setModel(m_row_model.get());
+
+    ui->summaryLabel->setText(QString("A：%1\nB：%2\n")
+                                  .arg(QFileInfo(m_result->m_path_a).fileName())
+                                  .arg(QFileInfo(m_result->m_path_b).fileName()) +
+                              m_result->summary() + QString("，耗时 %1 ms，双击跳转到A中的tag").arg(elapsed_ms));
+
+    QStringList lines;
+    for (auto& diff : m_result->m_metadata) {
+        lines.append(QString("%1: %2 -> %3")
+                         .arg(diff.m_key)
+                         .arg(diff.m_a.isEmpty() ? "(无)" : diff.m_a)
+                         .arg(diff.m_b.isEmpty() ? "(无)" : diff.m_b));
+    }
+    ui->metadataText->setPlainText(lines.isEmpty() ? "onMetaData相同" : lines.join("\n"));
+}
+
+void DiffView::clearResult() {
+    ui->diffTableView->setModel(nullptr);
+    m_row_model.reset();
+    m_result.reset();
+    ui->summaryLabel->setText("未比较");
+    ui->metadataText->clear();
+}
+
+void DiffView::onRowActivated(const QModelIndex& index) {
+    if (!index.isValid() || !m_row_model) {
+        return;
+    }
+
+    const DiffRow& row = m_row_model->getRow(index.row());
+    if (row.m_a >= 0) {
+        emit tagJumpRequested(static_cast<int>(row.m_a));
+    }
+}
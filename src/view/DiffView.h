@@ -0,0 +1,44 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "ModelWidget.h"
+#include <QWidget>
+#include <memory>
+
+using namespace std;
+
+QT_BEGIN_NAMESPACE
+namespace Ui {
+class DiffView;
+}
+QT_END_NAMESPACE
+
+/**
+ * @class DiffView
+ * @brief 两个文件的并排比较结果，下方列出onMetaData的差异
+ */
+class DiffView : public QWidget {
+    Q_OBJECT
+
+  public:
+    explicit DiffView(QWidget* parent = nullptr);
+    ~DiffView();
+
+    void setResult(unique_ptr<DiffResult> result, qint64 elapsed_ms);
+    void clearResult();
+
+  signals:
+    // 跳转到当前文件（A）中的指定tag
+    void tagJumpRequested(int tag_index);
+
+  private slots:
+    void onRowActivated(const QModelIndex& index);
+
+  private:
+    Ui::DiffView* ui;
+    unique_ptr<DiffResult> m_result;
+    unique_ptr<ModelDiffRows> m_row_model;
+};
@@ -0,0 +1,299 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "GopMapWidget.h"
+#include <QMouseEvent>
+#include <QPainter>
+#include <QToolTip>
+#include <QWheelEvent>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 一个像素覆盖多帧时按此顺序选类别，越靠前越重要
+constexpr uint8_t KIND_PRIORITY[GopMap::KIND_COUNT] = {0, 3, 4, 1, 2};
+
+// 视频与tag列表的底色同色相，关键帧偏橙，sequence header为紫色
+QColor kindColor(uint8_t kind) {
+    static const QColor colors[GopMap::KIND_COUNT] = {QColor::fromHsv(30, 220, 240),
+                                                      QColor::fromHsv(60, 200, 200),
+                                                      QColor::fromHsv(60, 80, 220),
+                                                      QColor::fromHsv(280, 160, 220),
+                                                      QColor(150, 150, 150)};
+    return colors[kind];
+}
+
+QColor gopBandColor(const GopMap::Gop& gop, int64_t gop_index) {
+    if (gop.m_irregular)
+        return QColor(220, 40, 40);
+    return gop_index % 2 ? QColor(120, 120, 120) : QColor(190, 190, 190);
+}
+
+} // namespace
+
+GopMapWidget::GopMapWidget(QWidget* parent) : QWidget(parent), m_tiles(TILE_CACHE_KB) {
+    setMouseTracking(true);
+    setMinimumHeight(40);
+}
+
+void GopMapWidget::setGopMap(const GopMap* gop_map) {
+    m_gop_map = gop_map;
+    m_tiles.clear();
+    m_current_frame = -1;
+    m_offset = 0;
+
+    // 默认显示整条图
+    m_min_scale = MAX_SCALE;
+    while (m_gop_map && m_min_scale > -40 && contentWidth(m_min_scale) > max(width(), 1)) {
+        --m_min_scale;
+    }
+    m_scale = m_min_scale;
+    update();
+}
+
+void GopMapWidget::setCurrentTag(int tag_index) {
+    m_current_frame = -1;
+    if (m_gop_map && tag_index >= 0) {
+        size_t frame = m_gop_map->frameOfTag(tag_index);
+        if (frame < m_gop_map->size() && m_gop_map->m_tag[frame] == static_cast<uint32_t>(tag_index))
+            m_current_frame = static_cast<int64_t>(frame);
+    }
+    update();
+}
+
+int64_t GopMapWidget::contentWidth(int scale) const {
+    int64_t frames = m_gop_map ? static_cast<int64_t>(m_gop_map->size()) : 0;
+    if (scale >= 0)
+        return frames << scale;
+    return (frames + (int64_t(1) << -scale) - 1) >> -scale;
+}
+
+void GopMapWidget::frameRange(int64_t x, size_t& begin, size_t& end) const {
+    size_t frames = m_gop_map ? m_gop_map->size() : 0;
+    if (x < 0) {
+        begin = end = 0;
+        return;
+    }
+    if (m_scale >= 0) {
+        begin = static_cast<size_t>(x >> m_scale);
+        end = begin + 1;
+    } else {
+        begin = static_cast<size_t>(x << -m_scale);
+        end = static_cast<size_t>((x + 1) << -m_scale);
+    }
+    begin = min(begin, frames);
+    end = min(end, frames);
+}
+
+size_t GopMapWidget::largestFrame(size_t begin, size_t end) const {
+    size_t largest = begin;
+    for (size_t f = begin + 1; f < end; ++f) {
+        if (m_gop_map->m_size[f] > m_gop_map->m_size[largest])
+            largest = f;
+    }
+    return largest;
+}
+
+const QImage& GopMapWidget::tile(int64_t tile_index) {
+    int64_t key = (static_cast<int64_t>(m_scale + 64) << 48) | tile_index;
+    if (QImage* cached = m_tiles.object(key))
+        return *cached;
+
+    QImage* image = new QImage(renderTile(tile_index));
+    m_tiles.insert(key, image, max<qint64>(1, TILE_WIDTH * height() * 4 / 1024));
+    return *image;
+}
+
+QImage GopMapWidget::renderTile(int64_t tile_index) const {
+    QImage image(TILE_WIDTH, height(), QImage::Format_ARGB32_Premultiplied);
+    image.fill(palette().color(QPalette::Base));
+    QPainter painter(&image);
+
+    // 高度按长度的平方根缩放，小的帧间预测帧也能看清
+    int bar_space = height() - BAND_HEIGHT - 1;
+    double max_size = max<uint32_t>(m_gop_map->m_max_size, 1);
+    auto barHeight = [&](uint32_t size) {
+        return max(1, static_cast<int>(sqrt(size / max_size) * bar_space));
+    };
+
+    int64_t tile_x = tile_index * TILE_WIDTH;
+    if (m_scale >= 0) {
+        // 每帧一格，宽度不小于4像素时留1像素间隔
+        int cell = 1 << m_scale;
+        int gap = cell >= 4 ? 1 : 0;
+        size_t begin = 0, end = 0, last = 0;
+        frameRange(tile_x, begin, end);
+        frameRange(tile_x + TILE_WIDTH - 1, last, end);
+        for (size_t f = begin; f < end; ++f) {
+            int x = static_cast<int>((static_cast<int64_t>(f) << m_scale) - tile_x);
+            int h = barHeight(m_gop_map->m_size[f]);
+            painter.fillRect(x, height() - h, cell - gap, h, kindColor(m_gop_map->m_kind[f]));
+            int64_t g = m_gop_map->gopAt(f);
+            if (g >= 0)
+                painter.fillRect(x, 0, cell, BAND_HEIGHT, gopBandColor(m_gop_map->m_gops[g], g));
+        }
+        return image;
+    }
+
+    for (int x = 0; x < TILE_WIDTH; ++x) {
+        size_t begin = 0, end = 0;
+        frameRange(tile_x + x, begin, end);
+        if (begin >= end)
+            break;
+
+        uint32_t size = 0;
+        uint8_t kind = m_gop_map->m_kind[begin];
+        for (size_t f = begin; f < end; ++f) {
+            size = max(size, m_gop_map->m_size[f]);
+            if (KIND_PRIORITY[m_gop_map->m_kind[f]] < KIND_PRIORITY[kind])
+                kind = m_gop_map->m_kind[f];
+        }
+        painter.setPen(kindColor(kind));
+        painter.drawLine(x, height() - 1, x, height() - barHeight(size));
+
+        // 覆盖的GOP中有不规则的就标红
+        int64_t first_gop = m_gop_map->gopAt(begin);
+        int64_t last_gop = m_gop_map->gopAt(end - 1);
+        if (last_gop < 0)
+            continue;
+        int64_t band_gop = last_gop;
+        for (int64_t g = max<int64_t>(first_gop, 0); g <= last_gop; ++g) {
+            if (m_gop_map->m_gops[g].m_irregular) {
+                band_gop = g;
+                break;
+            }
+        }
+        painter.fillRect(x, 0, 1, BAND_HEIGHT, gopBandColor(m_gop_map->m_gops[band_gop], band_gop));
+    }
+    return image;
+}
+
+void GopMapWidget::paintEvent(QPaintEvent*) {
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().color(QPalette::Base));
+    if (!m_gop_map || m_gop_map->size() == 0) {
+        painter.setPen(palette().color(QPalette::PlaceholderText));
+        painter.drawText(rect(), Qt::AlignCenter, "无视频帧");
+        return;
+    }
+
+    int64_t first_tile = m_offset / TILE_WIDTH;
+    int64_t last_tile = min(m_offset + width() - 1, contentWidth(m_scale) - 1) / TILE_WIDTH;
+    for (int64_t t = first_tile; t <= last_tile; ++t) {
+        painter.drawImage(static_cast<int>(t * TILE_WIDTH - m_offset), 0, tile(t));
+    }
+
+    // 当前选中的帧不进缓存，单独画
+    if (m_current_frame >= 0) {
+        int64_t x = (m_scale >= 0 ? m_current_frame << m_scale : m_current_frame >> -m_scale) - m_offset;
+        if (x >= 0 && x < width()) {
+            painter.setPen(palette().color(QPalette::Text));
+            painter.drawRect(static_cast<int>(x), 0, max(1 << max(m_scale, 0), 2) - 1, height() - 1);
+        }
+    }
+}
+
+void GopMapWidget::mousePressEvent(QMouseEvent* event) {
+    if (event->button() != Qt::LeftButton)
+        return;
+    m_dragging = true;
+    m_dragged = false;
+    m_press_x = event->pos().x();
+    m_press_offset = m_offset;
+}
+
+void GopMapWidget::mouseMoveEvent(QMouseEvent* event) {
+    if (!m_gop_map || m_gop_map->size() == 0)
+        return;
+
+    int x = event->pos().x();
+    if (m_dragging) {
+        m_dragged = m_dragged || abs(x - m_press_x) > 3;
+        if (m_dragged) {
+            m_offset = m_press_offset - (x - m_press_x);
+            clampOffset();
+            update();
+        }
+        return;
+    }
+
+    size_t begin = 0, end = 0;
+    frameRange(m_offset + x, begin, end);
+    if (begin >= end)
+        return;
+
+    size_t frame = largestFrame(begin, end);
+    QString text = end - begin > 1 ? QString("帧 %1 ~ %2，最大的为帧 %3\n").arg(begin).arg(end - 1).arg(frame)
+                                   : QString("帧 %1\n").arg(frame);
+    text += QString("tag %1，%2，%3 字节\n")
+                .arg(m_gop_map->m_tag[frame])
+                .arg(GopMap::kindName(m_gop_map->m_kind[frame]))
+                .arg(m_gop_map->m_size[frame]);
+    int64_t g = m_gop_map->gopAt(frame);
+    if (g >= 0) {
+        const GopMap::Gop& gop = m_gop_map->m_gops[g];
+        text += QString("GOP %1：%2 帧，%3 ms%4\n")
+                    .arg(g)
+                    .arg(gop.m_frames)
+                    .arg(gop.m_duration_ms)
+                    .arg(gop.m_irregular ? "，不规则" : "");
+    }
+    text += "单击跳转，拖动平移，滚轮缩放\n\n" + m_gop_map->summary();
+    QToolTip::showText(event->globalPos(), text, this);
+}
+
+void GopMapWidget::mouseReleaseEvent(QMouseEvent* event) {
+    if (event->button() != Qt::LeftButton || !m_dragging)
+        return;
+    m_dragging = false;
+    if (m_dragged || !m_gop_map)
+        return;
+
+    // 单击跳转到该处最大的帧
+    size_t begin = 0, end = 0;
+    frameRange(m_offset + event->pos().x(), begin, end);
+    if (begin < end) {
+        emit tagJumpRequested(static_cast<int>(m_gop_map->m_tag[largestFrame(begin, end)]));
+    }
+}
+
+void GopMapWidget::wheelEvent(QWheelEvent* event) {
+    if (!m_gop_map || m_gop_map->size() == 0)
+        return;
+    setScale(m_scale + (event->angleDelta().y() > 0 ? 1 : -1), static_cast<int>(event->position().x()));
+}
+
+void GopMapWidget::resizeEvent(QResizeEvent* event) {
+    // 瓦片高度随控件变化，宽度变化只影响最小级别
+    if (event->size().height() != event->oldSize().height())
+        m_tiles.clear();
+
+    int min_scale = MAX_SCALE;
+    while (m_gop_map && min_scale > -40 && contentWidth(min_scale) > max(event->size().width(), 1)) {
+        --min_scale;
+    }
+    bool fitted = m_scale == m_min_scale;
+    m_min_scale = min_scale;
+    if (fitted || m_scale < m_min_scale)
+        m_scale = m_min_scale;
+    clampOffset();
+}
+
+void GopMapWidget::setScale(int scale, int anchor_x) {
+    scale = clamp(scale, m_min_scale, MAX_SCALE);
+    if (scale == m_scale)
+        return;
+
+    // 缩放前后鼠标下是同一帧
+    double anchor_frame = ldexp(static_cast<double>(m_offset + anchor_x), -m_scale);
+    m_scale = scale;
+    m_offset = static_cast<int64_t>(ldexp(anchor_frame, m_scale)) - anchor_x;
+    clampOffset();
+    update();
+}
+
+void GopMapWidget::clampOffset() {
+    m_offset = clamp<int64_t>(m_offset, 0, max<int64_t>(0, contentWidth(m_scale) - width()));
+}
@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "GopMap.h"
+#include <QCache>
+#include <QImage>
+#include <QWidget>
+
+/**
+ * @class GopMapWidget
+ * @brief GOP结构图：每个视频帧一格，按帧类别着色、按tag长度定高，顶部色带标出各GOP，不规则的GOP为红色
+ *
+ * 缩放按2的幂分级，整条图按级别切成固定宽度的瓦片渲染后缓存，平移和重绘只贴图；
+ * 一个像素覆盖多帧时取最大的帧定高、按最重要的帧类别着色。滚轮缩放，拖动平移，单击跳转到tag
+ */
+class GopMapWidget : public QWidget {
+    Q_OBJECT
+
+  public:
+    explicit GopMapWidget(QWidget* parent = nullptr);
+
+    // gop_map由调用方持有，需保证在本控件使用期间有效
+    void setGopMap(const GopMap* gop_map);
+    // 标记当前选中的tag（不含FLV Header行），-1为不标记
+    void setCurrentTag(int tag_index);
+
+  signals:
+    // 跳转到tag列表中的指定tag（不含FLV Header行）
+    void tagJumpRequested(int tag_index);
+
+  protected:
+    void paintEvent(QPaintEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void mouseReleaseEvent(QMouseEvent* event) override;
+    void wheelEvent(QWheelEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+
+  private:
+    static constexpr int TILE_WIDTH = 256;
+    static constexpr int MAX_SCALE = 4;         // 每帧最宽16像素
+    static constexpr int BAND_HEIGHT = 4;       // 顶部GOP色带的高度
+    static constexpr int TILE_CACHE_KB = 32768; // 瓦片缓存上限
+
+    // 缩放为scale时整条图的像素宽度
+    int64_t contentWidth(int scale) const;
+    // 整条图中像素x覆盖的帧区间[begin, end)，超出范围时begin >= end
+    void frameRange(int64_t x, size_t& begin, size_t& end) const;
+    // 区间内长度最大的帧
+    size_t largestFrame(size_t begin, size_t end) const;
+
+    const QImage& tile(int64_t tile_index);
+    QImage renderTile(int64_t tile_index) const;
+
+    // 以控件坐标anchor_x处为中心缩放
+    void setScale(int scale, int anchor_x);
+    void clampOffset();
+
+    const GopMap* m_gop_map = nullptr;
+    int m_scale = 0;      // 每帧2^m_scale像素，为负时每像素2^-m_scale帧
+    int m_min_scale = 0;  // 整条图刚好放进控件宽度的级别
+    int64_t m_offset = 0; // 控件左边缘在整条图中的像素位置
+    int64_t m_current_frame = -1;
+    QCache<int64_t, QImage> m_tiles; // 键为级别和瓦片下标，成本按KB计
+
+    bool m_dragging = false;
+    bool m_dragged = false;
+    int m_press_x = 0;
+    int64_t m_press_offset = 0;
+};
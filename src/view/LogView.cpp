@@ -3,16 +3,21 @@
 // SPDX-License-Identifier: MIT
 
 #include "logview.h"
+#include "Log.h"
 #include "ui_logview.h"
-#include <QFile>
 #include <QStandardPaths>
-#include <QTextStream>
+#include <QTimer>
 
 LogView::LogView(QWidget* parent) : QWidget(parent), ui(new Ui::LogView) {
     ui->setupUi(this);
 
+    m_model = make_unique<ModelLogLines>(&m_index);
+    ui->logListView->setModel(m_model.get());
+    filterLogByLevel(ui->logLevelCombo->currentText());
+
     // 连接下拉框的信号
     connect(ui->logLevelCombo, &QComboBox::currentTextChanged, this, &LogView::filterLogByLevel);
+    connect(ui->filterEdit, &QLineEdit::textChanged, this, &LogView::applyFilter);
 }
 
 LogView::~LogView() {
@@ -20,54 +25,69 @@ LogView::~LogView() {
 }
 
 void LogView::loadLogFile() {
+    // 日志由后台线程批量写入，读取前先把队列中的写出
+    flushLog();
     QString logPath = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) + "/flv_parser.log";
-    QFile logFile(logPath);
 
-    if (!logFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        ui->logTextEdit->setPlainText("无法打开日志文件: " + logPath);
+    size_t line_count = m_index.lineCount();
+    QString error;
+    if (!m_index.open(logPath, error)) {
+        m_model->setRows({});
+        ui->statusLabel->setText(error);
         return;
     }
+    // 文件被截断时索引从头建立
+    if (m_index.lineCount() < line_count) {
+        m_model->setRows({});
+    }
 
-    QTextStream in(&logFile);
-    m_fullLogContent = in.readAll();
-    logFile.close();
-
-    // 应用当前选择的过滤器
-    filterLogByLevel(ui->logLevelCombo->currentText());
+    if (!m_indexing) {
+        m_indexing = true;
+        QTimer::singleShot(0, this, &LogView::indexNextBlock);
+    }
 }
 
-void LogView::filterLogByLevel(const QString& level) {
-    if (m_fullLogContent.isEmpty()) {
-        return;
-    }
+void LogView::indexNextBlock() {
+    size_t first = m_index.lineCount();
+    bool more = m_index.indexNext();
 
-    if (level == "全部") {
-        ui->logTextEdit->setPlainText(m_fullLogContent);
-        return;
-    }
+    vector<uint32_t> rows;
+    m_index.select(first, m_index.lineCount(), m_level_mask, m_filter_text, rows);
+    m_model->appendRows(rows);
 
-    // 根据日志等级过滤
-    QStringList lines = m_fullLogContent.split('\n');
-    QStringList filteredLines;
+    m_indexing = more;
+    if (more) {
+        QTimer::singleShot(0, this, &LogView::indexNextBlock);
+    }
+    updateStatus();
+}
 
-    // Qt日志格式为: [debug], [warning], [info]
+void LogView::filterLogByLevel(const QString& level) {
+    // Qt日志格式为: [debug], [info], [warning]
     if (level == "Warning") {
-        for (const QString& line : lines) {
-            if (line.contains("[warning]", Qt::CaseInsensitive)) {
-                filteredLines.append(line);
-            }
-        }
+        m_level_mask = (1u << LOG_LEVEL_WARNING) | (1u << LOG_LEVEL_CRITICAL) | (1u << LOG_LEVEL_FATAL);
     } else if (level == "Info") {
-        for (const QString& line : lines) {
-            if (line.contains("[info]", Qt::CaseInsensitive) || line.contains("[warning]", Qt::CaseInsensitive)) {
-                filteredLines.append(line);
-            }
-        }
-    } else if (level == "Debug") {
-        for (const QString& line : lines) {
-            filteredLines.append(line);
-        }
+        m_level_mask = ~(1u << LOG_LEVEL_DEBUG);
+    } else {
+        m_level_mask = ~0u;
     }
+    applyFilter();
+}
 
-    ui->logTextEdit->setPlainText(filteredLines.join('\n'));
+void LogView::applyFilter() {
+    m_filter_text = ui->filterEdit->text().toUtf8();
+
+    // 只在已索引的行上重新筛选，之后索引的块按新条件追加
+    vector<uint32_t> rows;
+    m_index.select(0, m_index.lineCount(), m_level_mask, m_filter_text, rows);
+    m_model->setRows(std::move(rows));
+    updateStatus();
+}
+
+void LogView::updateStatus() {
+    QString status = QString("显示%1/%2行").arg(m_model->rowCount()).arg(m_index.lineCount());
+    if (m_indexing && m_index.fileSize() > 0) {
+        status += QString("，索引中%1%").arg(m_index.indexedSize() * 100 / m_index.fileSize());
+    }
+    ui->statusLabel->setText(status);
 }
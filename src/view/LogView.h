@@ -4,7 +4,12 @@
 
 #pragma once
 
+#include "LogIndex.h"
+#include "ModelWidget.h"
 #include <QWidget>
+#include <memory>
+
+using namespace std;
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -12,6 +17,10 @@ class LogView;
 }
 QT_END_NAMESPACE
 
+/**
+ * @class LogView
+ * @brief 日志查看：映射日志文件后按块建立行索引，每块结束后把符合过滤条件的行追加到列表，界面保持响应
+ */
 class LogView : public QWidget {
     Q_OBJECT
 
@@ -19,12 +28,22 @@ class LogView : public QWidget {
     explicit LogView(QWidget* parent = nullptr);
     ~LogView();
 
+    // 再次调用时只索引文件新增的部分
     void loadLogFile();
 
   private slots:
     void filterLogByLevel(const QString& level);
+    void applyFilter();
+    void indexNextBlock();
 
   private:
+    void updateStatus();
+
     Ui::LogView* ui;
-    QString m_fullLogContent;
+    LogIndex m_index;
+    unique_ptr<ModelLogLines> m_model;
+
+    uint32_t m_level_mask = 0;
+    QByteArray m_filter_text;
+    bool m_indexing = false;
 };
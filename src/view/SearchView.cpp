@@ -0,0 +1,143 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "SearchView.h"
+#include "Log.h"
+#include "ui_searchview.h"
+#include <QHeaderView>
+#include <QTimer>
+
+SearchView::SearchView(QWidget* parent) : QWidget(parent), ui(new Ui::SearchView) {
+    ui->setupUi(this);
+
+    connect(ui->searchButton, &QPushButton::clicked, this, &SearchView::onSearchClicked);
+    connect(ui->patternEdit, &QLineEdit::returnPressed, this, &SearchView::onSearchClicked);
+
+    // 双击结果跳转到对应tag并高亮命中的字节
+    connect(ui->resultTableView, &QTableView::doubleClicked, this, &SearchView::onResultActivated);
+}
+
+SearchView::~SearchView() {
+    clearDocument();
+    delete ui;
+}
+
+void SearchView::setDocument(const QString& file_path, ModelTagList* tag_model) {
+    clearDocument();
+    m_file_path = file_path;
+    m_tag_model = tag_model;
+}
+
+void SearchView::clearDocument() {
+    if (m_searching) {
+        finishSearch("已取消");
+    }
+    ui->resultTableView->setModel(nullptr);
+    m_result_model.reset();
+    m_tag_model = nullptr;
+    m_file_path.clear();
+    ui->summaryLabel->setText("未搜索");
+}
+
+void SearchView::onSearchClicked() {
+    if (m_searching) {
+        finishSearch("已停止");
+        return;
+    }
+    startSearch();
+}
+
+void SearchView::startSearch() {
+    if (!m_tag_model || m_file_path.isEmpty()) {
+        ui->summaryLabel->setText("请先打开FLV文件");
+        return;
+    }
+
+    try {
+        m_patterns = FileSearch::compile(ui->patternEdit->text(), static_cast<FileSearch::MODE>(ui->modeCombo->currentIndex()));
+    } catch (const QString& error) {
+        ui->summaryLabel->setText(error);
+        return;
+    }
+
+    m_file.setFileName(m_file_path);
+    if (!m_file.open(QFile::ReadOnly)) {
+        ui->summaryLabel->setText("无法打开文件：" + m_file.errorString());
+        return;
+    }
+    m_size = m_file.size();
+    m_data = m_size > 0 ? m_file.map(0, m_size) : nullptr;
+    if (!m_data) {
+        m_file.close();
+        ui->summaryLabel->setText("文件映射失败");
+        return;
+    }
+
+    m_result_model = make_unique<ModelSearchResults>(m_tag_model, m_patterns);
+    ui->resultTableView->setModel(m_result_model.get());
+
+    m_pos = 0;
+    m_searching = true;
+    m_timer.start();
+    ui->searchButton->setText("停止");
+    qCInfo(runLog) << QString("[flv-search] event[started] pattern[%1] size[%2]").arg(ui->patternEdit->text()).arg(m_size);
+    QTimer::singleShot(0, this, &SearchView::searchNextBlock);
+}
+
+void SearchView::searchNextBlock() {
+    if (!m_searching) {
+        return;
+    }
+
+    int64_t end = min(m_size, m_pos + BLOCK_SIZE);
+    size_t remaining = FileSearch::MAX_HITS - m_result_model->hitCount();
+    vector<SearchHit> hits = FileSearch::find(m_data, m_size, m_pos, end, m_patterns, remaining);
+    FileSearch::resolveTags(m_tag_model->getTagIndex(), hits);
+    m_result_model->appendHits(std::move(hits));
+    m_pos = end;
+
+    if (m_result_model->hitCount() >= FileSearch::MAX_HITS) {
+        finishSearch(QString("结果超过 %1 个，已停止").arg(FileSearch::MAX_HITS));
+        return;
+    }
+    if (m_pos >= m_size) {
+        finishSearch("完成");
+        return;
+    }
+
+    ui->summaryLabel->setText(
+        QString("已搜索 %1%，找到 %2 个").arg(m_pos * 100 / m_size).arg(m_result_model->hitCount()));
+    QTimer::singleShot(0, this, &SearchView::searchNextBlock);
+}
+
+void SearchView::finishSearch(const QString& reason) {
+    m_searching = false;
+    if (m_data) {
+        m_file.unmap(const_cast<uchar*>(m_data));
+        m_data = nullptr;
+    }
+    m_file.close();
+    ui->searchButton->setText("搜索");
+
+    size_t hits = m_result_model ? m_result_model->hitCount() : 0;
+    qint64 elapsed = m_timer.elapsed();
+    ui->summaryLabel->setText(
+        QString("%1：找到 %2 个，已搜索 %3 字节，耗时 %4 ms，双击跳转").arg(reason).arg(hits).arg(m_pos).arg(elapsed));
+    qCInfo(runLog) << QString("[flv-search] event[finished] reason[%1] hits[%2] searched[%3] elapsed[%4ms]")
+                          .arg(reason)
+                          .arg(hits)
+                          .arg(m_pos)
+                          .arg(elapsed);
+}
+
+void SearchView::onResultActivated(const QModelIndex& index) {
+    if (!index.isValid() || !m_result_model) {
+        return;
+    }
+
+    const SearchHit& hit = m_result_model->getHit(index.row());
+    if (hit.m_tag_index >= HIT_IN_HEADER) {
+        emit bytesJumpRequested(static_cast<int>(hit.m_tag_index), hit.m_offset, hit.m_length);
+    }
+}
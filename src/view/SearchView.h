@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "ModelWidget.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QWidget>
+#include <memory>
+
+using namespace std;
+
+QT_BEGIN_NAMESPACE
+namespace Ui {
+class SearchView;
+}
+QT_END_NAMESPACE
+
+/**
+ * @class SearchView
+ * @brief 全文件搜索：映射整个文件后按块搜索，每块结束后把结果追加到列表，界面保持响应
+ */
+class SearchView : public QWidget {
+    Q_OBJECT
+
+  public:
+    explicit SearchView(QWidget* parent = nullptr);
+    ~SearchView();
+
+    // tag_model由TagView持有，重新加载文件前需调用clearDocument
+    void setDocument(const QString& file_path, ModelTagList* tag_model);
+    void clearDocument();
+
+  signals:
+    // 跳转到指定tag并高亮[offset, offset + length)，tag_index为-1时为FLV Header
+    void bytesJumpRequested(int tag_index, qint64 offset, quint32 length);
+
+  private slots:
+    void onSearchClicked();
+    void onResultActivated(const QModelIndex& index);
+    void searchNextBlock();
+
+  private:
+    void startSearch();
+    void finishSearch(const QString& reason);
+
+    // 每次搜索的数据量，块之间回到事件循环
+    static constexpr int64_t BLOCK_SIZE = 256 << 20;
+
+    Ui::SearchView* ui;
+    unique_ptr<ModelSearchResults> m_result_model;
+
+    QString m_file_path;
+    ModelTagList* m_tag_model = nullptr;
+
+    // 搜索状态
+    QFile m_file;
+    const uchar* m_data = nullptr;
+    int64_t m_size = 0;
+    int64_t m_pos = 0;
+    vector<SearchPattern> m_patterns;
+    bool m_searching = false;
+    QElapsedTimer m_timer;
+};
@@ -4,13 +4,32 @@
 
 #include "tagview.h"
 #include "BinaryEditDelegate.h"
+#include "Log.h"
+#include "TagQuery.h"
+#include "TagSorter.h"
+#include "Trace.h"
 #include "ui_tagview.h"
 #include <QAction>
+#include <QElapsedTimer>
+#include <QHeaderView>
 #include <QMenu>
 #include <QMessageBox>
+#include <QSignalBlocker>
+
+// 全局递增的文档版本号，只在界面线程使用
+static uint64_t nextGeneration() {
+    static uint64_t generation = 0;
+    return ++generation;
+}
 
 TagView::TagView(QWidget* parent) : QWidget(parent), ui(new Ui::TagView) {
     ui->setupUi(this);
+    m_tag_rows = make_unique<ModelTagRows>();
+
+    // 表头点击排序，由ModelTagRows在列式索引上排序；初始为文件顺序
+    ui->tagTableView->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+    ui->tagTableView->setSortingEnabled(true);
+
     setupConnections();
 }
 
@@ -23,37 +42,182 @@ void TagView::setupConnections() {
     m_contextMenu = new QMenu(this);
     m_deleteAction = new QAction("删除帧", this);
     m_contextMenu->addAction(m_deleteAction);
+    m_contextMenu->addSeparator();
+    m_cutStartAction = m_contextMenu->addAction("设为截取起点");
+    m_cutEndAction = m_contextMenu->addAction("设为截取终点");
+    m_cutAction = m_contextMenu->addAction("截取并另存为...");
 
     // 右键菜单
     connect(ui->tagTableView, &QTableView::customContextMenuRequested, this, &TagView::showContextMenu);
     connect(m_deleteAction, &QAction::triggered, this, &TagView::handleDeleteTag);
+    connect(m_cutStartAction, &QAction::triggered, this, [this]() { handleCutMark(false); });
+    connect(m_cutEndAction, &QAction::triggered, this, [this]() { handleCutMark(true); });
+    connect(m_cutAction, &QAction::triggered, this, [this]() {
+        // 终点包含所标记的tag
+        emit cutRequested(static_cast<uint32_t>(m_cut_start), static_cast<uint32_t>(m_cut_end + 1));
+    });
+
+    // 表头右键菜单：CTS没有单独的列，从这里排序
+    QHeaderView* header = ui->tagTableView->horizontalHeader();
+    header->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(header, &QHeaderView::customContextMenuRequested, this, &TagView::showHeaderMenu);
+    // 不支持排序的列点击后恢复原来的排序标记
+    connect(header, &QHeaderView::sortIndicatorChanged, this, [this, header](int section, Qt::SortOrder order) {
+        if (section >= 0 && TagSorter::keyForColumn(section) == TagSorter::KEY_NONE) {
+            QSignalBlocker blocker(header);
+            header->setSortIndicator(m_sort_section, m_sort_order);
+            return;
+        }
+        m_sort_section = section;
+        m_sort_order = order;
+    });
+
+    // 过滤表达式回车执行，清空时显示全部
+    connect(ui->queryEdit, &QLineEdit::returnPressed, this, &TagView::applyQuery);
+    connect(ui->queryEdit, &QLineEdit::textChanged, this, [this](const QString& text) {
+        if (text.trimmed().isEmpty() && m_tag_rows->isFiltered())
+            applyQuery();
+    });
+
+    // 单击时间线跳转到该处最大的tag
+    connect(ui->timelineWidget, &TimelineWidget::tagJumpRequested, this, &TagView::selectTag);
+    connect(ui->gopMapWidget, &GopMapWidget::tagJumpRequested, this, &TagView::selectTag);
 }
 
 void TagView::setTagList(unique_ptr<ModelTagList> model) {
+    TRACE_SCOPE("model_reset");
+    m_generation = nextGeneration();
     m_tag_table_model = std::move(model);
-    ui->tagTableView->setModel(m_tag_table_model.get());
+    // 原地增删行时模型指针不变，同样需要更新版本号
+    connect(m_tag_table_model.get(), &QAbstractItemModel::rowsRemoved, this, [this]() {
+        m_generation = nextGeneration();
+    });
+    connect(m_tag_table_model.get(), &QAbstractItemModel::rowsInserted, this, [this]() {
+        m_generation = nextGeneration();
+    });
+    m_tag_rows->setSourceModel(m_tag_table_model.get());
+    ui->tagTableView->setModel(m_tag_rows.get());
     m_tag_info_tree.reset();
     m_tag_data.reset();
 
-    // 获取选中模型，并连接选中变化信号
+    // 码率时间线
+    m_timeline.build(m_tag_table_model->getTagIndex());
+    ui->timelineWidget->setTimeline(&m_timeline);
+
+    // GOP结构图
+    m_gop_map.build(m_tag_table_model->getTagIndex());
+    ui->gopMapWidget->setGopMap(&m_gop_map);
+
+    // 获取选中模型，并连接选中变化信号（行代理对象不变，避免重复连接）
     QItemSelectionModel* selectionModel = ui->tagTableView->selectionModel();
-    connect(selectionModel, &QItemSelectionModel::selectionChanged, this, &TagView::onTagSelectionChanged);
+    connect(selectionModel,
+            &QItemSelectionModel::selectionChanged,
+            this,
+            &TagView::onTagSelectionChanged,
+            Qt::UniqueConnection);
+
+    // 删除tag后会重新加载文件，按查询框中的条件重新过滤，避免丢失当前过滤结果
+    applyQuery();
 }
 
 void TagView::clearTagList() {
-    m_tag_table_model.reset();
+    m_generation = nextGeneration();
     ui->tagTableView->setModel(nullptr);
+    m_tag_rows->setSourceModel(nullptr);
+    m_tag_table_model.reset();
+    ui->queryStatusLabel->clear();
     m_tag_info_tree.reset();
     m_tag_data.reset();
+    ui->timelineWidget->setTimeline(nullptr);
+    m_timeline.clear();
+    ui->gopMapWidget->setGopMap(nullptr);
+    m_gop_map.clear();
+    m_cut_start = -1;
+    m_cut_end = -1;
+}
+
+void TagView::setDrift(vector<DriftSample> drift) {
+    ui->timelineWidget->setDrift(std::move(drift));
+}
+
+void TagView::selectTag(int tag_index) {
+    if (!m_tag_table_model) {
+        return;
+    }
+
+    QModelIndex source_index = m_tag_table_model->index(tag_index + 1, 0); // 第0行为FLV Header
+    if (!source_index.isValid()) {
+        return;
+    }
+
+    // 目标tag被过滤掉时先恢复显示全部
+    QModelIndex index = m_tag_rows->mapFromSource(source_index);
+    if (!index.isValid()) {
+        ui->queryEdit->clear();
+        m_tag_rows->showAll();
+        index = m_tag_rows->mapFromSource(source_index);
+    }
+    ui->tagTableView->selectRow(index.row());
+    ui->tagTableView->scrollTo(index, QAbstractItemView::PositionAtCenter);
 }
 
 void TagView::showContextMenu(const QPoint& pos) {
     QModelIndex index = ui->tagTableView->indexAt(pos);
     if (index.isValid()) {
+        auto markText = [](const char* text, int64_t ms) {
+            return ms < 0 ? QString(text) : QString("%1（当前 %2 ms）").arg(text).arg(ms);
+        };
+        m_cutStartAction->setText(markText("设为截取起点", m_cut_start));
+        m_cutEndAction->setText(markText("设为截取终点", m_cut_end));
+        m_cutAction->setEnabled(m_cut_start >= 0 && m_cut_end >= m_cut_start);
+        m_menu_index = index;
         m_contextMenu->exec(ui->tagTableView->viewport()->mapToGlobal(pos));
     }
 }
 
+void TagView::handleCutMark(bool is_end) {
+    // 右键点击的行，不一定是当前行
+    int row = m_menu_index.isValid() ? sourceRow(m_menu_index) : -1;
+    if (!m_tag_table_model || row <= 0) {
+        return;
+    }
+
+    int64_t timestamp = m_tag_table_model->getTagIndex().m_timestamp[row - 1];
+    if (is_end) {
+        m_cut_end = timestamp;
+    } else {
+        m_cut_start = timestamp;
+    }
+}
+
+void TagView::showHeaderMenu(const QPoint& pos) {
+    QHeaderView* header = ui->tagTableView->horizontalHeader();
+    QMenu menu(this);
+    QAction* cts_ascending = menu.addAction("按CTS升序排序");
+    QAction* cts_descending = menu.addAction("按CTS降序排序");
+    menu.addSeparator();
+    QAction* file_order = menu.addAction("恢复文件顺序");
+
+    QAction* action = menu.exec(header->mapToGlobal(pos));
+    if (!action) {
+        return;
+    }
+
+    // 清除表头的排序标记，不触发按列排序
+    {
+        QSignalBlocker blocker(header);
+        header->setSortIndicator(-1, Qt::AscendingOrder);
+        m_sort_section = -1;
+    }
+    if (action == cts_ascending) {
+        m_tag_rows->sortByKey(TagSorter::KEY_CTS, Qt::AscendingOrder);
+    } else if (action == cts_descending) {
+        m_tag_rows->sortByKey(TagSorter::KEY_CTS, Qt::DescendingOrder);
+    } else if (action == file_order) {
+        m_tag_rows->sortByKey(TagSorter::KEY_NONE, Qt::AscendingOrder);
+    }
+}
+
 void TagView::handleDeleteTag() {
     QModelIndex currentIndex = ui->tagTableView->currentIndex();
     if (!currentIndex.isValid()) {
@@ -68,7 +232,47 @@ void TagView::handleDeleteTag() {
                                                               QMessageBox::No);
 
     if (reply == QMessageBox::Yes) {
-        emit tagDeleteRequested(currentIndex.row());
+        // 文件在重新加载完成前就已改变
+        m_generation = nextGeneration();
+        emit tagDeleteRequested(sourceRow(currentIndex));
+    }
+}
+
+int TagView::sourceRow(const QModelIndex& index) const {
+    return m_tag_rows->mapToSource(index).row();
+}
+
+void TagView::applyQuery() {
+    if (!m_tag_table_model) {
+        return;
+    }
+
+    QString text = ui->queryEdit->text().trimmed();
+    if (text.isEmpty()) {
+        m_tag_rows->showAll();
+        ui->queryStatusLabel->clear();
+        return;
+    }
+
+    try {
+        QElapsedTimer timer;
+        timer.start();
+        auto query = TagQuery::compile(text);
+        vector<int> rows = query->run(m_tag_table_model->getTagIndex());
+        qint64 elapsed = timer.elapsed();
+
+        size_t matched = rows.size();
+        m_tag_rows->setTagRows(std::move(rows));
+        ui->queryStatusLabel->setStyleSheet(QString());
+        ui->queryStatusLabel->setText(
+            QString("匹配 %1 / %2，%3 ms").arg(matched).arg(m_tag_table_model->getTagIndex().size()).arg(elapsed));
+        qCInfo(runLog) << QString("[flv-query] event[finished] query[%1] matched[%2] elapsed[%3ms]")
+                              .arg(text)
+                              .arg(matched)
+                              .arg(elapsed);
+    } catch (const QString& error) {
+        ui->queryStatusLabel->setStyleSheet("color: #cc0000;");
+        ui->queryStatusLabel->setText(error);
     }
 }
 
@@ -78,8 +282,7 @@ void TagView::onTagSelectionChanged(const QItemSelection& selected, const QItemS
         return;
     }
 
-    QModelIndex index = selectedIndexes.first();
-    int row = index.row();
+    int row = sourceRow(selectedIndexes.first());
     if (row < 0) {
         return;
     }
@@ -96,9 +299,12 @@ void TagView::onTagSelectionChanged(const QItemSelection& selected, const QItemS
     } else {
         auto tag = m_tag_table_model->getTagList()[row - 1].get();
         m_tag_info_tree.reset(new ModelTagInfoTree(tag->getTreeInfo()));
+        m_tag_table_model->ensureBinary(*tag);
         data_ptr = static_cast<BinaryData*>(tag);
     }
 
+    ui->gopMapWidget->setCurrentTag(row - 1);
+
     // 帧详细信息视图
     ui->tagInfoTree->setModel(m_tag_info_tree.get());
 
@@ -115,9 +321,12 @@ void TagView::onTagSelectionChanged(const QItemSelection& selected, const QItemS
     }
 
     // 帧二进制数据视图
-    m_tag_data.reset(new ModelTagBinary(*data_ptr));
-    m_tag_data->setFilePath(m_filePath);
-    ui->tagRawContent->setModel(m_tag_data.get());
+    {
+        TRACE_SCOPE("hex_model");
+        m_tag_data.reset(new ModelTagBinary(*data_ptr));
+        m_tag_data->setFilePath(m_filePath);
+        ui->tagRawContent->setModel(m_tag_data.get());
+    }
 
     // 连接数据修改信号
     connect(m_tag_data.get(), &ModelTagBinary::dataModified, this, &TagView::onBinaryDataModified);
@@ -131,6 +340,7 @@ void TagView::onTagSelectionChanged(const QItemSelection& selected, const QItemS
 
 void TagView::onBinaryDataModified() {
     // 发出文件修改信号，由 MainWindow 处理重新加载
+    m_generation = nextGeneration();
     emit fileModified();
 }
 
@@ -155,7 +365,19 @@ void TagView::onFieldSelectionChanged(const QItemSelection& selected, const QIte
     else
         offset -= m_tag_data->getData().m_offset;
 
-    if (offset < 0 || static_cast<uint64_t>(offset) >= m_tag_data->getData().m_size) {
+    highlightBytes(offset, size);
+}
+
+void TagView::selectTagBytes(int tag_index, int64_t offset, uint32_t size) {
+    selectTag(tag_index);
+    if (m_tag_data == nullptr) {
+        return;
+    }
+    highlightBytes(offset - m_tag_data->getData().m_offset, size);
+}
+
+void TagView::highlightBytes(int64_t offset, uint32_t size) {
+    if (m_tag_data == nullptr || offset < 0 || static_cast<uint64_t>(offset) >= m_tag_data->getData().m_bin_size) {
         return;
     }
 
@@ -175,8 +397,8 @@ void TagView::onFieldSelectionChanged(const QItemSelection& selected, const QIte
     }
 
     int64_t endRel = offset + size;
-    if (endRel > m_tag_data->getData().m_size)
-        endRel = m_tag_data->getData().m_size;
+    if (endRel > m_tag_data->getData().m_bin_size)
+        endRel = m_tag_data->getData().m_bin_size;
 
     // 直接计算左上 (startRow,startCol) 与右下 (endRow,endCol) 索引并用单个矩形范围选中
     int startRow = static_cast<int>(offset / 16);
@@ -4,8 +4,12 @@
 
 #pragma once
 
+#include "BitrateTimeline.h"
+#include "GopMap.h"
+#include "TimestampAnalyzer.h"
 #include "modelwidget.h"
 #include <QItemSelection>
+#include <QPersistentModelIndex>
 #include <QWidget>
 #include <memory>
 
@@ -29,34 +33,73 @@ class TagView : public QWidget {
     ModelTagList* getTagModel() const {
         return m_tag_table_model.get();
     }
+    // 文档版本号：重新加载、删除tag、修改文件后变化，且不同视图之间不会重复，用于判断后台结果是否过期
+    uint64_t getGeneration() const {
+        return m_generation;
+    }
 
     void setFilePath(const QString& filePath) {
         m_filePath = filePath;
     }
+    const QString& getFilePath() const {
+        return m_filePath;
+    }
+
+    // 选中并滚动到指定tag（不含FLV Header行）
+    void selectTag(int tag_index);
+    // 选中tag并在二进制视图中高亮文件偏移[offset, offset + size)
+    void selectTagBytes(int tag_index, int64_t offset, uint32_t size);
+    // 在码率时间线上叠加显示音视频漂移
+    void setDrift(vector<DriftSample> drift);
 
   signals:
     void tagDeleteRequested(int row);
     void fileModified();
+    // 截取[start, end)时间范围(ms)另存为
+    void cutRequested(uint32_t start, uint32_t end);
 
   private slots:
     void onTagSelectionChanged(const QItemSelection& selected, const QItemSelection& deselected);
     void onFieldSelectionChanged(const QItemSelection& selected, const QItemSelection& deselected);
     void showContextMenu(const QPoint& pos);
+    void showHeaderMenu(const QPoint& pos);
     void handleDeleteTag();
+    void handleCutMark(bool is_end);
     void onBinaryDataModified();
+    void applyQuery();
 
   private:
     void setupConnections();
+    // 表格行号转换为源模型行号（第0行为FLV Header）
+    int sourceRow(const QModelIndex& index) const;
+    // 高亮二进制视图中的字节，offset相对当前tag起点
+    void highlightBytes(int64_t offset, uint32_t size);
 
   private:
     Ui::TagView* ui;
 
     unique_ptr<ModelTagList> m_tag_table_model;
+    unique_ptr<ModelTagRows> m_tag_rows; // 表格实际绑定的行代理
     unique_ptr<ModelTagInfoTree> m_tag_info_tree;
     unique_ptr<ModelTagBinary> m_tag_data;
+    BitrateTimeline m_timeline;
+    GopMap m_gop_map;
 
     QMenu* m_contextMenu;
     QAction* m_deleteAction;
+    QAction* m_cutStartAction;
+    QAction* m_cutEndAction;
+    QAction* m_cutAction;
+
+    // 右键菜单标记的截取起点和终点tag的时间戳(ms)，-1为未设置
+    int64_t m_cut_start = -1;
+    int64_t m_cut_end = -1;
+    QPersistentModelIndex m_menu_index; // 右键菜单弹出时点击的行
+
+    // 当前表头排序标记，-1为无
+    int m_sort_section = -1;
+    Qt::SortOrder m_sort_order = Qt::AscendingOrder;
 
     QString m_filePath;
+    uint64_t m_generation = 0;
 };
@@ -0,0 +1,216 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "TimelineWidget.h"
+#include <QMouseEvent>
+#include <QPainter>
+#include <QToolTip>
+#include <QWheelEvent>
+#include <algorithm>
+#include <cstdlib>
+
+TimelineWidget::TimelineWidget(QWidget* parent) : QWidget(parent) {
+    setMouseTracking(true);
+    setMinimumHeight(80);
+}
+
+void TimelineWidget::setTimeline(const BitrateTimeline* timeline) {
+    m_timeline = timeline;
+    m_view_begin = 0;
+    m_view_end = timeline ? static_cast<double>(timeline->m_bucket_count) : 0;
+    m_summary = timeline ? timeline->summary() : QString();
+    m_drift.clear();
+    m_drift_range = 0;
+    update();
+}
+
+void TimelineWidget::setDrift(vector<DriftSample> drift) {
+    m_drift = std::move(drift);
+    // 至少显示到告警阈值，漂移很小时曲线贴近中线
+    m_drift_range = TimestampAnalyzer::MAX_DRIFT_MS;
+    for (const DriftSample& sample : m_drift) {
+        m_drift_range = max(m_drift_range, abs(sample.m_drift));
+    }
+    update();
+}
+
+const DriftSample* TimelineWidget::driftAt(int64_t begin_ms, int64_t end_ms) const {
+    auto it = lower_bound(m_drift.begin(), m_drift.end(), begin_ms, [](const DriftSample& sample, int64_t ms) {
+        return sample.m_dts < ms;
+    });
+    const DriftSample* result = nullptr;
+    for (; it != m_drift.end() && it->m_dts < end_ms; ++it) {
+        if (!result || abs(it->m_drift) > abs(result->m_drift))
+            result = &*it;
+    }
+    return result;
+}
+
+void TimelineWidget::bucketRange(int x, size_t& begin, size_t& end) const {
+    double per_pixel = (m_view_end - m_view_begin) / max(width(), 1);
+    begin = static_cast<size_t>(m_view_begin + x * per_pixel);
+    end = max(static_cast<size_t>(m_view_begin + (x + 1) * per_pixel), begin + 1);
+}
+
+void TimelineWidget::paintEvent(QPaintEvent*) {
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().color(QPalette::Base));
+    if (!m_timeline || m_timeline->m_bucket_count == 0) {
+        painter.setPen(palette().color(QPalette::PlaceholderText));
+        painter.drawText(rect(), Qt::AlignCenter, "无码率数据");
+        return;
+    }
+
+    const StreamTimeline& video = m_timeline->m_streams[BitrateTimeline::STREAM_VIDEO];
+    const StreamTimeline& audio = m_timeline->m_streams[BitrateTimeline::STREAM_AUDIO];
+
+    // 纵轴按可见区间内音视频合计的峰值缩放
+    size_t view_begin = static_cast<size_t>(m_view_begin);
+    size_t view_end = max(static_cast<size_t>(m_view_end), view_begin + 1);
+    uint64_t peak = max<uint64_t>(
+        video.m_pyramid.query(view_begin, view_end).m_max + audio.m_pyramid.query(view_begin, view_end).m_max, 1);
+
+    int h = height() - 16;
+    auto toY = [&](double bytes) {
+        return height() - static_cast<int>(bytes * h / peak);
+    };
+
+    // 颜色和tag列表的底色保持同一色相
+    QColor video_max = QColor::fromHsv(60, 90, 230);
+    QColor video_avg = QColor::fromHsv(60, 200, 200);
+    QColor audio_avg = QColor::fromHsv(120, 200, 170);
+
+    for (int x = 0; x < width(); ++x) {
+        size_t begin = 0, end = 0;
+        bucketRange(x, begin, end);
+        if (begin >= m_timeline->m_bucket_count)
+            break;
+        end = min(end, m_timeline->m_bucket_count);
+
+        SeriesPyramid::Result v = video.m_pyramid.query(begin, end);
+        SeriesPyramid::Result a = audio.m_pyramid.query(begin, end);
+        double v_avg = static_cast<double>(v.m_sum) / (end - begin);
+        double a_avg = static_cast<double>(a.m_sum) / (end - begin);
+
+        // 视频峰值为浅色柱，平均值为深色柱，音频叠在视频平均值之上
+        painter.setPen(video_max);
+        painter.drawLine(x, height(), x, toY(v.m_max));
+        painter.setPen(video_avg);
+        painter.drawLine(x, height(), x, toY(v_avg));
+        painter.setPen(audio_avg);
+        painter.drawLine(x, toY(v_avg), x, toY(v_avg + a_avg));
+    }
+
+    painter.setPen(palette().color(QPalette::Text));
+    painter.drawText(4,
+                     12,
+                     QString("峰值 %1 kbps    %2 s ~ %3 s")
+                         .arg(peak * 8.0 / m_timeline->m_bucket_ms, 0, 'f', 0)
+                         .arg((m_timeline->m_base_ms + m_view_begin * m_timeline->m_bucket_ms) / 1000.0, 0, 'f', 0)
+                         .arg((m_timeline->m_base_ms + m_view_end * m_timeline->m_bucket_ms) / 1000.0, 0, 'f', 0));
+
+    paintDrift(painter, 16, h);
+}
+
+void TimelineWidget::paintDrift(QPainter& painter, int top, int h) const {
+    if (m_drift.empty() || m_drift_range <= 0) {
+        return;
+    }
+
+    double span = max(m_view_end - m_view_begin, 1.0);
+    auto toX = [&](int64_t dts) {
+        double bucket = static_cast<double>(dts - m_timeline->m_base_ms) / m_timeline->m_bucket_ms;
+        return (bucket - m_view_begin) * width() / span;
+    };
+    double mid = top + h / 2.0;
+    auto toY = [&](int64_t drift) {
+        return mid - static_cast<double>(drift) * (h / 2.0) / m_drift_range;
+    };
+
+    QColor drift_color = QColor::fromHsv(0, 200, 210);
+    painter.setPen(QPen(drift_color, 1, Qt::DashLine));
+    painter.drawLine(QPointF(0, mid), QPointF(width(), mid));
+
+    // 从可见区间左侧的前一个采样画到右侧的后一个采样，曲线在边缘不断开
+    int64_t view_ms = m_timeline->m_base_ms + static_cast<int64_t>(m_view_begin * m_timeline->m_bucket_ms);
+    auto it = lower_bound(m_drift.begin(), m_drift.end(), view_ms, [](const DriftSample& sample, int64_t ms) {
+        return sample.m_dts < ms;
+    });
+    if (it != m_drift.begin())
+        --it;
+
+    painter.setPen(QPen(drift_color, 1.5));
+    QPointF prev(toX(it->m_dts), toY(it->m_drift));
+    for (++it; it != m_drift.end(); ++it) {
+        QPointF point(toX(it->m_dts), toY(it->m_drift));
+        painter.drawLine(prev, point);
+        if (point.x() > width())
+            break;
+        prev = point;
+    }
+
+    painter.drawText(QRect(0, 0, width() - 4, top), Qt::AlignRight, QString("漂移 ±%1 ms").arg(m_drift_range));
+}
+
+void TimelineWidget::mousePressEvent(QMouseEvent* event) {
+    if (!m_timeline || event->button() != Qt::LeftButton) {
+        return;
+    }
+
+    size_t begin = 0, end = 0;
+    bucketRange(event->pos().x(), begin, end);
+    int64_t tag = m_timeline->peakTag(begin, end);
+    if (tag >= 0) {
+        emit tagJumpRequested(static_cast<int>(tag));
+    }
+}
+
+void TimelineWidget::mouseMoveEvent(QMouseEvent* event) {
+    if (!m_timeline || m_timeline->m_bucket_count == 0) {
+        return;
+    }
+
+    size_t begin = 0, end = 0;
+    bucketRange(event->pos().x(), begin, end);
+    end = min(end, m_timeline->m_bucket_count);
+    if (begin >= end) {
+        return;
+    }
+
+    double seconds = (end - begin) * m_timeline->m_bucket_ms / 1000.0;
+    auto kbps = [&](int stream) {
+        return m_timeline->m_streams[stream].m_pyramid.query(begin, end).m_sum * 8.0 / 1000.0 / seconds;
+    };
+    int64_t begin_ms = m_timeline->m_base_ms + static_cast<int64_t>(begin) * m_timeline->m_bucket_ms;
+    int64_t end_ms = m_timeline->m_base_ms + static_cast<int64_t>(end) * m_timeline->m_bucket_ms;
+    QString drift_text;
+    if (const DriftSample* sample = driftAt(begin_ms, end_ms))
+        drift_text = QString("音视频漂移 %1 ms\n").arg(sample->m_drift);
+    QString text = QString("%1 s ~ %2 s\n视频 %3 kbps，音频 %4 kbps\n%5单击跳转到最大的tag\n\n%6")
+                       .arg(begin_ms / 1000.0, 0, 'f', 0)
+                       .arg(end_ms / 1000.0, 0, 'f', 0)
+                       .arg(kbps(BitrateTimeline::STREAM_VIDEO), 0, 'f', 1)
+                       .arg(kbps(BitrateTimeline::STREAM_AUDIO), 0, 'f', 1)
+                       .arg(drift_text)
+                       .arg(m_summary);
+    QToolTip::showText(event->globalPos(), text, this);
+}
+
+void TimelineWidget::wheelEvent(QWheelEvent* event) {
+    if (!m_timeline || m_timeline->m_bucket_count == 0) {
+        return;
+    }
+
+    // 以鼠标位置为中心缩放，最少显示4个时间桶
+    double total = static_cast<double>(m_timeline->m_bucket_count);
+    double span = m_view_end - m_view_begin;
+    double anchor = m_view_begin + span * event->position().x() / max(width(), 1);
+    double factor = event->angleDelta().y() > 0 ? 0.8 : 1.25;
+    double new_span = clamp(span * factor, min(4.0, total), total);
+
+    double ratio = (anchor - m_view_begin) / span;
+    m_view_begin = clamp(anchor - new_span * ratio, 0.0, total - new_span);
+    m_view_end = m_view_begin + new_span;
+    update();
+}
@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "BitrateTimeline.h"
+#include "TimestampAnalyzer.h"
+#include <QWidget>
+
+/**
+ * @class TimelineWidget
+ * @brief 码率时间线面板：每个像素列查询一次mip金字塔，滚轮缩放，单击跳转到该处最大的tag；
+ *        时间戳分析后叠加显示音视频漂移曲线
+ */
+class TimelineWidget : public QWidget {
+    Q_OBJECT
+
+  public:
+    explicit TimelineWidget(QWidget* parent = nullptr);
+
+    // timeline由调用方持有，需保证在本控件使用期间有效
+    void setTimeline(const BitrateTimeline* timeline);
+    // 音视频漂移采样，按DTS递增；重新设置时间线时清空
+    void setDrift(vector<DriftSample> drift);
+
+  signals:
+    // 跳转到tag列表中的指定tag（不含FLV Header行）
+    void tagJumpRequested(int tag_index);
+
+  protected:
+    void paintEvent(QPaintEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void wheelEvent(QWheelEvent* event) override;
+
+  private:
+    // 像素列x覆盖的时间桶区间[begin, end)
+    void bucketRange(int x, size_t& begin, size_t& end) const;
+    // 绘制漂移曲线，纵轴以中线为0，按采样中的最大漂移缩放
+    void paintDrift(QPainter& painter, int top, int h) const;
+    // [begin_ms, end_ms)内绝对值最大的漂移采样，没有采样时返回nullptr
+    const DriftSample* driftAt(int64_t begin_ms, int64_t end_ms) const;
+
+    const BitrateTimeline* m_timeline = nullptr;
+    double m_view_begin = 0; // 可见区间（时间桶）
+    double m_view_end = 0;
+    QString m_summary;
+    vector<DriftSample> m_drift;
+    int64_t m_drift_range = 0; // 纵轴半幅(ms)
+};
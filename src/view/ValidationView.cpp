@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#include "ValidationView.h"
+#include "ui_validationview.h"
+#include <QHeaderView>
+
+ValidationView::ValidationView(QWidget* parent) : QWidget(parent), ui(new Ui::ValidationView) {
+    ui->setupUi(this);
+
+    // 双击问题行跳转到对应tag
+    connect(ui->issueTableView, &QTableView::doubleClicked, this, &ValidationView::onIssueActivated);
+}
+
+ValidationView::~ValidationView() {
+    delete ui;
+}
+
+void ValidationView::setIssues(vector<ValidationIssue> issues, qint64 elapsed_ms) {
+    size_t errors = count_if(issues.begin(), issues.end(), [](const ValidationIssue& issue) {
+        return issue.m_severity == SEVERITY_ERROR;
+    });
+    QString summary = QString("共 %1 个问题（错误 %2，警告 %3），耗时 %4 ms，双击跳转到对应tag")
+                          .arg(issues.size())
+                          .arg(errors)
+                          .arg(issues.size() - errors)
+                          .arg(elapsed_ms);
+    setIssues(std::move(issues), summary);
+}
+
+void ValidationView::setIssues(vector<ValidationIssue> issues, const QString& summary) {
+    ui->summaryLabel->setText(summary);
+
+    m_issue_model = make_unique<ModelValidationIssues>(std::move(issues));
+    ui->issueTableView->setModel(m_issue_model.get());
+    ui->issueTableView->horizontalHeader()->setSortIndicator(0, Qt::AscendingOrder);
+}
+
+void ValidationView::clearIssues() {
+    ui->issueTableView->setModel(nullptr);
+    m_issue_model.reset();
+    ui->summaryLabel->setText("未校验");
+}
+
+void ValidationView::onIssueActivated(const QModelIndex& index) {
+    if (!index.isValid() || !m_issue_model) {
+        return;
+    }
+
+    const ValidationIssue& issue = m_issue_model->getIssue(index.row());
+    if (issue.m_tag_index >= 0) {
+        emit tagJumpRequested(static_cast<int>(issue.m_tag_index));
+    }
+}
@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: 2025 FLV Parser Contributors
+//
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "ModelWidget.h"
+#include <QWidget>
+#include <memory>
+
+using namespace std;
+
+QT_BEGIN_NAMESPACE
+namespace Ui {
+class ValidationView;
+}
+QT_END_NAMESPACE
+
+class ValidationView : public QWidget {
+    Q_OBJECT
+
+  public:
+    explicit ValidationView(QWidget* parent = nullptr);
+    ~ValidationView();
+
+    void setIssues(vector<ValidationIssue> issues, qint64 elapsed_ms);
+    // 显示其他分析产生的问题列表，summary显示在列表上方
+    void setIssues(vector<ValidationIssue> issues, const QString& summary);
+    void clearIssues();
+
+  signals:
+    // 跳转到tag列表中的指定tag（不含FLV Header行）
+    void tagJumpRequested(int tag_index);
+
+  private slots:
+    void onIssueActivated(const QModelIndex& index);
+
+  private:
+    Ui::ValidationView* ui;
+    unique_ptr<ModelValidationIssues> m_issue_model;
+};
@@ -4,16 +4,37 @@
 
 #include "mainwindow.h"
 #include "DeleteStrategy.h"
+#include "DiffView.h"
+#include "FlvConcat.h"
+#include "FlvCutter.h"
+#include "FlvDiff.h"
+#include "FlvSplitter.h"
 #include "Log.h"
+#include "MemoryBudget.h"
+#include "Mp4Remuxer.h"
+#include "RepairWriter.h"
+#include "SearchView.h"
+#include "StreamExtractor.h"
+#include "TimestampAnalyzer.h"
+#include "Trace.h"
+#include "TsMuxer.h"
 #include "docview.h"
 #include "logview.h"
 #include "tagview.h"
 #include "ui_mainwindow.h"
+#include "ValidationView.h"
 #include <QApplication>
+#include <QElapsedTimer>
 #include <QFileDialog>
+#include <QFileInfo>
+#include <QInputDialog>
 #include <QLabel>
 #include <QMessageBox>
+#include <QPointer>
+#include <QSettings>
 #include <QStackedWidget>
+#include <QTabWidget>
+#include <QTimer>
 #include <memory>
 
 using namespace std;
@@ -40,12 +61,38 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), ui(new Ui::MainWi
                            .arg(strongBlue.green())
                            .arg(strongBlue.blue());
     qApp->setStyleSheet(qApp->styleSheet() + selStyle);
+
+    // 内存预算和状态栏用量，每秒刷新
+    QSettings settings("flv-parser", "flv-parser");
+    uint64_t budget_mb = settings.value("memory/budget_mb", MemoryBudget::DEFAULT_LIMIT >> 20).toULongLong();
+    MemoryBudget::instance().setLimit(max<uint64_t>(budget_mb, 64) << 20);
+    m_memoryLabel = new QLabel(this);
+    statusBar()->addPermanentWidget(m_memoryLabel);
+    QTimer* memory_timer = new QTimer(this);
+    connect(memory_timer, &QTimer::timeout, this, &MainWindow::updateMemoryStatus);
+    memory_timer->start(1000);
+    updateMemoryStatus();
 }
 
 MainWindow::~MainWindow() {
+    m_loads.wait();
     delete ui;
 }
 
+// 后台解析的结果，由界面线程接收
+struct MainWindow::DocumentLoad {
+    unique_ptr<ModelTagList> m_model;
+    QString m_error;
+    qint64 m_elapsed = 0;
+};
+
+struct MainWindow::DiffTask {
+    uint64_t m_generation = 0; // 发起比较时A的文档版本号，完成时已重新加载、修改或切换则丢弃结果
+    unique_ptr<DiffResult> m_result;
+    QString m_error;
+    qint64 m_elapsed = 0;
+};
+
 void MainWindow::handleTagDelete(int row) {
     auto strategy = TagDeleteStrategyFactory::createStrategy(m_currentFile);
 
@@ -59,47 +106,126 @@ void MainWindow::handleTagDelete(int row) {
 }
 
 void MainWindow::on_actionopen_triggered() {
-    // 读文件
-    QString fileName = QFileDialog::getOpenFileName(this, "Open the file");
-    if (fileName.isEmpty())
-        return;
-    m_currentFile = fileName;
-    loadFile();
+    // 读文件，可同时选择多个，各自在后台并行解析
+    QStringList fileNames = QFileDialog::getOpenFileNames(this, "Open the file");
+    for (const QString& fileName : fileNames) {
+        openDocument(fileName);
+    }
+}
+
+void MainWindow::openDocument(const QString& path) {
+    m_stackedWidget->setCurrentWidget(m_documentTabs);
+    for (int i = 0; i < m_documentTabs->count(); ++i) {
+        auto* view = static_cast<TagView*>(m_documentTabs->widget(i));
+        if (QFileInfo(view->getFilePath()) == QFileInfo(path)) {
+            m_documentTabs->setCurrentIndex(i);
+            return;
+        }
+    }
+
+    TagView* view = new TagView(m_documentTabs);
+    view->setFilePath(path);
+    connect(view, &TagView::tagDeleteRequested, this, &MainWindow::handleTagDelete);
+    connect(view, &TagView::fileModified, this, [this, view]() { loadDocument(view); });
+    connect(view, &TagView::cutRequested, this, &MainWindow::handleCutRequest);
+
+    int index = m_documentTabs->addTab(view, QFileInfo(path).fileName());
+    m_documentTabs->setTabToolTip(index, path);
+    m_documentTabs->setCurrentIndex(index);
+    loadDocument(view);
 }
 
 void MainWindow::loadFile() {
-    m_stackedWidget->setCurrentWidget(m_tagView);
+    if (m_tagView) {
+        m_stackedWidget->setCurrentWidget(m_documentTabs);
+        loadDocument(m_tagView);
+    }
+}
+
+void MainWindow::loadDocument(TagView* view) {
+    // 搜索、校验和比较结果引用了旧的tag列表，需先清除
+    if (view == m_tagView) {
+        m_searchView->clearDocument();
+        m_validationView->clearIssues();
+        m_diffView->clearResult();
+    }
+    view->clearTagList();
+
+    QString path = view->getFilePath();
+    m_documentTabs->setTabText(m_documentTabs->indexOf(view), "⏳ " + QFileInfo(path).fileName());
+
+    // 模型在池线程中创建，解析完成后移回界面线程
+    bool recover = ui->actionRecoveryMode->isChecked();
+    QPointer<TagView> target(view);
+    m_loads.run([this, target, path, recover]() {
+        TRACE_SCOPE("load_file");
+        auto load = make_shared<DocumentLoad>();
+        QElapsedTimer timer;
+        timer.start();
+
+        QFile file(path);
+        if (file.open(QFile::ReadWrite)) {
+            load->m_model = make_unique<ModelTagList>();
+            load->m_model->readFromFile(file, recover);
+            load->m_model->moveToThread(QApplication::instance()->thread());
+        } else {
+            load->m_error = file.errorString();
+        }
+        load->m_elapsed = timer.elapsed();
 
-    QFile file(m_currentFile);
+        QMetaObject::invokeMethod(
+            this, [this, target, load]() { finishLoad(target, load); }, Qt::QueuedConnection);
+    });
+}
+
+void MainWindow::finishLoad(TagView* view, const shared_ptr<DocumentLoad>& load) {
+    int index = view ? m_documentTabs->indexOf(view) : -1;
+    if (index < 0) {
+        return; // 解析期间标签页已关闭
+    }
 
-    if (!file.open(QFile::ReadWrite)) {
-        QMessageBox::warning(this, "Warning", "Cannot open file: " + file.errorString());
+    if (!load->m_model) {
+        QMessageBox::warning(this, "Warning", "Cannot open file: " + load->m_error);
+        onDocumentCloseRequested(index);
         return;
     }
-    setWindowTitle(m_currentFile);
 
-    // 在状态栏提示正在处理
-    m_tagView->clearTagList(); // 清除旧数据
+    m_documentTabs->setTabText(index, QFileInfo(view->getFilePath()).fileName());
+    view->setTagList(std::move(load->m_model));
+    // 后台解析只记账，由界面线程统一释放超出预算的缓存
+    MemoryBudget::instance().trim();
+    qCInfo(runLog) << QString("[flv-parsing] event[document loaded] file[%1] tags[%2] elapsed[%3ms]")
+                          .arg(view->getFilePath())
+                          .arg(view->getTagModel()->getTagIndex().size())
+                          .arg(load->m_elapsed);
 
-    QLabel* statusLabel = new QLabel("⏳ Processing...");
-    statusLabel->setStyleSheet("color: #0066cc; font-weight: bold;");
-    statusBar()->addWidget(statusLabel);
-    QApplication::processEvents(); // 强制刷新UI，让提示立即显示
+    if (view == m_tagView) {
+        m_searchView->setDocument(view->getFilePath(), view->getTagModel());
+    }
+}
 
-    // 解析文件
-    auto tag_table_model = make_unique<ModelTagList>();
-    tag_table_model->readFromFile(file);
-    file.close();
+void MainWindow::onDocumentChanged(int index) {
+    m_tagView = index >= 0 ? static_cast<TagView*>(m_documentTabs->widget(index)) : nullptr;
+    m_currentFile = m_tagView ? m_tagView->getFilePath() : QString();
+    setWindowTitle(m_currentFile);
 
-    // 设置帧列表到视图
-    if (m_tagView) {
-        m_tagView->setFilePath(m_currentFile);
-        m_tagView->setTagList(std::move(tag_table_model));
+    // 搜索、校验和比较结果属于之前的文档；解析结果留在各自的标签页中，切换时不需要重新解析
+    m_validationView->clearIssues();
+    m_diffView->clearResult();
+    if (m_tagView && m_tagView->getTagModel()) {
+        m_searchView->setDocument(m_currentFile, m_tagView->getTagModel());
+    } else {
+        m_searchView->clearDocument();
     }
+}
 
-    // 处理完成后清除提示
-    statusBar()->clearMessage();
-    statusBar()->removeWidget(statusLabel);
+void MainWindow::onDocumentCloseRequested(int index) {
+    QWidget* view = m_documentTabs->widget(index);
+    if (view == m_tagView) {
+        m_searchView->clearDocument();
+    }
+    m_documentTabs->removeTab(index); // 关闭当前标签页时会触发onDocumentChanged
+    view->deleteLater();
 }
 
 void MainWindow::on_actionabout_triggered() {
@@ -116,9 +242,66 @@ void MainWindow::on_actionViewLog_triggered() {
     }
 }
 
+void MainWindow::on_actionDebugLog_toggled(bool checked) {
+    setDebugLogEnabled(checked);
+}
+
+void MainWindow::on_actionTrace_toggled(bool checked) {
+    if (checked) {
+        Trace::start();
+    } else {
+        Trace::stop();
+    }
+}
+
+void MainWindow::on_actionExportTrace_triggered() {
+    size_t event_count = Trace::eventCount();
+    if (event_count == 0) {
+        QMessageBox::information(this, "提示", "没有跟踪记录，请先勾选“记录性能跟踪”再打开或编辑文件");
+        return;
+    }
+
+    QString target =
+        QFileDialog::getSaveFileName(this, "导出性能跟踪", "flv_parser_trace.json", "Chrome trace (*.json)");
+    if (target.isEmpty())
+        return;
+
+    QString error;
+    if (!Trace::exportChromeJson(target, error)) {
+        QMessageBox::warning(this, "错误", "导出失败：" + error);
+        return;
+    }
+    QMessageBox::information(this, "导出完成", QString("已导出%1个区间").arg(event_count));
+}
+
+void MainWindow::on_actionMemoryBudget_triggered() {
+    MemoryBudget& budget = MemoryBudget::instance();
+    bool ok = false;
+    int value = QInputDialog::getInt(this,
+                                     "内存预算",
+                                     budget.toString() + "\n\n超出预算时释放最久未查看的tag二进制数据和字段树(MB)",
+                                     static_cast<int>(budget.limit() >> 20),
+                                     64,
+                                     1024 * 1024,
+                                     64,
+                                     &ok);
+    if (!ok)
+        return;
+
+    budget.setLimit(static_cast<uint64_t>(value) << 20);
+    QSettings("flv-parser", "flv-parser").setValue("memory/budget_mb", value);
+    updateMemoryStatus();
+}
+
+void MainWindow::updateMemoryStatus() {
+    const MemoryBudget& budget = MemoryBudget::instance();
+    m_memoryLabel->setText(QString("内存 %1/%2 MB").arg(budget.total() >> 20).arg(budget.limit() >> 20));
+    m_memoryLabel->setToolTip(budget.toString());
+}
+
 void MainWindow::on_actionViewMain_triggered() {
-    if (m_stackedWidget && m_tagView) {
-        m_stackedWidget->setCurrentWidget(m_tagView);
+    if (m_stackedWidget && m_documentTabs) {
+        m_stackedWidget->setCurrentWidget(m_documentTabs);
     }
 }
 
@@ -129,20 +312,414 @@ void MainWindow::on_actionViewDoc_triggered() {
     }
 }
 
+void MainWindow::on_actionValidate_triggered() {
+    ModelTagList* model = m_tagView ? m_tagView->getTagModel() : nullptr;
+    if (!model) {
+        QMessageBox::information(this, "提示", "请先打开FLV文件");
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    auto issues = StreamValidator::validate(model->getFlvHeader(), model->getTagIndex());
+    qint64 elapsed = timer.elapsed();
+    qCInfo(runLog) << QString("[flv-validating] event[finished] issues[%1] elapsed[%2ms]").arg(issues.size()).arg(elapsed);
+
+    m_validationView->setIssues(std::move(issues), elapsed);
+    m_stackedWidget->setCurrentWidget(m_validationView);
+}
+
+void MainWindow::on_actionRepair_triggered() {
+    ModelTagList* model = m_tagView ? m_tagView->getTagModel() : nullptr;
+    if (!model) {
+        QMessageBox::information(this, "提示", "请先打开FLV文件");
+        return;
+    }
+
+    QFileInfo info(m_currentFile);
+    QString default_path = info.absolutePath() + "/" + info.completeBaseName() + "_repaired.flv";
+    QString target = QFileDialog::getSaveFileName(this, "修复并另存为", default_path, "FLV (*.flv)");
+    if (target.isEmpty())
+        return;
+
+    QElapsedTimer timer;
+    timer.start();
+    RepairReport report;
+    bool ok = RepairWriter::repair(
+        m_currentFile, target, model->getTagList(), model->getTagIndex(), RepairOptions(), report);
+    qint64 elapsed = timer.elapsed();
+
+    if (!ok) {
+        QMessageBox::warning(this, "错误", "修复失败：" + report.m_error);
+        return;
+    }
+    QMessageBox::information(this, "修复完成", report.toString() + QString("\n耗时%1ms").arg(elapsed));
+
+    // 修复覆盖了当前文件时重新加载
+    if (QFileInfo(target) == info) {
+        loadFile();
+    }
+}
+
+void MainWindow::on_actionExtractVideo_triggered() {
+    extractStream(StreamExtractor::TRACK_VIDEO);
+}
+
+void MainWindow::on_actionExtractAudio_triggered() {
+    extractStream(StreamExtractor::TRACK_AUDIO);
+}
+
+void MainWindow::extractStream(uint8_t track) {
+    ModelTagList* model = m_tagView ? m_tagView->getTagModel() : nullptr;
+    if (!model) {
+        QMessageBox::information(this, "提示", "请先打开FLV文件");
+        return;
+    }
+
+    auto stream_track = static_cast<StreamExtractor::TRACK>(track);
+    QString title = track == StreamExtractor::TRACK_VIDEO ? "导出视频流" : "导出音频流";
+
+    // 多轨文件先选择轨道
+    uint8_t track_id = 0;
+    vector<uint8_t> track_ids =
+        model->getTagIndex().trackIds(track == StreamExtractor::TRACK_VIDEO ? TAG_TYPE_VIDEO : TAG_TYPE_AUDIO);
+    if (track_ids.size() > 1) {
+        QStringList items;
+        for (uint8_t id : track_ids)
+            items.append(QString::number(id));
+        bool ok = false;
+        QString item = QInputDialog::getItem(this, title, "轨道", items, 0, false, &ok);
+        if (!ok)
+            return;
+        track_id = static_cast<uint8_t>(item.toUInt());
+    }
+
+    QString format = StreamExtractor::outputFormat(model->getTagIndex(), stream_track, track_id);
+    if (format.isEmpty()) {
+        QMessageBox::information(this, "提示", "没有可导出的流，目前支持H.264、HEVC、AAC和MP3");
+        return;
+    }
+
+    QFileInfo info(m_currentFile);
+    QString default_path = info.absolutePath() + "/" + info.completeBaseName() + "." + format;
+    QString target =
+        QFileDialog::getSaveFileName(this, title, default_path, QString("%1 (*.%2)").arg(format.toUpper(), format));
+    if (target.isEmpty())
+        return;
+
+    QElapsedTimer timer;
+    timer.start();
+    ExtractReport report;
+    bool ok = StreamExtractor::extract(m_currentFile, target, model->getTagIndex(), stream_track, report, track_id);
+    qint64 elapsed = timer.elapsed();
+
+    if (!ok) {
+        QMessageBox::warning(this, "错误", "导出失败：" + report.m_error);
+        return;
+    }
+    QMessageBox::information(this, "导出完成", report.toString() + QString("\n耗时%1ms").arg(elapsed));
+}
+
+void MainWindow::on_actionConcat_triggered() {
+    QString dir = m_currentFile.isEmpty() ? QString() : QFileInfo(m_currentFile).absolutePath();
+    QStringList sources = QFileDialog::getOpenFileNames(this, "选择要合并的片段", dir, "FLV (*.flv)");
+    if (sources.isEmpty())
+        return;
+    if (sources.size() < 2) {
+        QMessageBox::information(this, "提示", "至少选择两个片段");
+        return;
+    }
+    // 对话框返回的顺序不固定，按文件名排序，录制工具的分段文件名通常带序号或时间
+    sources.sort();
+
+    QFileInfo info(sources.first());
+    QString default_path = info.absolutePath() + "/" + info.completeBaseName() + "_merged.flv";
+    QString target = QFileDialog::getSaveFileName(this, "合并并另存为", default_path, "FLV (*.flv)");
+    if (target.isEmpty())
+        return;
+
+    ConcatOptions options;
+    QElapsedTimer timer;
+    timer.start();
+    ConcatReport report;
+    bool ok = FlvConcat::concat(sources, target, options, report);
+    if (!ok && report.m_error.contains("sequence header")) {
+        QString question = report.m_error + "\n\n是否保留各片段的sequence header继续合并？";
+        auto button = QMessageBox::question(this, "编码参数不同", question);
+        if (button == QMessageBox::Yes) {
+            options.m_allow_config_change = true;
+            ok = FlvConcat::concat(sources, target, options, report);
+        }
+    }
+    qint64 elapsed = timer.elapsed();
+
+    if (!ok) {
+        QMessageBox::warning(this, "错误", "合并失败：" + report.m_error);
+        return;
+    }
+    QMessageBox::information(this, "合并完成", report.toString() + QString("\n耗时%1ms").arg(elapsed));
+}
+
+void MainWindow::on_actionSplit_triggered() {
+    ModelTagList* model = m_tagView ? m_tagView->getTagModel() : nullptr;
+    if (!model) {
+        QMessageBox::information(this, "提示", "请先打开FLV文件");
+        return;
+    }
+
+    const QStringList modes = {"按时长（分钟）", "按大小（MB）", "按关键帧数"};
+    bool ok = false;
+    QString mode = QInputDialog::getItem(this, "分割", "分割方式", modes, 0, false, &ok);
+    if (!ok)
+        return;
+    int value = QInputDialog::getInt(this, "分割", mode, mode == modes[0] ? 60 : 1024, 1, 1000000, 1, &ok);
+    if (!ok)
+        return;
+
+    SplitOptions options;
+    if (mode == modes[0]) {
+        options.m_mode = SplitOptions::MODE_DURATION;
+        options.m_value = static_cast<uint64_t>(value) * 60 * 1000;
+    } else if (mode == modes[1]) {
+        options.m_mode = SplitOptions::MODE_SIZE;
+        options.m_value = static_cast<uint64_t>(value) * 1024 * 1024;
+    } else {
+        options.m_mode = SplitOptions::MODE_KEYFRAMES;
+        options.m_value = static_cast<uint64_t>(value);
+    }
+
+    QFileInfo info(m_currentFile);
+    QString output_dir = QFileDialog::getExistingDirectory(this, "选择输出目录", info.absolutePath());
+    if (output_dir.isEmpty())
+        return;
+
+    QElapsedTimer timer;
+    timer.start();
+    SplitReport report;
+    ok = FlvSplitter::split(m_currentFile, output_dir, model->getTagList(), model->getTagIndex(), options, report);
+    qint64 elapsed = timer.elapsed();
+
+    if (!ok) {
+        QMessageBox::warning(this, "错误", "分割失败：" + report.m_error);
+        return;
+    }
+    QMessageBox::information(this, "分割完成", report.toString() + QString("\n耗时%1ms").arg(elapsed));
+}
+
+void MainWindow::on_actionRemuxMp4_triggered() {
+    ModelTagList* model = m_tagView ? m_tagView->getTagModel() : nullptr;
+    if (!model) {
+        QMessageBox::information(this, "提示", "请先打开FLV文件");
+        return;
+    }
+
+    QFileInfo info(m_currentFile);
+    QString default_path = info.absolutePath() + "/" + info.completeBaseName() + ".mp4";
+    QString target = QFileDialog::getSaveFileName(this, "转封装为fMP4", default_path, "MP4 (*.mp4 *.m4s)");
+    if (target.isEmpty())
+        return;
+
+    QElapsedTimer timer;
+    timer.start();
+    RemuxReport report;
+    bool ok = Mp4Remuxer::remux(m_currentFile, target, model->getTagList(), model->getTagIndex(), report);
+    qint64 elapsed = timer.elapsed();
+
+    if (!ok) {
+        QMessageBox::warning(this, "错误", "转封装失败：" + report.m_error);
+        return;
+    }
+    QMessageBox::information(this, "转封装完成", report.toString() + QString("\n耗时%1ms").arg(elapsed));
+}
+
+void MainWindow::on_actionRemuxTs_triggered() {
+    ModelTagList* model = m_tagView ? m_tagView->getTagModel() : nullptr;
+    if (!model) {
+        QMessageBox::information(this, "提示", "请先打开FLV文件");
+        return;
+    }
+
+    QFileInfo info(m_currentFile);
+    QString default_path = info.absolutePath() + "/" + info.completeBaseName() + ".m3u8";
+    QString target = QFileDialog::getSaveFileName(
+        this, "转封装为MPEG-TS/HLS", default_path, "HLS (*.m3u8);;MPEG-TS (*.ts)");
+    if (target.isEmpty())
+        return;
+
+    TsOptions options;
+    options.m_hls = target.endsWith(".m3u8", Qt::CaseInsensitive);
+    QElapsedTimer timer;
+    timer.start();
+    TsReport report;
+    bool ok = TsMuxer::remux(m_currentFile, target, model->getTagIndex(), options, report);
+    qint64 elapsed = timer.elapsed();
+
+    if (!ok) {
+        QMessageBox::warning(this, "错误", "转封装失败：" + report.m_error);
+        return;
+    }
+    QMessageBox::information(this, "转封装完成", report.toString() + QString("\n耗时%1ms").arg(elapsed));
+}
+
+void MainWindow::on_actionAnalyzeTiming_triggered() {
+    ModelTagList* model = m_tagView ? m_tagView->getTagModel() : nullptr;
+    if (!model) {
+        QMessageBox::information(this, "提示", "请先打开FLV文件");
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    TimingAnalysis analysis = TimestampAnalyzer::analyze(model->getTagIndex());
+    qint64 elapsed = timer.elapsed();
+    qCInfo(runLog) << QString("[flv-analyzing] event[timing finished] issues[%1] max_drift[%2ms] elapsed[%3ms]")
+                          .arg(analysis.m_issues.size())
+                          .arg(analysis.m_max_drift)
+                          .arg(elapsed);
+
+    QString summary = analysis.summary() +
+                      QString("\n共 %1 个问题，耗时 %2 ms，双击跳转到对应tag").arg(analysis.m_issues.size()).arg(elapsed);
+    if (!analysis.m_drift.empty())
+        summary += "，漂移曲线已叠加在码率时间线上";
+    m_tagView->setDrift(std::move(analysis.m_drift));
+    m_validationView->setIssues(std::move(analysis.m_issues), summary);
+    m_stackedWidget->setCurrentWidget(m_validationView);
+}
+
+void MainWindow::on_actionSearch_triggered() {
+    m_stackedWidget->setCurrentWidget(m_searchView);
+}
+
+void MainWindow::on_actionDiff_triggered() {
+    ModelTagList* model = m_tagView ? m_tagView->getTagModel() : nullptr;
+    if (!model) {
+        QMessageBox::information(this, "提示", "请先打开FLV文件");
+        return;
+    }
+
+    QString other = QFileDialog::getOpenFileName(this, "选择要比较的文件", QFileInfo(m_currentFile).absolutePath());
+    if (other.isEmpty())
+        return;
+
+    // A的索引和onMetaData复制一份，比较期间A可能被重新加载
+    auto task = make_shared<DiffTask>();
+    task->m_generation = m_tagView->getGeneration();
+    auto index_a = make_shared<TagIndex>(model->getTagIndex());
+    shared_ptr<MetadataItem> metadata_a;
+    if (const MetadataItem* metadata = FlvDiff::firstMetadata(*model))
+        metadata_a = make_shared<MetadataItem>(*metadata);
+
+    statusBar()->showMessage("正在比较：" + QFileInfo(other).fileName());
+    m_loads.run([this, task, path_a = m_currentFile, index_a, metadata_a, other]() {
+        TRACE_SCOPE("diff_files");
+        QElapsedTimer timer;
+        timer.start();
+        try {
+            task->m_result = make_unique<DiffResult>(FlvDiff::compareFiles(path_a, *index_a, metadata_a.get(), other));
+        } catch (const QString& error) {
+            task->m_error = error;
+        }
+        task->m_elapsed = timer.elapsed();
+
+        QMetaObject::invokeMethod(
+            this, [this, task]() { finishDiff(task); }, Qt::QueuedConnection);
+    });
+}
+
+void MainWindow::finishDiff(const shared_ptr<DiffTask>& task) {
+    statusBar()->clearMessage();
+    if (!task->m_result) {
+        QMessageBox::warning(this, "错误", "比较失败：" + task->m_error);
+        return;
+    }
+    if (!m_tagView || m_tagView->getGeneration() != task->m_generation) {
+        return; // 比较期间A已重新加载、修改或切换，结果中的下标不再对应
+    }
+
+    m_diffView->setResult(std::move(task->m_result), task->m_elapsed);
+    m_stackedWidget->setCurrentWidget(m_diffView);
+}
+
+void MainWindow::on_actionHashTags_triggered() {
+    ModelTagList* model = m_tagView ? m_tagView->getTagModel() : nullptr;
+    if (!model) {
+        QMessageBox::information(this, "提示", "请先打开FLV文件");
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    try {
+        auto duplicates = model->computePayloadHashes(m_currentFile);
+        qint64 elapsed = timer.elapsed();
+        QString summary = QString("已计算 %1 个tag的负载哈希，发现 %2 个重复，耗时 %3 ms\n"
+                                  "tag列表中可用 duplicate 或 hash=<哈希> 过滤，双击跳转到对应tag")
+                              .arg(model->getTagIndex().size())
+                              .arg(duplicates.size())
+                              .arg(elapsed);
+        m_validationView->setIssues(std::move(duplicates), summary);
+        m_stackedWidget->setCurrentWidget(m_validationView);
+    } catch (const QString& error) {
+        QMessageBox::warning(this, "错误", "计算哈希失败：" + error);
+    }
+}
+
+void MainWindow::handleCutRequest(uint32_t start, uint32_t end) {
+    ModelTagList* model = m_tagView ? m_tagView->getTagModel() : nullptr;
+    if (!model) {
+        return;
+    }
+
+    QFileInfo info(m_currentFile);
+    QString default_path =
+        info.absolutePath() + "/" + info.completeBaseName() + QString("_%1-%2.flv").arg(start / 1000).arg(end / 1000);
+    QString target = QFileDialog::getSaveFileName(this, "截取并另存为", default_path, "FLV (*.flv)");
+    if (target.isEmpty())
+        return;
+    if (QFileInfo(target) == info) {
+        QMessageBox::warning(this, "错误", "不能覆盖当前打开的文件");
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    CutReport report;
+    bool ok = FlvCutter::cut(m_currentFile, target, model->getTagList(), model->getTagIndex(), start, end, report);
+    qint64 elapsed = timer.elapsed();
+
+    if (!ok) {
+        QMessageBox::warning(this, "错误", "截取失败：" + report.m_error);
+        return;
+    }
+    QMessageBox::information(this, "截取完成", report.toString() + QString("\n耗时%1ms").arg(elapsed));
+}
+
+void MainWindow::handleBytesJump(int tag_index, qint64 offset, quint32 length) {
+    if (!m_tagView)
+        return;
+    m_stackedWidget->setCurrentWidget(m_documentTabs);
+    m_tagView->selectTagBytes(tag_index, offset, length);
+}
+
+void MainWindow::handleTagJump(int tag_index) {
+    if (!m_tagView)
+        return;
+    m_stackedWidget->setCurrentWidget(m_documentTabs);
+    m_tagView->selectTag(tag_index);
+}
+
 void MainWindow::setupViews() {
     // 创建StackedWidget作为中央widget
     m_stackedWidget = new QStackedWidget(this);
     setCentralWidget(m_stackedWidget);
 
-    // 创建帧视图
-    m_tagView = new TagView(this);
-    m_stackedWidget->addWidget(m_tagView);
-
-    // 连接帧删除信号
-    connect(m_tagView, &TagView::tagDeleteRequested, this, &MainWindow::handleTagDelete);
-
-    // 连接文件修改信号
-    connect(m_tagView, &TagView::fileModified, this, &MainWindow::loadFile);
+    // 创建文档标签页，打开文件时每个文件新建一个帧视图，帧删除、文件修改和截取信号在openDocument中连接
+    m_tagView = nullptr;
+    m_documentTabs = new QTabWidget(this);
+    m_documentTabs->setTabsClosable(true);
+    m_documentTabs->setMovable(true);
+    m_documentTabs->setDocumentMode(true);
+    m_stackedWidget->addWidget(m_documentTabs);
 
     // 创建日志查看界面
     m_logView = new LogView(this);
@@ -152,6 +729,25 @@ void MainWindow::setupViews() {
     m_docView = new DocView(this);
     m_stackedWidget->addWidget(m_docView);
 
+    // 创建校验结果界面
+    m_validationView = new ValidationView(this);
+    m_stackedWidget->addWidget(m_validationView);
+    connect(m_validationView, &ValidationView::tagJumpRequested, this, &MainWindow::handleTagJump);
+
+    // 创建搜索界面
+    m_searchView = new SearchView(this);
+    m_stackedWidget->addWidget(m_searchView);
+    connect(m_searchView, &SearchView::bytesJumpRequested, this, &MainWindow::handleBytesJump);
+
+    // 创建文件比较界面
+    m_diffView = new DiffView(this);
+    m_stackedWidget->addWidget(m_diffView);
+    connect(m_diffView, &DiffView::tagJumpRequested, this, &MainWindow::handleTagJump);
+
+    // 其他视图创建后再连接，切换标签页时会更新它们
+    connect(m_documentTabs, &QTabWidget::currentChanged, this, &MainWindow::onDocumentChanged);
+    connect(m_documentTabs, &QTabWidget::tabCloseRequested, this, &MainWindow::onDocumentCloseRequested);
+
     // 默认显示帧视图
     m_stackedWidget->setCurrentIndex(0);
 }
@@ -4,9 +4,11 @@
 
 #pragma once
 
+#include "ThreadPool.h"
 #include "modelwidget.h"
 #include <QAction>
 #include <QItemSelection>
+#include <QLabel>
 #include <QMainWindow>
 #include <QMenu>
 
@@ -21,9 +23,13 @@ class MainWindow;
 QT_END_NAMESPACE
 
 class QStackedWidget;
+class QTabWidget;
 class LogView;
 class TagView;
 class DocView;
+class ValidationView;
+class SearchView;
+class DiffView;
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -38,24 +44,84 @@ class MainWindow : public QMainWindow {
     void on_actionabout_triggered();
 
     void on_actionViewLog_triggered();
+    void on_actionDebugLog_toggled(bool checked);
+    void on_actionTrace_toggled(bool checked);
+    void on_actionExportTrace_triggered();
+    void on_actionMemoryBudget_triggered();
 
     void on_actionViewMain_triggered();
 
     void on_actionViewDoc_triggered();
 
+    void on_actionValidate_triggered();
+
+    void on_actionRepair_triggered();
+
+    void on_actionExtractVideo_triggered();
+
+    void on_actionExtractAudio_triggered();
+
+    void on_actionConcat_triggered();
+
+    void on_actionSplit_triggered();
+
+    void on_actionRemuxMp4_triggered();
+
+    void on_actionRemuxTs_triggered();
+
+    void on_actionAnalyzeTiming_triggered();
+
+    void on_actionSearch_triggered();
+
+    void on_actionDiff_triggered();
+
+    void on_actionHashTags_triggered();
+
+    void handleTagJump(int tag_index);
+
+    void handleBytesJump(int tag_index, qint64 offset, quint32 length);
+
     void handleTagDelete(int row);
 
+    void handleCutRequest(uint32_t start, uint32_t end);
+
+    void onDocumentChanged(int index);
+
+    void onDocumentCloseRequested(int index);
+
   private:
+    struct DocumentLoad;
+    struct DiffTask;
+
+    // 已打开时切换到对应标签页，否则新建标签页并在后台解析
+    void openDocument(const QString& path);
+    // 在共用线程池中解析view对应的文件，完成后由finishLoad在界面线程设置到视图
+    void loadDocument(TagView* view);
+    void finishLoad(TagView* view, const shared_ptr<DocumentLoad>& load);
+    // 比较在池线程中进行，完成后由finishDiff在界面线程显示结果
+    void finishDiff(const shared_ptr<DiffTask>& task);
+    // 重新加载当前文档
     void loadFile();
     void setupViews();
+    // track为StreamExtractor::TRACK
+    void extractStream(uint8_t track);
+    void updateMemoryStatus();
 
   private:
     Ui::MainWindow* ui;
-    QString m_currentFile;
+    QString m_currentFile; // 当前标签页的文件
 
     // 视图管理
     QStackedWidget* m_stackedWidget;
-    TagView* m_tagView;
+    QTabWidget* m_documentTabs; // 每个打开的文件一个帧视图，各自持有解析结果，切换时不重新解析
+    TagView* m_tagView;         // 当前标签页的帧视图，没有打开文件时为空
     LogView* m_logView;
     DocView* m_docView;
+    ValidationView* m_validationView;
+    SearchView* m_searchView;
+    DiffView* m_diffView;
+
+    QLabel* m_memoryLabel; // 状态栏常驻的内存用量
+
+    TaskGroup m_loads; // 后台解析、比较任务，析构时等待完成
 };